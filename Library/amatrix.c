@@ -91,7 +91,7 @@ init_pointer_amatrix(pamatrix a, pfield src, uint rows, uint cols)
   a->a = src;
   a->rows = rows;
   a->ld = rows;
-  a->cols = rows;
+  a->cols = cols;
   a->owner = src;
 
 #ifdef USE_OPENMP
@@ -934,6 +934,79 @@ mvm_amatrix_avector(field alpha, bool atrans, pcamatrix a, pcavector src,
     addeval_amatrix_avector(alpha, a, src, trg);
 }
 
+/* ------------------------------------------------------------
+ * Reduced-precision storage
+ * ------------------------------------------------------------ */
+
+plowfield
+lowprec_amatrix(pcamatrix a)
+{
+  plowfield al;
+  longindex lda = a->ld;
+  longindex rows = a->rows;
+  uint      i, j;
+
+  if (a->rows == 0 || a->cols == 0)
+    return NULL;
+
+  al = (plowfield) allocmem(sizeof(lowfield) * rows * a->cols);
+
+  for (j = 0; j < a->cols; j++)
+    for (i = 0; i < a->rows; i++)
+      al[i + j * rows] = (lowfield) a->a[i + j * lda];
+
+  return al;
+}
+
+void
+fullprec_amatrix(pclowfield al, pamatrix a)
+{
+  longindex lda = a->ld;
+  longindex rows = a->rows;
+  uint      i, j;
+
+  for (j = 0; j < a->cols; j++)
+    for (i = 0; i < a->rows; i++)
+      a->a[i + j * lda] = (field) al[i + j * rows];
+}
+
+void
+addeval_lowprec_avector(field alpha, uint rows, uint cols, pclowfield a,
+			pcavector src, pavector trg)
+{
+  field     beta;
+  longindex lda = rows;
+  uint      i, j;
+
+  assert(src->dim >= cols);
+  assert(trg->dim >= rows);
+
+  for (j = 0; j < cols; j++) {
+    beta = alpha * src->v[j];
+    for (i = 0; i < rows; i++)
+      trg->v[i] += beta * (field) a[i + j * lda];
+  }
+}
+
+void
+addevaltrans_lowprec_avector(field alpha, uint rows, uint cols,
+			     pclowfield a, pcavector src, pavector trg)
+{
+  field     sum;
+  longindex lda = rows;
+  uint      i, j;
+
+  assert(src->dim >= rows);
+  assert(trg->dim >= cols);
+
+  for (j = 0; j < cols; j++) {
+    sum = f_zero;
+    for (i = 0; i < rows; i++)
+      sum += CONJ((field) a[i + j * lda]) * src->v[i];
+    trg->v[j] += alpha * sum;
+  }
+}
+
 #ifdef USE_BLAS
 void
 add_amatrix(field alpha, bool atrans, pcamatrix a, pamatrix b)
@@ -651,6 +651,62 @@ HEADER_PREFIX void
 mvm_amatrix_avector(field alpha, bool atrans, pcamatrix a, pcavector src,
     pavector trg);
 
+/** @brief Create a reduced-precision copy of a matrix.
+ *
+ *  The coefficients of @f$A@f$ are rounded to @ref lowfield and stored
+ *  in column-major order with leading dimension <tt>a->rows</tt>.
+ *
+ *  @remark The array has to be released by @ref freemem.
+ *
+ *  @param a Matrix @f$A@f$.
+ *  @returns Reduced-precision coefficients or <tt>NULL</tt> if
+ *    @f$A@f$ is empty. */
+HEADER_PREFIX plowfield
+lowprec_amatrix(pcamatrix a);
+
+/** @brief Restore a matrix from a reduced-precision copy.
+ *
+ *  @param al Reduced-precision coefficients created by
+ *    @ref lowprec_amatrix.
+ *  @param a Target matrix, has to provide storage for the
+ *    coefficients. */
+HEADER_PREFIX void
+fullprec_amatrix(pclowfield al, pamatrix a);
+
+/** @brief Multiply a reduced-precision matrix @f$A@f$ by a vector
+ *  @f$x@f$, @f$y \gets y + \alpha A x@f$.
+ *
+ *  The coefficients are converted to @ref field on the fly, all
+ *  sums are accumulated in @ref field.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param rows Number of rows of @f$A@f$.
+ *  @param cols Number of columns of @f$A@f$.
+ *  @param a Coefficients of @f$A@f$ in column-major order with leading
+ *    dimension <tt>rows</tt>.
+ *  @param src Source vector @f$x@f$.
+ *  @param trg Target vector @f$y@f$. */
+HEADER_PREFIX void
+addeval_lowprec_avector(field alpha, uint rows, uint cols, pclowfield a,
+    pcavector src, pavector trg);
+
+/** @brief Multiply the adjoint of a reduced-precision matrix @f$A@f$
+ *  by a vector @f$x@f$, @f$y \gets y + \alpha A^* x@f$.
+ *
+ *  The coefficients are converted to @ref field on the fly, all
+ *  sums are accumulated in @ref field.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param rows Number of rows of @f$A@f$.
+ *  @param cols Number of columns of @f$A@f$.
+ *  @param a Coefficients of @f$A@f$ in column-major order with leading
+ *    dimension <tt>rows</tt>.
+ *  @param src Source vector @f$x@f$.
+ *  @param trg Target vector @f$y@f$. */
+HEADER_PREFIX void
+addevaltrans_lowprec_avector(field alpha, uint rows, uint cols,
+    pclowfield a, pcavector src, pavector trg);
+
 /** @brief Add two matrices,
  *  @f$B \gets B + \alpha A@f$ or @f$B \gets B + \alpha A^*@f$.
  *
@@ -11,6 +11,10 @@
 #include <math.h>
 #include <stdio.h>
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 static uint active_avector = 0;
 
 /* ------------------------------------------------------------
@@ -228,6 +232,216 @@ getsize_heap_avector(pcavector v)
   return sz;
 }
 
+/* ------------------------------------------------------------
+ * Blocked kernels
+ * ------------------------------------------------------------ */
+
+/* Long vectors are split into blocks of this length that are handled
+ * by different threads. Reductions add the contributions of the blocks
+ * in a fixed order, so the results do not depend on the number of
+ * threads. Vectors with only one block call the serial kernel directly
+ * without entering a parallel region. Since all kernels distribute the
+ * blocks in the same way, a vector initialized by clear_avector or
+ * fill_avector is also placed in the memory of the threads that will
+ * work on it. */
+#define AVECTOR_BLOCK 16384
+
+/* Reductions collect the contributions of up to this many blocks
+ * in a buffer on the stack */
+#define AVECTOR_PARTS 64
+
+static uint
+blocks_avector(uint dim)
+{
+  return (dim + AVECTOR_BLOCK - 1) / AVECTOR_BLOCK;
+}
+
+static uint
+blocksize_avector(uint dim, uint b)
+{
+  return UINT_MIN(AVECTOR_BLOCK, dim - b * AVECTOR_BLOCK);
+}
+
+#ifdef USE_OPENMP
+/* Only split if the nesting depth permits another parallel region */
+#define AVECTOR_PARALLEL() \
+  (omp_get_active_level() < max_pardepth)
+#endif
+
+#ifdef USE_COMPLEX
+/* The C99 complex multiplication takes care of infinite operands by
+ * calling a library function, which prevents the fused loops from
+ * being vectorized, so these products are spelled out */
+static inline field
+mul_field(field a, field b)
+{
+  field     c;
+
+  ((real *) &c)[0] = REAL(a) * REAL(b) - IMAG(a) * IMAG(b);
+  ((real *) &c)[1] = REAL(a) * IMAG(b) + IMAG(a) * REAL(b);
+
+  return c;
+}
+
+static inline field
+mulconj_field(field a, field b)
+{
+  field     c;
+
+  ((real *) &c)[0] = REAL(a) * REAL(b) + IMAG(a) * IMAG(b);
+  ((real *) &c)[1] = REAL(a) * IMAG(b) - IMAG(a) * REAL(b);
+
+  return c;
+}
+#else
+#define mul_field(a, b) ((a) * (b))
+#define mulconj_field(a, b) ((a) * (b))
+#endif
+
+static void
+fill_block(uint n, field x, pfield v)
+{
+  uint      i;
+
+  for (i = 0; i < n; i++)
+    v[i] = x;
+}
+
+static void
+copy_block(uint n, pcfield v, pfield w)
+{
+  uint      i;
+
+  for (i = 0; i < n; i++)
+    w[i] = v[i];
+}
+
+#ifdef USE_BLAS
+static void
+scale_block(uint n, field alpha, pfield v)
+{
+  h2_scal(&n, &alpha, v, &u_one);
+}
+
+static real
+norm2_block(uint n, pcfield v)
+{
+  return h2_nrm2(&n, v, &u_one);
+}
+
+static field
+dotprod_block(uint n, pcfield x, pcfield y)
+{
+  return h2_dot(&n, x, &u_one, y, &u_one);
+}
+
+static void
+add_block(uint n, field alpha, pcfield x, pfield y)
+{
+  h2_axpy(&n, &alpha, x, &u_one, y, &u_one);
+}
+#else
+static void
+scale_block(uint n, field alpha, pfield v)
+{
+  uint      i;
+
+  for (i = 0; i < n; i++)
+    v[i] *= alpha;
+}
+
+static real
+norm2_block(uint n, pcfield v)
+{
+  real      sum;
+  uint      i;
+
+  sum = 0.0;
+  for (i = 0; i < n; i++)
+    sum += ABSSQR(v[i]);
+
+  return REAL_SQRT(sum);
+}
+
+static field
+dotprod_block(uint n, pcfield x, pcfield y)
+{
+  register field alpha;
+  uint      i;
+
+  alpha = 0.0;
+  for (i = 0; i < n; i++)
+    alpha += CONJ(x[i]) * y[i];
+
+  return alpha;
+}
+
+static void
+add_block(uint n, field alpha, pcfield x, pfield y)
+{
+  uint      i;
+
+  for (i = 0; i < n; i++)
+    y[i] += alpha * x[i];
+}
+#endif
+
+static void
+scaleadd_block(uint n, field alpha, pcfield x, field beta, pfield y)
+{
+  uint      i;
+
+  for (i = 0; i < n; i++)
+    y[i] = mul_field(alpha, x[i]) + mul_field(beta, y[i]);
+}
+
+static field
+adddotprod_block(uint n, field alpha, pcfield x, pfield y, pcfield z)
+{
+  field     sum;
+  uint      i;
+
+  sum = 0.0;
+  for (i = 0; i < n; i++) {
+    y[i] += mul_field(alpha, x[i]);
+    sum += mulconj_field(z[i], y[i]);
+  }
+
+  return sum;
+}
+
+/* Returns the squared norm of the updated vector */
+static real
+addnorm2_block(uint n, field alpha, pcfield x, pfield y)
+{
+  real      sum;
+  uint      i;
+
+  sum = 0.0;
+  for (i = 0; i < n; i++) {
+    y[i] += mul_field(alpha, x[i]);
+    sum += REAL(y[i]) * REAL(y[i]) + IMAG(y[i]) * IMAG(y[i]);
+  }
+
+  return sum;
+}
+
+static void
+dotprods_block(uint k, uint off, uint n, pcavector * x, pcavector * y,
+	       pfield d)
+{
+  uint      i, j;
+
+  for (j = 0; j < k; j++)
+    d[j] = 0.0;
+
+  /* One pass over the block, so vectors appearing in several
+   * products are read only once */
+  for (i = off; i < off + n; i++)
+    for (j = 0; j < k; j++)
+      d[j] += mulconj_field(x[j]->v[i], y[j]->v[i]);
+}
+
 /* ------------------------------------------------------------
  * Simple utility functions
  * ------------------------------------------------------------ */
@@ -235,19 +449,26 @@ getsize_heap_avector(pcavector v)
 void
 clear_avector(pavector v)
 {
-  uint      i;
-
-  for (i = 0; i < v->dim; i++)
-    v->v[i] = 0.0;
+  fill_avector(v, 0.0);
 }
 
 void
 fill_avector(pavector v, field x)
 {
-  uint      i;
+  uint      blocks = blocks_avector(v->dim);
+  uint      b;
+
+  if (blocks <= 1) {
+    fill_block(v->dim, x, v->v);
+    return;
+  }
 
-  for (i = 0; i < v->dim; i++)
-    v->v[i] = x;
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    fill_block(blocksize_avector(v->dim, b), x,
+	       v->v + (size_t) b * AVECTOR_BLOCK);
 }
 
 void
@@ -277,12 +498,23 @@ random_real_avector(pavector v)
 void
 copy_avector(pcavector v, pavector w)
 {
-  uint      i;
+  uint      blocks = blocks_avector(v->dim);
+  uint      b;
 
   assert(v->dim == w->dim);
 
-  for (i = 0; i < v->dim; i++)
-    w->v[i] = v->v[i];
+  if (blocks <= 1) {
+    copy_block(v->dim, v->v, w->v);
+    return;
+  }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    copy_block(blocksize_avector(v->dim, b),
+	       v->v + (size_t) b * AVECTOR_BLOCK,
+	       w->v + (size_t) b * AVECTOR_BLOCK);
 }
 
 void
@@ -316,87 +548,242 @@ print_avector(pcavector v)
  * Very basic linear algebra
  * ------------------------------------------------------------ */
 
-#ifdef USE_BLAS
-void
-scale_avector(field alpha, pavector v)
-{
-  h2_scal(&v->dim, &alpha, v->v, &u_one);
-}
-#else
 void
 scale_avector(field alpha, pavector v)
 {
-  uint      i;
+  uint      blocks = blocks_avector(v->dim);
+  uint      b;
 
-  for (i = 0; i < v->dim; i++)
-    v->v[i] *= alpha;
-}
-#endif
+  if (blocks <= 1) {
+    scale_block(v->dim, alpha, v->v);
+    return;
+  }
 
-#ifdef USE_BLAS
-real
-norm2_avector(pcavector v)
-{
-  return h2_nrm2(&v->dim, v->v, &u_one);
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    scale_block(blocksize_avector(v->dim, b), alpha,
+		v->v + (size_t) b * AVECTOR_BLOCK);
 }
-#else
+
 real
 norm2_avector(pcavector v)
 {
+  uint      blocks = blocks_avector(v->dim);
+  real      part1[AVECTOR_PARTS], *part;
   real      sum;
-  uint      i;
+  uint      b;
+
+  if (blocks <= 1)
+    return norm2_block(v->dim, v->v);
+
+  part = (blocks > AVECTOR_PARTS ? allocreal(blocks) : part1);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    part[b] = norm2_block(blocksize_avector(v->dim, b),
+			  v->v + (size_t) b * AVECTOR_BLOCK);
 
   sum = 0.0;
-  for (i = 0; i < v->dim; i++)
-    sum += ABSSQR(v->v[i]);
+  for (b = 0; b < blocks; b++)
+    sum += part[b] * part[b];
+
+  if (part != part1)
+    freemem(part);
 
   return REAL_SQRT(sum);
 }
-#endif
 
-#ifdef USE_BLAS
 field
 dotprod_avector(pcavector x, pcavector y)
 {
+  uint      blocks = blocks_avector(x->dim);
+  field     part1[AVECTOR_PARTS], *part;
+  field     sum;
+  uint      b;
+
   assert(x->dim == y->dim);
 
-  return h2_dot(&x->dim, x->v, &u_one, y->v, &u_one);
-}
-#else
-field
-dotprod_avector(pcavector x, pcavector y)
-{
-  register field alpha;
-  uint      i;
+  if (blocks <= 1)
+    return dotprod_block(x->dim, x->v, y->v);
 
-  assert(x->dim == y->dim);
+  part = (blocks > AVECTOR_PARTS ? allocfield(blocks) : part1);
 
-  alpha = 0.0;
-  for (i = 0; i < x->dim; i++)
-    alpha += CONJ(x->v[i]) * y->v[i];
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    part[b] = dotprod_block(blocksize_avector(x->dim, b),
+			    x->v + (size_t) b * AVECTOR_BLOCK,
+			    y->v + (size_t) b * AVECTOR_BLOCK);
 
-  return alpha;
+  sum = 0.0;
+  for (b = 0; b < blocks; b++)
+    sum += part[b];
+
+  if (part != part1)
+    freemem(part);
+
+  return sum;
 }
-#endif
 
-#ifdef USE_BLAS
 void
 add_avector(field alpha, pcavector x, pavector y)
 {
+  uint      blocks = blocks_avector(x->dim);
+  uint      b;
+
   assert(y->dim >= x->dim);
 
-  h2_axpy(&x->dim, &alpha, x->v, &u_one, y->v, &u_one);
+  if (blocks <= 1) {
+    add_block(x->dim, alpha, x->v, y->v);
+    return;
+  }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    add_block(blocksize_avector(x->dim, b), alpha,
+	      x->v + (size_t) b * AVECTOR_BLOCK,
+	      y->v + (size_t) b * AVECTOR_BLOCK);
 }
-#else
+
+/* ------------------------------------------------------------
+ * Fused operations
+ * ------------------------------------------------------------ */
+
 void
-add_avector(field alpha, pcavector x, pavector y)
+scaleadd_avector(field alpha, pcavector x, field beta, pavector y)
 {
-  uint      i;
+  uint      blocks = blocks_avector(x->dim);
+  uint      b;
 
   assert(y->dim >= x->dim);
 
-  for (i = 0; i < x->dim; i++) {
-    y->v[i] += alpha * x->v[i];
+  if (blocks <= 1) {
+    scaleadd_block(x->dim, alpha, x->v, beta, y->v);
+    return;
   }
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    scaleadd_block(blocksize_avector(x->dim, b), alpha,
+		   x->v + (size_t) b * AVECTOR_BLOCK, beta,
+		   y->v + (size_t) b * AVECTOR_BLOCK);
 }
+
+field
+adddotprod_avector(field alpha, pcavector x, pavector y, pcavector z)
+{
+  uint      blocks = blocks_avector(x->dim);
+  field     part1[AVECTOR_PARTS], *part;
+  field     sum;
+  uint      b;
+
+  assert(y->dim == x->dim);
+  assert(z->dim == x->dim);
+
+  if (blocks <= 1)
+    return adddotprod_block(x->dim, alpha, x->v, y->v, z->v);
+
+  part = (blocks > AVECTOR_PARTS ? allocfield(blocks) : part1);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
 #endif
+  for (b = 0; b < blocks; b++)
+    part[b] = adddotprod_block(blocksize_avector(x->dim, b), alpha,
+			       x->v + (size_t) b * AVECTOR_BLOCK,
+			       y->v + (size_t) b * AVECTOR_BLOCK,
+			       z->v + (size_t) b * AVECTOR_BLOCK);
+
+  sum = 0.0;
+  for (b = 0; b < blocks; b++)
+    sum += part[b];
+
+  if (part != part1)
+    freemem(part);
+
+  return sum;
+}
+
+real
+addnorm2_avector(field alpha, pcavector x, pavector y)
+{
+  uint      blocks = blocks_avector(x->dim);
+  real      part1[AVECTOR_PARTS], *part;
+  real      sum;
+  uint      b;
+
+  assert(y->dim == x->dim);
+
+  if (blocks <= 1)
+    return REAL_SQRT(addnorm2_block(x->dim, alpha, x->v, y->v));
+
+  part = (blocks > AVECTOR_PARTS ? allocreal(blocks) : part1);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    part[b] = addnorm2_block(blocksize_avector(x->dim, b), alpha,
+			     x->v + (size_t) b * AVECTOR_BLOCK,
+			     y->v + (size_t) b * AVECTOR_BLOCK);
+
+  sum = 0.0;
+  for (b = 0; b < blocks; b++)
+    sum += part[b];
+
+  if (part != part1)
+    freemem(part);
+
+  return REAL_SQRT(sum);
+}
+
+void
+dotprods_avector(uint k, pcavector * x, pcavector * y, pfield d)
+{
+  uint      dim, blocks;
+  field     part1[AVECTOR_PARTS], *part;
+  uint      b, j;
+
+  if (k == 0)
+    return;
+
+  dim = x[0]->dim;
+  for (j = 0; j < k; j++) {
+    assert(x[j]->dim == dim);
+    assert(y[j]->dim == dim);
+  }
+
+  blocks = blocks_avector(dim);
+  if (blocks <= 1) {
+    dotprods_block(k, 0, dim, x, y, d);
+    return;
+  }
+
+  part = (blocks * k > AVECTOR_PARTS ?
+	  allocfield((size_t) blocks * k) : part1);
+
+#ifdef USE_OPENMP
+#pragma omp parallel for schedule(static) if(AVECTOR_PARALLEL())
+#endif
+  for (b = 0; b < blocks; b++)
+    dotprods_block(k, b * AVECTOR_BLOCK, blocksize_avector(dim, b), x, y,
+		   part + (size_t) b * k);
+
+  for (j = 0; j < k; j++)
+    d[j] = 0.0;
+  for (b = 0; b < blocks; b++)
+    for (j = 0; j < k; j++)
+      d[j] += part[(size_t) b * k + j];
+
+  if (part != part1)
+    freemem(part);
+}
@@ -416,6 +416,67 @@ dotprod_avector(pcavector x, pcavector y);
 HEADER_PREFIX void
 add_avector(field alpha, pcavector x, pavector y);
 
+/* ------------------------------------------------------------
+ Fused operations
+ ------------------------------------------------------------ */
+
+/** @brief Scale a vector and add another one,
+ *  @f$y \gets \alpha x + \beta y@f$.
+ *
+ *  Equivalent to @ref scale_avector followed by @ref add_avector, but
+ *  reads and writes @f$y@f$ only once.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param beta Scaling factor @f$\beta@f$.
+ *  @param y Target vector @f$y@f$. */
+HEADER_PREFIX void
+scaleadd_avector(field alpha, pcavector x, field beta, pavector y);
+
+/** @brief Add two vectors and compute an inner product with the result,
+ *  @f$y \gets y + \alpha x@f$ and @f$\langle z, y\rangle_2@f$.
+ *
+ *  Equivalent to @ref add_avector followed by @ref dotprod_avector, but
+ *  reads @f$y@f$ only once.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$.
+ *  @param z Vector @f$z@f$, may coincide with @f$x@f$, but not with
+ *         @f$y@f$.
+ *  @returns Inner product @f$\langle z, y\rangle_2@f$ of @f$z@f$ and the
+ *         updated vector @f$y@f$. */
+HEADER_PREFIX field
+adddotprod_avector(field alpha, pcavector x, pavector y, pcavector z);
+
+/** @brief Add two vectors and compute the Euclidean norm of the result,
+ *  @f$y \gets y + \alpha x@f$ and @f$\|y\|_2@f$.
+ *
+ *  Equivalent to @ref add_avector followed by @ref norm2_avector, but
+ *  reads @f$y@f$ only once.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$.
+ *  @returns Euclidean norm @f$\|y\|_2@f$ of the updated vector. */
+HEADER_PREFIX real
+addnorm2_avector(field alpha, pcavector x, pavector y);
+
+/** @brief Compute several Euclidean inner products in one pass,
+ *  @f$d_j \gets \langle x_j, y_j\rangle_2@f$ for all
+ *  @f$j\in\{0,\ldots,k-1\}@f$.
+ *
+ *  The vectors are traversed only once, so a vector appearing in
+ *  several products, e.g., @f$\langle r, u\rangle_2@f$ and
+ *  @f$\langle r, r\rangle_2@f$, is read only once.
+ *
+ *  @param k Number of inner products.
+ *  @param x Array of <tt>k</tt> vectors @f$x_j@f$.
+ *  @param y Array of <tt>k</tt> vectors @f$y_j@f$ of the same dimension.
+ *  @param d Array of <tt>k</tt> entries receiving the inner products. */
+HEADER_PREFIX void
+dotprods_avector(uint k, pcavector * x, pcavector * y, pfield d);
+
 /** @} */
 
 #endif
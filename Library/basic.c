@@ -7,6 +7,7 @@
 #include "basic.h"
 
 #include <stdio.h>
+#include <string.h>
 #ifdef WIN32
 #include <Windows.h>
 #include <MMSystem.h>
@@ -35,6 +36,10 @@
 
 int       max_pardepth = 0;
 
+bool      use_simd = false;
+
+simdisa   simd_isa = SIMD_NONE;
+
 #ifdef TRACE_MEMORY
 size_t    current_memory = 0;
 #endif
@@ -43,15 +48,23 @@ size_t    current_memory = 0;
  Set up the library
  ------------------------------------------------------------ */
 
+#ifdef USE_SIMD
+static const char *simd_isa_name[] = { "none", "sse2", "avx2", "avx512" };
+#endif
+
 void
 init_h2lib(int *argc, char ***argv)
 {
   (void) argc;
   (void) argv;
 
-#ifdef USE_OPENMP
+#if defined(USE_OPENMP) || defined(USE_SIMD)
   char     *env;
-  int       i, j;
+  int       i;
+#endif
+
+#ifdef USE_OPENMP
+  int       j;
 
   if (omp_in_parallel()) {
     fprintf(stderr, "Calling init_h2lib in parallel section is forbidden.\n");
@@ -74,6 +87,37 @@ init_h2lib(int *argc, char ***argv)
   max_pardepth = 0;
 #endif
 
+#ifdef USE_SIMD
+  use_simd = false;
+  simd_isa = SIMD_NONE;
+  for (i = SIMD_AVX512; i > SIMD_NONE; i--)
+    if (supports_simd_h2lib((simdisa) i)) {
+      simd_isa = (simdisa) i;
+      use_simd = true;
+      break;
+    }
+  if (!use_simd)
+    fprintf(stderr, "The host supports none of the instruction sets"
+	    " the SIMD kernels have been compiled for, using scalar"
+	    " kernels.\n");
+
+  env = getenv("H2_SIMD");
+  if (env) {
+    for (i = SIMD_SSE2; i <= SIMD_AVX512; i++)
+      if (strcmp(env, simd_isa_name[i]) == 0)
+	break;
+    if (i <= SIMD_AVX512) {
+      if (supports_simd_h2lib((simdisa) i))
+	simd_isa = (simdisa) i;
+      else
+	fprintf(stderr, "SIMD kernels for %s are not available,"
+		" using %s.\n", env, simd_isa_name[simd_isa]);
+    }
+    else if (atoi(env) == 0)
+      use_simd = false;
+  }
+#endif
+
 #ifdef USE_FREEGLUT
   glutInit(argc, *argv);
 #endif
@@ -84,6 +128,64 @@ init_h2lib(int *argc, char ***argv)
 #endif
 }
 
+const char *
+simd_isa_h2lib()
+{
+#ifdef USE_SIMD
+  if (use_simd)
+    return simd_isa_name[simd_isa];
+#endif
+  return "none";
+}
+
+bool
+supports_simd_h2lib(simdisa isa)
+{
+#ifdef USE_SIMD
+#if (defined(__GNUC__) || defined(__clang__)) && \
+  (defined(__x86_64__) || defined(__i386__))
+  __builtin_cpu_init();
+  switch (isa) {
+#ifdef USE_SIMD_SSE2
+  case SIMD_SSE2:
+    return __builtin_cpu_supports("sse2");
+#endif
+#ifdef USE_SIMD_AVX2
+  case SIMD_AVX2:
+    return __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+#ifdef USE_SIMD_AVX512
+  case SIMD_AVX512:
+    return __builtin_cpu_supports("avx512f")
+      && __builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma");
+#endif
+  default:
+    return false;
+  }
+#else
+  /* No way to check the host, only the baseline instruction set */
+#ifdef USE_SIMD_SSE2
+  return isa == SIMD_SSE2;
+#else
+  (void) isa;
+  return false;
+#endif
+#endif
+#else
+  (void) isa;
+  return false;
+#endif
+}
+
+void
+unavailable_simd_h2lib(const char *file, int line)
+{
+  (void) fprintf(stderr,
+		 "SIMD kernels for instruction set %d are not available"
+		 " in %s:%d\n", (int) simd_isa, file, line);
+  abort();
+}
+
 void
 uninit_h2lib()
 {
@@ -157,6 +259,37 @@ _h2_allocuint(size_t sz, const char *filename, int line)
   return (uint *) ((void *) ptr + ALLOC_OFFSET);
 }
 
+longindex *
+_h2_alloclongindex(size_t sz, const char *filename, int line)
+{
+  longindex *ptr;
+  size_t    dsz;
+
+  dsz = sizeof(longindex) * sz + ALLOC_OFFSET;
+  if ((dsz - ALLOC_OFFSET) / sizeof(longindex) != sz) {
+    (void) fprintf(stderr, "Integer overflow in vector allocation in %s:%d\n",
+		   filename, line);
+    abort();
+  }
+
+  ptr = (longindex *) h2_malloc(dsz);
+  if (ptr == NULL && dsz > 0) {
+    (void) fprintf(stderr,
+		   "Vector allocation of %lu entries failed in %s:%d\n",
+		   (unsigned long) sz, filename, line);
+    abort();
+  }
+
+  *((size_t *) ptr) = dsz;
+
+#ifdef USE_OPENMP
+#pragma omp atomic
+#endif
+  current_memory += dsz;
+
+  return (longindex *) ((void *) ptr + ALLOC_OFFSET);
+}
+
 real     *
 _h2_allocreal(size_t sz, const char *filename, int line)
 {
@@ -226,7 +359,8 @@ _h2_allocmatrix(size_t rows, size_t cols, const char *filename, int line)
   size_t    dsz;
 
   dsz = sizeof(field) * rows * cols + ALLOC_OFFSET;
-  if ((dsz - ALLOC_OFFSET) / sizeof(field) != rows * cols) {
+  if ((cols > 0 && rows > ((size_t) -1 - ALLOC_OFFSET) / sizeof(field) / cols)
+      || (dsz - ALLOC_OFFSET) / sizeof(field) != rows * cols) {
     (void) fprintf(stderr, "Integer overflow in matrix allocation in %s:%d\n",
 		   filename, line);
     abort();
@@ -315,6 +449,30 @@ _h2_allocuint(size_t sz, const char *filename, int line)
   return ptr;
 }
 
+longindex *
+_h2_alloclongindex(size_t sz, const char *filename, int line)
+{
+  longindex *ptr;
+  size_t    dsz;
+
+  dsz = sizeof(longindex) * sz;
+  if (dsz / sizeof(longindex) != sz) {
+    (void) fprintf(stderr, "Integer overflow in vector allocation in %s:%d\n",
+		   filename, line);
+    abort();
+  }
+
+  ptr = (longindex *) h2_malloc(dsz);
+  if (ptr == NULL && dsz > 0) {
+    (void) fprintf(stderr,
+		   "Vector allocation of %lu entries failed in %s:%d\n",
+		   (unsigned long) sz, filename, line);
+    abort();
+  }
+
+  return ptr;
+}
+
 real     *
 _h2_allocreal(size_t sz, const char *filename, int line)
 {
@@ -370,7 +528,8 @@ _h2_allocmatrix(size_t rows, size_t cols, const char *filename, int line)
   size_t    dsz;
 
   dsz = sizeof(field) * rows * cols;
-  if (dsz / sizeof(field) != rows * cols) {
+  if ((cols > 0 && rows > (size_t) -1 / sizeof(field) / cols)
+      || dsz / sizeof(field) != rows * cols) {
     (void) fprintf(stderr, "Integer overflow in matrix allocation in %s:%d\n",
 		   filename, line);
     abort();
@@ -30,7 +30,7 @@ typedef stopwatch *pstopwatch;
 #include "settings.h"
 
 #ifdef USE_SIMD
-#include "simd.h"
+#include <xmmintrin.h>
 #endif
 
 /* ------------------------------------------------------------
@@ -53,6 +53,37 @@ typedef stopwatch *pstopwatch;
 /** @brief Reasonable cut-off depth for parallelization. */
 extern int max_pardepth;
 
+/** @brief Instruction sets the SIMD kernels can be compiled for. */
+typedef enum {
+  /** @brief No SIMD kernels */
+  SIMD_NONE = 0,
+  /** @brief SSE2, available on every x86-64 processor */
+  SIMD_SSE2 = 1,
+  /** @brief AVX2 and FMA */
+  SIMD_AVX2 = 2,
+  /** @brief AVX-512 foundation */
+  SIMD_AVX512 = 3
+} simdisa;
+
+/** @brief Use the SIMD kernels compiled into the library.
+ *
+ *  Set by @ref init_h2lib if the library has been compiled with
+ *  <tt>USE_SIMD</tt> and the host supports one of the instruction sets
+ *  the SIMD kernels have been compiled for, can be switched off by
+ *  setting the environment variable <tt>H2_SIMD</tt> to zero.
+ *  If not set, the BEM modules fall back to the scalar kernels. */
+extern bool use_simd;
+
+/** @brief Instruction set of the SIMD kernels used if @ref use_simd
+ *  is set.
+ *
+ *  Set by @ref init_h2lib to the best instruction set supported by
+ *  the host, or to the one named by the environment variable
+ *  <tt>H2_SIMD</tt>, e.g., <tt>H2_SIMD=sse2</tt>.
+ *  Only instruction sets with @ref supports_simd_h2lib may be
+ *  selected. */
+extern simdisa simd_isa;
+
 /** @brief "Machine accuracy" for some algorithms */
 #define H2_MACH_EPS 1e-13
 
@@ -72,6 +103,33 @@ extern int max_pardepth;
 HEADER_PREFIX void
 init_h2lib(int *argc, char ***argv);
 
+/** @brief Instruction set used for the SIMD kernels.
+ *
+ *  @returns Name of the instruction set @ref simd_isa, or
+ *    <tt>"none"</tt> if the library has been compiled without
+ *    <tt>USE_SIMD</tt> or the scalar kernels are used, see
+ *    @ref use_simd. */
+HEADER_PREFIX const char *
+simd_isa_h2lib();
+
+/** @brief Check if SIMD kernels for an instruction set can be used.
+ *
+ *  @param isa Instruction set.
+ *  @returns <tt>true</tt> if the SIMD kernels have been compiled for
+ *    <tt>isa</tt> and the host supports it. */
+HEADER_PREFIX bool
+supports_simd_h2lib(simdisa isa);
+
+/** @brief Abort because no SIMD kernels are available for @ref simd_isa.
+ *
+ *  Called by @ref SIMD_CALL if @ref simd_isa names an instruction set
+ *  the kernels have not been compiled for.
+ *
+ *  @param file Source file of the call.
+ *  @param line Line of the call. */
+HEADER_PREFIX void
+unavailable_simd_h2lib(const char *file, int line);
+
 /** @brief Uninitialize the library.
  *
  *  This function cleans up the run-time environment once the
@@ -103,6 +161,54 @@ uninit_h2lib();
 #define h2_free(p) free(p)
 #endif
 
+#ifdef USE_SIMD
+/**
+ * @brief Declare the instances of a SIMD routine for all instruction sets.
+ *
+ * Files containing SIMD kernels are compiled once for every instruction
+ * set listed in <tt>SIMD_ISAS</tt>, the instances carry the suffix
+ * given by <tt>SIMD_NAME</tt> in simd.h.
+ * @param ret Return type.
+ * @param name Name of the routine without suffix.
+ * @param args Parenthesized parameter list.
+ */
+#define SIMD_DECLARE(ret, name, args) \
+  HEADER_PREFIX ret name##_sse2 args; \
+  HEADER_PREFIX ret name##_avx2 args; \
+  HEADER_PREFIX ret name##_avx512 args
+
+#ifdef USE_SIMD_SSE2
+#define SIMD_CASE_SSE2(name, args) case SIMD_SSE2: name##_sse2 args; break;
+#else
+#define SIMD_CASE_SSE2(name, args)
+#endif
+#ifdef USE_SIMD_AVX2
+#define SIMD_CASE_AVX2(name, args) case SIMD_AVX2: name##_avx2 args; break;
+#else
+#define SIMD_CASE_AVX2(name, args)
+#endif
+#ifdef USE_SIMD_AVX512
+#define SIMD_CASE_AVX512(name, args) case SIMD_AVX512: name##_avx512 args; break;
+#else
+#define SIMD_CASE_AVX512(name, args)
+#endif
+
+/**
+ * @brief Call the instance of a SIMD routine for @ref simd_isa.
+ *
+ * @param name Name of the routine without suffix, see @ref SIMD_DECLARE.
+ * @param args Parenthesized argument list.
+ */
+#define SIMD_CALL(name, args) \
+  switch (simd_isa) { \
+  SIMD_CASE_SSE2(name, args) \
+  SIMD_CASE_AVX2(name, args) \
+  SIMD_CASE_AVX512(name, args) \
+  default: \
+    unavailable_simd_h2lib(__FILE__, __LINE__); \
+  }
+#endif
+
 
 /**
  * @brief Current amount of allocated memory (bytes)
@@ -533,6 +639,20 @@ _h2_allocmem(size_t sz, const char *filename, int line);
 HEADER_PREFIX uint *
 _h2_allocuint(size_t sz, const char *filename, int line);
 
+/** @brief Allocate heap storage of type @ref longindex.
+ *
+ *  @param sz Number of @ref longindex variables.
+ *  @returns Pointer to <tt>sz</tt> variables of type @ref longindex. */
+#define alloclongindex(sz) _h2_alloclongindex(sz,__FILE__,__LINE__)
+/** @brief Allocate heap storage of type @ref longindex.
+ *
+ *  @param sz Number of @ref longindex variables.
+ *  @param filename Name of source file (used for error messages).
+ *  @param line Line number in source file.
+ *  @returns Pointer to <tt>sz</tt> variables of type @ref longindex. */
+HEADER_PREFIX longindex *
+_h2_alloclongindex(size_t sz, const char *filename, int line);
+
 /** @brief Allocate heap storage of type @ref real.
  *
  *  @param sz Number of @ref real variables
@@ -251,6 +251,8 @@ struct _parbem2d {
   uint      grcnn;
   pgreencluster2d *gccn;
   uint      gccnn;
+  uint     *grcs;		/* construction state of grcn entries */
+  uint     *gccs;		/* construction state of gccn entries */
   pgreenclusterbasis2d *grbn;
   uint      grbnn;
   pgreenclusterbasis2d *gcbn;
@@ -507,6 +509,8 @@ new_parbem2d()
   par->grcnn = 0;
   par->gccn = NULL;
   par->gccnn = 0;
+  par->grcs = NULL;
+  par->gccs = NULL;
   par->grbn = NULL;
   par->grbnn = 0;
   par->gcbn = NULL;
@@ -552,6 +556,7 @@ del_parbem2d(pparbem2d par)
       }
     }
     freemem(par->grcn);
+    freemem(par->grcs);
   }
 
   n = par->gccnn;
@@ -562,6 +567,7 @@ del_parbem2d(pparbem2d par)
       }
     }
     freemem(par->gccn);
+    freemem(par->gccs);
   }
 
   /*
@@ -1388,6 +1394,57 @@ assemble_row_greencluster2d(pcbem2d bem, pgreencluster2d gc)
   freemem(N);
 }
 
+/* Return the Green cluster number <tt>name</tt> from the table
+ * <tt>gcn</tt>, constructing it with <tt>assemble</tt> on first use.
+ * <tt>gcs</tt> holds the construction state of each entry: bit 0 is set
+ * once a thread has claimed the entry, bit 1 once it is ready.
+ * Threads requesting different clusters never wait for each other. */
+static pgreencluster2d
+get_greencluster2d(pcbem2d bem, pccluster t, uint name,
+		   pgreencluster2d * gcn, uint * gcs,
+		   void (*assemble) (pcbem2d bem, pgreencluster2d gc))
+{
+  pgreencluster2d gc;
+#ifdef USE_OPENMP
+  uint      state;
+
+#pragma omp atomic read seq_cst
+  state = gcs[name];
+
+  if (!(state & 2)) {
+#pragma omp atomic capture seq_cst
+    {
+      state = gcs[name];
+      gcs[name] |= 1;
+    }
+
+    if (state == 0) {
+      gc = new_greencluster2d(t);
+      assemble(bem, gc);
+      gcn[name] = gc;
+
+#pragma omp atomic update seq_cst
+      gcs[name] |= 2;
+    }
+    else {
+      while (!(state & 2)) {
+#pragma omp atomic read seq_cst
+	state = gcs[name];
+      }
+    }
+  }
+#else
+  if (gcs[name] == 0) {
+    gc = new_greencluster2d(t);
+    assemble(bem, gc);
+    gcn[name] = gc;
+    gcs[name] = 3;
+  }
+#endif
+
+  return gcn[name];
+}
+
 static void
 assemble_bem2d_greenhybrid_row_rkmatrix(pccluster rc, uint rname,
 					pccluster cc, uint cname, pcbem2d bem,
@@ -1406,17 +1463,8 @@ assemble_bem2d_greenhybrid_row_rkmatrix(pccluster rc, uint rname,
 
   (void) cname;
 
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    grc = par->grcn[rname];
-
-    if (grc == NULL) {
-      grc = par->grcn[rname] = new_greencluster2d(rc);
-      assemble_row_greencluster2d(bem, grc);
-    }
-  }
+  grc = get_greencluster2d(bem, rc, rname, par->grcn, par->grcs,
+			  assemble_row_greencluster2d);
 
   V = grc->V;
   rank = V->cols;
@@ -1513,17 +1561,8 @@ assemble_bem2d_greenhybrid_col_rkmatrix(pccluster rc, uint rname,
 
   (void) rname;
 
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    gcc = par->gccn[cname];
-
-    if (gcc == NULL) {
-      gcc = par->gccn[cname] = new_greencluster2d(cc);
-      assemble_col_greencluster2d(bem, gcc);
-    }
-  }
+  gcc = get_greencluster2d(bem, cc, cname, par->gccn, par->gccs,
+			  assemble_col_greencluster2d);
 
   V = gcc->V;
   rank = V->cols;
@@ -1551,29 +1590,11 @@ assemble_bem2d_greenhybrid_mixed_rkmatrix(pccluster rc, uint rname,
   uint     *xihatV, *xihatW;
   uint      rankV, rankW;
 
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    grc = par->grcn[rname];
+  grc = get_greencluster2d(bem, rc, rname, par->grcn, par->grcs,
+			  assemble_row_greencluster2d);
 
-    if (grc == NULL) {
-      grc = par->grcn[rname] = new_greencluster2d(rc);
-      assemble_row_greencluster2d(bem, grc);
-    }
-  }
-
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    gcc = par->gccn[cname];
-
-    if (gcc == NULL) {
-      gcc = par->gccn[cname] = new_greencluster2d(cc);
-      assemble_col_greencluster2d(bem, gcc);
-    }
-  }
+  gcc = get_greencluster2d(bem, cc, cname, par->gccn, par->gccs,
+			  assemble_col_greencluster2d);
 
   rankV = grc->V->cols;
   rankW = gcc->V->cols;
@@ -3223,15 +3244,18 @@ setup_hmatrix_aprx_greenhybrid_row_bem2d(pbem2d bem, pccluster rc,
       }
     }
     freemem(par->grcn);
+    freemem(par->grcs);
   }
 
   n = rc->desc;
 
   par->grcn = (pgreencluster2d *) allocmem((size_t) n *
 					   sizeof(pgreencluster2d));
+  par->grcs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->grcn[i] = NULL;
+    par->grcs[i] = 0;
   }
 
   par->grcnn = n;
@@ -3275,15 +3299,18 @@ setup_hmatrix_aprx_greenhybrid_col_bem2d(pbem2d bem, pccluster rc,
       }
     }
     freemem(par->gccn);
+    freemem(par->gccs);
   }
 
   n = cc->desc;
 
   par->gccn = (pgreencluster2d *) allocmem((size_t) n *
 					   sizeof(pgreencluster2d));
+  par->gccs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->gccn[i] = NULL;
+    par->gccs[i] = 0;
   }
 
   par->gccnn = n;
@@ -3328,15 +3355,18 @@ setup_hmatrix_aprx_greenhybrid_mixed_bem2d(pbem2d bem, pccluster rc,
       }
     }
     freemem(par->grcn);
+    freemem(par->grcs);
   }
 
   n = rc->desc;
 
   par->grcn = (pgreencluster2d *) allocmem((size_t) n *
 					   sizeof(pgreencluster2d));
+  par->grcs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->grcn[i] = NULL;
+    par->grcs[i] = 0;
   }
 
   par->grcnn = n;
@@ -3350,15 +3380,18 @@ setup_hmatrix_aprx_greenhybrid_mixed_bem2d(pbem2d bem, pccluster rc,
       }
     }
     freemem(par->gccn);
+    freemem(par->gccs);
   }
 
   n = cc->desc;
 
   par->gccn = (pgreencluster2d *) allocmem((size_t) n *
 					   sizeof(pgreencluster2d));
+  par->gccs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->gccn[i] = NULL;
+    par->gccs[i] = 0;
   }
 
   par->gccnn = n;
@@ -6,9 +6,6 @@
 /* C STD LIBRARY */
 #include <string.h>
 /* CORE 0 */
-#ifdef USE_SIMD
-#include "simd.h"
-#endif
 #include "basic.h"
 /* CORE 1 */
 /* CORE 2 */
@@ -258,6 +255,8 @@ struct _parbem3d {
   uint      grcnn;
   pgreencluster3d *gccn;
   uint      gccnn;
+  uint     *grcs;		/* construction state of grcn entries */
+  uint     *gccs;		/* construction state of gccn entries */
   pgreenclusterbasis3d *grbn;
   uint      grbnn;
   pgreenclusterbasis3d *gcbn;
@@ -554,6 +553,8 @@ new_parbem3d()
   par->grcnn = 0;
   par->gccn = NULL;
   par->gccnn = 0;
+  par->grcs = NULL;
+  par->gccs = NULL;
   par->grbn = NULL;
   par->grbnn = 0;
   par->gcbn = NULL;
@@ -607,6 +608,7 @@ del_parbem3d(pparbem3d par)
       }
     }
     freemem(par->grcn);
+    freemem(par->grcs);
   }
 
   n = par->gccnn;
@@ -617,6 +619,7 @@ del_parbem3d(pparbem3d par)
       }
     }
     freemem(par->gccn);
+    freemem(par->gccs);
   }
 
   /*
@@ -659,6 +662,11 @@ new_bem3d(pcsurface3d gr, basisfunctionbem3d row_basis,
   bem->mass = NULL;
   bem->v2t = NULL;
   bem->alpha = 0.0;
+#ifdef USE_SIMD
+  bem->sincos_terms = VSINCOS_MAXTERMS;
+#else
+  bem->sincos_terms = 0;
+#endif
 
   bem->row_basis = row_basis;
   bem->col_basis = col_basis;
@@ -681,6 +689,7 @@ new_bem3d(pcsurface3d gr, basisfunctionbem3d row_basis,
   bem->aprx = new_aprxbem3d();
   bem->kernels = new_kernelbem3d();
   bem->par = new_parbem3d();
+  bem->tasks = NULL;
 
 
   if (row_basis == BASIS_LINEAR_BEM3D || col_basis == BASIS_LINEAR_BEM3D) {
@@ -707,6 +716,10 @@ del_bem3d(pbem3d bem)
   del_kernelbem3d(bem->kernels);
   del_parbem3d(bem->par);
 
+  if (bem->tasks != NULL) {
+    del_taskpool(bem->tasks);
+  }
+
   n = bem->gr->vertices;
   if (bem->v2t != NULL) {
     for (i = 0; i < n; ++i) {
@@ -720,6 +733,132 @@ del_bem3d(pbem3d bem)
   freemem(bem);
 }
 
+void
+setup_singcache_bem3d(pbem3d bem, size_t maxsize)
+{
+  psingquad2d sq = bem->sq;
+
+  assert(sq != NULL);
+
+  if (sq->cache != NULL) {
+    del_singcache(sq->cache);
+    sq->cache = NULL;
+  }
+
+  if (maxsize > 0) {
+    sq->cache = new_singcache(maxsize);
+  }
+}
+
+void
+invalidate_kernel_bem3d(pbem3d bem)
+{
+  pparbem3d par = bem->par;
+  uint      i;
+
+  if (bem->sq != NULL && bem->sq->cache != NULL) {
+    clear_singcache(bem->sq->cache);
+  }
+
+  /* Green-hybrid clusters store pivots and interpolation operators
+   * computed from the kernel function */
+  for (i = 0; par->grcn != NULL && i < par->grcnn; i++) {
+    if (par->grcn[i] != NULL) {
+      del_greencluster3d(par->grcn[i]);
+      par->grcn[i] = NULL;
+    }
+    par->grcs[i] = 0;
+  }
+
+  for (i = 0; par->gccn != NULL && i < par->gccnn; i++) {
+    if (par->gccn[i] != NULL) {
+      del_greencluster3d(par->gccn[i]);
+      par->gccn[i] = NULL;
+    }
+    par->gccs[i] = 0;
+  }
+}
+
+static void
+count_triangles_cluster(pcbem3d bem, pccluster c, basisfunctionbem3d basis,
+			uint stamp, uint * last, uint * count)
+{
+  plistnode l;
+  uint      i, t;
+
+  for (i = 0; i < c->size; i++) {
+    if (basis == BASIS_LINEAR_BEM3D) {
+      for (l = bem->v2t[c->idx[i]]; l->next != NULL; l = l->next) {
+	t = l->data;
+	if (last[t] != stamp) {
+	  last[t] = stamp;
+	  count[t]++;
+	}
+      }
+    }
+    else {
+      t = c->idx[i];
+      if (last[t] != stamp) {
+	last[t] = stamp;
+	count[t]++;
+      }
+    }
+  }
+}
+
+static void
+count_triangles_block(pcbem3d bem, pcblock b, uint * stamp, uint * last,
+		      uint * count)
+{
+  uint      i;
+
+  if (b->son) {
+    for (i = 0; i < b->rsons * b->csons; i++)
+      count_triangles_block(bem, b->son[i], stamp, last, count);
+  }
+  else if (!b->a) {
+    (*stamp)++;
+    count_triangles_cluster(bem, b->rc, bem->row_basis, *stamp, last, count);
+    count_triangles_cluster(bem, b->cc, bem->col_basis, *stamp, last, count);
+  }
+}
+
+uint
+setup_triquadpoints_bem3d(pbem3d bem, pcblock b, uint mincount,
+			  size_t budget)
+{
+  pcsurface3d gr = bem->gr;
+  uint     *count, *last;
+  uint      stamp, slots, t;
+
+  assert(bem->sq != NULL);
+
+  if (b == NULL)
+    return setup_triquadpoints_singquad2d(gr, bem->sq, NULL, 0, budget);
+
+  if ((bem->row_basis == BASIS_LINEAR_BEM3D
+       || bem->col_basis == BASIS_LINEAR_BEM3D) && bem->v2t == NULL)
+    setup_vertex_to_triangle_map_bem3d(bem);
+
+  /* Number of inadmissible leaves every triangle appears in */
+  count = allocuint(gr->triangles);
+  last = allocuint(gr->triangles);
+  for (t = 0; t < gr->triangles; t++) {
+    count[t] = 0;
+    last[t] = 0;
+  }
+  stamp = 0;
+  count_triangles_block(bem, b, &stamp, last, count);
+
+  slots = setup_triquadpoints_singquad2d(gr, bem->sq, count, mincount,
+					 budget);
+
+  freemem(last);
+  freemem(count);
+
+  return slots;
+}
+
 pvert_list
 new_vert_list(pvert_list next)
 {
@@ -957,11 +1096,29 @@ build_bem3d_cluster(pcbem3d bem, uint clf, basisfunctionbem3d basis)
  * Nearfield integration routines
  ****************************************************/
 
-#ifdef USE_SIMD
+bool
+get_triquadpoints_bem3d(pcbem3d bem, uint t, const real ** x,
+			const real ** y, const real ** z)
+{
+  pcsingquad2d sq = bem->sq;
+  size_t    off;
+
+  if (sq->tri_slot == NULL || sq->tri_slot[t] == TRIQUADPOINTS_NONE) {
+    *x = *y = *z = NULL;
+    return false;
+  }
+
+  off = (size_t) sq->tri_slot[t] * ROUNDUP(sq->n_single, VREAL_PAD);
+  *x = sq->tri_x + off;
+  *y = sq->tri_y + off;
+  *z = sq->tri_z + off;
+
+  return true;
+}
+
 void
-assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx,
-			    pcbem3d bem, bool ntrans, pamatrix N,
-			    kernel_simd_func3d kernel)
+assemble_cc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+		       bool ntrans, pamatrix N, kernel_func3d kernel)
 {
   const pcsurface3d gr = bem->gr;
   const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
@@ -972,28 +1129,25 @@ assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx,
   uint      rows = ntrans ? N->cols : N->rows;
   uint      cols = ntrans ? N->rows : N->cols;
   longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
 
 #ifdef USE_OPENMP
 #pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
   {
 #endif
-    vreal     vt[3][3], vs[3][3], nx[3], ny[3];
+    const real *A_t, *B_t, *C_t, *A_s, *B_s, *C_s, *nx, *ny;
     const uint *tri_t, *tri_s;
+    const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+    bool      pts, ptt;
     real     *xq, *yq, *wq;
     uint      tp[3], sp[3];
-    real      factor, factor2, base;
-    vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i,
-      eval_r, eval_i, vcount, cmp;
-    uint      q, nq, vnq, remainder, ss, tt, s, t, i, j;
-#ifdef USE_TRIQUADPOINTS
-    real     *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
-    uint      c;
-    uint      q2;
-    uint      nq2 = bem->sq->n_single;
-    uint      vnq2 = ROUNDUP(nq2, VREAL);
-#endif
-
-    vreal     c_one = vset1(1.0);
+    real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
+      factor2, base;
+    field     sum, val;
+    int64_t   key[SINGCACHE_KEYLEN];
+    bool      cached;
+    uint      q, nq, vnq, ss, tt, s, t, c;
+    uint      q2, nq2 = bem->sq->n_single;
 
 #ifdef USE_OPENMP
 #pragma omp for
@@ -1002,132 +1156,88 @@ assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx,
       ss = (cidx == NULL ? s : cidx[s]);
       tri_s = gr_t[ss];
       factor = gr_g[ss] * bem->kernel_const;
-      for (i = 0; i < 3; ++i) {
-	ny[i] = vload1(gr_n[ss] + i);
-      }
-#ifdef USE_TRIQUADPOINTS
-      tri_sx = bem->sq->tri_x + ss * vnq2;
-      tri_sy = bem->sq->tri_y + ss * vnq2;
-      tri_sz = bem->sq->tri_z + ss * vnq2;
-#endif
+      ny = gr_n[ss];
+      pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
 
       for (t = 0; t < rows; ++t) {
 	tt = (ridx == NULL ? t : ridx[t]);
 	tri_t = gr_t[tt];
 	factor2 = factor * gr_g[tt];
-	for (i = 0; i < 3; ++i) {
-	  nx[i] = vload1(gr_n[tt] + i);
-	}
-#ifdef USE_TRIQUADPOINTS
-	tri_tx = bem->sq->tri_x + tt * vnq2;
-	tri_ty = bem->sq->tri_y + tt * vnq2;
-	tri_tz = bem->sq->tri_z + tt * vnq2;
-#endif
+	nx = gr_n[tt];
+	ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
 
-#ifdef USE_TRIQUADPOINTS
 	c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
 					 &yq, &wq, &nq, &base);
-	if (nq % VREAL || nq2 % VREAL) {
-	  for (q = 0; q < VREAL; ++q) {
-	    vcount[q] = q;
-	  }
-	}
-#else
-	(void) select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp,
-					    &xq, &yq, &wq, &nq, &base);
-	if (nq % VREAL) {
-	  for (q = 0; q < VREAL; ++q) {
-	    vcount[q] = q;
-	  }
-	}
-#endif
-	vnq = ROUNDUP(nq, VREAL);
-
+	vnq = ROUNDUP(nq, VREAL_PAD);
 	wq += 9 * vnq;
 
-	sum_r = vsetzero();
-	sum_i = vsetzero();
-
-#ifdef USE_TRIQUADPOINTS
-	if (c == 0) {
-	  remainder = vnq2 - VREAL;
-
-	  for (q = 0; q < nq2; q++) {
-	    x[0] = vload1(tri_tx + q);
-	    x[1] = vload1(tri_ty + q);
-	    x[2] = vload1(tri_tz + q);
-	    for (q2 = 0; q2 < vnq2; q2 += VREAL) {
-	      y[0] = vload(tri_sx + q2);
-	      y[1] = vload(tri_sy + q2);
-	      y[2] = vload(tri_sz + q2);
-	      w = vloadu(wq + q2 + q * nq2);
-
-	      kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	      if (nq2 % VREAL && q2 >= remainder) {
-		cmp =
-		  vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
-		eval_r = vand(cmp, eval_r);
-		eval_i = vand(cmp, eval_i);
-	      }
+	A_t = gr_x[tri_t[tp[0]]];
+	B_t = gr_x[tri_t[tp[1]]];
+	C_t = gr_x[tri_t[tp[2]]];
+	A_s = gr_x[tri_s[sp[0]]];
+	B_s = gr_x[tri_s[sp[1]]];
+	C_s = gr_x[tri_s[sp[2]]];
 
-	      sum_r = vfmadd(w, eval_r, sum_r);
-	      sum_i = vfmadd(w, eval_i, sum_i);
-	    }
-	  }
+	/* Congruent singular pairs have already been integrated */
+	cached = (c > 0 && sc != NULL);
+	if (cached) {
+	  key_singcache(1, c, tp, sp, A_t, B_t, C_t, A_s, B_s, C_s, key);
+	  cached = lookup_singcache(sc, key, 1, &val);
 	}
-	else {
-#endif
-	  remainder = vnq - VREAL;
-
-	  for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-	    for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	      vt[i][j] = vload1(gr_x[tri_t[tp[j]]] + i);
-	      vs[i][j] = vload1(gr_x[tri_s[sp[j]]] + i);
-	    }
-	  }
 
-	  for (q = 0; q < vnq; q += VREAL) {
-	    tx = vload(xq + q);
-	    sx = vload(xq + q + vnq);
-	    ty = vload(yq + q);
-	    sy = vload(yq + q + vnq);
-	    w = vload(wq + q);
+	if (c == 0 && pts && ptt) {
+	  /* Tensor rule of the single triangle rules on precomputed points */
+	  val = 0.0;
 
-	    ct[0] = vsub(c_one, tx);
-	    ct[1] = vsub(tx, sx);
-	    ct[2] = sx;
-	    cs[0] = vsub(c_one, ty);
-	    cs[1] = vsub(ty, sy);
-	    cs[2] = sy;
+	  for (q = 0; q < nq2; ++q) {
+	    x[0] = tri_tx[q];
+	    x[1] = tri_ty[q];
+	    x[2] = tri_tz[q];
+	    for (q2 = 0; q2 < nq2; ++q2) {
+	      y[0] = tri_sx[q2];
+	      y[1] = tri_sy[q2];
+	      y[2] = tri_sz[q2];
 
-	    for (i = 0; i < 3; ++i) {
-	      x[i] = vdot3(vt[i], ct);
-	      y[i] = vdot3(vs[i], cs);
+	      val += wq[q2 + q * nq2] * kernel(x, y, nx, ny, (void *) bem);
 	    }
+	  }
+	}
+	else if (!cached) {
+	  val = 0.0;
 
-	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	    if (nq % VREAL && q >= remainder) {
-	      cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	      eval_r = vand(cmp, eval_r);
-	      eval_i = vand(cmp, eval_i);
-	    }
+	  for (q = 0; q < nq; ++q) {
+	    tx = xq[q];
+	    sx = xq[q + vnq];
+	    ty = yq[q];
+	    sy = yq[q + vnq];
+	    Ax = 1.0 - tx;
+	    Bx = tx - sx;
+	    Cx = sx;
+	    Ay = 1.0 - ty;
+	    By = ty - sy;
+	    Cy = sy;
+
+	    x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
+	    x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
+	    x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
+	    y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
+	    y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
+	    y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+
+	    val += wq[q] * kernel(x, y, nx, ny, (void *) bem);
+	  }
 
-	    sum_r = vfmadd(w, eval_r, sum_r);
-	    sum_i = vfmadd(w, eval_i, sum_i);
+	  if (c > 0 && sc != NULL) {
+	    insert_singcache(sc, key, 1, &val);
 	  }
-#ifdef USE_TRIQUADPOINTS
 	}
-#endif
+	sum = base + val;
 
 	if (ntrans) {
-	  aa[s + t * ld] = ((vreduce(sum_r) + base) * factor2)
-	    - (vreduce(sum_i) * factor2) * I;
+	  aa[s + t * ld] = CONJ(sum) * factor2;
 	}
 	else {
-	  aa[t + s * ld] = ((vreduce(sum_r) + base) * factor2)
-	    + (vreduce(sum_i) * factor2) * I;
+	  aa[t + s * ld] = sum * factor2;
 	}
 
 	if (bem->alpha != 0.0 && tt == ss) {
@@ -1145,21 +1255,26 @@ assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx,
 #endif
 }
 
-#endif
-
 void
-assemble_cc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-		       bool ntrans, pamatrix N, kernel_func3d kernel)
+assemble_cc_sweep_near_bem3d(const uint * ridx, const uint * cidx,
+			     pcbem3d bem, bool ntrans, uint m, pamatrix * N,
+			     const field * alpha, kernel_sweep_func3d kernel,
+			     void *data)
 {
   const pcsurface3d gr = bem->gr;
   const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const real *gr_g = (const real *) gr->g;
-  field    *aa = N->a;
-  uint      rows = ntrans ? N->cols : N->rows;
-  uint      cols = ntrans ? N->rows : N->cols;
-  longindex ld = N->ld;
+  uint      rows, cols, l0;
+
+  /* Matrices may be missing, all others have the same size */
+  for (l0 = 0; l0 < m && N[l0] == NULL; l0++);
+  if (l0 == m) {
+    return;
+  }
+  rows = ntrans ? N[l0]->cols : N[l0]->rows;
+  cols = ntrans ? N[l0]->rows : N[l0]->cols;
 
 #ifdef USE_OPENMP
 #pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
@@ -1167,12 +1282,18 @@ assemble_cc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 #endif
     const real *A_t, *B_t, *C_t, *A_s, *B_s, *C_s, *nx, *ny;
     const uint *tri_t, *tri_s;
+    const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+    bool      pts, ptt;
     real     *xq, *yq, *wq;
     uint      tp[3], sp[3];
     real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
-      factor2, base;
-    field     sum;
-    uint      q, nq, vnq, ss, tt, s, t;
+      factor2, base, w;
+    field    *sum, *eval, a;
+    uint      q, nq, vnq, ss, tt, s, t, l, c;
+    uint      q2, nq2 = bem->sq->n_single;
+
+    sum = allocfield(m);
+    eval = allocfield(m);
 
 #ifdef USE_OPENMP
 #pragma omp for
@@ -1182,16 +1303,18 @@ assemble_cc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
       tri_s = gr_t[ss];
       factor = gr_g[ss] * bem->kernel_const;
       ny = gr_n[ss];
+      pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
 
       for (t = 0; t < rows; ++t) {
 	tt = (ridx == NULL ? t : ridx[t]);
 	tri_t = gr_t[tt];
 	factor2 = factor * gr_g[tt];
 	nx = gr_n[tt];
+	ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
 
-	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				     &wq, &nq, &base);
-	vnq = ROUNDUP(nq, VREAL);
+	c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
+					 &yq, &wq, &nq, &base);
+	vnq = ROUNDUP(nq, VREAL_PAD);
 	wq += 9 * vnq;
 
 	A_t = gr_x[tri_t[tp[0]]];
@@ -1201,58 +1324,99 @@ assemble_cc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 	B_s = gr_x[tri_s[sp[1]]];
 	C_s = gr_x[tri_s[sp[2]]];
 
-	sum = base;
-
-	for (q = 0; q < nq; ++q) {
-	  tx = xq[q];
-	  sx = xq[q + vnq];
-	  ty = yq[q];
-	  sy = yq[q + vnq];
-	  Ax = 1.0 - tx;
-	  Bx = tx - sx;
-	  Cx = sx;
-	  Ay = 1.0 - ty;
-	  By = ty - sy;
-	  Cy = sy;
-
-	  x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
-	  x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
-	  x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
-	  y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
-	  y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
-	  y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
-
-	  sum += wq[q] * kernel(x, y, nx, ny, (void *) bem);
+	for (l = 0; l < m; ++l) {
+	  sum[l] = 0.0;
 	}
-	if (ntrans) {
-	  aa[s + t * ld] = CONJ(sum) * factor2;
+
+	if (c == 0 && pts && ptt) {
+	  /* Tensor rule of the single triangle rules on precomputed points */
+	  for (q = 0; q < nq2; ++q) {
+	    x[0] = tri_tx[q];
+	    x[1] = tri_ty[q];
+	    x[2] = tri_tz[q];
+	    for (q2 = 0; q2 < nq2; ++q2) {
+	      y[0] = tri_sx[q2];
+	      y[1] = tri_sy[q2];
+	      y[2] = tri_sz[q2];
+
+	      kernel(x, y, nx, ny, data, m, eval);
+
+	      w = wq[q2 + q * nq2];
+	      for (l = 0; l < m; ++l) {
+		sum[l] += w * eval[l];
+	      }
+	    }
+	  }
 	}
 	else {
-	  aa[t + s * ld] = sum * factor2;
+	  for (q = 0; q < nq; ++q) {
+	    tx = xq[q];
+	    sx = xq[q + vnq];
+	    ty = yq[q];
+	    sy = yq[q + vnq];
+	    Ax = 1.0 - tx;
+	    Bx = tx - sx;
+	    Cx = sx;
+	    Ay = 1.0 - ty;
+	    By = ty - sy;
+	    Cy = sy;
+
+	    x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
+	    x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
+	    x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
+	    y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
+	    y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
+	    y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+
+	    kernel(x, y, nx, ny, data, m, eval);
+
+	    w = wq[q];
+	    for (l = 0; l < m; ++l) {
+	      sum[l] += w * eval[l];
+	    }
+	  }
 	}
 
-	if (bem->alpha != 0.0 && tt == ss) {
+	for (l = 0; l < m; ++l) {
+	  if (N[l] == NULL) {
+	    continue;
+	  }
+
+	  a = (alpha ? alpha[l] : bem->alpha);
+
 	  if (ntrans) {
-	    aa[t + t * ld] += 0.5 * CONJ(bem->alpha) * gr_g[tt];
+	    N[l]->a[s + t * N[l]->ld] = CONJ(base + sum[l]) * factor2;
 	  }
 	  else {
-	    aa[t + t * ld] += 0.5 * bem->alpha * gr_g[tt];
+	    N[l]->a[t + s * N[l]->ld] = (base + sum[l]) * factor2;
+	  }
+
+	  if (a != 0.0 && tt == ss) {
+	    if (ntrans) {
+	      N[l]->a[t + t * N[l]->ld] += 0.5 * CONJ(a) * gr_g[tt];
+	    }
+	    else {
+	      N[l]->a[t + t * N[l]->ld] += 0.5 * a * gr_g[tt];
+	    }
 	  }
 	}
       }
     }
+
+    freemem(eval);
+    freemem(sum);
 #ifdef USE_OPENMP
   }
 #endif
 }
 
-#ifdef USE_SIMD
 void
-assemble_cc_simd_far_bem3d(const uint * ridx, const uint * cidx,
-			   pcbem3d bem, bool ntrans, pamatrix N,
-			   kernel_simd_func3d kernel)
+assemble_cc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+		      bool ntrans, pamatrix N, kernel_func3d kernel)
 {
   const pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const real *gr_g = (const real *) gr->g;
   field    *aa = N->a;
@@ -1264,258 +1428,69 @@ assemble_cc_simd_far_bem3d(const uint * ridx, const uint * cidx,
 #pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
   {
 #endif
-    vreal     nx[3], ny[3];
-    real     *wq;
-    real      factor, factor2, base;
-    vreal     w, x[3], y[3], sum_r, sum_i, eval_r, eval_i, vcount, cmp;
-    uint      q, nq, vnq, remainder, ss, tt, s, t, i;
-#ifdef USE_TRIQUADPOINTS
-    real     *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
-    uint      q2;
-    uint      nq2 = bem->sq->n_single;
-    uint      vnq2 = ROUNDUP(nq2, VREAL);
-#else
-    const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-    const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-
-    uint      j;
-    vreal     c_one = vset1(1.0);
-    vreal     vt[3][3], vs[3][3];
-    vreal     ct[3], cs[3], tx, sx, ty, sy;
-    real     *xq = bem->sq->x_dist;
-    real     *yq = bem->sq->y_dist;
+    const real *A_t, *B_t, *C_t, *A_s, *B_s, *C_s, *nx, *ny;
     const uint *tri_t, *tri_s;
-#endif
+    real     *xq, *yq, *wq;
+    real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
+      factor2;
+    field     sum;
+    uint      q, nq, vnq, ss, tt, s, t;
 
+    xq = bem->sq->x_dist;
+    yq = bem->sq->y_dist;
     nq = bem->sq->n_dist;
-    vnq = ROUNDUP(nq, VREAL);
+    vnq = ROUNDUP(nq, VREAL_PAD);
     wq = bem->sq->w_dist + 9 * vnq;
-    base = bem->sq->base_dist;
 
 #ifdef USE_OPENMP
 #pragma omp for
 #endif
     for (s = 0; s < cols; ++s) {
       ss = (cidx == NULL ? s : cidx[s]);
-
-      factor = gr_g[ss] * bem->kernel_const;
-      for (i = 0; i < 3; ++i) {
-	ny[i] = vload1(gr_n[ss] + i);
-      }
-#ifdef USE_TRIQUADPOINTS
-      tri_sx = bem->sq->tri_x + ss * vnq2;
-      tri_sy = bem->sq->tri_y + ss * vnq2;
-      tri_sz = bem->sq->tri_z + ss * vnq2;
-#else
       tri_s = gr_t[ss];
-#endif
+      factor = gr_g[ss] * bem->kernel_const;
+
+      A_s = gr_x[tri_s[0]];
+      B_s = gr_x[tri_s[1]];
+      C_s = gr_x[tri_s[2]];
+      ny = gr_n[ss];
 
       for (t = 0; t < rows; ++t) {
 	tt = (ridx == NULL ? t : ridx[t]);
-
-	factor2 = factor * gr_g[tt];
-	for (i = 0; i < 3; ++i) {
-	  nx[i] = vload1(gr_n[tt] + i);
-	}
-#ifdef USE_TRIQUADPOINTS
-	tri_tx = bem->sq->tri_x + tt * vnq2;
-	tri_ty = bem->sq->tri_y + tt * vnq2;
-	tri_tz = bem->sq->tri_z + tt * vnq2;
-#else
 	tri_t = gr_t[tt];
-#endif
-
-#ifdef USE_TRIQUADPOINTS
-	if (nq % VREAL || nq2 % VREAL) {
-	  for (q = 0; q < VREAL; ++q) {
-	    vcount[q] = q;
-	  }
-	}
-#else
-	if (nq % VREAL) {
-	  for (q = 0; q < VREAL; ++q) {
-	    vcount[q] = q;
-	  }
-	}
-#endif
+	factor2 = factor * gr_g[tt];
 
-	sum_r = vsetzero();
-	sum_i = vsetzero();
+	A_t = gr_x[tri_t[0]];
+	B_t = gr_x[tri_t[1]];
+	C_t = gr_x[tri_t[2]];
+	nx = gr_n[tt];
 
-#ifdef USE_TRIQUADPOINTS
-	remainder = vnq2 - VREAL;
+	sum = bem->sq->base_dist;
 
-	for (q = 0; q < nq2; q++) {
-	  x[0] = vload1(tri_tx + q);
-	  x[1] = vload1(tri_ty + q);
-	  x[2] = vload1(tri_tz + q);
-	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
-	    y[0] = vload(tri_sx + q2);
-	    y[1] = vload(tri_sy + q2);
-	    y[2] = vload(tri_sz + q2);
-	    w = vloadu(wq + q2 + q * nq2);
+	for (q = 0; q < nq; ++q) {
+	  tx = xq[q];
+	  sx = xq[q + vnq];
+	  ty = yq[q];
+	  sy = yq[q + vnq];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
+	  Ay = 1.0 - ty;
+	  By = ty - sy;
+	  Cy = sy;
 
-	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+	  x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
+	  x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
+	  x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
 
-	    if (nq2 % VREAL && q2 >= remainder) {
-	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
-	      eval_r = vand(cmp, eval_r);
-	      eval_i = vand(cmp, eval_i);
-	    }
+	  y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
+	  y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
+	  y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
 
-	    sum_r = vfmadd(w, eval_r, sum_r);
-	    sum_i = vfmadd(w, eval_i, sum_i);
-	  }
+	  sum += wq[q] * kernel(x, y, nx, ny, (void *) bem);
 	}
-#else
-	remainder = vnq - VREAL;
-
-	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	    vt[i][j] = vload1(gr_x[tri_t[j]] + i);
-	    vs[i][j] = vload1(gr_x[tri_s[j]] + i);
-	  }
-	}
-
-	for (q = 0; q < vnq; q += VREAL) {
-	  tx = vload(xq + q);
-	  sx = vload(xq + q + vnq);
-	  ty = vload(yq + q);
-	  sy = vload(yq + q + vnq);
-	  w = vload(wq + q);
-
-	  ct[0] = vsub(c_one, tx);
-	  ct[1] = vsub(tx, sx);
-	  ct[2] = sx;
-	  cs[0] = vsub(c_one, ty);
-	  cs[1] = vsub(ty, sy);
-	  cs[2] = sy;
-
-	  for (i = 0; i < 3; ++i) {
-	    x[i] = vdot3(vt[i], ct);
-	    y[i] = vdot3(vs[i], cs);
-	  }
-
-	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	  if (nq % VREAL && q >= remainder) {
-	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	    eval_r = vand(cmp, eval_r);
-	    eval_i = vand(cmp, eval_i);
-	  }
-
-	  sum_r = vfmadd(w, eval_r, sum_r);
-	  sum_i = vfmadd(w, eval_i, sum_i);
-	}
-#endif
-
-	if (ntrans) {
-	  aa[s + t * ld] = ((vreduce(sum_r) + base) * factor2)
-	    - (vreduce(sum_i) * factor2) * I;
-	}
-	else {
-	  aa[t + s * ld] = ((vreduce(sum_r) + base) * factor2)
-	    + (vreduce(sum_i) * factor2) * I;
-	}
-
-	if (bem->alpha != 0.0 && tt == ss) {
-	  if (ntrans) {
-	    aa[t + t * ld] += 0.5 * CONJ(bem->alpha) * gr_g[tt];
-	  }
-	  else {
-	    aa[t + t * ld] += 0.5 * bem->alpha * gr_g[tt];
-	  }
-	}
-      }
-    }
-#ifdef USE_OPENMP
-  }
-#endif
-}
-
-#endif
-
-void
-assemble_cc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-		      bool ntrans, pamatrix N, kernel_func3d kernel)
-{
-  const pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const real *gr_g = (const real *) gr->g;
-  field    *aa = N->a;
-  uint      rows = ntrans ? N->cols : N->rows;
-  uint      cols = ntrans ? N->rows : N->cols;
-  longindex ld = N->ld;
-
-#ifdef USE_OPENMP
-#pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
-  {
-#endif
-    const real *A_t, *B_t, *C_t, *A_s, *B_s, *C_s, *nx, *ny;
-    const uint *tri_t, *tri_s;
-    real     *xq, *yq, *wq;
-    real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
-      factor2;
-    field     sum;
-    uint      q, nq, vnq, ss, tt, s, t;
-
-    xq = bem->sq->x_dist;
-    yq = bem->sq->y_dist;
-    nq = bem->sq->n_dist;
-    vnq = ROUNDUP(nq, VREAL);
-    wq = bem->sq->w_dist + 9 * vnq;
-
-#ifdef USE_OPENMP
-#pragma omp for
-#endif
-    for (s = 0; s < cols; ++s) {
-      ss = (cidx == NULL ? s : cidx[s]);
-      tri_s = gr_t[ss];
-      factor = gr_g[ss] * bem->kernel_const;
-
-      A_s = gr_x[tri_s[0]];
-      B_s = gr_x[tri_s[1]];
-      C_s = gr_x[tri_s[2]];
-      ny = gr_n[ss];
-
-      for (t = 0; t < rows; ++t) {
-	tt = (ridx == NULL ? t : ridx[t]);
-	tri_t = gr_t[tt];
-	factor2 = factor * gr_g[tt];
-
-	A_t = gr_x[tri_t[0]];
-	B_t = gr_x[tri_t[1]];
-	C_t = gr_x[tri_t[2]];
-	nx = gr_n[tt];
-
-	sum = bem->sq->base_dist;
-
-	for (q = 0; q < nq; ++q) {
-	  tx = xq[q];
-	  sx = xq[q + vnq];
-	  ty = yq[q];
-	  sy = yq[q + vnq];
-	  Ax = 1.0 - tx;
-	  Bx = tx - sx;
-	  Cx = sx;
-	  Ay = 1.0 - ty;
-	  By = ty - sy;
-	  Cy = sy;
-
-	  x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
-	  x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
-	  x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
-
-	  y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
-	  y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
-	  y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
-
-	  sum += wq[q] * kernel(x, y, nx, ny, (void *) bem);
-	}
-	if (ntrans) {
-	  aa[s + t * ld] = CONJ(sum) * factor2;
+	if (ntrans) {
+	  aa[s + t * ld] = CONJ(sum) * factor2;
 	}
 	else {
 	  aa[t + s * ld] = sum * factor2;
@@ -1527,273 +1502,6 @@ assemble_cc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 #endif
 }
 
-#ifdef USE_SIMD
-void
-assemble_cl_simd_near_bem3d(const uint * ridx, const uint * cidx,
-			    pcbem3d bem, bool ntrans, pamatrix N,
-			    kernel_simd_func3d kernel)
-{
-  const pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const preal gr_g = (const preal) gr->g;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const uint triangles = gr->triangles;
-  plistnode *v2t = bem->v2t;
-
-  field    *aa = N->a;
-  uint      rows = ntrans ? N->cols : N->rows;
-  uint      cols = ntrans ? N->rows : N->cols;
-  longindex ld = N->ld;
-
-  vreal     vt[3][3], vs[3][3], nx[3], ny[3];
-  real     *quad_r, *quad_i;
-  ptri_list tl, tl1;
-  pvert_list vl;
-  const uint *tri_t, *tri_s;
-  plistnode v;
-  real     *xq, *yq, *wq, *mass;
-  uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
-  vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i, eval_r,
-    eval_i, vcount, cmp;
-  real      base, factor, factor2;
-  uint      i, j, t, s, q, nq, vnq, remainder, cj;
-  uint      ii, jj, tt, ss, vv;
-#ifdef USE_TRIQUADPOINTS
-  real     *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
-  uint      c;
-  uint      q2;
-  uint      nq2 = bem->sq->n_single;
-  uint      vnq2 = ROUNDUP(nq2, VREAL);
-#endif
-
-  clear_amatrix(N);
-
-  quad_r = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
-  quad_i = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
-  vreal     c_one = vset1(1.0);
-
-  tl = NULL;
-
-  cj = 0;
-  for (i = 0; i < cols; ++i) {
-    ii = (cidx == NULL ? i : cidx[i]);
-    for (v = v2t[ii], vv = v->data; v->next != NULL;
-	 v = v->next, vv = v->data) {
-
-      tl1 = tl;
-      while (tl1 && tl1->t != vv) {
-	tl1 = tl1->next;
-      }
-
-      if (tl1 == NULL) {
-	tl1 = tl = new_tri_list(tl);
-	tl->t = vv;
-	cj++;
-      }
-
-      tl1->vl = new_vert_list(tl1->vl);
-      tl1->vl->v = i;
-    }
-  }
-
-  for (s = 0, tl1 = tl; s < cj; s++, tl1 = tl1->next) {
-    ss = tl1->t;
-    assert(ss < triangles);
-    factor = gr_g[ss] * bem->kernel_const;
-    tri_s = gr_t[ss];
-    for (i = 0; i < 3; ++i) {
-      ny[i] = vload1(gr_n[ss] + i);
-    }
-#ifdef USE_TRIQUADPOINTS
-    tri_sx = bem->sq->tri_x + ss * vnq2;
-    tri_sy = bem->sq->tri_y + ss * vnq2;
-    tri_sz = bem->sq->tri_z + ss * vnq2;
-#endif
-    for (t = 0; t < rows; t++) {
-      tt = (ridx == NULL ? t : ridx[t]);
-      assert(tt < triangles);
-      factor2 = factor * gr_g[tt];
-      tri_t = gr_t[tt];
-      for (i = 0; i < 3; ++i) {
-	nx[i] = vload1(gr_n[tt] + i);
-      }
-#ifdef USE_TRIQUADPOINTS
-      tri_tx = bem->sq->tri_x + tt * vnq2;
-      tri_ty = bem->sq->tri_y + tt * vnq2;
-      tri_tz = bem->sq->tri_z + tt * vnq2;
-#endif
-
-#ifdef USE_TRIQUADPOINTS
-      c =
-	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				     &wq, &nq, &base);
-      if (nq % VREAL || nq2 % VREAL) {
-	for (q = 0; q < VREAL; ++q) {
-	  vcount[q] = q;
-	}
-      }
-
-#else
-      (void) select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
-					  &yq, &wq, &nq, &base);
-      if (nq % VREAL) {
-	for (q = 0; q < VREAL; ++q) {
-	  vcount[q] = q;
-	}
-      }
-
-#endif
-      vnq = ROUNDUP(nq, VREAL);
-
-#ifdef USE_TRIQUADPOINTS
-      if (c == 0) {
-	remainder = vnq2 - VREAL;
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[i];
-	  tri_sp[i] = tri_s[i];
-	}
-
-	for (q = 0; q < nq2; q++) {
-	  x[0] = vload1(tri_tx + q);
-	  x[1] = vload1(tri_ty + q);
-	  x[2] = vload1(tri_tz + q);
-	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
-	    y[0] = vload(tri_sx + q2);
-	    y[1] = vload(tri_sy + q2);
-	    y[2] = vload(tri_sz + q2);
-
-	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	    if (nq2 % VREAL && q2 >= remainder) {
-	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
-	      eval_r = vand(cmp, eval_r);
-	      eval_i = vand(cmp, eval_i);
-	    }
-
-	    vstoreu(quad_r + q2 + q * nq2, eval_r);
-	    vstoreu(quad_i + q2 + q * nq2, eval_i);
-	  }
-	}
-      }
-      else {
-#endif
-	remainder = vnq - VREAL;
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[tp[i]];
-	  tri_sp[i] = tri_s[sp[i]];
-	}
-
-	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	    vt[i][j] = vload1(gr_x[tri_tp[j]] + i);
-	    vs[i][j] = vload1(gr_x[tri_sp[j]] + i);
-	  }
-	}
-
-	for (q = 0; q < vnq; q += VREAL) {
-	  tx = vload(xq + q);
-	  sx = vload(xq + q + vnq);
-	  ty = vload(yq + q);
-	  sy = vload(yq + q + vnq);
-
-	  ct[0] = vsub(c_one, tx);
-	  ct[1] = vsub(tx, sx);
-	  ct[2] = sx;
-	  cs[0] = vsub(c_one, ty);
-	  cs[1] = vsub(ty, sy);
-	  cs[2] = sy;
-
-	  for (i = 0; i < 3; ++i) {
-	    x[i] = vdot3(vt[i], ct);
-	    y[i] = vdot3(vs[i], cs);
-	  }
-
-	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	  if (nq % VREAL && q >= remainder) {
-	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	    eval_r = vand(cmp, eval_r);
-	    eval_i = vand(cmp, eval_i);
-	  }
-
-	  vstore(quad_r + q, eval_r);
-	  vstore(quad_i + q, eval_i);
-	}
-#ifdef USE_TRIQUADPOINTS
-      }
-#endif
-      vl = tl1->vl;
-      while (vl) {
-	j = vl->v;
-	if (j < cols) {
-	  jj = cidx == NULL ? j : cidx[j];
-	  for (i = 0; i < 3; ++i) {
-	    if (jj == tri_sp[i]) {
-	      sum_r = vsetzero();
-	      sum_i = vsetzero();
-
-	      for (q = 0; q < vnq; q += VREAL) {
-		eval_r = vload(quad_r + q);
-		eval_i = vload(quad_i + q);
-		w = vload(wq + q);
-		sum_r = vfmadd(w, eval_r, sum_r);
-		sum_i = vfmadd(w, eval_i, sum_i);
-	      }
-
-	      if (ntrans) {
-		aa[j + t * ld] += ((vreduce(sum_r) + base) * factor2)
-		  - (vreduce(sum_i) * factor2) * I;
-	      }
-	      else {
-		aa[t + j * ld] += ((vreduce(sum_r) + base) * factor2)
-		  + (vreduce(sum_i) * factor2) * I;
-	      }
-	    }
-	    wq += vnq;
-	  }
-	  wq -= 3 * vnq;
-	}
-	vl = vl->next;
-      }
-
-      if (bem->alpha != 0.0 && tt == ss) {
-
-	for (i = 0; i < 3; ++i) {
-	  tri_sp[i] = tri_s[i];
-	}
-
-	mass = bem->mass;
-	factor2 = bem->alpha * gr_g[tt];
-
-	vl = tl1->vl;
-	while (vl) {
-	  j = vl->v;
-	  if (j < cols) {
-	    jj = cidx == NULL ? j : cidx[j];
-	    for (i = 0; i < 3; ++i) {
-	      if (jj == tri_sp[i]) {
-		if (ntrans) {
-		  aa[j + t * ld] += factor2 * *mass;
-		}
-		else {
-		  aa[t + j * ld] += factor2 * *mass;
-		}
-	      }
-	      mass++;
-	    }
-	    mass = bem->mass;
-	  }
-	  vl = vl->next;
-	}
-      }
-    }
-  }
-}
-#endif
-
 void
 assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		       bool ntrans, pamatrix N, kernel_func3d kernel)
@@ -1810,6 +1518,7 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   uint      rows = ntrans ? N->cols : N->rows;
   uint      cols = ntrans ? N->rows : N->cols;
   longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
 
   field    *quad;
   ptri_list tl, tl1;
@@ -1817,12 +1526,14 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   const real *A_t, *B_t, *C_t, *A_s, *B_s, *C_s, *ns, *nt;
   const uint *tri_t, *tri_s;
   plistnode v;
-  real     *xq, *yq, *wq, *mass;
+  real     *xq, *yq, *wq, *ww, *mass;
   uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
   real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
     factor2, base;
-  field     res;
-  uint      i, j, t, s, q, nq, vnq, cj;
+  field     res, val[3];
+  int64_t   key[SINGCACHE_KEYLEN];
+  bool      cached;
+  uint      i, j, k, t, s, q, nq, vnq, cj, c;
   uint      ii, jj, tt, ss, vv;
 
   clear_amatrix(N);
@@ -1867,9 +1578,9 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 
       factor2 = factor * gr_g[tt];
 
-      select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				   &wq, &nq, &base);
-      vnq = ROUNDUP(nq, VREAL);
+      c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
+				       &yq, &wq, &nq, &base);
+      vnq = ROUNDUP(nq, VREAL_PAD);
 
       for (i = 0; i < 3; ++i) {
 	tri_tp[i] = tri_t[tp[i]];
@@ -1883,27 +1594,48 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
       B_s = gr_x[tri_sp[1]];
       C_s = gr_x[tri_sp[2]];
 
-      for (q = 0; q < nq; ++q) {
-	tx = xq[q];
-	sx = xq[q + vnq];
-	ty = yq[q];
-	sy = yq[q + vnq];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-	Ay = 1.0 - ty;
-	By = ty - sy;
-	Cy = sy;
+      /* Congruent singular pairs have already been integrated */
+      cached = (c > 0 && sc != NULL);
+      if (cached) {
+	key_singcache(3, c, tp, sp, A_t, B_t, C_t, A_s, B_s, C_s, key);
+	cached = lookup_singcache(sc, key, 3, val);
+      }
+
+      if (!cached) {
+	for (q = 0; q < nq; ++q) {
+	  tx = xq[q];
+	  sx = xq[q + vnq];
+	  ty = yq[q];
+	  sy = yq[q + vnq];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
+	  Ay = 1.0 - ty;
+	  By = ty - sy;
+	  Cy = sy;
+
+	  x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
+	  x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
+	  x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
+
+	  y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
+	  y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
+	  y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
 
-	x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
-	x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
-	x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
+	  quad[q] = kernel(x, y, nt, ns, (void *) bem);
+	}
 
-	y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
-	y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
-	y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+	for (k = 0; k < 3; ++k) {
+	  val[k] = 0.0;
+	  ww = wq + k * vnq;
+	  for (q = 0; q < nq; ++q) {
+	    val[k] += ww[q] * quad[q];
+	  }
+	}
 
-	quad[q] = kernel(x, y, nt, ns, (void *) bem);
+	if (c > 0 && sc != NULL) {
+	  insert_singcache(sc, key, 3, val);
+	}
       }
 
       vl = tl1->vl;
@@ -1913,11 +1645,7 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 	  jj = cidx == NULL ? j : cidx[j];
 	  for (i = 0; i < 3; ++i) {
 	    if (jj == tri_sp[i]) {
-	      res = base;
-
-	      for (q = 0; q < nq; ++q) {
-		res += wq[q] * quad[q];
-	      }
+	      res = base + val[i];
 
 	      if (ntrans) {
 		aa[j + t * ld] += res * factor2;
@@ -1926,9 +1654,7 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		aa[t + j * ld] += res * factor2;
 	      }
 	    }
-	    wq += vnq;
 	  }
-	  wq -= 3 * vnq;
 	}
 	vl = vl->next;
       }
@@ -1970,17 +1696,6 @@ assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   freemem(quad);
 }
 
-#ifdef USE_SIMD
-void
-assemble_cl_simd_far_bem3d(const uint * ridx, const uint * cidx,
-			   pcbem3d bem, bool ntrans, pamatrix N,
-			   kernel_simd_func3d kernel)
-{
-  //TODO implement nice 'far' version
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, kernel);
-}
-#endif
-
 void
 assemble_cl_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		      bool ntrans, pamatrix N, kernel_func3d kernel)
@@ -2020,7 +1735,7 @@ assemble_cl_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   yq = bem->sq->y_dist;
   wq = bem->sq->w_dist;
   nq = bem->sq->n_dist;
-  vnq = ROUNDUP(nq, VREAL);
+  vnq = ROUNDUP(nq, VREAL_PAD);
   base = bem->sq->base_dist;
 
   cj = 0;
@@ -2123,273 +1838,6 @@ assemble_cl_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   freemem(quad);
 }
 
-#ifdef USE_SIMD
-void
-assemble_lc_simd_near_bem3d(const uint * ridx, const uint * cidx,
-			    pcbem3d bem, bool ntrans, pamatrix N,
-			    kernel_simd_func3d kernel)
-{
-  const pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const preal gr_g = (const preal) gr->g;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const uint triangles = gr->triangles;
-  plistnode *v2t = bem->v2t;
-
-  field    *aa = N->a;
-  uint      rows = ntrans ? N->cols : N->rows;
-  uint      cols = ntrans ? N->rows : N->cols;
-  longindex ld = N->ld;
-
-  vreal     vt[3][3], vs[3][3], nx[3], ny[3];
-  real     *quad_r, *quad_i;
-  ptri_list tl, tl1;
-  pvert_list vl;
-  const uint *tri_t, *tri_s;
-  plistnode v;
-  real     *xq, *yq, *wq, *mass;
-  uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
-  vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i, eval_r,
-    eval_i, vcount, cmp;
-  real      base, factor, factor2;
-  uint      i, j, t, s, q, nq, vnq, remainder, cj;
-  uint      ii, tt, ss, vv;
-#ifdef USE_TRIQUADPOINTS
-  real     *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
-  uint      c;
-  uint      q2;
-  uint      nq2 = bem->sq->n_single;
-  uint      vnq2 = ROUNDUP(nq2, VREAL);
-#endif
-
-  clear_amatrix(N);
-
-  quad_r = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
-  quad_i = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
-  vreal     c_one = vset1(1.0);
-
-  tl = NULL;
-
-  cj = 0;
-  for (j = 0; j < rows; ++j) {
-    ii = (ridx == NULL ? j : ridx[j]);
-    for (v = v2t[ii], vv = v->data; v->next != NULL;
-	 v = v->next, vv = v->data) {
-
-      tl1 = tl;
-      while (tl1 && tl1->t != vv) {
-	tl1 = tl1->next;
-      }
-
-      if (tl1 == NULL) {
-	tl1 = tl = new_tri_list(tl);
-	tl->t = vv;
-	cj++;
-      }
-
-      tl1->vl = new_vert_list(tl1->vl);
-      tl1->vl->v = j;
-    }
-  }
-
-  for (t = 0, tl1 = tl; t < cj; t++, tl1 = tl1->next) {
-    tt = tl1->t;
-    assert(tt < triangles);
-    factor = gr_g[tt] * bem->kernel_const;
-    tri_s = gr_t[tt];
-    for (i = 0; i < 3; ++i) {
-      nx[i] = vload1(gr_n[tt] + i);
-    }
-#ifdef USE_TRIQUADPOINTS
-    tri_tx = bem->sq->tri_x + tt * vnq2;
-    tri_ty = bem->sq->tri_y + tt * vnq2;
-    tri_tz = bem->sq->tri_z + tt * vnq2;
-#endif
-    for (s = 0; s < cols; s++) {
-      ss = (cidx == NULL ? s : cidx[s]);
-      assert(ss < triangles);
-      factor2 = factor * gr_g[ss];
-      tri_t = gr_t[ss];
-      for (i = 0; i < 3; ++i) {
-	ny[i] = vload1(gr_n[ss] + i);
-      }
-#ifdef USE_TRIQUADPOINTS
-      tri_sx = bem->sq->tri_x + ss * vnq2;
-      tri_sy = bem->sq->tri_y + ss * vnq2;
-      tri_sz = bem->sq->tri_z + ss * vnq2;
-#endif
-
-#ifdef USE_TRIQUADPOINTS
-      c =
-	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				     &wq, &nq, &base);
-      if (nq % VREAL || nq2 % VREAL) {
-	for (q = 0; q < VREAL; ++q) {
-	  vcount[q] = q;
-	}
-      }
-
-#else
-      (void) select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
-					  &yq, &wq, &nq, &base);
-      if (nq % VREAL) {
-	for (q = 0; q < VREAL; ++q) {
-	  vcount[q] = q;
-	}
-      }
-
-#endif
-      vnq = ROUNDUP(nq, VREAL);
-
-#ifdef USE_TRIQUADPOINTS
-      if (c == 0) {
-	remainder = vnq2 - VREAL;
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[i];
-	  tri_sp[i] = tri_s[i];
-	}
-
-	for (q = 0; q < nq2; q++) {
-	  x[0] = vload1(tri_tx + q);
-	  x[1] = vload1(tri_ty + q);
-	  x[2] = vload1(tri_tz + q);
-	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
-	    y[0] = vload(tri_sx + q2);
-	    y[1] = vload(tri_sy + q2);
-	    y[2] = vload(tri_sz + q2);
-
-	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	    if (nq2 % VREAL && q2 >= remainder) {
-	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
-	      eval_r = vand(cmp, eval_r);
-	      eval_i = vand(cmp, eval_i);
-	    }
-
-	    vstoreu(quad_r + q2 + q * nq2, eval_r);
-	    vstoreu(quad_i + q2 + q * nq2, eval_i);
-	  }
-	}
-      }
-      else {
-#endif
-	remainder = vnq - VREAL;
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[tp[i]];
-	  tri_sp[i] = tri_s[sp[i]];
-	}
-
-	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	    vt[i][j] = vload1(gr_x[tri_tp[j]] + i);
-	    vs[i][j] = vload1(gr_x[tri_sp[j]] + i);
-	  }
-	}
-
-	for (q = 0; q < vnq; q += VREAL) {
-	  tx = vload(xq + q);
-	  sx = vload(xq + q + vnq);
-	  ty = vload(yq + q);
-	  sy = vload(yq + q + vnq);
-
-	  ct[0] = vsub(c_one, tx);
-	  ct[1] = vsub(tx, sx);
-	  ct[2] = sx;
-	  cs[0] = vsub(c_one, ty);
-	  cs[1] = vsub(ty, sy);
-	  cs[2] = sy;
-
-	  for (i = 0; i < 3; ++i) {
-	    x[i] = vdot3(vt[i], ct);
-	    y[i] = vdot3(vs[i], cs);
-	  }
-
-	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	  if (nq % VREAL && q >= remainder) {
-	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	    eval_r = vand(cmp, eval_r);
-	    eval_i = vand(cmp, eval_i);
-	  }
-
-	  vstore(quad_r + q, eval_r);
-	  vstore(quad_i + q, eval_i);
-	}
-#ifdef USE_TRIQUADPOINTS
-      }
-#endif
-      vl = tl1->vl;
-      while (vl) {
-	i = vl->v;
-	if (i < rows) {
-	  ii = ridx == NULL ? i : ridx[i];
-	  for (j = 0; j < 3; ++j) {
-	    if (ii == tri_tp[j]) {
-	      sum_r = vsetzero();
-	      sum_i = vsetzero();
-
-	      for (q = 0; q < vnq; q += VREAL) {
-		eval_r = vload(quad_r + q);
-		eval_i = vload(quad_i + q);
-		w = vload(wq + q);
-		sum_r = vfmadd(w, eval_r, sum_r);
-		sum_i = vfmadd(w, eval_i, sum_i);
-	      }
-
-	      if (ntrans) {
-		aa[s + i * ld] += ((vreduce(sum_r) + base) * factor2)
-		  - (vreduce(sum_i) * factor2) * I;
-	      }
-	      else {
-		aa[i + s * ld] += ((vreduce(sum_r) + base) * factor2)
-		  + (vreduce(sum_i) * factor2) * I;
-	      }
-	    }
-	    wq += vnq;
-	  }
-	  wq -= 3 * vnq;
-	}
-	vl = vl->next;
-      }
-
-      if (bem->alpha != 0.0 && tt == ss) {
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[i];
-	}
-
-	mass = bem->mass;
-	factor2 = bem->alpha * gr_g[tt];
-
-	vl = tl1->vl;
-	while (vl) {
-	  i = vl->v;
-	  if (i < rows) {
-	    ii = ridx == NULL ? i : ridx[i];
-	    for (j = 0; j < 3; ++j) {
-	      if (ii == tri_tp[j]) {
-		if (ntrans) {
-		  aa[s + i * ld] += factor2 * *mass;
-		}
-		else {
-		  aa[i + s * ld] += factor2 * *mass;
-		}
-	      }
-	      mass++;
-	    }
-	    mass = bem->mass;
-	  }
-	  vl = vl->next;
-	}
-      }
-    }
-  }
-}
-#endif
-
 void
 assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		       bool ntrans, pamatrix N, kernel_func3d kernel)
@@ -2406,6 +1854,7 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   uint      rows = ntrans ? N->cols : N->rows;
   uint      cols = ntrans ? N->rows : N->cols;
   longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
 
   field    *quad;
   ptri_list tl, tl1;
@@ -2413,12 +1862,14 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   const real *A_t, *B_t, *C_t, *A_s, *B_s, *C_s, *ns, *nt;
   const uint *tri_t, *tri_s;
   plistnode v;
-  real     *xq, *yq, *wq, *mass;
+  real     *xq, *yq, *wq, *ww, *mass;
   uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
   real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
     factor2, base;
-  field     res;
-  uint      i, j, t, s, q, nq, vnq, cj;
+  field     res, val[3];
+  int64_t   key[SINGCACHE_KEYLEN];
+  bool      cached;
+  uint      i, j, k, t, s, q, nq, vnq, cj, c;
   uint      ii, tt, ss, vv;
 
   clear_amatrix(N);
@@ -2463,9 +1914,9 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 
       factor2 = factor * gr_g[ss];
 
-      select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				   &wq, &nq, &base);
-      vnq = ROUNDUP(nq, VREAL);
+      c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
+				       &yq, &wq, &nq, &base);
+      vnq = ROUNDUP(nq, VREAL_PAD);
 
       for (i = 0; i < 3; ++i) {
 	tri_tp[i] = tri_t[tp[i]];
@@ -2479,27 +1930,48 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
       B_s = gr_x[tri_sp[1]];
       C_s = gr_x[tri_sp[2]];
 
-      for (q = 0; q < nq; ++q) {
-	tx = xq[q];
-	sx = xq[q + vnq];
-	ty = yq[q];
-	sy = yq[q + vnq];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-	Ay = 1.0 - ty;
-	By = ty - sy;
-	Cy = sy;
+      /* Congruent singular pairs have already been integrated */
+      cached = (c > 0 && sc != NULL);
+      if (cached) {
+	key_singcache(3, c, tp, sp, A_t, B_t, C_t, A_s, B_s, C_s, key);
+	cached = lookup_singcache(sc, key, 3, val);
+      }
 
-	x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
-	x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
-	x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
+      if (!cached) {
+	for (q = 0; q < nq; ++q) {
+	  tx = xq[q];
+	  sx = xq[q + vnq];
+	  ty = yq[q];
+	  sy = yq[q + vnq];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
+	  Ay = 1.0 - ty;
+	  By = ty - sy;
+	  Cy = sy;
 
-	y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
-	y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
-	y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+	  x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
+	  x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
+	  x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
 
-	quad[q] = kernel(x, y, nt, ns, (void *) bem);
+	  y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
+	  y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
+	  y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+
+	  quad[q] = kernel(x, y, nt, ns, (void *) bem);
+	}
+
+	for (k = 0; k < 3; ++k) {
+	  val[k] = 0.0;
+	  ww = wq + k * vnq;
+	  for (q = 0; q < nq; ++q) {
+	    val[k] += ww[q] * quad[q];
+	  }
+	}
+
+	if (c > 0 && sc != NULL) {
+	  insert_singcache(sc, key, 3, val);
+	}
       }
 
       vl = tl1->vl;
@@ -2509,11 +1981,7 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 	  ii = ridx == NULL ? i : ridx[i];
 	  for (j = 0; j < 3; ++j) {
 	    if (ii == tri_tp[j]) {
-	      res = base;
-
-	      for (q = 0; q < nq; ++q) {
-		res += wq[q] * quad[q];
-	      }
+	      res = base + val[j];
 
 	      if (ntrans) {
 		aa[s + i * ld] += res * factor2;
@@ -2522,9 +1990,7 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		aa[i + s * ld] += res * factor2;
 	      }
 	    }
-	    wq += vnq;
 	  }
-	  wq -= 3 * vnq;
 	}
 	vl = vl->next;
       }
@@ -2566,17 +2032,6 @@ assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   freemem(quad);
 }
 
-#ifdef USE_SIMD
-void
-assemble_lc_simd_far_bem3d(const uint * ridx, const uint * cidx,
-			   pcbem3d bem, bool ntrans, pamatrix N,
-			   kernel_simd_func3d kernel)
-{
-  //TODO implement nice 'far' version
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, kernel);
-}
-#endif
-
 void
 assemble_lc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		      bool ntrans, pamatrix N, kernel_func3d kernel)
@@ -2616,7 +2071,7 @@ assemble_lc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   yq = bem->sq->y_dist;
   wq = bem->sq->w_dist;
   nq = bem->sq->n_dist;
-  vnq = ROUNDUP(nq, VREAL);
+  vnq = ROUNDUP(nq, VREAL_PAD);
   base = bem->sq->base_dist;
 
   cj = 0;
@@ -2719,321 +2174,6 @@ assemble_lc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   freemem(quad);
 }
 
-#ifdef USE_SIMD
-void
-assemble_ll_simd_near_bem3d(const uint * ridx, const uint * cidx,
-			    pcbem3d bem, bool ntrans, pamatrix N,
-			    kernel_simd_func3d kernel)
-{
-  const pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  const uint triangles = gr->triangles;
-  plistnode *v2t = bem->v2t;
-  field    *aa = N->a;
-  uint      rows = ntrans ? N->cols : N->rows;
-  uint      cols = ntrans ? N->rows : N->cols;
-  longindex ld = N->ld;
-
-  ptri_list tl_r, tl1_r, tl_c, tl1_c;
-  pvert_list vl_r, vl_c;
-  vreal     vt[3][3], vs[3][3], nx[3], ny[3];
-  real     *quad_r, *quad_i;
-  const uint *tri_t, *tri_s;
-  plistnode v;
-  real     *xq, *yq, *wq, *ww;
-  uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
-  vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i, eval_r,
-    eval_i, vcount, cmp;
-  real      base, factor, factor2;
-  real     *mass;
-  uint      i, j, t, s, q, nq, vnq, remainder, rj, cj;
-  uint      ii, jj, tt, ss, vv, k, l;
-#ifdef USE_TRIQUADPOINTS
-  real     *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
-  uint      c;
-  uint      q2;
-  uint      nq2 = bem->sq->n_single;
-  uint      vnq2 = ROUNDUP(nq2, VREAL);
-#endif
-
-  quad_r = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
-  quad_i = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
-  vreal     c_one = vset1(1.0);
-
-  clear_amatrix(N);
-
-  tl_r = NULL;
-  tl_c = NULL;
-
-  rj = 0;
-  for (i = 0; i < rows; ++i) {
-    ii = (ridx == NULL ? i : ridx[i]);
-    for (v = v2t[ii], vv = v->data; v->next != NULL;
-	 v = v->next, vv = v->data) {
-
-      tl1_r = tl_r;
-      while (tl1_r && tl1_r->t != vv) {
-	tl1_r = tl1_r->next;
-      }
-
-      if (tl1_r == NULL) {
-	tl1_r = tl_r = new_tri_list(tl_r);
-	tl_r->t = vv;
-	rj++;
-      }
-
-      tl1_r->vl = new_vert_list(tl1_r->vl);
-      tl1_r->vl->v = i;
-    }
-  }
-
-  cj = 0;
-  for (i = 0; i < cols; ++i) {
-    ii = (cidx == NULL ? i : cidx[i]);
-    for (v = v2t[ii], vv = v->data; v->next != NULL;
-	 v = v->next, vv = v->data) {
-
-      tl1_c = tl_c;
-      while (tl1_c && tl1_c->t != vv) {
-	tl1_c = tl1_c->next;
-      }
-
-      if (tl1_c == NULL) {
-	tl1_c = tl_c = new_tri_list(tl_c);
-	tl_c->t = vv;
-	cj++;
-      }
-
-      tl1_c->vl = new_vert_list(tl1_c->vl);
-      tl1_c->vl->v = i;
-    }
-  }
-
-  for (s = 0, tl1_c = tl_c; s < cj; s++, tl1_c = tl1_c->next) {
-    ss = tl1_c->t;
-    assert(ss < triangles);
-    factor = gr_g[ss] * bem->kernel_const;
-    tri_s = gr_t[ss];
-    for (i = 0; i < 3; ++i) {
-      ny[i] = vload1(gr_n[ss] + i);
-    }
-#ifdef USE_TRIQUADPOINTS
-    tri_sx = bem->sq->tri_x + ss * vnq2;
-    tri_sy = bem->sq->tri_y + ss * vnq2;
-    tri_sz = bem->sq->tri_z + ss * vnq2;
-#endif
-    for (t = 0, tl1_r = tl_r; t < rj; t++, tl1_r = tl1_r->next) {
-      tt = tl1_r->t;
-      assert(tt < triangles);
-      factor2 = factor * gr_g[tt];
-      tri_t = gr_t[tt];
-      for (i = 0; i < 3; ++i) {
-	nx[i] = vload1(gr_n[tt] + i);
-      }
-#ifdef USE_TRIQUADPOINTS
-      tri_tx = bem->sq->tri_x + tt * vnq2;
-      tri_ty = bem->sq->tri_y + tt * vnq2;
-      tri_tz = bem->sq->tri_z + tt * vnq2;
-#endif
-
-#ifdef USE_TRIQUADPOINTS
-      c =
-	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				     &wq, &nq, &base);
-      if (nq % VREAL || nq2 % VREAL) {
-	for (q = 0; q < VREAL; ++q) {
-	  vcount[q] = q;
-	}
-      }
-
-#else
-      (void) select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
-					  &yq, &wq, &nq, &base);
-      if (nq % VREAL) {
-	for (q = 0; q < VREAL; ++q) {
-	  vcount[q] = q;
-	}
-      }
-
-#endif
-      vnq = ROUNDUP(nq, VREAL);
-
-#ifdef USE_TRIQUADPOINTS
-      if (c == 0) {
-	remainder = vnq2 - VREAL;
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[i];
-	  tri_sp[i] = tri_s[i];
-	}
-
-	for (q = 0; q < nq2; q++) {
-	  x[0] = vload1(tri_tx + q);
-	  x[1] = vload1(tri_ty + q);
-	  x[2] = vload1(tri_tz + q);
-	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
-	    y[0] = vload(tri_sx + q2);
-	    y[1] = vload(tri_sy + q2);
-	    y[2] = vload(tri_sz + q2);
-
-	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	    if (nq2 % VREAL && q2 >= remainder) {
-	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
-	      eval_r = vand(cmp, eval_r);
-	      eval_i = vand(cmp, eval_i);
-	    }
-
-	    vstoreu(quad_r + q2 + q * nq2, eval_r);
-	    vstoreu(quad_i + q2 + q * nq2, eval_i);
-	  }
-	}
-      }
-      else {
-#endif
-	remainder = vnq - VREAL;
-
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[tp[i]];
-	  tri_sp[i] = tri_s[sp[i]];
-	}
-
-	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	    vt[i][j] = vload1(gr_x[tri_tp[j]] + i);
-	    vs[i][j] = vload1(gr_x[tri_sp[j]] + i);
-	  }
-	}
-
-	for (q = 0; q < vnq; q += VREAL) {
-	  tx = vload(xq + q);
-	  sx = vload(xq + q + vnq);
-	  ty = vload(yq + q);
-	  sy = vload(yq + q + vnq);
-
-	  ct[0] = vsub(c_one, tx);
-	  ct[1] = vsub(tx, sx);
-	  ct[2] = sx;
-	  cs[0] = vsub(c_one, ty);
-	  cs[1] = vsub(ty, sy);
-	  cs[2] = sy;
-
-	  for (i = 0; i < 3; ++i) {
-	    x[i] = vdot3(vt[i], ct);
-	    y[i] = vdot3(vs[i], cs);
-	  }
-
-	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
-
-	  if (nq % VREAL && q >= remainder) {
-	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	    eval_r = vand(cmp, eval_r);
-	    eval_i = vand(cmp, eval_i);
-	  }
-
-	  vstore(quad_r + q, eval_r);
-	  vstore(quad_i + q, eval_i);
-	}
-#ifdef USE_TRIQUADPOINTS
-      }
-#endif
-
-      vl_c = tl1_c->vl;
-      while (vl_c) {
-	j = vl_c->v;
-	assert(j < cols);
-	jj = ((cidx == NULL) ? j : cidx[j]);
-	for (k = 0; k < 3; ++k) {
-	  if (jj == tri_sp[k]) {
-	    vl_r = tl1_r->vl;
-	    while (vl_r) {
-	      i = vl_r->v;
-	      assert(i < rows);
-	      ii = ((ridx == NULL) ? i : ridx[i]);
-	      for (l = 0; l < 3; ++l) {
-		if (ii == tri_tp[l]) {
-		  sum_r = vsetzero();
-		  sum_i = vsetzero();
-		  ww = wq + (l + k * 3) * vnq;
-
-		  for (q = 0; q < vnq; q += VREAL) {
-		    eval_r = vload(quad_r + q);
-		    eval_i = vload(quad_i + q);
-		    w = vload(ww + q);
-		    sum_r = vfmadd(w, eval_r, sum_r);
-		    sum_i = vfmadd(w, eval_i, sum_i);
-		  }
-
-		  if (ntrans) {
-		    aa[j + i * ld] += ((vreduce(sum_r) + base) * factor2)
-		      - (vreduce(sum_i) * factor2) * I;
-		  }
-		  else {
-		    aa[i + j * ld] += ((vreduce(sum_r) + base) * factor2)
-		      + (vreduce(sum_i) * factor2) * I;
-		  }
-
-		}
-	      }
-	      vl_r = vl_r->next;
-	    }
-	  }
-	}
-	vl_c = vl_c->next;
-      }
-
-      if (bem->alpha != 0.0 && tt == ss) {
-	for (i = 0; i < 3; ++i) {
-	  tri_tp[i] = tri_t[i];
-	  tri_sp[i] = tri_s[i];
-	}
-
-	mass = bem->mass;
-	factor2 = bem->alpha * gr_g[tt];
-
-	vl_c = tl1_c->vl;
-	while (vl_c) {
-	  j = vl_c->v;
-	  assert(j < cols);
-	  jj = ((cidx == NULL) ? j : cidx[j]);
-	  for (k = 0; k < 3; ++k) {
-	    if (jj == tri_sp[k]) {
-	      vl_r = tl1_r->vl;
-	      while (vl_r) {
-		i = vl_r->v;
-		assert(i < rows);
-		ii = ((ridx == NULL) ? i : ridx[i]);
-		for (l = 0; l < 3; ++l) {
-		  if (ii == tri_tp[l]) {
-		    if (ntrans) {
-		      aa[j + i * ld] += CONJ(mass[l + k * 3] * factor2);
-		    }
-		    else {
-		      aa[i + j * ld] += mass[l + k * 3] * factor2;
-		    }
-		  }
-		}
-		vl_r = vl_r->next;
-	      }
-	    }
-	  }
-	  vl_c = vl_c->next;
-	}
-      }
-    }
-  }
-
-  del_tri_list(tl_r);
-  del_tri_list(tl_c);
-
-  freemem(quad_r);
-  freemem(quad_i);
-}
-#endif
-
 void
 assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		       bool ntrans, pamatrix N, kernel_func3d kernel)
@@ -3050,6 +2190,7 @@ assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   uint      rows = ntrans ? N->cols : N->rows;
   uint      cols = ntrans ? N->rows : N->cols;
   longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
 
   ptri_list tl_r, tl1_r, tl_c, tl1_c;
   pvert_list vl_r, vl_c;
@@ -3060,9 +2201,11 @@ assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
   real      Ax, Bx, Cx, Ay, By, Cy, tx, sx, ty, sy, x[3], y[3], factor,
     factor2, base;
-  field     res;
+  field     res, val[9];
+  int64_t   key[SINGCACHE_KEYLEN];
+  bool      cached;
   real     *mass;
-  uint      i, j, t, s, k, l, rj, cj, tt, ss, q, nq, vnq, ii, jj, vv;
+  uint      i, j, t, s, k, l, rj, cj, tt, ss, q, nq, vnq, ii, jj, vv, c;
 
   quad = allocfield(bem->sq->nmax);
 
@@ -3128,9 +2271,9 @@ assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
       tri_t = gr_t[tt];
       nt = gr_n[tt];
 
-      select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
-				   &wq, &nq, &base);
-      vnq = ROUNDUP(nq, VREAL);
+      c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
+				       &yq, &wq, &nq, &base);
+      vnq = ROUNDUP(nq, VREAL_PAD);
 
       for (i = 0; i < 3; ++i) {
 	tri_tp[i] = tri_t[tp[i]];
@@ -3144,26 +2287,47 @@ assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
       B_s = gr_x[tri_sp[1]];
       C_s = gr_x[tri_sp[2]];
 
-      for (q = 0; q < nq; ++q) {
-	tx = xq[q];
-	sx = xq[q + vnq];
-	ty = yq[q];
-	sy = yq[q + vnq];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-	Ay = 1.0 - ty;
-	By = ty - sy;
-	Cy = sy;
+      /* Congruent singular pairs have already been integrated */
+      cached = (c > 0 && sc != NULL);
+      if (cached) {
+	key_singcache(9, c, tp, sp, A_t, B_t, C_t, A_s, B_s, C_s, key);
+	cached = lookup_singcache(sc, key, 9, val);
+      }
+
+      if (!cached) {
+	for (q = 0; q < nq; ++q) {
+	  tx = xq[q];
+	  sx = xq[q + vnq];
+	  ty = yq[q];
+	  sy = yq[q + vnq];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
+	  Ay = 1.0 - ty;
+	  By = ty - sy;
+	  Cy = sy;
+
+	  x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
+	  x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
+	  x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
+	  y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
+	  y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
+	  y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+
+	  quad[q] = kernel(x, y, nt, ns, (void *) bem);
+	}
 
-	x[0] = A_t[0] * Ax + B_t[0] * Bx + C_t[0] * Cx;
-	x[1] = A_t[1] * Ax + B_t[1] * Bx + C_t[1] * Cx;
-	x[2] = A_t[2] * Ax + B_t[2] * Bx + C_t[2] * Cx;
-	y[0] = A_s[0] * Ay + B_s[0] * By + C_s[0] * Cy;
-	y[1] = A_s[1] * Ay + B_s[1] * By + C_s[1] * Cy;
-	y[2] = A_s[2] * Ay + B_s[2] * By + C_s[2] * Cy;
+	for (k = 0; k < 9; ++k) {
+	  val[k] = 0.0;
+	  ww = wq + k * vnq;
+	  for (q = 0; q < nq; ++q) {
+	    val[k] += ww[q] * quad[q];
+	  }
+	}
 
-	quad[q] = kernel(x, y, nt, ns, (void *) bem);
+	if (c > 0 && sc != NULL) {
+	  insert_singcache(sc, key, 9, val);
+	}
       }
 
       vl_c = tl1_c->vl;
@@ -3180,12 +2344,7 @@ assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 	      ii = ((ridx == NULL) ? i : ridx[i]);
 	      for (l = 0; l < 3; ++l) {
 		if (ii == tri_tp[l]) {
-		  res = base;
-
-		  ww = wq + (l + k * 3) * vnq;
-		  for (q = 0; q < nq; ++q) {
-		    res += ww[q] * quad[q];
-		  }
+		  res = base + val[l + k * 3];
 
 		  if (ntrans) {
 		    aa[j + i * ld] += CONJ(res * factor2);
@@ -3249,17 +2408,6 @@ assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   freemem(quad);
 }
 
-#ifdef USE_SIMD
-void
-assemble_ll_simd_far_bem3d(const uint * ridx, const uint * cidx,
-			   pcbem3d bem, bool ntrans, pamatrix N,
-			   kernel_simd_func3d kernel)
-{
-  //TODO implement nice 'far' version
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, kernel);
-}
-#endif
-
 void
 assemble_ll_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 		      bool ntrans, pamatrix N, kernel_func3d kernel)
@@ -3291,7 +2439,7 @@ assemble_ll_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
   xq = bem->sq->x_dist;
   yq = bem->sq->y_dist;
   nq = bem->sq->n_dist;
-  vnq = ROUNDUP(nq, VREAL);
+  vnq = ROUNDUP(nq, VREAL_PAD);
   wq = bem->sq->w_dist;
 
   quad = allocfield(bem->sq->nmax);
@@ -3552,12 +2700,13 @@ fill_row_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
   longindex ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
 
-  const real *A, *B, *C, *n;
+  const real *A, *B, *C, *n, *px, *py, *pz;
+  bool      pt;
   uint      t, tt, i, q;
   real      gt_fac, x[3], tx, sx, Ax, Bx, Cx;
   field     sum;
@@ -3569,213 +2718,37 @@ fill_row_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
     B = gr_x[gr_t[tt][1]];
     C = gr_x[gr_t[tt][2]];
     n = gr_n[tt];
+    pt = get_triquadpoints_bem3d(bem, tt, &px, &py, &pz);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
-
-	sum += ww[q] * kernel(x, Z[i], n, NULL, (void *) bem);
-      }
-
-      V->a[t + i * ld] = sum * gt_fac;
-    }
-  }
-}
-
-#ifdef USE_SIMD
-#ifdef USE_TRIQUADPOINTS
-void
-fill_row_simd_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
-		      pamatrix V, kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  uint      t, tt, i, j, q, remainder;
-  real      gt_fac;
-  field     sum;
-  real     *tri_tx, *tri_ty, *tri_tz;
-
-  vreal     x[3], z[3], nx[3];
-  vreal     w, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
-  for (t = 0; t < rows; ++t) {
-    tt = (idx == NULL ? t : idx[t]);
-    gt_fac = gr_g[tt] * bem->kernel_const;
-    n = gr_n[tt];
-    tri_tx = bem->sq->tri_x + tt * vnq;
-    tri_ty = bem->sq->tri_y + tt * vnq;
-    tri_tz = bem->sq->tri_z + tt * vnq;
-
-    for (j = 0; j < 3; ++j) {
-      nx[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < cols; ++i) {
-      sum = 0.0;
-
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	x[0] = vload(tri_tx + q);
-	x[1] = vload(tri_ty + q);
-	x[2] = vload(tri_tz + q);
-	w = vload(wq + q);
-
-	kernel(x, z, nx, NULL, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
-	}
-
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
-      }
-
-      sum =
-	((vreduce(sum_r) + base) * gt_fac) + (vreduce(sum_i) * gt_fac) * I;
-
-      V->a[t + i * ld] = sum;
-    }
-  }
-}
-#else
-void
-fill_row_simd_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
-		      pamatrix V, kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *xq = bem->sq->x_single;
-  real     *yq = bem->sq->y_single;
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  const uint *tri_t;
-  uint      t, tt, i, j, q, remainder;
-  real      gt_fac;
-  field     sum;
-
-  vreal     vt[3][3], ct[3], x[3], z[3], nx[3];
-  vreal     tx, sx, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  c_one = vset1(1.0);
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
-  for (t = 0; t < rows; ++t) {
-    tt = (idx == NULL ? t : idx[t]);
-    gt_fac = gr_g[tt] * bem->kernel_const;
-    tri_t = gr_t[tt];
-    n = gr_n[tt];
-
-    for (j = 0; j < 3; ++j) {
-      nx[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-      for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	vt[i][j] = vload1(gr_x[tri_t[j]] + i);
-      }
-    }
-
-    for (i = 0; i < cols; ++i) {
-
-      sum = 0.0;
-
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	tx = vload(xq + q);
-	sx = vload(yq + q);
-	w = vload(wq + q);
-
-	ct[0] = vsub(c_one, tx);
-	ct[1] = vsub(tx, sx);
-	ct[2] = sx;
-
-	for (j = 0; j < 3; ++j) {
-	  x[j] = vdot3(vt[j], ct);
+	if (pt) {
+	  x[0] = px[q];
+	  x[1] = py[q];
+	  x[2] = pz[q];
 	}
+	else {
+	  tx = xx[q];
+	  sx = yy[q];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
 
-	kernel(x, z, nx, NULL, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
+	  x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
+	  x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
+	  x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
 	}
 
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
+	sum += ww[q] * kernel(x, Z[i], n, NULL, (void *) bem);
       }
 
-      sum =
-	((vreduce(sum_r) + base) * gt_fac) + (vreduce(sum_i) * gt_fac) * I;
-
-      V->a[t + i * ld] = sum;
+      V->a[t + i * ld] = sum * gt_fac;
     }
   }
 }
-#endif
-#endif
 
 void
 fill_col_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
@@ -3791,230 +2764,55 @@ fill_col_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
   longindex ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
-  real     *ww = bem->sq->w_single + 3 * vnq;
-
-  const real *A, *B, *C, *n;
-  uint      s, ss, i, q;
-  real      gs_fac, x[3], tx, sx, Ax, Bx, Cx;
-  field     sum;
-
-  for (s = 0; s < rows; ++s) {
-    ss = (idx == NULL ? s : idx[s]);
-    gs_fac = gr_g[ss] * bem->kernel_const;
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
-    n = gr_n[ss];
-
-    for (i = 0; i < cols; ++i) {
-
-      sum = 0.0;
-
-      for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
-
-	sum += ww[q] * kernel(Z[i], x, NULL, n, (void *) bem);
-      }
-
-      V->a[s + i * ld] = sum * gs_fac;
-    }
-  }
-}
-
-#ifdef USE_SIMD
-#ifdef USE_TRIQUADPOINTS
-void
-fill_col_simd_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
-		      pamatrix V, kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  uint      s, ss, i, j, q, remainder;
-  real      gs_fac;
-  field     sum;
-  real     *tri_sx, *tri_sy, *tri_sz;
-
-  vreal     y[3], z[3], ny[3];
-  vreal     w, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
-  for (s = 0; s < rows; ++s) {
-    ss = (idx == NULL ? s : idx[s]);
-    gs_fac = gr_g[ss] * bem->kernel_const;
-    n = gr_n[ss];
-    tri_sx = bem->sq->tri_x + ss * vnq;
-    tri_sy = bem->sq->tri_y + ss * vnq;
-    tri_sz = bem->sq->tri_z + ss * vnq;
-
-    for (j = 0; j < 3; ++j) {
-      ny[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < cols; ++i) {
-      sum = 0.0;
-
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	y[0] = vload(tri_sx + q);
-	y[1] = vload(tri_sy + q);
-	y[2] = vload(tri_sz + q);
-	w = vload(wq + q);
-
-	kernel(z, y, NULL, ny, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
-	}
-
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
-      }
-
-      sum =
-	((vreduce(sum_r) + base) * gs_fac) + (vreduce(sum_i) * gs_fac) * I;
-
-      V->a[s + i * ld] = sum;
-    }
-  }
-}
-#else
-void
-fill_col_simd_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
-		      pamatrix V, kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *xq = bem->sq->x_single;
-  real     *yq = bem->sq->y_single;
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  const uint *tri_s;
-  uint      s, ss, i, j, q, remainder;
-  real      gs_fac;
-  field     sum;
-
-  vreal     vs[3][3], cs[3], y[3], z[3], ny[3];
-  vreal     ty, sy, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  c_one = vset1(1.0);
-
-  remainder = vnq - VREAL;
+  real     *yy = bem->sq->y_single;
+  real     *ww = bem->sq->w_single + 3 * vnq;
 
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
+  const real *A, *B, *C, *n, *px, *py, *pz;
+  bool      pt;
+  uint      s, ss, i, q;
+  real      gs_fac, x[3], tx, sx, Ax, Bx, Cx;
+  field     sum;
 
   for (s = 0; s < rows; ++s) {
     ss = (idx == NULL ? s : idx[s]);
     gs_fac = gr_g[ss] * bem->kernel_const;
-    tri_s = gr_t[ss];
+    A = gr_x[gr_t[ss][0]];
+    B = gr_x[gr_t[ss][1]];
+    C = gr_x[gr_t[ss][2]];
     n = gr_n[ss];
-
-    for (j = 0; j < 3; ++j) {
-      ny[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-      for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	vs[i][j] = vload1(gr_x[tri_s[j]] + i);
-      }
-    }
+    pt = get_triquadpoints_bem3d(bem, ss, &px, &py, &pz);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	ty = vload(xq + q);
-	sy = vload(yq + q);
-	w = vload(wq + q);
-
-	cs[0] = vsub(c_one, ty);
-	cs[1] = vsub(ty, sy);
-	cs[2] = sy;
-
-	for (j = 0; j < 3; ++j) {
-	  y[j] = vdot3(vs[j], cs);
+      for (q = 0; q < nq; ++q) {
+	if (pt) {
+	  x[0] = px[q];
+	  x[1] = py[q];
+	  x[2] = pz[q];
 	}
+	else {
+	  tx = xx[q];
+	  sx = yy[q];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
 
-	kernel(z, y, NULL, ny, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
+	  x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
+	  x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
+	  x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
 	}
 
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
+	sum += ww[q] * kernel(Z[i], x, NULL, n, (void *) bem);
       }
 
-      sum =
-	((vreduce(sum_r) + base) * gs_fac) + (vreduce(sum_i) * gs_fac) * I;
-
-      V->a[s + i * ld] = sum;
+      V->a[s + i * ld] = sum * gs_fac;
     }
   }
 }
-#endif
-#endif
 
 void
 fill_row_l_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
@@ -4031,7 +2829,7 @@ fill_row_l_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -4147,7 +2945,7 @@ fill_col_l_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -4263,12 +3061,13 @@ fill_dnz_row_c_bem3d(const uint * idx, const real(*Z)[3],
   longindex ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
 
-  const real *A, *B, *C, *n;
+  const real *A, *B, *C, *n, *px, *py, *pz;
+  bool      pt;
   uint      t, tt, i, q;
   real      gt_fac, x[3], tx, sx, Ax, Bx, Cx;
   field     sum;
@@ -4280,363 +3079,42 @@ fill_dnz_row_c_bem3d(const uint * idx, const real(*Z)[3],
     B = gr_x[gr_t[tt][1]];
     C = gr_x[gr_t[tt][2]];
     n = gr_n[tt];
+    pt = get_triquadpoints_bem3d(bem, tt, &px, &py, &pz);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
       for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
-
-	sum += ww[q] * kernel(x, Z[i], n, N[i], (void *) bem);
-      }
-
-      V->a[t + i * ld] = sum * gt_fac;
-    }
-  }
-}
-
-#ifdef USE_SIMD
-#ifdef USE_TRIQUADPOINTS
-void
-fill_dnz_row_simd_c_bem3d(const uint * idx, const real(*Z)[3],
-			  const real(*N)[3], pcbem3d bem, pamatrix V,
-			  kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  uint      t, tt, i, j, q, remainder;
-  real      gt_fac;
-  field     sum;
-  real     *tri_tx, *tri_ty, *tri_tz;
-
-  vreal     x[3], z[3], nx[3], nz[3];
-  vreal     w, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
-  for (t = 0; t < rows; ++t) {
-    tt = (idx == NULL ? t : idx[t]);
-    gt_fac = gr_g[tt] * bem->kernel_const;
-    n = gr_n[tt];
-    tri_tx = bem->sq->tri_x + tt * vnq;
-    tri_ty = bem->sq->tri_y + tt * vnq;
-    tri_tz = bem->sq->tri_z + tt * vnq;
-
-    for (j = 0; j < 3; ++j) {
-      nx[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < cols; ++i) {
-      sum = 0.0;
-
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-	nz[j] = vset1(N[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	x[0] = vload(tri_tx + q);
-	x[1] = vload(tri_ty + q);
-	x[2] = vload(tri_tz + q);
-	w = vload(wq + q);
-
-	kernel(x, z, nx, nz, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
-	}
-
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
-      }
-
-      sum =
-	((vreduce(sum_r) + base) * gt_fac) + (vreduce(sum_i) * gt_fac) * I;
-
-      V->a[t + i * ld] = sum;
-    }
-  }
-}
-#else
-void
-fill_dnz_row_simd_c_bem3d(const uint * idx, const real(*Z)[3],
-			  const real(*N)[3], pcbem3d bem, pamatrix V,
-			  kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *xq = bem->sq->x_single;
-  real     *yq = bem->sq->y_single;
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  const uint *tri_t;
-  uint      t, tt, i, j, q, remainder;
-  real      gt_fac;
-  field     sum;
-
-  vreal     vt[3][3], ct[3], x[3], z[3], nx[3], nz[3];
-  vreal     tx, sx, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  c_one = vset1(1.0);
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
-  for (t = 0; t < rows; ++t) {
-    tt = (idx == NULL ? t : idx[t]);
-    gt_fac = gr_g[tt] * bem->kernel_const;
-    tri_t = gr_t[tt];
-    n = gr_n[tt];
-
-    for (j = 0; j < 3; ++j) {
-      nx[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-      for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	vt[i][j] = vload1(gr_x[tri_t[j]] + i);
-      }
-    }
-
-    for (i = 0; i < cols; ++i) {
-
-      sum = 0.0;
-
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-	nz[j] = vset1(N[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	tx = vload(xq + q);
-	sx = vload(yq + q);
-	w = vload(wq + q);
-
-	ct[0] = vsub(c_one, tx);
-	ct[1] = vsub(tx, sx);
-	ct[2] = sx;
-
-	for (j = 0; j < 3; ++j) {
-	  x[j] = vdot3(vt[j], ct);
-	}
-
-	kernel(x, z, nx, nz, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
+	if (pt) {
+	  x[0] = px[q];
+	  x[1] = py[q];
+	  x[2] = pz[q];
 	}
+	else {
+	  tx = xx[q];
+	  sx = yy[q];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
 
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
-      }
-
-      sum =
-	((vreduce(sum_r) + base) * gt_fac) + (vreduce(sum_i) * gt_fac) * I;
-
-      V->a[t + i * ld] = sum;
-    }
-  }
-}
-#endif
-#endif
-
-void
-fill_dnz_col_c_bem3d(const uint * idx, const real(*Z)[3],
-		     const real(*N)[3], pcbem3d bem, pamatrix V,
-		     kernel_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
-  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *xx = bem->sq->x_single;
-  real     *yy = bem->sq->y_single;
-  real     *ww = bem->sq->w_single + 3 * vnq;
-
-  const real *A, *B, *C, *n;
-  uint      s, ss, i, q;
-  real      gs_fac, x[3], tx, sx, Ax, Bx, Cx;
-  field     sum;
-
-  for (s = 0; s < rows; ++s) {
-    ss = (idx == NULL ? s : idx[s]);
-    gs_fac = gr_g[ss] * bem->kernel_const;
-    A = gr_x[gr_t[ss][0]];
-    B = gr_x[gr_t[ss][1]];
-    C = gr_x[gr_t[ss][2]];
-    n = gr_n[ss];
-
-    for (i = 0; i < cols; ++i) {
-
-      sum = 0.0;
-
-      for (q = 0; q < nq; ++q) {
-	tx = xx[q];
-	sx = yy[q];
-	Ax = 1.0 - tx;
-	Bx = tx - sx;
-	Cx = sx;
-
-	x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-	x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-	x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
-
-	sum += ww[q] * kernel(Z[i], x, N[i], n, (void *) bem);
-      }
-
-      V->a[s + i * ld] = sum * gs_fac;
-    }
-  }
-}
-
-#ifdef USE_SIMD
-#ifdef USE_TRIQUADPOINTS
-void
-fill_dnz_col_simd_c_bem3d(const uint * idx, const real(*Z)[3],
-			  const real(*N)[3], pcbem3d bem, pamatrix V,
-			  kernel_simd_func3d kernel)
-{
-  pcsurface3d gr = bem->gr;
-  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
-  const preal gr_g = (const preal) gr->g;
-  uint      rows = V->rows;
-  uint      cols = V->cols;
-  longindex ld = V->ld;
-
-  uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
-
-  const real *n;
-  uint      s, ss, i, j, q, remainder;
-  real      gs_fac;
-  field     sum;
-  real     *tri_sx, *tri_sy, *tri_sz;
-
-  vreal     y[3], z[3], ny[3], nz[3];
-  vreal     w, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
-  for (s = 0; s < rows; ++s) {
-    ss = (idx == NULL ? s : idx[s]);
-    gs_fac = gr_g[ss] * bem->kernel_const;
-    n = gr_n[ss];
-    tri_sx = bem->sq->tri_x + ss * vnq;
-    tri_sy = bem->sq->tri_y + ss * vnq;
-    tri_sz = bem->sq->tri_z + ss * vnq;
-
-    for (j = 0; j < 3; ++j) {
-      ny[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < cols; ++i) {
-      sum = 0.0;
-
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-	nz[j] = vset1(N[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	y[0] = vload(tri_sx + q);
-	y[1] = vload(tri_sy + q);
-	y[2] = vload(tri_sz + q);
-	w = vload(wq + q);
-
-	kernel(z, y, nz, ny, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
+	  x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
+	  x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
+	  x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
 	}
 
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
+	sum += ww[q] * kernel(x, Z[i], n, N[i], (void *) bem);
       }
 
-      sum =
-	((vreduce(sum_r) + base) * gs_fac) + (vreduce(sum_i) * gs_fac) * I;
-
-      V->a[s + i * ld] = sum;
+      V->a[t + i * ld] = sum * gt_fac;
     }
   }
 }
-#else
+
 void
-fill_dnz_col_simd_c_bem3d(const uint * idx, const real(*Z)[3],
-			  const real(*N)[3], pcbem3d bem, pamatrix V,
-			  kernel_simd_func3d kernel)
+fill_dnz_col_c_bem3d(const uint * idx, const real(*Z)[3],
+		     const real(*N)[3], pcbem3d bem, pamatrix V,
+		     kernel_func3d kernel)
 {
   pcsurface3d gr = bem->gr;
   const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
@@ -4648,93 +3126,55 @@ fill_dnz_col_simd_c_bem3d(const uint * idx, const real(*Z)[3],
   longindex ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
-  real     *xq = bem->sq->x_single;
-  real     *yq = bem->sq->y_single;
-  real     *wq = bem->sq->w_single + 3 * vnq;
-  real      base = bem->sq->base_single;
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
+  real     *xx = bem->sq->x_single;
+  real     *yy = bem->sq->y_single;
+  real     *ww = bem->sq->w_single + 3 * vnq;
 
-  const real *n;
-  const uint *tri_s;
-  uint      s, ss, i, j, q, remainder;
-  real      gs_fac;
+  const real *A, *B, *C, *n, *px, *py, *pz;
+  bool      pt;
+  uint      s, ss, i, q;
+  real      gs_fac, x[3], tx, sx, Ax, Bx, Cx;
   field     sum;
 
-  vreal     vs[3][3], cs[3], y[3], z[3], ny[3], nz[3];
-  vreal     ty, sy, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
-
-  c_one = vset1(1.0);
-
-  remainder = vnq - VREAL;
-
-  if (nq % VREAL) {
-    for (q = 0; q < VREAL; ++q) {
-      vcount[q] = q;
-    }
-  }
-
   for (s = 0; s < rows; ++s) {
     ss = (idx == NULL ? s : idx[s]);
     gs_fac = gr_g[ss] * bem->kernel_const;
-    tri_s = gr_t[ss];
+    A = gr_x[gr_t[ss][0]];
+    B = gr_x[gr_t[ss][1]];
+    C = gr_x[gr_t[ss][2]];
     n = gr_n[ss];
-
-    for (j = 0; j < 3; ++j) {
-      ny[j] = vset1(n[j]);
-    }
-
-    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
-      for (j = 0; j < 3; ++j) {	// vertex A, B, C
-	vs[i][j] = vload1(gr_x[tri_s[j]] + i);
-      }
-    }
+    pt = get_triquadpoints_bem3d(bem, ss, &px, &py, &pz);
 
     for (i = 0; i < cols; ++i) {
 
       sum = 0.0;
 
-      sum_r = vsetzero();
-      sum_i = vsetzero();
-
-      for (j = 0; j < 3; ++j) {
-	z[j] = vset1(Z[i][j]);
-	nz[j] = vset1(N[i][j]);
-      }
-
-      for (q = 0; q < vnq; q += VREAL) {
-	ty = vload(xq + q);
-	sy = vload(yq + q);
-	w = vload(wq + q);
-
-	cs[0] = vsub(c_one, ty);
-	cs[1] = vsub(ty, sy);
-	cs[2] = sy;
-
-	for (j = 0; j < 3; ++j) {
-	  y[j] = vdot3(vs[j], cs);
+      for (q = 0; q < nq; ++q) {
+	if (pt) {
+	  x[0] = px[q];
+	  x[1] = py[q];
+	  x[2] = pz[q];
 	}
+	else {
+	  tx = xx[q];
+	  sx = yy[q];
+	  Ax = 1.0 - tx;
+	  Bx = tx - sx;
+	  Cx = sx;
 
-	kernel(z, y, nz, ny, (void *) bem, &eval_r, &eval_i);
-
-	if (nq % VREAL && q >= remainder) {
-	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
-	  eval_r = vand(cmp, eval_r);
-	  eval_i = vand(cmp, eval_i);
+	  x[0] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
+	  x[1] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
+	  x[2] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
 	}
 
-	sum_r = vfmadd(w, eval_r, sum_r);
-	sum_i = vfmadd(w, eval_i, sum_i);
+	sum += ww[q] * kernel(Z[i], x, N[i], n, (void *) bem);
       }
 
-      sum =
-	((vreduce(sum_r) + base) * gs_fac) + (vreduce(sum_i) * gs_fac) * I;
-
-      V->a[s + i * ld] = sum;
+      V->a[s + i * ld] = sum * gs_fac;
     }
   }
 }
-#endif
-#endif
 
 void
 fill_dnz_row_l_bem3d(const uint * idx, const real(*Z)[3],
@@ -4752,7 +3192,7 @@ fill_dnz_row_l_bem3d(const uint * idx, const real(*Z)[3],
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -4869,7 +3309,7 @@ fill_dnz_col_l_bem3d(const uint * idx, const real(*Z)[3],
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -5590,6 +4030,57 @@ assemble_row_greencluster3d(pcbem3d bem, pgreencluster3d gc)
   freemem(N);
 }
 
+/* Return the Green cluster number <tt>name</tt> from the table
+ * <tt>gcn</tt>, constructing it with <tt>assemble</tt> on first use.
+ * <tt>gcs</tt> holds the construction state of each entry: bit 0 is set
+ * once a thread has claimed the entry, bit 1 once it is ready.
+ * Threads requesting different clusters never wait for each other. */
+static pgreencluster3d
+get_greencluster3d(pcbem3d bem, pccluster t, uint name,
+		   pgreencluster3d * gcn, uint * gcs,
+		   void (*assemble) (pcbem3d bem, pgreencluster3d gc))
+{
+  pgreencluster3d gc;
+#ifdef USE_OPENMP
+  uint      state;
+
+#pragma omp atomic read seq_cst
+  state = gcs[name];
+
+  if (!(state & 2)) {
+#pragma omp atomic capture seq_cst
+    {
+      state = gcs[name];
+      gcs[name] |= 1;
+    }
+
+    if (state == 0) {
+      gc = new_greencluster3d(t);
+      assemble(bem, gc);
+      gcn[name] = gc;
+
+#pragma omp atomic update seq_cst
+      gcs[name] |= 2;
+    }
+    else {
+      while (!(state & 2)) {
+#pragma omp atomic read seq_cst
+	state = gcs[name];
+      }
+    }
+  }
+#else
+  if (gcs[name] == 0) {
+    gc = new_greencluster3d(t);
+    assemble(bem, gc);
+    gcn[name] = gc;
+    gcs[name] = 3;
+  }
+#endif
+
+  return gcn[name];
+}
+
 static void
 assemble_bem3d_greenhybrid_row_rkmatrix(pccluster rc, uint rname,
 					pccluster cc, uint cname, pcbem3d bem,
@@ -5608,17 +4099,8 @@ assemble_bem3d_greenhybrid_row_rkmatrix(pccluster rc, uint rname,
 
   (void) cname;
 
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    grc = par->grcn[rname];
-
-    if (grc == NULL) {
-      grc = par->grcn[rname] = new_greencluster3d(rc);
-      assemble_row_greencluster3d(bem, grc);
-    }
-  }
+  grc = get_greencluster3d(bem, rc, rname, par->grcn, par->grcs,
+			  assemble_row_greencluster3d);
 
   V = grc->V;
   rank = V->cols;
@@ -5713,17 +4195,8 @@ assemble_bem3d_greenhybrid_col_rkmatrix(pccluster rc, uint rname,
 
   (void) rname;
 
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    gcc = par->gccn[cname];
-
-    if (gcc == NULL) {
-      gcc = par->gccn[cname] = new_greencluster3d(cc);
-      assemble_col_greencluster3d(bem, gcc);
-    }
-  }
+  gcc = get_greencluster3d(bem, cc, cname, par->gccn, par->gccs,
+			  assemble_col_greencluster3d);
 
   V = gcc->V;
   rank = V->cols;
@@ -5754,29 +4227,11 @@ assemble_bem3d_greenhybrid_mixed_rkmatrix(pccluster rc, uint rname,
   uint     *xihatV, *xihatW;
   uint      rankV, rankW;
 
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    grc = par->grcn[rname];
-
-    if (grc == NULL) {
-      grc = par->grcn[rname] = new_greencluster3d(rc);
-      assemble_row_greencluster3d(bem, grc);
-    }
-  }
-
-#ifdef USE_OPENMP
-#pragma omp critical(greenhybrid)
-#endif
-  {
-    gcc = par->gccn[cname];
+  grc = get_greencluster3d(bem, rc, rname, par->grcn, par->grcs,
+			  assemble_row_greencluster3d);
 
-    if (gcc == NULL) {
-      gcc = par->gccn[cname] = new_greencluster3d(cc);
-      assemble_col_greencluster3d(bem, gcc);
-    }
-  }
+  gcc = get_greencluster3d(bem, cc, cname, par->gccn, par->gccs,
+			  assemble_col_greencluster3d);
 
   rankV = grc->V->cols;
   rankW = gcc->V->cols;
@@ -7625,7 +6080,7 @@ assemble_bem3d_lagrange_c_amatrix(const uint * idx, pcrealavector px,
   uint      rows = V->rows;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -7692,7 +6147,7 @@ assemble_bem3d_lagrange_wave_c_amatrix(const uint * idx, pcrealavector px,
   uint      rows = V->rows;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -7768,7 +6223,7 @@ assemble_bem3d_lagrange_l_amatrix(const uint * idx, pcrealavector px,
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -7897,7 +6352,7 @@ assemble_bem3d_lagrange_wave_l_amatrix(const uint * idx, pcrealavector px,
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -8034,7 +6489,7 @@ assemble_bem3d_dn_lagrange_c_amatrix(const uint * idx, pcrealavector px,
   longindex ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -8112,7 +6567,7 @@ assemble_bem3d_dn_lagrange_wave_c_amatrix(const uint * idx,
   longindex ld = V->ld;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -8211,7 +6666,7 @@ assemble_bem3d_dn_lagrange_l_amatrix(const uint * idx, pcrealavector px,
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -8348,7 +6803,7 @@ assemble_bem3d_dn_lagrange_wave_l_amatrix(const uint * idx,
   field    *aa = V->a;
   longindex ld = V->ld;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -8585,7 +7040,7 @@ integrate_bem3d_c_avector(pbem3d bem, boundary_func3d f, pavector w,
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   const real *gr_g = gr->g;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -8639,7 +7094,7 @@ integrate_bem3d_l_avector(pbem3d bem, boundary_func3d f, pavector w,
   const uint triangles = gr->triangles;
   const uint vertices = gr->vertices;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -8712,7 +7167,7 @@ normL2_bem3d(pbem3d bem, boundary_func3d rhs, void *data)
   real     *xq = bem->sq->x_single;
   real     *yq = bem->sq->y_single;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *wq = bem->sq->w_single + 3 * vnq;
 
   const real *A, *B, *C, *N;
@@ -8784,7 +7239,7 @@ normL2diff_c_bem3d(pbem3d bem, pavector x, boundary_func3d rhs, void *data)
   real     *xq = bem->sq->x_single;
   real     *yq = bem->sq->y_single;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *wq = bem->sq->w_single + 3 * vnq;
   field    *xv = x->v;
 
@@ -8832,7 +7287,7 @@ projectL2_bem3d_c_avector(pbem3d bem, boundary_func3d f, pavector w,
   const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
   const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -8917,7 +7372,7 @@ normL2_l_bem3d(pbem3d bem, pavector x)
   real     *xq = bem->sq->x_single;
   real     *yq = bem->sq->y_single;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *wq = bem->sq->w_single + 3 * vnq;
   field    *xv = x->v;
 
@@ -8962,7 +7417,7 @@ normL2diff_l_bem3d(pbem3d bem, pavector x, boundary_func3d rhs, void *data)
   real     *xq = bem->sq->x_single;
   real     *yq = bem->sq->y_single;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *wq = bem->sq->w_single + 3 * vnq;
   field    *xv = x->v;
 
@@ -9017,7 +7472,7 @@ projectL2_bem3d_l_avector(pbem3d bem, boundary_func3d f, pavector w,
   const uint triangles = gr->triangles;
   const uint vertices = gr->vertices;
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -9385,15 +7840,18 @@ setup_hmatrix_aprx_greenhybrid_row_bem3d(pbem3d bem, pccluster rc,
       }
     }
     freemem(par->grcn);
+    freemem(par->grcs);
   }
 
   n = rc->desc;
 
   par->grcn = (pgreencluster3d *) allocmem((size_t) n *
 					   sizeof(pgreencluster3d));
+  par->grcs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->grcn[i] = NULL;
+    par->grcs[i] = 0;
   }
 
   par->grcnn = n;
@@ -9444,15 +7902,18 @@ setup_hmatrix_aprx_greenhybrid_col_bem3d(pbem3d bem, pccluster rc,
       }
     }
     freemem(par->gccn);
+    freemem(par->gccs);
   }
 
   n = cc->desc;
 
   par->gccn = (pgreencluster3d *) allocmem((size_t) n *
 					   sizeof(pgreencluster3d));
+  par->gccs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->gccn[i] = NULL;
+    par->gccs[i] = 0;
   }
 
   par->gccnn = n;
@@ -9504,15 +7965,18 @@ setup_hmatrix_aprx_greenhybrid_mixed_bem3d(pbem3d bem, pccluster rc,
       }
     }
     freemem(par->grcn);
+    freemem(par->grcs);
   }
 
   n = rc->desc;
 
   par->grcn = (pgreencluster3d *) allocmem((size_t) n *
 					   sizeof(pgreencluster3d));
+  par->grcs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->grcn[i] = NULL;
+    par->grcs[i] = 0;
   }
 
   par->grcnn = n;
@@ -9526,15 +7990,18 @@ setup_hmatrix_aprx_greenhybrid_mixed_bem3d(pbem3d bem, pccluster rc,
       }
     }
     freemem(par->gccn);
+    freemem(par->gccs);
   }
 
   n = cc->desc;
 
   par->gccn = (pgreencluster3d *) allocmem((size_t) n *
 					   sizeof(pgreencluster3d));
+  par->gccs = allocuint(n);
 
   for (i = 0; i < n; ++i) {
     par->gccn[i] = NULL;
+    par->gccs[i] = 0;
   }
 
   par->gccnn = n;
@@ -10013,6 +8480,282 @@ assemble_bem3d_amatrix(pbem3d bem, pamatrix G)
   freemem(idx);
 }
 
+/* ------------------------------------------------------------
+ Task-based assembly of leaves
+ ------------------------------------------------------------ */
+
+typedef struct _leafdata leafdata;
+typedef leafdata *pleafdata;
+
+struct _leafdata {
+  pbem3d    bem;
+  ptaskpool tp;
+
+  uint     *rnamen;		/* row cluster names of the blocks */
+  uint     *cnamen;		/* column cluster names of the blocks */
+
+  bool      near;		/* collect inadmissible leaves */
+  bool      far;		/* collect admissible leaves */
+
+  void      (*hleaf) (pcblock b, uint bname, uint rname, uint cname,
+			  uint pardepth, void *data);
+  void      (*h2leaf) (ph2matrix G, uint bname, uint rname, uint cname,
+			   uint pardepth, void *data);
+  void     *data;		/* passed to hleaf and h2leaf */
+};
+
+/* Estimated cost of a leaf, singular quadrature for touching clusters
+ * is considerably more expensive than regular quadrature */
+static    real
+leafcost_bem3d(pcbem3d bem, pccluster rc, pccluster cc, bool near, uint k)
+{
+  psingquad2d sq = bem->sq;
+  real      nq = (sq ? sq->n_dist : 1);
+  real      cost;
+
+  if (near) {
+    cost = (real) rc->size * cc->size * nq;
+    if (sq && getdist_2_cluster(rc, cc) <= 0.0)
+      cost += (real) UINT_MIN(rc->size, cc->size)
+	* (sq->n_id + sq->n_edge + sq->n_vert);
+  }
+  else {
+    cost = (real) (rc->size + cc->size) * k * nq;
+  }
+
+  return cost;
+}
+
+static void
+collect_bem3d_leaf_hmatrix(pcblock b, uint bname, uint rname, uint cname,
+			   uint pardepth, void *data)
+{
+  pleafdata ld = (pleafdata) data;
+  pbem3d    bem = ld->bem;
+  paprxbem3d aprx = bem->aprx;
+  phmatrix  G = bem->par->hn[bname];
+  uint      k;
+
+  (void) b;
+  (void) pardepth;
+
+  ld->rnamen[bname] = rname;
+  ld->cnamen[bname] = cname;
+
+  if (G->r && ld->far) {
+    k = (aprx->k_inter > 0 ? aprx->k_inter :
+	 aprx->k_green > 0 ? aprx->k_green : 16);
+    add_taskpool(ld->tp, bname, leafcost_bem3d(bem, G->rc, G->cc, false, k),
+		 TASKPOOL_NOGROUP);
+  }
+  else if (G->f && ld->near) {
+    add_taskpool(ld->tp, bname, leafcost_bem3d(bem, G->rc, G->cc, true, 0),
+		 TASKPOOL_NOGROUP);
+  }
+}
+
+static void
+work_bem3d_leaf_hmatrix(uint bname, void *data)
+{
+  pleafdata ld = (pleafdata) data;
+
+  ld->hleaf(NULL, bname, ld->rnamen[bname], ld->cnamen[bname], 0, ld->data);
+}
+
+/* Assemble the leaves of an hmatrix by decreasing estimated cost with
+ * work stealing, par->hn has to be set up, hleaf is called with data */
+static void
+assemble_leaves_data_bem3d_hmatrix(pbem3d bem, pblock b, bool near, bool far,
+				   void (*hleaf) (pcblock b, uint bname,
+						  uint rname, uint cname,
+						  uint pardepth, void *data),
+				   void *data)
+{
+  leafdata  ld;
+
+  if (bem->tasks == NULL)
+    bem->tasks = new_taskpool();
+  clear_taskpool(bem->tasks);
+
+  ld.bem = bem;
+  ld.tp = bem->tasks;
+  ld.rnamen = allocuint(b->desc);
+  ld.cnamen = allocuint(b->desc);
+  ld.near = near;
+  ld.far = far;
+  ld.hleaf = hleaf;
+  ld.h2leaf = NULL;
+  ld.data = data;
+
+  iterate_block(b, 0, 0, 0, collect_bem3d_leaf_hmatrix, NULL, &ld);
+
+  run_taskpool(bem->tasks, work_bem3d_leaf_hmatrix, &ld);
+
+  freemem(ld.cnamen);
+  freemem(ld.rnamen);
+}
+
+static void
+assemble_leaves_bem3d_hmatrix(pbem3d bem, pblock b, bool near, bool far,
+			      void (*hleaf) (pcblock b, uint bname,
+					     uint rname, uint cname,
+					     uint pardepth, void *data))
+{
+  assemble_leaves_data_bem3d_hmatrix(bem, b, near, far, hleaf, bem);
+}
+
+static void
+collect_bem3d_leaf_h2matrix(ph2matrix G, uint bname, uint rname, uint cname,
+			    uint pardepth, void *data)
+{
+  pleafdata ld = (pleafdata) data;
+  pbem3d    bem = ld->bem;
+  pccluster rc = G->rb->t;
+  pccluster cc = G->cb->t;
+
+  (void) pardepth;
+
+  ld->rnamen[bname] = rname;
+  ld->cnamen[bname] = cname;
+
+  if (G->u && ld->far) {
+    add_taskpool(ld->tp, bname, (real) G->rb->k * G->cb->k,
+		 TASKPOOL_NOGROUP);
+  }
+  else if (G->f && ld->near) {
+    add_taskpool(ld->tp, bname, leafcost_bem3d(bem, rc, cc, true, 0),
+		 TASKPOOL_NOGROUP);
+  }
+}
+
+static void
+work_bem3d_leaf_h2matrix(uint bname, void *data)
+{
+  pleafdata ld = (pleafdata) data;
+
+  ld->h2leaf(ld->bem->par->h2n[bname], bname, ld->rnamen[bname],
+	     ld->cnamen[bname], 0, ld->data);
+}
+
+/* Assemble the leaves of an h2matrix by decreasing estimated cost with
+ * work stealing, par->h2n has to be set up, h2leaf is called with data */
+static void
+assemble_leaves_data_bem3d_h2matrix(pbem3d bem, ph2matrix G, bool near,
+				    bool far,
+				    void (*h2leaf) (ph2matrix G, uint bname,
+						    uint rname, uint cname,
+						    uint pardepth, void *data),
+				    void *data)
+{
+  leafdata  ld;
+
+  if (bem->tasks == NULL)
+    bem->tasks = new_taskpool();
+  clear_taskpool(bem->tasks);
+
+  ld.bem = bem;
+  ld.tp = bem->tasks;
+  ld.rnamen = allocuint(G->desc);
+  ld.cnamen = allocuint(G->desc);
+  ld.near = near;
+  ld.far = far;
+  ld.hleaf = NULL;
+  ld.h2leaf = h2leaf;
+  ld.data = data;
+
+  iterate_h2matrix(G, 0, 0, 0, 0, collect_bem3d_leaf_h2matrix, NULL, &ld);
+
+  run_taskpool(bem->tasks, work_bem3d_leaf_h2matrix, &ld);
+
+  freemem(ld.cnamen);
+  freemem(ld.rnamen);
+}
+
+static void
+assemble_leaves_bem3d_h2matrix(pbem3d bem, ph2matrix G, bool near, bool far,
+			       void (*h2leaf) (ph2matrix G, uint bname,
+					       uint rname, uint cname,
+					       uint pardepth, void *data))
+{
+  assemble_leaves_data_bem3d_h2matrix(bem, G, near, far, h2leaf, bem);
+}
+
+/* ------------------------------------------------------------
+ Fused assembly of several operators
+ ------------------------------------------------------------ */
+
+typedef struct _fuseddata fuseddata;
+typedef fuseddata *pfuseddata;
+
+struct _fuseddata {
+  uint      m;
+  pbem3d   *bem;
+  uint      l0;			/* first operator that is present */
+  nearfield_fused_func3d nearfield;
+};
+
+static void
+assemble_bem3d_fused_block_hmatrix(pcblock b, uint bname, uint rname,
+				   uint cname, uint pardepth, void *data)
+{
+  pfuseddata fd = (pfuseddata) data;
+  pbem3d   *bem = fd->bem;
+  phmatrix  G = bem[fd->l0]->par->hn[bname];
+  pamatrix *N;
+  uint      l;
+
+  (void) b;
+  (void) pardepth;
+
+  if (G->r) {
+    for (l = 0; l < fd->m; l++) {
+      if (bem[l]) {
+	G = bem[l]->par->hn[bname];
+	bem[l]->farfield_rk(G->rc, rname, G->cc, cname, bem[l], G->r);
+	if (bem[l]->aprx->recomp == true) {
+	  trunc_rkmatrix(0, bem[l]->aprx->accur_recomp, G->r);
+	}
+      }
+    }
+  }
+  else if (G->f) {
+    N = (pamatrix *) allocmem(sizeof(pamatrix) * fd->m);
+    for (l = 0; l < fd->m; l++) {
+      N[l] = (bem[l] ? bem[l]->par->hn[bname]->f : NULL);
+    }
+    fd->nearfield(G->rc->idx, G->cc->idx, bem, false, fd->m, N);
+    freemem(N);
+  }
+}
+
+static void
+assemble_bem3d_fused_block_h2matrix(ph2matrix G, uint bname, uint rname,
+				    uint cname, uint pardepth, void *data)
+{
+  pfuseddata fd = (pfuseddata) data;
+  pbem3d   *bem = fd->bem;
+  pamatrix *N;
+  uint      l;
+
+  (void) pardepth;
+
+  if (G->u) {
+    for (l = 0; l < fd->m; l++) {
+      if (bem[l]) {
+	bem[l]->farfield_u(rname, cname, bname, bem[l]);
+      }
+    }
+  }
+  else if (G->f) {
+    N = (pamatrix *) allocmem(sizeof(pamatrix) * fd->m);
+    for (l = 0; l < fd->m; l++) {
+      N[l] = (bem[l] ? bem[l]->par->h2n[bname]->f : NULL);
+    }
+    fd->nearfield(G->rb->t->idx, G->cb->t->idx, bem, false, fd->m, N);
+    freemem(N);
+  }
+}
+
 /* ------------------------------------------------------------
  Fill hmatrix
  ------------------------------------------------------------ */
@@ -10118,13 +8861,48 @@ assemble_bem3d_hmatrix(pbem3d bem, pblock b, phmatrix G)
   pparbem3d par = bem->par;
   par->hn = enumerate_hmatrix(b, G);
 
-  iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
-		      assemble_bem3d_block_hmatrix, bem);
+  assemble_leaves_bem3d_hmatrix(bem, b, true, true,
+				assemble_bem3d_block_hmatrix);
 
   freemem(par->hn);
   par->hn = NULL;
 }
 
+void
+assemble_bem3d_fused_hmatrix(uint m, pbem3d * bem, pblock b, phmatrix * G,
+			     nearfield_fused_func3d nearfield)
+{
+  fuseddata fd;
+  uint      l;
+
+  for (l = 0; l < m && bem[l] == NULL; l++);
+  if (l == m) {
+    return;
+  }
+
+  fd.m = m;
+  fd.bem = bem;
+  fd.l0 = l;
+  fd.nearfield = nearfield;
+
+  for (; l < m; l++) {
+    assert((bem[l] == NULL) == (G[l] == NULL));
+    if (bem[l]) {
+      bem[l]->par->hn = enumerate_hmatrix(b, G[l]);
+    }
+  }
+
+  assemble_leaves_data_bem3d_hmatrix(bem[fd.l0], b, true, true,
+				     assemble_bem3d_fused_block_hmatrix, &fd);
+
+  for (l = 0; l < m; l++) {
+    if (bem[l]) {
+      freemem(bem[l]->par->hn);
+      bem[l]->par->hn = NULL;
+    }
+  }
+}
+
 void
 assemblecoarsen_bem3d_hmatrix(pbem3d bem, pblock b, phmatrix G)
 {
@@ -10144,8 +8922,8 @@ assemble_bem3d_nearfield_hmatrix(pbem3d bem, pblock b, phmatrix G)
   pparbem3d par = bem->par;
   par->hn = enumerate_hmatrix(b, G);
 
-  iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
-		      assemble_bem3d_nearfield_block_hmatrix, bem);
+  assemble_leaves_bem3d_hmatrix(bem, b, true, false,
+				assemble_bem3d_nearfield_block_hmatrix);
 
   freemem(par->hn);
   par->hn = NULL;
@@ -10157,13 +8935,21 @@ assemble_bem3d_farfield_hmatrix(pbem3d bem, pblock b, phmatrix G)
   pparbem3d par = bem->par;
   par->hn = enumerate_hmatrix(b, G);
 
-  iterate_byrow_block(b, 0, 0, 0, max_pardepth, NULL,
-		      assemble_bem3d_farfield_block_hmatrix, bem);
+  assemble_leaves_bem3d_hmatrix(bem, b, false, true,
+				assemble_bem3d_farfield_block_hmatrix);
 
   freemem(par->hn);
   par->hn = NULL;
 }
 
+void
+assemble_bem3d_matrixfree_hmatrix(pbem3d bem, pblock b, phmatrix G)
+{
+  matrixfree_nearfield_hmatrix(G, (matrixentry_t) bem->nearfield, bem);
+
+  assemble_bem3d_farfield_hmatrix(bem, b, G);
+}
+
 /* ------------------------------------------------------------
  Fill h2-matrix
  ------------------------------------------------------------ */
@@ -10314,20 +9100,56 @@ assemble_bem3d_h2matrix(pbem3d bem, ph2matrix G)
 {
   bem->par->h2n = enumerate_h2matrix(G);
 
-  iterate_h2matrix(G, 0, 0, 0, max_pardepth, NULL,
-		   assemble_bem3d_block_h2matrix, bem);
+  assemble_leaves_bem3d_h2matrix(bem, G, true, true,
+				 assemble_bem3d_block_h2matrix);
 
   freemem(bem->par->h2n);
   bem->par->h2n = NULL;
 }
 
+void
+assemble_bem3d_fused_h2matrix(uint m, pbem3d * bem, ph2matrix * G,
+			      nearfield_fused_func3d nearfield)
+{
+  fuseddata fd;
+  uint      l;
+
+  for (l = 0; l < m && bem[l] == NULL; l++);
+  if (l == m) {
+    return;
+  }
+
+  fd.m = m;
+  fd.bem = bem;
+  fd.l0 = l;
+  fd.nearfield = nearfield;
+
+  for (; l < m; l++) {
+    assert((bem[l] == NULL) == (G[l] == NULL));
+    if (bem[l]) {
+      bem[l]->par->h2n = enumerate_h2matrix(G[l]);
+    }
+  }
+
+  assemble_leaves_data_bem3d_h2matrix(bem[fd.l0], G[fd.l0], true, true,
+				      assemble_bem3d_fused_block_h2matrix,
+				      &fd);
+
+  for (l = 0; l < m; l++) {
+    if (bem[l]) {
+      freemem(bem[l]->par->h2n);
+      bem[l]->par->h2n = NULL;
+    }
+  }
+}
+
 void
 assemble_bem3d_nearfield_h2matrix(pbem3d bem, ph2matrix G)
 {
   bem->par->h2n = enumerate_h2matrix(G);
 
-  iterate_h2matrix(G, 0, 0, 0, max_pardepth, NULL,
-		   assemble_bem3d_nearfield_block_h2matrix, bem);
+  assemble_leaves_bem3d_h2matrix(bem, G, true, false,
+				 assemble_bem3d_nearfield_block_h2matrix);
 
   freemem(bem->par->h2n);
   bem->par->h2n = NULL;
@@ -10338,8 +9160,8 @@ assemble_bem3d_farfield_h2matrix(pbem3d bem, ph2matrix G)
 {
   bem->par->h2n = enumerate_h2matrix(G);
 
-  iterate_h2matrix(G, 0, 0, 0, max_pardepth, NULL,
-		   assemble_bem3d_farfield_block_h2matrix, bem);
+  assemble_leaves_bem3d_h2matrix(bem, G, false, true,
+				 assemble_bem3d_farfield_block_h2matrix);
 
   freemem(bem->par->h2n);
   bem->par->h2n = NULL;
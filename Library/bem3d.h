@@ -18,9 +18,6 @@
 #include <omp.h>
 #endif
 /* CORE 0 */
-#ifdef USE_SIMD
-#include "simd.h"
-#endif
 #include "basic.h"
 /* CORE 1 */
 #include "amatrix.h"
@@ -44,6 +41,7 @@
 #include "hcoarsen.h"
 #include "h2update.h"
 #include "aca.h"
+#include "taskpool.h"
 /* SIMPLE */
 /* BEM */
 #include "macrosurface3d.h"
@@ -253,14 +251,39 @@ typedef field (*kernel_wave_func3d)(const real *x, const real *y,
 typedef field (*kernel_wave_func3d_idx)(uint idx_x, uint idx_y,
     pcreal dir, void *data);
 
-#ifdef USE_SIMD
-typedef void (*kernel_simd_func3d)(const vreal *x, const vreal *y,
-    const vreal *nx, const vreal *ny, void *data, vreal *res_re, vreal *res_im);
+/**
+ * @brief Evaluate a family of kernel functions, e.g., for several wave
+ * numbers, at points @p x and @p y.
+ *
+ * Quantities shared by all members of the family, e.g., @f$|x-y|@f$, are
+ * only computed once.
+ *
+ * @param x First evaluation point.
+ * @param y Second evaluation point.
+ * @param nx Normal vector that belongs to @p x.
+ * @param ny Normal vector that belongs to @p y.
+ * @param data Additional data that is needed to evaluate the functions.
+ * @param m Number of kernel functions.
+ * @param res Values of the @p m kernel functions.
+ */
+typedef void (*kernel_sweep_func3d)(const real *x, const real *y,
+    const real *nx, const real *ny, void *data, uint m, field *res);
 
-typedef void (*kernel_simd_wave_func3d)(const vreal *x, const vreal *y,
-    const vreal *nx, const vreal *ny, pcreal dir, void *data, vreal *res_re,
-    vreal *res_im);
-#endif
+/**
+ * @brief Callback that computes nearfield entries of several
+ * boundary integral operators in one pass, e.g., single and double layer
+ * operator on the same mesh.
+ *
+ * @param ridx Indices of row boundary elements or NULL.
+ * @param cidx Indices of column boundary elements or NULL.
+ * @param bem Array of @p m @ref _bem3d "bem3d" objects, entries may be NULL.
+ * @param ntrans Store the entries in a transposed way.
+ * @param m Number of operators.
+ * @param N Matrices of identical size, <tt>N[i]</tt> takes the entries for
+ *        <tt>bem[i]</tt> and is NULL if <tt>bem[i]</tt> is.
+ */
+typedef void (*nearfield_fused_func3d)(const uint *ridx, const uint *cidx,
+    pbem3d *bem, bool ntrans, uint m, pamatrix *N);
 
 /**
  * This is just an abbreviation for the struct @ref _listnode .
@@ -366,6 +389,12 @@ struct _bem3d {
    */
   field kernel_const;
 
+  /**
+   * @brief Number of terms of the polynomials approximating sine and cosine
+   * in vectorized kernels, see @ref set_kernelaccuracy_helmholtzbem3d.
+   */
+  uint sincos_terms;
+
   /**
    * @brief This field describes the mapping from the vertices of a geometry to
    * the triangles they belong to.
@@ -769,6 +798,16 @@ struct _bem3d {
    * \see kernelbem2d
    */
   pkernelbem3d kernels;
+
+  /**
+   * @brief Task pool used to assemble the leaves of @ref hmatrix and
+   * @ref h2matrix objects.
+   *
+   * The pool is created by the first assembly and keeps the per-thread
+   * busy and idle times of the last one, they can be inspected by
+   * @ref print_taskpool.
+   */
+  ptaskpool tasks;
 };
 
 /**
@@ -1422,6 +1461,83 @@ new_bem3d(pcsurface3d gr, basisfunctionbem3d row_basis,
 HEADER_PREFIX void
 del_bem3d(pbem3d bem);
 
+/**
+ * @brief Enable or disable the cache for singular integrals.
+ *
+ * If the cache is enabled, the nearfield assembly routines compute the
+ * integrals for pairs of triangles sharing a vertex, an edge or both
+ * triangles only once for every congruence class, see @ref singcache.
+ * This requires that the kernel function only depends on @f$x-y@f$ and the
+ * normal vectors, which is true for all kernels provided by this library.
+ * If parameters of the kernel function, e.g., the wave number, are changed,
+ * the cache has to be cleared by @ref invalidate_kernel_bem3d.
+ *
+ * @param bem @ref _bem3d "bem3d" object.
+ * @param maxsize Maximal storage for the cache in bytes, zero disables the
+ *        cache.
+ */
+HEADER_PREFIX void
+setup_singcache_bem3d(pbem3d bem, size_t maxsize);
+
+/**
+ * @brief Discard all data derived from the kernel function.
+ *
+ * Has to be called if parameters of the kernel function, e.g., the wave
+ * number, are changed.
+ * Entries of the singular integral cache and the clusters of the
+ * Green-hybrid approximation are removed, while the geometry, the
+ * quadrature rules, precomputed quadrature points and the approximation
+ * parameters are kept, so matrices with the same block structure can be
+ * assembled again without further setup.
+ *
+ * @param bem @ref _bem3d "bem3d" object.
+ */
+HEADER_PREFIX void
+invalidate_kernel_bem3d(pbem3d bem);
+
+/**
+ * @brief Precompute the quadrature points of the single triangle rule
+ * for some or all triangles.
+ *
+ * Regular nearfield integrals and the evaluation of kernel functions in
+ * the farfield use the stored points of a triangle instead of
+ * transforming the reference points again for every pair of triangles,
+ * see @ref setup_triquadpoints_singquad2d.
+ * Calling this function again replaces the previous selection,
+ * @ref del_triquadpoints_singquad2d discards all points.
+ * If the library is compiled with <tt>USE_TRIQUADPOINTS</tt>, the
+ * points of all triangles are precomputed by default.
+ *
+ * @param bem @ref _bem3d "bem3d" object.
+ * @param b Optional block tree. If not <tt>NULL</tt>, only triangles
+ *        appearing in more than <tt>mincount</tt> inadmissible leaves of
+ *        <tt>b</tt> are selected.
+ * @param mincount Threshold for the number of inadmissible leaves.
+ * @param budget Maximal storage for the points in bytes, zero means
+ *        unlimited. Triangles appearing in more leaves are preferred.
+ * @return Number of triangles with precomputed points.
+ */
+HEADER_PREFIX uint
+setup_triquadpoints_bem3d(pbem3d bem, pcblock b, uint mincount,
+			  size_t budget);
+
+/**
+ * @brief Look up the precomputed quadrature points of a triangle.
+ *
+ * @param bem @ref _bem3d "bem3d" object.
+ * @param t Index of the triangle.
+ * @param x Returns the x-coordinates of the points, the array is padded
+ *        to a multiple of <tt>VREAL_PAD</tt>.
+ * @param y Returns the y-coordinates of the points.
+ * @param z Returns the z-coordinates of the points.
+ * @return <tt>true</tt> if the points of <tt>t</tt> have been
+ *        precomputed by @ref setup_triquadpoints_bem3d, otherwise
+ *        <tt>x</tt>, <tt>y</tt> and <tt>z</tt> are set to <tt>NULL</tt>.
+ */
+HEADER_PREFIX bool
+get_triquadpoints_bem3d(pcbem3d bem, uint t, const real ** x,
+			const real ** y, const real ** z);
+
 /* ------------------------------------------------------------
  * Methods to build clustertrees
  * ------------------------------------------------------------ */
@@ -1546,11 +1662,40 @@ build_bem3d_cluster(pcbem3d bem, uint clf, basisfunctionbem3d basis);
 HEADER_PREFIX void
 assemble_cc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
+
+/**
+ * @brief Compute entries of a family of boundary integral operators with
+ * piecewise constant basis functions for both Ansatz and test functions
+ * in one pass over the quadrature points.
+ *
+ * Works like @ref assemble_cc_near_bem3d for @p m kernel functions at once,
+ * e.g., for a sweep over several wave numbers or for the single and double
+ * layer operators on the same mesh.
+ * The singular integral cache is not used.
+ *
+ * @param ridx Defines the indices of row boundary elements used. If
+ * <tt>ridx</tt> equals NULL, then Elements <tt>0, ..., N[i]->rows-1</tt> are
+ * used.
+ * @param cidx Defines the indices of column boundary elements used.
+ * If <tt>cidx</tt> equals NULL, then Elements <tt>0, ..., N[i]->cols-1</tt>
+ * are used.
+ * @param bem @ref _bem3d "Bem3d" object, that contains additional
+ *        Information for the computation of the matrix entries.
+ * @param ntrans Is a boolean flag to indicates the way of storing the entries
+ * in the matrices <tt>N[i]</tt>.
+ * @param m Number of kernel functions.
+ * @param N Matrices of identical size, <tt>N[i]</tt> takes the entries for
+ *        the <tt>i</tt>-th kernel function. Entries that are NULL are
+ *        skipped.
+ * @param alpha Factors of the mass matrices added to <tt>N[i]</tt>, or NULL
+ *        to use <tt>bem->alpha</tt> for all matrices.
+ * @param kernel Evaluates the @p m kernel functions.
+ * @param data Additional data passed to @p kernel.
+ */
 HEADER_PREFIX void
-assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
+assemble_cc_sweep_near_bem3d(const uint * ridx, const uint * cidx,
+    pcbem3d bem, bool ntrans, uint m, pamatrix *N, const field *alpha,
+    kernel_sweep_func3d kernel, void *data);
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1581,11 +1726,6 @@ assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_cc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_cc_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1614,11 +1754,6 @@ assemble_cc_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_cl_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_cl_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1650,11 +1785,6 @@ assemble_cl_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_cl_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_cl_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1683,11 +1813,6 @@ assemble_cl_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_lc_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_lc_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1719,11 +1844,6 @@ assemble_lc_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_lc_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_lc_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1751,11 +1871,6 @@ assemble_lc_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_ll_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_ll_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief Compute general entries of a boundary integral operator with
@@ -1786,11 +1901,6 @@ assemble_ll_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
 HEADER_PREFIX void
 assemble_ll_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
     bool ntrans, pamatrix N, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-assemble_ll_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
-    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
-#endif
 
 /* ------------------------------------------------------------
  * Evaluate kernel function at given points
@@ -1887,11 +1997,6 @@ fill_wave_bem3d(pcbem3d bem, const real (*X)[3], const real (*Y)[3],
 HEADER_PREFIX void
 fill_row_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem, pamatrix V,
     kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-fill_row_simd_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem,
-    pamatrix V, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief This function will integrate a kernel function @f$g@f$ on
@@ -1922,11 +2027,6 @@ fill_row_simd_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem,
 HEADER_PREFIX void
 fill_col_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem, pamatrix V,
     kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-fill_col_simd_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem,
-    pamatrix V, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief This function will integrate a kernel function @f$g@f$ on
@@ -2019,11 +2119,6 @@ fill_col_l_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem, pamatrix V,
 HEADER_PREFIX void
 fill_dnz_row_c_bem3d(const uint * idx, const real (*Z)[3], const real (*N)[3],
     pcbem3d bem, pamatrix V, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-fill_dnz_row_simd_c_bem3d(const uint * idx, const real (*Z)[3],
-    const real (*N)[3], pcbem3d bem, pamatrix V, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief This function will integrate a normal derivative of a kernel function
@@ -2056,11 +2151,6 @@ fill_dnz_row_simd_c_bem3d(const uint * idx, const real (*Z)[3],
 HEADER_PREFIX void
 fill_dnz_col_c_bem3d(const uint * idx, const real (*Z)[3], const real (*N)[3],
     pcbem3d bem, pamatrix V, kernel_func3d kernel);
-#ifdef USE_SIMD
-HEADER_PREFIX void
-fill_dnz_col_simd_c_bem3d(const uint * idx, const real (*Z)[3],
-    const real (*N)[3], pcbem3d bem, pamatrix V, kernel_simd_func3d kernel);
-#endif
 
 /**
  * @brief This function will integrate a normal derivative of a kernel function
@@ -3079,6 +3169,27 @@ assemble_bem3d_amatrix(pbem3d bem, pamatrix G);
 HEADER_PREFIX void
 assemble_bem3d_hmatrix(pbem3d bem, pblock b, phmatrix G);
 
+/**
+ * @brief Fills several @ref _hmatrix "hmatrices" sharing the same block tree
+ * in one traversal.
+ *
+ * The nearfield blocks of all matrices are computed by one call to
+ * @p nearfield, so quadrature points and kernel quantities can be shared
+ * between the operators, e.g., by @ref nearfield_fused_laplacebem3d.
+ * The farfield blocks are approximated for each operator as in
+ * @ref assemble_bem3d_hmatrix.
+ *
+ * @param m Number of operators.
+ * @param bem Array of @p m @ref _bem3d "bem3d" objects, entries may be NULL.
+ * @param b Root of the @ref _block "blocktree".
+ * @param G Array of @p m @ref _hmatrix "hmatrices" to be filled,
+ *        <tt>G[i]</tt> is NULL if and only if <tt>bem[i]</tt> is.
+ * @param nearfield Computes the nearfield entries of all operators.
+ */
+HEADER_PREFIX void
+assemble_bem3d_fused_hmatrix(uint m, pbem3d *bem, pblock b, phmatrix *G,
+    nearfield_fused_func3d nearfield);
+
 /**
  * @brief Fills a @ref _hmatrix "hmatrix" with a predefined approximation
  * technique using coarsening strategy.
@@ -3150,6 +3261,31 @@ assemble_bem3d_nearfield_hmatrix(pbem3d bem, pblock b, phmatrix G);
 HEADER_PREFIX void
 assemble_bem3d_farfield_hmatrix(pbem3d bem, pblock b, phmatrix G);
 
+/**
+ * @brief Fills the farfield blocks of a @ref _hmatrix "hmatrix" and makes
+ * the nearfield blocks matrix-free.
+ *
+ * The admissible leaves are assembled as in
+ * @ref assemble_bem3d_farfield_hmatrix.
+ * The storage of the inadmissible leaves is released, their entries are
+ * recomputed by <tt>bem->nearfield</tt> during every matrix-vector
+ * multiplication, see @ref matrixfree_nearfield_hmatrix.
+ * This saves the memory of the nearfield at the price of its quadrature in
+ * each multiplication.
+ *
+ * @attention <tt>bem</tt> has to remain valid as long as <tt>G</tt> is used.
+ * Only matrix-vector multiplications can be applied to <tt>G</tt> until
+ * @ref store_nearfield_hmatrix is called.
+ *
+ * @param bem @ref _bem3d "bem3d" object containing all necessary information
+ * for computing the entries of @ref _hmatrix "hmatrix" <tt>G</tt> .
+ * @param b Root of the @ref _block "blocktree".
+ * @param G @ref _hmatrix "hmatrix" to be filled. <tt>b</tt> has to be
+ * appropriate to <tt>G</tt>.
+ */
+HEADER_PREFIX void
+assemble_bem3d_matrixfree_hmatrix(pbem3d bem, pblock b, phmatrix G);
+
 /* ------------------------------------------------------------
  * Fill H2-matrix
  * ------------------------------------------------------------ */
@@ -3238,6 +3374,27 @@ assemble_bem3d_h2matrix_col_clusterbasis(pcbem3d bem, pclusterbasis cb);
 HEADER_PREFIX void
 assemble_bem3d_h2matrix(pbem3d bem, ph2matrix G);
 
+/**
+ * @brief Fills several @ref _h2matrix "h2matrices" sharing the same block
+ * structure in one traversal.
+ *
+ * The nearfield blocks of all matrices are computed by one call to
+ * @p nearfield, the coupling matrices are computed for each operator as in
+ * @ref assemble_bem3d_h2matrix.
+ *
+ * @attention The @ref _clusterbasis "clusterbasis" of every operator have to
+ * be computed before calling this function.
+ *
+ * @param m Number of operators.
+ * @param bem Array of @p m @ref _bem3d "bem3d" objects, entries may be NULL.
+ * @param G Array of @p m @ref _h2matrix "h2matrices" to be filled,
+ *        <tt>G[i]</tt> is NULL if and only if <tt>bem[i]</tt> is.
+ * @param nearfield Computes the nearfield entries of all operators.
+ */
+HEADER_PREFIX void
+assemble_bem3d_fused_h2matrix(uint m, pbem3d *bem, ph2matrix *G,
+    nearfield_fused_func3d nearfield);
+
 /**
  * @brief Fills the nearfield part of a @ref _h2matrix "h2matrix".
  *
@@ -0,0 +1,1912 @@
+/* ------------------------------------------------------------
+ This is the file "bem3d_simd.c" of the H2Lib package.
+ All rights reserved, Sven Christophersen 2011
+ ------------------------------------------------------------ */
+
+/* The quadrature arrays are padded to VREAL_PAD entries, vnq is the
+ * leading dimension of the arrays while the loops only run up to the
+ * next multiple of VREAL and mask the last vector. */
+
+/* C STD LIBRARY */
+#include <string.h>
+/* CORE 0 */
+#include "basic.h"
+/* CORE 1 */
+/* CORE 2 */
+/* CORE 3 */
+/* SIMPLE */
+/* PARTICLES */
+/* BEM */
+#include "bem3d_simd.h"
+
+void
+assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx,
+			    pcbem3d bem, bool ntrans, pamatrix N,
+			    kernel_simd_func3d kernel)
+{
+  const pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const real *gr_g = (const real *) gr->g;
+  field    *aa = N->a;
+  uint      rows = ntrans ? N->cols : N->rows;
+  uint      cols = ntrans ? N->rows : N->cols;
+  longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
+
+#ifdef USE_OPENMP
+#pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
+  {
+#endif
+    vreal     vt[3][3], vs[3][3], nx[3], ny[3];
+    const uint *tri_t, *tri_s;
+    real     *xq, *yq, *wq;
+    uint      tp[3], sp[3];
+    real      factor, factor2, base;
+    field     sum, val;
+    int64_t   key[SINGCACHE_KEYLEN];
+    bool      cached;
+    vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i,
+      eval_r, eval_i, vcount, cmp;
+    uint      q, nq, vnq, remainder, ss, tt, s, t, i, j;
+    const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+    bool      pts, ptt;
+    uint      c;
+    uint      q2;
+    uint      nq2 = bem->sq->n_single;
+    uint      vnq2 = ROUNDUP(nq2, VREAL);
+
+    vreal     c_one = vset1(1.0);
+
+#ifdef USE_OPENMP
+#pragma omp for
+#endif
+    for (s = 0; s < cols; ++s) {
+      ss = (cidx == NULL ? s : cidx[s]);
+      tri_s = gr_t[ss];
+      factor = gr_g[ss] * bem->kernel_const;
+      for (i = 0; i < 3; ++i) {
+	ny[i] = vload1(gr_n[ss] + i);
+      }
+      pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+
+      for (t = 0; t < rows; ++t) {
+	tt = (ridx == NULL ? t : ridx[t]);
+	tri_t = gr_t[tt];
+	factor2 = factor * gr_g[tt];
+	for (i = 0; i < 3; ++i) {
+	  nx[i] = vload1(gr_n[tt] + i);
+	}
+	ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+
+	c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
+					 &yq, &wq, &nq, &base);
+	if (nq % VREAL || nq2 % VREAL) {
+	  for (q = 0; q < VREAL; ++q) {
+	    vcount[q] = q;
+	  }
+	}
+	vnq = ROUNDUP(nq, VREAL_PAD);
+
+	wq += 9 * vnq;
+
+	sum_r = vsetzero();
+	sum_i = vsetzero();
+
+	/* Congruent singular pairs have already been integrated */
+	cached = (c > 0 && sc != NULL);
+	if (cached) {
+	  key_singcache(1, c, tp, sp, gr_x[tri_t[tp[0]]], gr_x[tri_t[tp[1]]],
+			gr_x[tri_t[tp[2]]], gr_x[tri_s[sp[0]]],
+			gr_x[tri_s[sp[1]]], gr_x[tri_s[sp[2]]], key);
+	  cached = lookup_singcache(sc, key, 1, &val);
+	}
+
+	if (c == 0 && pts && ptt) {
+	  remainder = vnq2 - VREAL;
+
+	  for (q = 0; q < nq2; q++) {
+	    x[0] = vload1(tri_tx + q);
+	    x[1] = vload1(tri_ty + q);
+	    x[2] = vload1(tri_tz + q);
+	    for (q2 = 0; q2 < vnq2; q2 += VREAL) {
+	      y[0] = vload(tri_sx + q2);
+	      y[1] = vload(tri_sy + q2);
+	      y[2] = vload(tri_sz + q2);
+	      w = vloadu(wq + q2 + q * nq2);
+
+	      kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	      if (nq2 % VREAL && q2 >= remainder) {
+		cmp =
+		  vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
+		eval_r = vand(cmp, eval_r);
+		eval_i = vand(cmp, eval_i);
+	      }
+
+	      sum_r = vfmadd(w, eval_r, sum_r);
+	      sum_i = vfmadd(w, eval_i, sum_i);
+	    }
+	  }
+	  val = vreduce(sum_r) + vreduce(sum_i) * I;
+	}
+	else if (!cached) {
+	  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+	  for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+	    for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	      vt[i][j] = vload1(gr_x[tri_t[tp[j]]] + i);
+	      vs[i][j] = vload1(gr_x[tri_s[sp[j]]] + i);
+	    }
+	  }
+
+	  for (q = 0; q < nq; q += VREAL) {
+	    tx = vload(xq + q);
+	    sx = vload(xq + q + vnq);
+	    ty = vload(yq + q);
+	    sy = vload(yq + q + vnq);
+	    w = vload(wq + q);
+
+	    ct[0] = vsub(c_one, tx);
+	    ct[1] = vsub(tx, sx);
+	    ct[2] = sx;
+	    cs[0] = vsub(c_one, ty);
+	    cs[1] = vsub(ty, sy);
+	    cs[2] = sy;
+
+	    for (i = 0; i < 3; ++i) {
+	      x[i] = vdot3(vt[i], ct);
+	      y[i] = vdot3(vs[i], cs);
+	    }
+
+	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	    if (nq % VREAL && q >= remainder) {
+	      cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	      eval_r = vand(cmp, eval_r);
+	      eval_i = vand(cmp, eval_i);
+	    }
+
+	    sum_r = vfmadd(w, eval_r, sum_r);
+	    sum_i = vfmadd(w, eval_i, sum_i);
+	  }
+	  val = vreduce(sum_r) + vreduce(sum_i) * I;
+
+	  if (c > 0 && sc != NULL) {
+	    insert_singcache(sc, key, 1, &val);
+	  }
+	}
+	sum = base + val;
+
+	if (ntrans) {
+	  aa[s + t * ld] = CONJ(sum) * factor2;
+	}
+	else {
+	  aa[t + s * ld] = sum * factor2;
+	}
+
+	if (bem->alpha != 0.0 && tt == ss) {
+	  if (ntrans) {
+	    aa[t + t * ld] += 0.5 * CONJ(bem->alpha) * gr_g[tt];
+	  }
+	  else {
+	    aa[t + t * ld] += 0.5 * bem->alpha * gr_g[tt];
+	  }
+	}
+      }
+    }
+#ifdef USE_OPENMP
+  }
+#endif
+}
+
+void
+assemble_cc_simd_sweep_near_bem3d(const uint * ridx, const uint * cidx,
+				  pcbem3d bem, bool ntrans, uint m,
+				  pamatrix * N, const field * alpha,
+				  kernel_simd_sweep_func3d kernel, void *data)
+{
+  const pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const real *gr_g = (const real *) gr->g;
+  uint      rows, cols, l0;
+
+  /* Matrices may be missing, all others have the same size */
+  for (l0 = 0; l0 < m && N[l0] == NULL; l0++);
+  if (l0 == m) {
+    return;
+  }
+  rows = ntrans ? N[l0]->cols : N[l0]->rows;
+  cols = ntrans ? N[l0]->rows : N[l0]->cols;
+
+#ifdef USE_OPENMP
+#pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
+  {
+#endif
+    vreal     vt[3][3], vs[3][3], nx[3], ny[3];
+    const uint *tri_t, *tri_s;
+    real     *xq, *yq, *wq;
+    uint      tp[3], sp[3];
+    real      factor, factor2, base;
+    vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], vcount, cmp;
+    vreal    *sum_r, *sum_i, *eval_r, *eval_i;
+    field     val, a;
+    uint      q, nq, vnq, remainder, ss, tt, s, t, i, j, l;
+    const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+    bool      pts, ptt;
+    uint      c;
+    uint      q2;
+    uint      nq2 = bem->sq->n_single;
+    uint      vnq2 = ROUNDUP(nq2, VREAL);
+
+    vreal     c_one = vset1(1.0);
+
+    sum_r = (vreal *) allocmem(sizeof(vreal) * m);
+    sum_i = (vreal *) allocmem(sizeof(vreal) * m);
+    eval_r = (vreal *) allocmem(sizeof(vreal) * m);
+    eval_i = (vreal *) allocmem(sizeof(vreal) * m);
+
+#ifdef USE_OPENMP
+#pragma omp for
+#endif
+    for (s = 0; s < cols; ++s) {
+      ss = (cidx == NULL ? s : cidx[s]);
+      tri_s = gr_t[ss];
+      factor = gr_g[ss] * bem->kernel_const;
+      for (i = 0; i < 3; ++i) {
+	ny[i] = vload1(gr_n[ss] + i);
+      }
+      pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+
+      for (t = 0; t < rows; ++t) {
+	tt = (ridx == NULL ? t : ridx[t]);
+	tri_t = gr_t[tt];
+	factor2 = factor * gr_g[tt];
+	for (i = 0; i < 3; ++i) {
+	  nx[i] = vload1(gr_n[tt] + i);
+	}
+	ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+
+	c = select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq,
+					 &yq, &wq, &nq, &base);
+	if (nq % VREAL || nq2 % VREAL) {
+	  for (q = 0; q < VREAL; ++q) {
+	    vcount[q] = q;
+	  }
+	}
+	vnq = ROUNDUP(nq, VREAL_PAD);
+
+	wq += 9 * vnq;
+
+	for (l = 0; l < m; ++l) {
+	  sum_r[l] = vsetzero();
+	  sum_i[l] = vsetzero();
+	}
+
+	if (c == 0 && pts && ptt) {
+	  remainder = vnq2 - VREAL;
+
+	  for (q = 0; q < nq2; q++) {
+	    x[0] = vload1(tri_tx + q);
+	    x[1] = vload1(tri_ty + q);
+	    x[2] = vload1(tri_tz + q);
+	    for (q2 = 0; q2 < vnq2; q2 += VREAL) {
+	      y[0] = vload(tri_sx + q2);
+	      y[1] = vload(tri_sy + q2);
+	      y[2] = vload(tri_sz + q2);
+	      w = vloadu(wq + q2 + q * nq2);
+
+	      kernel(x, y, nx, ny, data, m, eval_r, eval_i);
+
+	      if (nq2 % VREAL && q2 >= remainder) {
+		cmp =
+		  vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
+		for (l = 0; l < m; ++l) {
+		  eval_r[l] = vand(cmp, eval_r[l]);
+		  eval_i[l] = vand(cmp, eval_i[l]);
+		}
+	      }
+
+	      for (l = 0; l < m; ++l) {
+		sum_r[l] = vfmadd(w, eval_r[l], sum_r[l]);
+		sum_i[l] = vfmadd(w, eval_i[l], sum_i[l]);
+	      }
+	    }
+	  }
+	}
+	else {
+	  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+	  for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+	    for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	      vt[i][j] = vload1(gr_x[tri_t[tp[j]]] + i);
+	      vs[i][j] = vload1(gr_x[tri_s[sp[j]]] + i);
+	    }
+	  }
+
+	  for (q = 0; q < nq; q += VREAL) {
+	    tx = vload(xq + q);
+	    sx = vload(xq + q + vnq);
+	    ty = vload(yq + q);
+	    sy = vload(yq + q + vnq);
+	    w = vload(wq + q);
+
+	    ct[0] = vsub(c_one, tx);
+	    ct[1] = vsub(tx, sx);
+	    ct[2] = sx;
+	    cs[0] = vsub(c_one, ty);
+	    cs[1] = vsub(ty, sy);
+	    cs[2] = sy;
+
+	    for (i = 0; i < 3; ++i) {
+	      x[i] = vdot3(vt[i], ct);
+	      y[i] = vdot3(vs[i], cs);
+	    }
+
+	    kernel(x, y, nx, ny, data, m, eval_r, eval_i);
+
+	    if (nq % VREAL && q >= remainder) {
+	      cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	      for (l = 0; l < m; ++l) {
+		eval_r[l] = vand(cmp, eval_r[l]);
+		eval_i[l] = vand(cmp, eval_i[l]);
+	      }
+	    }
+
+	    for (l = 0; l < m; ++l) {
+	      sum_r[l] = vfmadd(w, eval_r[l], sum_r[l]);
+	      sum_i[l] = vfmadd(w, eval_i[l], sum_i[l]);
+	    }
+	  }
+	}
+
+	for (l = 0; l < m; ++l) {
+	  if (N[l] == NULL) {
+	    continue;
+	  }
+
+	  val = ((vreduce(sum_r[l]) + base) * factor2)
+	    + (vreduce(sum_i[l]) * factor2) * I;
+	  a = (alpha ? alpha[l] : bem->alpha);
+
+	  if (ntrans) {
+	    N[l]->a[s + t * N[l]->ld] = CONJ(val);
+	  }
+	  else {
+	    N[l]->a[t + s * N[l]->ld] = val;
+	  }
+
+	  if (a != 0.0 && tt == ss) {
+	    if (ntrans) {
+	      N[l]->a[t + t * N[l]->ld] += 0.5 * CONJ(a) * gr_g[tt];
+	    }
+	    else {
+	      N[l]->a[t + t * N[l]->ld] += 0.5 * a * gr_g[tt];
+	    }
+	  }
+	}
+      }
+    }
+
+    freemem(eval_i);
+    freemem(eval_r);
+    freemem(sum_i);
+    freemem(sum_r);
+#ifdef USE_OPENMP
+  }
+#endif
+}
+
+void
+assemble_cc_simd_far_bem3d(const uint * ridx, const uint * cidx,
+			   pcbem3d bem, bool ntrans, pamatrix N,
+			   kernel_simd_func3d kernel)
+{
+  const pcsurface3d gr = bem->gr;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const real *gr_g = (const real *) gr->g;
+  field    *aa = N->a;
+  uint      rows = ntrans ? N->cols : N->rows;
+  uint      cols = ntrans ? N->rows : N->cols;
+  longindex ld = N->ld;
+
+#ifdef USE_OPENMP
+#pragma omp parallel if(!omp_in_parallel() && cols >= 256) num_threads(1 << max_pardepth)
+  {
+#endif
+    const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+    const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+    vreal     nx[3], ny[3];
+    real     *wq;
+    real      factor, factor2, base;
+    vreal     w, x[3], y[3], sum_r, sum_i, eval_r, eval_i, vcount, cmp;
+    uint      q, nq, vnq, remainder, ss, tt, s, t, i;
+    const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+    bool      pts, ptt;
+    uint      q2;
+    uint      nq2 = bem->sq->n_single;
+    uint      vnq2 = ROUNDUP(nq2, VREAL);
+    uint      j;
+    vreal     c_one = vset1(1.0);
+    vreal     vt[3][3], vs[3][3];
+    vreal     ct[3], cs[3], tx, sx, ty, sy;
+    real     *xq = bem->sq->x_dist;
+    real     *yq = bem->sq->y_dist;
+    const uint *tri_t, *tri_s;
+
+    nq = bem->sq->n_dist;
+    vnq = ROUNDUP(nq, VREAL_PAD);
+    wq = bem->sq->w_dist + 9 * vnq;
+    base = bem->sq->base_dist;
+
+    if (nq % VREAL || nq2 % VREAL) {
+      for (q = 0; q < VREAL; ++q) {
+	vcount[q] = q;
+      }
+    }
+
+#ifdef USE_OPENMP
+#pragma omp for
+#endif
+    for (s = 0; s < cols; ++s) {
+      ss = (cidx == NULL ? s : cidx[s]);
+
+      factor = gr_g[ss] * bem->kernel_const;
+      for (i = 0; i < 3; ++i) {
+	ny[i] = vload1(gr_n[ss] + i);
+      }
+      pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+      tri_s = gr_t[ss];
+
+      for (t = 0; t < rows; ++t) {
+	tt = (ridx == NULL ? t : ridx[t]);
+
+	factor2 = factor * gr_g[tt];
+	for (i = 0; i < 3; ++i) {
+	  nx[i] = vload1(gr_n[tt] + i);
+	}
+	ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+	tri_t = gr_t[tt];
+
+	sum_r = vsetzero();
+	sum_i = vsetzero();
+
+	if (pts && ptt) {
+	  remainder = vnq2 - VREAL;
+
+	  for (q = 0; q < nq2; q++) {
+	    x[0] = vload1(tri_tx + q);
+	    x[1] = vload1(tri_ty + q);
+	    x[2] = vload1(tri_tz + q);
+	    for (q2 = 0; q2 < vnq2; q2 += VREAL) {
+	      y[0] = vload(tri_sx + q2);
+	      y[1] = vload(tri_sy + q2);
+	      y[2] = vload(tri_sz + q2);
+	      w = vloadu(wq + q2 + q * nq2);
+
+	      kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	      if (nq2 % VREAL && q2 >= remainder) {
+		cmp =
+		  vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
+		eval_r = vand(cmp, eval_r);
+		eval_i = vand(cmp, eval_i);
+	      }
+
+	      sum_r = vfmadd(w, eval_r, sum_r);
+	      sum_i = vfmadd(w, eval_i, sum_i);
+	    }
+	  }
+	}
+	else {
+	  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+	  for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+	    for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	      vt[i][j] = vload1(gr_x[tri_t[j]] + i);
+	      vs[i][j] = vload1(gr_x[tri_s[j]] + i);
+	    }
+	  }
+
+	  for (q = 0; q < nq; q += VREAL) {
+	    tx = vload(xq + q);
+	    sx = vload(xq + q + vnq);
+	    ty = vload(yq + q);
+	    sy = vload(yq + q + vnq);
+	    w = vload(wq + q);
+
+	    ct[0] = vsub(c_one, tx);
+	    ct[1] = vsub(tx, sx);
+	    ct[2] = sx;
+	    cs[0] = vsub(c_one, ty);
+	    cs[1] = vsub(ty, sy);
+	    cs[2] = sy;
+
+	    for (i = 0; i < 3; ++i) {
+	      x[i] = vdot3(vt[i], ct);
+	      y[i] = vdot3(vs[i], cs);
+	    }
+
+	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	    if (nq % VREAL && q >= remainder) {
+	      cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	      eval_r = vand(cmp, eval_r);
+	      eval_i = vand(cmp, eval_i);
+	    }
+
+	    sum_r = vfmadd(w, eval_r, sum_r);
+	    sum_i = vfmadd(w, eval_i, sum_i);
+	  }
+	}
+
+	if (ntrans) {
+	  aa[s + t * ld] = ((vreduce(sum_r) + base) * factor2)
+	    - (vreduce(sum_i) * factor2) * I;
+	}
+	else {
+	  aa[t + s * ld] = ((vreduce(sum_r) + base) * factor2)
+	    + (vreduce(sum_i) * factor2) * I;
+	}
+
+	if (bem->alpha != 0.0 && tt == ss) {
+	  if (ntrans) {
+	    aa[t + t * ld] += 0.5 * CONJ(bem->alpha) * gr_g[tt];
+	  }
+	  else {
+	    aa[t + t * ld] += 0.5 * bem->alpha * gr_g[tt];
+	  }
+	}
+      }
+    }
+#ifdef USE_OPENMP
+  }
+#endif
+}
+
+void
+assemble_cl_simd_near_bem3d(const uint * ridx, const uint * cidx,
+			    pcbem3d bem, bool ntrans, pamatrix N,
+			    kernel_simd_func3d kernel)
+{
+  const pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const preal gr_g = (const preal) gr->g;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const uint triangles = gr->triangles;
+  plistnode *v2t = bem->v2t;
+
+  field    *aa = N->a;
+  uint      rows = ntrans ? N->cols : N->rows;
+  uint      cols = ntrans ? N->rows : N->cols;
+  longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
+
+  vreal     vt[3][3], vs[3][3], nx[3], ny[3];
+  real     *quad_r, *quad_i;
+  ptri_list tl, tl1;
+  pvert_list vl;
+  const uint *tri_t, *tri_s;
+  plistnode v;
+  real     *xq, *yq, *wq, *mass;
+  uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
+  vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i, eval_r,
+    eval_i, vcount, cmp;
+  real      base, factor, factor2;
+  field     val[3], res;
+  int64_t   key[SINGCACHE_KEYLEN];
+  bool      cached;
+  real     *ww;
+  uint      k;
+  uint      i, j, t, s, q, nq, vnq, remainder, cj;
+  uint      ii, jj, tt, ss, vv;
+  const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+  bool      pts, ptt;
+  uint      c;
+  uint      q2;
+  uint      nq2 = bem->sq->n_single;
+  uint      vnq2 = ROUNDUP(nq2, VREAL);
+
+  clear_amatrix(N);
+
+  quad_r = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
+  quad_i = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
+  vreal     c_one = vset1(1.0);
+
+  /* The summation reads up to the next multiple of VREAL */
+  for (q = 0; q < ROUNDUP(bem->sq->nmax, VREAL); ++q) {
+    quad_r[q] = 0.0;
+    quad_i[q] = 0.0;
+  }
+
+  tl = NULL;
+
+  cj = 0;
+  for (i = 0; i < cols; ++i) {
+    ii = (cidx == NULL ? i : cidx[i]);
+    for (v = v2t[ii], vv = v->data; v->next != NULL;
+	 v = v->next, vv = v->data) {
+
+      tl1 = tl;
+      while (tl1 && tl1->t != vv) {
+	tl1 = tl1->next;
+      }
+
+      if (tl1 == NULL) {
+	tl1 = tl = new_tri_list(tl);
+	tl->t = vv;
+	cj++;
+      }
+
+      tl1->vl = new_vert_list(tl1->vl);
+      tl1->vl->v = i;
+    }
+  }
+
+  for (s = 0, tl1 = tl; s < cj; s++, tl1 = tl1->next) {
+    ss = tl1->t;
+    assert(ss < triangles);
+    factor = gr_g[ss] * bem->kernel_const;
+    tri_s = gr_t[ss];
+    for (i = 0; i < 3; ++i) {
+      ny[i] = vload1(gr_n[ss] + i);
+    }
+    pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+    for (t = 0; t < rows; t++) {
+      tt = (ridx == NULL ? t : ridx[t]);
+      assert(tt < triangles);
+      factor2 = factor * gr_g[tt];
+      tri_t = gr_t[tt];
+      for (i = 0; i < 3; ++i) {
+	nx[i] = vload1(gr_n[tt] + i);
+      }
+      ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+
+      c =
+	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
+				     &wq, &nq, &base);
+      if (nq % VREAL || nq2 % VREAL) {
+	for (q = 0; q < VREAL; ++q) {
+	  vcount[q] = q;
+	}
+      }
+
+      vnq = ROUNDUP(nq, VREAL_PAD);
+
+      /* Congruent singular pairs have already been integrated */
+      cached = (c > 0 && sc != NULL);
+      if (cached) {
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[tp[i]];
+	  tri_sp[i] = tri_s[sp[i]];
+	}
+	key_singcache(3, c, tp, sp, gr_x[tri_tp[0]], gr_x[tri_tp[1]],
+		      gr_x[tri_tp[2]], gr_x[tri_sp[0]], gr_x[tri_sp[1]],
+		      gr_x[tri_sp[2]], key);
+	cached = lookup_singcache(sc, key, 3, val);
+      }
+
+      if (c == 0 && pts && ptt) {
+	remainder = vnq2 - VREAL;
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[i];
+	  tri_sp[i] = tri_s[i];
+	}
+
+	for (q = 0; q < nq2; q++) {
+	  x[0] = vload1(tri_tx + q);
+	  x[1] = vload1(tri_ty + q);
+	  x[2] = vload1(tri_tz + q);
+	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
+	    y[0] = vload(tri_sx + q2);
+	    y[1] = vload(tri_sy + q2);
+	    y[2] = vload(tri_sz + q2);
+
+	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	    if (nq2 % VREAL && q2 >= remainder) {
+	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
+	      eval_r = vand(cmp, eval_r);
+	      eval_i = vand(cmp, eval_i);
+	    }
+
+	    vstoreu(quad_r + q2 + q * nq2, eval_r);
+	    vstoreu(quad_i + q2 + q * nq2, eval_i);
+	  }
+	}
+      }
+      else if (!cached) {
+	remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[tp[i]];
+	  tri_sp[i] = tri_s[sp[i]];
+	}
+
+	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	    vt[i][j] = vload1(gr_x[tri_tp[j]] + i);
+	    vs[i][j] = vload1(gr_x[tri_sp[j]] + i);
+	  }
+	}
+
+	for (q = 0; q < nq; q += VREAL) {
+	  tx = vload(xq + q);
+	  sx = vload(xq + q + vnq);
+	  ty = vload(yq + q);
+	  sy = vload(yq + q + vnq);
+
+	  ct[0] = vsub(c_one, tx);
+	  ct[1] = vsub(tx, sx);
+	  ct[2] = sx;
+	  cs[0] = vsub(c_one, ty);
+	  cs[1] = vsub(ty, sy);
+	  cs[2] = sy;
+
+	  for (i = 0; i < 3; ++i) {
+	    x[i] = vdot3(vt[i], ct);
+	    y[i] = vdot3(vs[i], cs);
+	  }
+
+	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	  if (nq % VREAL && q >= remainder) {
+	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	    eval_r = vand(cmp, eval_r);
+	    eval_i = vand(cmp, eval_i);
+	  }
+
+	  vstore(quad_r + q, eval_r);
+	  vstore(quad_i + q, eval_i);
+	}
+      }
+
+      if (!cached) {
+	for (k = 0; k < 3; ++k) {
+	  sum_r = vsetzero();
+	  sum_i = vsetzero();
+	  ww = wq + k * vnq;
+
+	  for (q = 0; q < nq; q += VREAL) {
+	    eval_r = vload(quad_r + q);
+	    eval_i = vload(quad_i + q);
+	    w = vload(ww + q);
+	    sum_r = vfmadd(w, eval_r, sum_r);
+	    sum_i = vfmadd(w, eval_i, sum_i);
+	  }
+
+	  val[k] = vreduce(sum_r) + vreduce(sum_i) * I;
+	}
+
+	if (c > 0 && sc != NULL) {
+	  insert_singcache(sc, key, 3, val);
+	}
+      }
+
+      vl = tl1->vl;
+      while (vl) {
+	j = vl->v;
+	if (j < cols) {
+	  jj = cidx == NULL ? j : cidx[j];
+	  for (i = 0; i < 3; ++i) {
+	    if (jj == tri_sp[i]) {
+	      res = base + val[i];
+
+	      if (ntrans) {
+		aa[j + t * ld] += CONJ(res) * factor2;
+	      }
+	      else {
+		aa[t + j * ld] += res * factor2;
+	      }
+	    }
+	  }
+	}
+	vl = vl->next;
+      }
+
+      if (bem->alpha != 0.0 && tt == ss) {
+
+	for (i = 0; i < 3; ++i) {
+	  tri_sp[i] = tri_s[i];
+	}
+
+	mass = bem->mass;
+	factor2 = bem->alpha * gr_g[tt];
+
+	vl = tl1->vl;
+	while (vl) {
+	  j = vl->v;
+	  if (j < cols) {
+	    jj = cidx == NULL ? j : cidx[j];
+	    for (i = 0; i < 3; ++i) {
+	      if (jj == tri_sp[i]) {
+		if (ntrans) {
+		  aa[j + t * ld] += factor2 * *mass;
+		}
+		else {
+		  aa[t + j * ld] += factor2 * *mass;
+		}
+	      }
+	      mass++;
+	    }
+	    mass = bem->mass;
+	  }
+	  vl = vl->next;
+	}
+      }
+    }
+  }
+}
+
+void
+assemble_cl_simd_far_bem3d(const uint * ridx, const uint * cidx,
+			   pcbem3d bem, bool ntrans, pamatrix N,
+			   kernel_simd_func3d kernel)
+{
+  //TODO implement nice 'far' version
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, kernel);
+}
+
+void
+assemble_lc_simd_near_bem3d(const uint * ridx, const uint * cidx,
+			    pcbem3d bem, bool ntrans, pamatrix N,
+			    kernel_simd_func3d kernel)
+{
+  const pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const preal gr_g = (const preal) gr->g;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const uint triangles = gr->triangles;
+  plistnode *v2t = bem->v2t;
+
+  field    *aa = N->a;
+  uint      rows = ntrans ? N->cols : N->rows;
+  uint      cols = ntrans ? N->rows : N->cols;
+  longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
+
+  vreal     vt[3][3], vs[3][3], nx[3], ny[3];
+  real     *quad_r, *quad_i;
+  ptri_list tl, tl1;
+  pvert_list vl;
+  const uint *tri_t, *tri_s;
+  plistnode v;
+  real     *xq, *yq, *wq, *mass;
+  uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
+  vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i, eval_r,
+    eval_i, vcount, cmp;
+  real      base, factor, factor2;
+  field     val[3], res;
+  int64_t   key[SINGCACHE_KEYLEN];
+  bool      cached;
+  real     *ww;
+  uint      k;
+  uint      i, j, t, s, q, nq, vnq, remainder, cj;
+  uint      ii, tt, ss, vv;
+  const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+  bool      pts, ptt;
+  uint      c;
+  uint      q2;
+  uint      nq2 = bem->sq->n_single;
+  uint      vnq2 = ROUNDUP(nq2, VREAL);
+
+  clear_amatrix(N);
+
+  quad_r = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
+  quad_i = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
+  vreal     c_one = vset1(1.0);
+
+  /* The summation reads up to the next multiple of VREAL */
+  for (q = 0; q < ROUNDUP(bem->sq->nmax, VREAL); ++q) {
+    quad_r[q] = 0.0;
+    quad_i[q] = 0.0;
+  }
+
+  tl = NULL;
+
+  cj = 0;
+  for (j = 0; j < rows; ++j) {
+    ii = (ridx == NULL ? j : ridx[j]);
+    for (v = v2t[ii], vv = v->data; v->next != NULL;
+	 v = v->next, vv = v->data) {
+
+      tl1 = tl;
+      while (tl1 && tl1->t != vv) {
+	tl1 = tl1->next;
+      }
+
+      if (tl1 == NULL) {
+	tl1 = tl = new_tri_list(tl);
+	tl->t = vv;
+	cj++;
+      }
+
+      tl1->vl = new_vert_list(tl1->vl);
+      tl1->vl->v = j;
+    }
+  }
+
+  for (t = 0, tl1 = tl; t < cj; t++, tl1 = tl1->next) {
+    tt = tl1->t;
+    assert(tt < triangles);
+    factor = gr_g[tt] * bem->kernel_const;
+    tri_s = gr_t[tt];
+    for (i = 0; i < 3; ++i) {
+      nx[i] = vload1(gr_n[tt] + i);
+    }
+    ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+    for (s = 0; s < cols; s++) {
+      ss = (cidx == NULL ? s : cidx[s]);
+      assert(ss < triangles);
+      factor2 = factor * gr_g[ss];
+      tri_t = gr_t[ss];
+      for (i = 0; i < 3; ++i) {
+	ny[i] = vload1(gr_n[ss] + i);
+      }
+      pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+
+      c =
+	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
+				     &wq, &nq, &base);
+      if (nq % VREAL || nq2 % VREAL) {
+	for (q = 0; q < VREAL; ++q) {
+	  vcount[q] = q;
+	}
+      }
+
+      vnq = ROUNDUP(nq, VREAL_PAD);
+
+      /* Congruent singular pairs have already been integrated */
+      cached = (c > 0 && sc != NULL);
+      if (cached) {
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[tp[i]];
+	  tri_sp[i] = tri_s[sp[i]];
+	}
+	key_singcache(3, c, tp, sp, gr_x[tri_tp[0]], gr_x[tri_tp[1]],
+		      gr_x[tri_tp[2]], gr_x[tri_sp[0]], gr_x[tri_sp[1]],
+		      gr_x[tri_sp[2]], key);
+	cached = lookup_singcache(sc, key, 3, val);
+      }
+
+      if (c == 0 && pts && ptt) {
+	remainder = vnq2 - VREAL;
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[i];
+	  tri_sp[i] = tri_s[i];
+	}
+
+	for (q = 0; q < nq2; q++) {
+	  x[0] = vload1(tri_tx + q);
+	  x[1] = vload1(tri_ty + q);
+	  x[2] = vload1(tri_tz + q);
+	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
+	    y[0] = vload(tri_sx + q2);
+	    y[1] = vload(tri_sy + q2);
+	    y[2] = vload(tri_sz + q2);
+
+	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	    if (nq2 % VREAL && q2 >= remainder) {
+	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
+	      eval_r = vand(cmp, eval_r);
+	      eval_i = vand(cmp, eval_i);
+	    }
+
+	    vstoreu(quad_r + q2 + q * nq2, eval_r);
+	    vstoreu(quad_i + q2 + q * nq2, eval_i);
+	  }
+	}
+      }
+      else if (!cached) {
+	remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[tp[i]];
+	  tri_sp[i] = tri_s[sp[i]];
+	}
+
+	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	    vt[i][j] = vload1(gr_x[tri_tp[j]] + i);
+	    vs[i][j] = vload1(gr_x[tri_sp[j]] + i);
+	  }
+	}
+
+	for (q = 0; q < nq; q += VREAL) {
+	  tx = vload(xq + q);
+	  sx = vload(xq + q + vnq);
+	  ty = vload(yq + q);
+	  sy = vload(yq + q + vnq);
+
+	  ct[0] = vsub(c_one, tx);
+	  ct[1] = vsub(tx, sx);
+	  ct[2] = sx;
+	  cs[0] = vsub(c_one, ty);
+	  cs[1] = vsub(ty, sy);
+	  cs[2] = sy;
+
+	  for (i = 0; i < 3; ++i) {
+	    x[i] = vdot3(vt[i], ct);
+	    y[i] = vdot3(vs[i], cs);
+	  }
+
+	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	  if (nq % VREAL && q >= remainder) {
+	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	    eval_r = vand(cmp, eval_r);
+	    eval_i = vand(cmp, eval_i);
+	  }
+
+	  vstore(quad_r + q, eval_r);
+	  vstore(quad_i + q, eval_i);
+	}
+      }
+
+      if (!cached) {
+	for (k = 0; k < 3; ++k) {
+	  sum_r = vsetzero();
+	  sum_i = vsetzero();
+	  ww = wq + k * vnq;
+
+	  for (q = 0; q < nq; q += VREAL) {
+	    eval_r = vload(quad_r + q);
+	    eval_i = vload(quad_i + q);
+	    w = vload(ww + q);
+	    sum_r = vfmadd(w, eval_r, sum_r);
+	    sum_i = vfmadd(w, eval_i, sum_i);
+	  }
+
+	  val[k] = vreduce(sum_r) + vreduce(sum_i) * I;
+	}
+
+	if (c > 0 && sc != NULL) {
+	  insert_singcache(sc, key, 3, val);
+	}
+      }
+
+      vl = tl1->vl;
+      while (vl) {
+	i = vl->v;
+	if (i < rows) {
+	  ii = ridx == NULL ? i : ridx[i];
+	  for (j = 0; j < 3; ++j) {
+	    if (ii == tri_tp[j]) {
+	      res = base + val[j];
+
+	      if (ntrans) {
+		aa[s + i * ld] += CONJ(res) * factor2;
+	      }
+	      else {
+		aa[i + s * ld] += res * factor2;
+	      }
+	    }
+	  }
+	}
+	vl = vl->next;
+      }
+
+      if (bem->alpha != 0.0 && tt == ss) {
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[i];
+	}
+
+	mass = bem->mass;
+	factor2 = bem->alpha * gr_g[tt];
+
+	vl = tl1->vl;
+	while (vl) {
+	  i = vl->v;
+	  if (i < rows) {
+	    ii = ridx == NULL ? i : ridx[i];
+	    for (j = 0; j < 3; ++j) {
+	      if (ii == tri_tp[j]) {
+		if (ntrans) {
+		  aa[s + i * ld] += factor2 * *mass;
+		}
+		else {
+		  aa[i + s * ld] += factor2 * *mass;
+		}
+	      }
+	      mass++;
+	    }
+	    mass = bem->mass;
+	  }
+	  vl = vl->next;
+	}
+      }
+    }
+  }
+}
+
+void
+assemble_lc_simd_far_bem3d(const uint * ridx, const uint * cidx,
+			   pcbem3d bem, bool ntrans, pamatrix N,
+			   kernel_simd_func3d kernel)
+{
+  //TODO implement nice 'far' version
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, kernel);
+}
+
+void
+assemble_ll_simd_near_bem3d(const uint * ridx, const uint * cidx,
+			    pcbem3d bem, bool ntrans, pamatrix N,
+			    kernel_simd_func3d kernel)
+{
+  const pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const preal gr_g = (const preal) gr->g;
+  const uint triangles = gr->triangles;
+  plistnode *v2t = bem->v2t;
+  field    *aa = N->a;
+  uint      rows = ntrans ? N->cols : N->rows;
+  uint      cols = ntrans ? N->rows : N->cols;
+  longindex ld = N->ld;
+  psingcache sc = bem->sq->cache;
+
+  ptri_list tl_r, tl1_r, tl_c, tl1_c;
+  pvert_list vl_r, vl_c;
+  vreal     vt[3][3], vs[3][3], nx[3], ny[3];
+  real     *quad_r, *quad_i;
+  const uint *tri_t, *tri_s;
+  plistnode v;
+  real     *xq, *yq, *wq, *ww;
+  uint      tp[3], sp[3], tri_tp[3], tri_sp[3];
+  vreal     ct[3], cs[3], tx, sx, ty, sy, w, x[3], y[3], sum_r, sum_i, eval_r,
+    eval_i, vcount, cmp;
+  real      base, factor, factor2;
+  field     val[9], res;
+  int64_t   key[SINGCACHE_KEYLEN];
+  bool      cached;
+  real     *mass;
+  uint      i, j, t, s, q, nq, vnq, remainder, rj, cj;
+  uint      ii, jj, tt, ss, vv, k, l;
+  const real *tri_tx, *tri_ty, *tri_tz, *tri_sx, *tri_sy, *tri_sz;
+  bool      pts, ptt;
+  uint      c;
+  uint      q2;
+  uint      nq2 = bem->sq->n_single;
+  uint      vnq2 = ROUNDUP(nq2, VREAL);
+
+  quad_r = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
+  quad_i = allocreal(ROUNDUP(bem->sq->nmax, VREAL));
+  vreal     c_one = vset1(1.0);
+
+  /* The summation reads up to the next multiple of VREAL */
+  for (q = 0; q < ROUNDUP(bem->sq->nmax, VREAL); ++q) {
+    quad_r[q] = 0.0;
+    quad_i[q] = 0.0;
+  }
+
+  clear_amatrix(N);
+
+  tl_r = NULL;
+  tl_c = NULL;
+
+  rj = 0;
+  for (i = 0; i < rows; ++i) {
+    ii = (ridx == NULL ? i : ridx[i]);
+    for (v = v2t[ii], vv = v->data; v->next != NULL;
+	 v = v->next, vv = v->data) {
+
+      tl1_r = tl_r;
+      while (tl1_r && tl1_r->t != vv) {
+	tl1_r = tl1_r->next;
+      }
+
+      if (tl1_r == NULL) {
+	tl1_r = tl_r = new_tri_list(tl_r);
+	tl_r->t = vv;
+	rj++;
+      }
+
+      tl1_r->vl = new_vert_list(tl1_r->vl);
+      tl1_r->vl->v = i;
+    }
+  }
+
+  cj = 0;
+  for (i = 0; i < cols; ++i) {
+    ii = (cidx == NULL ? i : cidx[i]);
+    for (v = v2t[ii], vv = v->data; v->next != NULL;
+	 v = v->next, vv = v->data) {
+
+      tl1_c = tl_c;
+      while (tl1_c && tl1_c->t != vv) {
+	tl1_c = tl1_c->next;
+      }
+
+      if (tl1_c == NULL) {
+	tl1_c = tl_c = new_tri_list(tl_c);
+	tl_c->t = vv;
+	cj++;
+      }
+
+      tl1_c->vl = new_vert_list(tl1_c->vl);
+      tl1_c->vl->v = i;
+    }
+  }
+
+  for (s = 0, tl1_c = tl_c; s < cj; s++, tl1_c = tl1_c->next) {
+    ss = tl1_c->t;
+    assert(ss < triangles);
+    factor = gr_g[ss] * bem->kernel_const;
+    tri_s = gr_t[ss];
+    for (i = 0; i < 3; ++i) {
+      ny[i] = vload1(gr_n[ss] + i);
+    }
+    pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+    for (t = 0, tl1_r = tl_r; t < rj; t++, tl1_r = tl1_r->next) {
+      tt = tl1_r->t;
+      assert(tt < triangles);
+      factor2 = factor * gr_g[tt];
+      tri_t = gr_t[tt];
+      for (i = 0; i < 3; ++i) {
+	nx[i] = vload1(gr_n[tt] + i);
+      }
+      ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+
+      c =
+	select_quadrature_singquad2d(bem->sq, tri_t, tri_s, tp, sp, &xq, &yq,
+				     &wq, &nq, &base);
+      if (nq % VREAL || nq2 % VREAL) {
+	for (q = 0; q < VREAL; ++q) {
+	  vcount[q] = q;
+	}
+      }
+
+      vnq = ROUNDUP(nq, VREAL_PAD);
+
+      /* Congruent singular pairs have already been integrated */
+      cached = (c > 0 && sc != NULL);
+      if (cached) {
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[tp[i]];
+	  tri_sp[i] = tri_s[sp[i]];
+	}
+	key_singcache(9, c, tp, sp, gr_x[tri_tp[0]], gr_x[tri_tp[1]],
+		      gr_x[tri_tp[2]], gr_x[tri_sp[0]], gr_x[tri_sp[1]],
+		      gr_x[tri_sp[2]], key);
+	cached = lookup_singcache(sc, key, 9, val);
+      }
+
+      if (c == 0 && pts && ptt) {
+	remainder = vnq2 - VREAL;
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[i];
+	  tri_sp[i] = tri_s[i];
+	}
+
+	for (q = 0; q < nq2; q++) {
+	  x[0] = vload1(tri_tx + q);
+	  x[1] = vload1(tri_ty + q);
+	  x[2] = vload1(tri_tz + q);
+	  for (q2 = 0; q2 < vnq2; q2 += VREAL) {
+	    y[0] = vload(tri_sx + q2);
+	    y[1] = vload(tri_sy + q2);
+	    y[2] = vload(tri_sz + q2);
+
+	    kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	    if (nq2 % VREAL && q2 >= remainder) {
+	      cmp = vcmplt(vadd(vcount, vset1((real) q2)), vset1((real) nq2));
+	      eval_r = vand(cmp, eval_r);
+	      eval_i = vand(cmp, eval_i);
+	    }
+
+	    vstoreu(quad_r + q2 + q * nq2, eval_r);
+	    vstoreu(quad_i + q2 + q * nq2, eval_i);
+	  }
+	}
+      }
+      else if (!cached) {
+	remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[tp[i]];
+	  tri_sp[i] = tri_s[sp[i]];
+	}
+
+	for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+	  for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	    vt[i][j] = vload1(gr_x[tri_tp[j]] + i);
+	    vs[i][j] = vload1(gr_x[tri_sp[j]] + i);
+	  }
+	}
+
+	for (q = 0; q < nq; q += VREAL) {
+	  tx = vload(xq + q);
+	  sx = vload(xq + q + vnq);
+	  ty = vload(yq + q);
+	  sy = vload(yq + q + vnq);
+
+	  ct[0] = vsub(c_one, tx);
+	  ct[1] = vsub(tx, sx);
+	  ct[2] = sx;
+	  cs[0] = vsub(c_one, ty);
+	  cs[1] = vsub(ty, sy);
+	  cs[2] = sy;
+
+	  for (i = 0; i < 3; ++i) {
+	    x[i] = vdot3(vt[i], ct);
+	    y[i] = vdot3(vs[i], cs);
+	  }
+
+	  kernel(x, y, nx, ny, (void *) bem, &eval_r, &eval_i);
+
+	  if (nq % VREAL && q >= remainder) {
+	    cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	    eval_r = vand(cmp, eval_r);
+	    eval_i = vand(cmp, eval_i);
+	  }
+
+	  vstore(quad_r + q, eval_r);
+	  vstore(quad_i + q, eval_i);
+	}
+      }
+
+      if (!cached) {
+	for (k = 0; k < 9; ++k) {
+	  sum_r = vsetzero();
+	  sum_i = vsetzero();
+	  ww = wq + k * vnq;
+
+	  for (q = 0; q < nq; q += VREAL) {
+	    eval_r = vload(quad_r + q);
+	    eval_i = vload(quad_i + q);
+	    w = vload(ww + q);
+	    sum_r = vfmadd(w, eval_r, sum_r);
+	    sum_i = vfmadd(w, eval_i, sum_i);
+	  }
+
+	  val[k] = vreduce(sum_r) + vreduce(sum_i) * I;
+	}
+
+	if (c > 0 && sc != NULL) {
+	  insert_singcache(sc, key, 9, val);
+	}
+      }
+
+      vl_c = tl1_c->vl;
+      while (vl_c) {
+	j = vl_c->v;
+	assert(j < cols);
+	jj = ((cidx == NULL) ? j : cidx[j]);
+	for (k = 0; k < 3; ++k) {
+	  if (jj == tri_sp[k]) {
+	    vl_r = tl1_r->vl;
+	    while (vl_r) {
+	      i = vl_r->v;
+	      assert(i < rows);
+	      ii = ((ridx == NULL) ? i : ridx[i]);
+	      for (l = 0; l < 3; ++l) {
+		if (ii == tri_tp[l]) {
+		  res = base + val[l + k * 3];
+
+		  if (ntrans) {
+		    aa[j + i * ld] += CONJ(res) * factor2;
+		  }
+		  else {
+		    aa[i + j * ld] += res * factor2;
+		  }
+		}
+	      }
+	      vl_r = vl_r->next;
+	    }
+	  }
+	}
+	vl_c = vl_c->next;
+      }
+
+      if (bem->alpha != 0.0 && tt == ss) {
+	for (i = 0; i < 3; ++i) {
+	  tri_tp[i] = tri_t[i];
+	  tri_sp[i] = tri_s[i];
+	}
+
+	mass = bem->mass;
+	factor2 = bem->alpha * gr_g[tt];
+
+	vl_c = tl1_c->vl;
+	while (vl_c) {
+	  j = vl_c->v;
+	  assert(j < cols);
+	  jj = ((cidx == NULL) ? j : cidx[j]);
+	  for (k = 0; k < 3; ++k) {
+	    if (jj == tri_sp[k]) {
+	      vl_r = tl1_r->vl;
+	      while (vl_r) {
+		i = vl_r->v;
+		assert(i < rows);
+		ii = ((ridx == NULL) ? i : ridx[i]);
+		for (l = 0; l < 3; ++l) {
+		  if (ii == tri_tp[l]) {
+		    if (ntrans) {
+		      aa[j + i * ld] += CONJ(mass[l + k * 3] * factor2);
+		    }
+		    else {
+		      aa[i + j * ld] += mass[l + k * 3] * factor2;
+		    }
+		  }
+		}
+		vl_r = vl_r->next;
+	      }
+	    }
+	  }
+	  vl_c = vl_c->next;
+	}
+      }
+    }
+  }
+
+  del_tri_list(tl_r);
+  del_tri_list(tl_c);
+
+  freemem(quad_r);
+  freemem(quad_i);
+}
+
+void
+assemble_ll_simd_far_bem3d(const uint * ridx, const uint * cidx,
+			   pcbem3d bem, bool ntrans, pamatrix N,
+			   kernel_simd_func3d kernel)
+{
+  //TODO implement nice 'far' version
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, kernel);
+}
+
+void
+fill_row_simd_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
+		      pamatrix V, kernel_simd_func3d kernel)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const preal gr_g = (const preal) gr->g;
+  uint      rows = V->rows;
+  uint      cols = V->cols;
+  longindex ld = V->ld;
+
+  uint      nq = bem->sq->n_single;
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
+  real     *xq = bem->sq->x_single;
+  real     *yq = bem->sq->y_single;
+  real     *wq = bem->sq->w_single + 3 * vnq;
+  real      base = bem->sq->base_single;
+
+  const real *n;
+  const uint *tri_t;
+  const real *tri_tx, *tri_ty, *tri_tz;
+  bool      ptt;
+  uint      t, tt, i, j, q, remainder;
+  real      gt_fac;
+  field     sum;
+
+  vreal     vt[3][3], ct[3], x[3], z[3], nx[3];
+  vreal     tx, sx, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
+
+  c_one = vset1(1.0);
+
+  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+  if (nq % VREAL) {
+    for (q = 0; q < VREAL; ++q) {
+      vcount[q] = q;
+    }
+  }
+
+  for (t = 0; t < rows; ++t) {
+    tt = (idx == NULL ? t : idx[t]);
+    gt_fac = gr_g[tt] * bem->kernel_const;
+    tri_t = gr_t[tt];
+    ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+    n = gr_n[tt];
+
+    for (j = 0; j < 3; ++j) {
+      nx[j] = vset1(n[j]);
+    }
+
+    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+      for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	vt[i][j] = vload1(gr_x[tri_t[j]] + i);
+      }
+    }
+
+    for (i = 0; i < cols; ++i) {
+
+      sum = 0.0;
+
+      sum_r = vsetzero();
+      sum_i = vsetzero();
+
+      for (j = 0; j < 3; ++j) {
+	z[j] = vset1(Z[i][j]);
+      }
+
+      for (q = 0; q < nq; q += VREAL) {
+	w = vload(wq + q);
+
+	if (ptt) {
+	  x[0] = vload(tri_tx + q);
+	  x[1] = vload(tri_ty + q);
+	  x[2] = vload(tri_tz + q);
+	}
+	else {
+	  tx = vload(xq + q);
+	  sx = vload(yq + q);
+
+	  ct[0] = vsub(c_one, tx);
+	  ct[1] = vsub(tx, sx);
+	  ct[2] = sx;
+
+	  for (j = 0; j < 3; ++j) {
+	    x[j] = vdot3(vt[j], ct);
+	  }
+	}
+
+	kernel(x, z, nx, NULL, (void *) bem, &eval_r, &eval_i);
+
+	if (nq % VREAL && q >= remainder) {
+	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	  eval_r = vand(cmp, eval_r);
+	  eval_i = vand(cmp, eval_i);
+	}
+
+	sum_r = vfmadd(w, eval_r, sum_r);
+	sum_i = vfmadd(w, eval_i, sum_i);
+      }
+
+      sum =
+	((vreduce(sum_r) + base) * gt_fac) + (vreduce(sum_i) * gt_fac) * I;
+
+      V->a[t + i * ld] = sum;
+    }
+  }
+}
+
+void
+fill_col_simd_c_bem3d(const uint * idx, const real(*Z)[3], pcbem3d bem,
+		      pamatrix V, kernel_simd_func3d kernel)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const preal gr_g = (const preal) gr->g;
+  uint      rows = V->rows;
+  uint      cols = V->cols;
+  longindex ld = V->ld;
+
+  uint      nq = bem->sq->n_single;
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
+  real     *xq = bem->sq->x_single;
+  real     *yq = bem->sq->y_single;
+  real     *wq = bem->sq->w_single + 3 * vnq;
+  real      base = bem->sq->base_single;
+
+  const real *n;
+  const uint *tri_s;
+  const real *tri_sx, *tri_sy, *tri_sz;
+  bool      pts;
+  uint      s, ss, i, j, q, remainder;
+  real      gs_fac;
+  field     sum;
+
+  vreal     vs[3][3], cs[3], y[3], z[3], ny[3];
+  vreal     ty, sy, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
+
+  c_one = vset1(1.0);
+
+  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+  if (nq % VREAL) {
+    for (q = 0; q < VREAL; ++q) {
+      vcount[q] = q;
+    }
+  }
+
+  for (s = 0; s < rows; ++s) {
+    ss = (idx == NULL ? s : idx[s]);
+    gs_fac = gr_g[ss] * bem->kernel_const;
+    tri_s = gr_t[ss];
+    pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+    n = gr_n[ss];
+
+    for (j = 0; j < 3; ++j) {
+      ny[j] = vset1(n[j]);
+    }
+
+    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+      for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	vs[i][j] = vload1(gr_x[tri_s[j]] + i);
+      }
+    }
+
+    for (i = 0; i < cols; ++i) {
+
+      sum = 0.0;
+
+      sum_r = vsetzero();
+      sum_i = vsetzero();
+
+      for (j = 0; j < 3; ++j) {
+	z[j] = vset1(Z[i][j]);
+      }
+
+      for (q = 0; q < nq; q += VREAL) {
+	w = vload(wq + q);
+
+	if (pts) {
+	  y[0] = vload(tri_sx + q);
+	  y[1] = vload(tri_sy + q);
+	  y[2] = vload(tri_sz + q);
+	}
+	else {
+	  ty = vload(xq + q);
+	  sy = vload(yq + q);
+
+	  cs[0] = vsub(c_one, ty);
+	  cs[1] = vsub(ty, sy);
+	  cs[2] = sy;
+
+	  for (j = 0; j < 3; ++j) {
+	    y[j] = vdot3(vs[j], cs);
+	  }
+	}
+
+	kernel(z, y, NULL, ny, (void *) bem, &eval_r, &eval_i);
+
+	if (nq % VREAL && q >= remainder) {
+	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	  eval_r = vand(cmp, eval_r);
+	  eval_i = vand(cmp, eval_i);
+	}
+
+	sum_r = vfmadd(w, eval_r, sum_r);
+	sum_i = vfmadd(w, eval_i, sum_i);
+      }
+
+      sum =
+	((vreduce(sum_r) + base) * gs_fac) + (vreduce(sum_i) * gs_fac) * I;
+
+      V->a[s + i * ld] = sum;
+    }
+  }
+}
+
+void
+fill_dnz_row_simd_c_bem3d(const uint * idx, const real(*Z)[3],
+			  const real(*N)[3], pcbem3d bem, pamatrix V,
+			  kernel_simd_func3d kernel)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const preal gr_g = (const preal) gr->g;
+  uint      rows = V->rows;
+  uint      cols = V->cols;
+  longindex ld = V->ld;
+
+  uint      nq = bem->sq->n_single;
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
+  real     *xq = bem->sq->x_single;
+  real     *yq = bem->sq->y_single;
+  real     *wq = bem->sq->w_single + 3 * vnq;
+  real      base = bem->sq->base_single;
+
+  const real *n;
+  const uint *tri_t;
+  const real *tri_tx, *tri_ty, *tri_tz;
+  bool      ptt;
+  uint      t, tt, i, j, q, remainder;
+  real      gt_fac;
+  field     sum;
+
+  vreal     vt[3][3], ct[3], x[3], z[3], nx[3], nz[3];
+  vreal     tx, sx, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
+
+  c_one = vset1(1.0);
+
+  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+  if (nq % VREAL) {
+    for (q = 0; q < VREAL; ++q) {
+      vcount[q] = q;
+    }
+  }
+
+  for (t = 0; t < rows; ++t) {
+    tt = (idx == NULL ? t : idx[t]);
+    gt_fac = gr_g[tt] * bem->kernel_const;
+    tri_t = gr_t[tt];
+    ptt = get_triquadpoints_bem3d(bem, tt, &tri_tx, &tri_ty, &tri_tz);
+    n = gr_n[tt];
+
+    for (j = 0; j < 3; ++j) {
+      nx[j] = vset1(n[j]);
+    }
+
+    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+      for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	vt[i][j] = vload1(gr_x[tri_t[j]] + i);
+      }
+    }
+
+    for (i = 0; i < cols; ++i) {
+
+      sum = 0.0;
+
+      sum_r = vsetzero();
+      sum_i = vsetzero();
+
+      for (j = 0; j < 3; ++j) {
+	z[j] = vset1(Z[i][j]);
+	nz[j] = vset1(N[i][j]);
+      }
+
+      for (q = 0; q < nq; q += VREAL) {
+	w = vload(wq + q);
+
+	if (ptt) {
+	  x[0] = vload(tri_tx + q);
+	  x[1] = vload(tri_ty + q);
+	  x[2] = vload(tri_tz + q);
+	}
+	else {
+	  tx = vload(xq + q);
+	  sx = vload(yq + q);
+
+	  ct[0] = vsub(c_one, tx);
+	  ct[1] = vsub(tx, sx);
+	  ct[2] = sx;
+
+	  for (j = 0; j < 3; ++j) {
+	    x[j] = vdot3(vt[j], ct);
+	  }
+	}
+
+	kernel(x, z, nx, nz, (void *) bem, &eval_r, &eval_i);
+
+	if (nq % VREAL && q >= remainder) {
+	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	  eval_r = vand(cmp, eval_r);
+	  eval_i = vand(cmp, eval_i);
+	}
+
+	sum_r = vfmadd(w, eval_r, sum_r);
+	sum_i = vfmadd(w, eval_i, sum_i);
+      }
+
+      sum =
+	((vreduce(sum_r) + base) * gt_fac) + (vreduce(sum_i) * gt_fac) * I;
+
+      V->a[t + i * ld] = sum;
+    }
+  }
+}
+
+void
+fill_dnz_col_simd_c_bem3d(const uint * idx, const real(*Z)[3],
+			  const real(*N)[3], pcbem3d bem, pamatrix V,
+			  kernel_simd_func3d kernel)
+{
+  pcsurface3d gr = bem->gr;
+  const     real(*gr_x)[3] = (const real(*)[3]) gr->x;
+  const     uint(*gr_t)[3] = (const uint(*)[3]) gr->t;
+  const     real(*gr_n)[3] = (const real(*)[3]) gr->n;
+  const preal gr_g = (const preal) gr->g;
+  uint      rows = V->rows;
+  uint      cols = V->cols;
+  longindex ld = V->ld;
+
+  uint      nq = bem->sq->n_single;
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
+  real     *xq = bem->sq->x_single;
+  real     *yq = bem->sq->y_single;
+  real     *wq = bem->sq->w_single + 3 * vnq;
+  real      base = bem->sq->base_single;
+
+  const real *n;
+  const uint *tri_s;
+  const real *tri_sx, *tri_sy, *tri_sz;
+  bool      pts;
+  uint      s, ss, i, j, q, remainder;
+  real      gs_fac;
+  field     sum;
+
+  vreal     vs[3][3], cs[3], y[3], z[3], ny[3], nz[3];
+  vreal     ty, sy, w, c_one, eval_r, eval_i, sum_r, sum_i, cmp, vcount;
+
+  c_one = vset1(1.0);
+
+  remainder = ROUNDUP(nq, VREAL) - VREAL;
+
+  if (nq % VREAL) {
+    for (q = 0; q < VREAL; ++q) {
+      vcount[q] = q;
+    }
+  }
+
+  for (s = 0; s < rows; ++s) {
+    ss = (idx == NULL ? s : idx[s]);
+    gs_fac = gr_g[ss] * bem->kernel_const;
+    tri_s = gr_t[ss];
+    pts = get_triquadpoints_bem3d(bem, ss, &tri_sx, &tri_sy, &tri_sz);
+    n = gr_n[ss];
+
+    for (j = 0; j < 3; ++j) {
+      ny[j] = vset1(n[j]);
+    }
+
+    for (i = 0; i < 3; ++i) {	// x-, y-, z- component
+      for (j = 0; j < 3; ++j) {	// vertex A, B, C
+	vs[i][j] = vload1(gr_x[tri_s[j]] + i);
+      }
+    }
+
+    for (i = 0; i < cols; ++i) {
+
+      sum = 0.0;
+
+      sum_r = vsetzero();
+      sum_i = vsetzero();
+
+      for (j = 0; j < 3; ++j) {
+	z[j] = vset1(Z[i][j]);
+	nz[j] = vset1(N[i][j]);
+      }
+
+      for (q = 0; q < nq; q += VREAL) {
+	w = vload(wq + q);
+
+	if (pts) {
+	  y[0] = vload(tri_sx + q);
+	  y[1] = vload(tri_sy + q);
+	  y[2] = vload(tri_sz + q);
+	}
+	else {
+	  ty = vload(xq + q);
+	  sy = vload(yq + q);
+
+	  cs[0] = vsub(c_one, ty);
+	  cs[1] = vsub(ty, sy);
+	  cs[2] = sy;
+
+	  for (j = 0; j < 3; ++j) {
+	    y[j] = vdot3(vs[j], cs);
+	  }
+	}
+
+	kernel(z, y, nz, ny, (void *) bem, &eval_r, &eval_i);
+
+	if (nq % VREAL && q >= remainder) {
+	  cmp = vcmplt(vadd(vcount, vset1((real) q)), vset1((real) nq));
+	  eval_r = vand(cmp, eval_r);
+	  eval_i = vand(cmp, eval_i);
+	}
+
+	sum_r = vfmadd(w, eval_r, sum_r);
+	sum_i = vfmadd(w, eval_i, sum_i);
+      }
+
+      sum =
+	((vreduce(sum_r) + base) * gs_fac) + (vreduce(sum_i) * gs_fac) * I;
+
+      V->a[s + i * ld] = sum;
+    }
+  }
+}
@@ -0,0 +1,151 @@
+/* ------------------------------------------------------------
+ This is the file "bem3d_simd.h" of the H2Lib package.
+ All rights reserved, Sven Christophersen 2011
+ ------------------------------------------------------------ */
+
+/**
+ * @file bem3d_simd.h
+ * @author Sven Christophersen
+ * @date 2011
+ *
+ * SIMD versions of the assembly routines of @ref bem3d.h.
+ *
+ * This header may only be included by files that are compiled once for
+ * every instruction set listed in <tt>SIMD_ISAS</tt>, e.g.,
+ * bem3d_simd.c, laplacebem3d_simd.c and helmholtzbem3d_simd.c.
+ * The vector type @ref vreal depends on the instruction set, so every
+ * routine is renamed by <tt>SIMD_NAME</tt> and the instances for
+ * different instruction sets can be linked into the same library.
+ * Routines compiled for other instruction sets are called via
+ * @ref SIMD_CALL.
+ */
+
+#ifndef BEM3D_SIMD_H_
+#define BEM3D_SIMD_H_
+
+#ifdef USE_SIMD
+
+/* CORE 0 */
+#include "simd.h"
+/* BEM */
+#include "bem3d.h"
+
+/* ------------------------------------------------------------
+ * Instruction set specific names
+ * ------------------------------------------------------------ */
+
+#define assemble_cc_simd_near_bem3d SIMD_NAME(assemble_cc_simd_near_bem3d)
+#define assemble_cc_simd_sweep_near_bem3d \
+  SIMD_NAME(assemble_cc_simd_sweep_near_bem3d)
+#define assemble_cc_simd_far_bem3d SIMD_NAME(assemble_cc_simd_far_bem3d)
+#define assemble_cl_simd_near_bem3d SIMD_NAME(assemble_cl_simd_near_bem3d)
+#define assemble_cl_simd_far_bem3d SIMD_NAME(assemble_cl_simd_far_bem3d)
+#define assemble_lc_simd_near_bem3d SIMD_NAME(assemble_lc_simd_near_bem3d)
+#define assemble_lc_simd_far_bem3d SIMD_NAME(assemble_lc_simd_far_bem3d)
+#define assemble_ll_simd_near_bem3d SIMD_NAME(assemble_ll_simd_near_bem3d)
+#define assemble_ll_simd_far_bem3d SIMD_NAME(assemble_ll_simd_far_bem3d)
+#define fill_row_simd_c_bem3d SIMD_NAME(fill_row_simd_c_bem3d)
+#define fill_col_simd_c_bem3d SIMD_NAME(fill_col_simd_c_bem3d)
+#define fill_dnz_row_simd_c_bem3d SIMD_NAME(fill_dnz_row_simd_c_bem3d)
+#define fill_dnz_col_simd_c_bem3d SIMD_NAME(fill_dnz_col_simd_c_bem3d)
+
+/* ------------------------------------------------------------
+ * Kernel functions
+ * ------------------------------------------------------------ */
+
+/**
+ * @brief Evaluate a kernel function for <tt>VREAL</tt> pairs of points.
+ *
+ * SIMD version of @ref kernel_func3d, real and imaginary parts of the
+ * results are returned separately.
+ */
+typedef void (*kernel_simd_func3d)(const vreal *x, const vreal *y,
+    const vreal *nx, const vreal *ny, void *data, vreal *res_re, vreal *res_im);
+
+/**
+ * @brief SIMD version of @ref kernel_wave_func3d.
+ */
+typedef void (*kernel_simd_wave_func3d)(const vreal *x, const vreal *y,
+    const vreal *nx, const vreal *ny, pcreal dir, void *data, vreal *res_re,
+    vreal *res_im);
+
+/**
+ * @brief SIMD version of @ref kernel_sweep_func3d.
+ */
+typedef void (*kernel_simd_sweep_func3d)(const vreal *x, const vreal *y,
+    const vreal *nx, const vreal *ny, void *data, uint m, vreal *res_re,
+    vreal *res_im);
+
+/* ------------------------------------------------------------
+ * Nearfield and farfield integration
+ * ------------------------------------------------------------ */
+
+/** @brief SIMD version of @ref assemble_cc_near_bem3d. */
+HEADER_PREFIX void
+assemble_cc_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_cc_sweep_near_bem3d. */
+HEADER_PREFIX void
+assemble_cc_simd_sweep_near_bem3d(const uint * ridx, const uint * cidx,
+    pcbem3d bem, bool ntrans, uint m, pamatrix *N, const field *alpha,
+    kernel_simd_sweep_func3d kernel, void *data);
+
+/** @brief SIMD version of @ref assemble_cc_far_bem3d. */
+HEADER_PREFIX void
+assemble_cc_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_cl_near_bem3d. */
+HEADER_PREFIX void
+assemble_cl_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_cl_far_bem3d. */
+HEADER_PREFIX void
+assemble_cl_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_lc_near_bem3d. */
+HEADER_PREFIX void
+assemble_lc_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_lc_far_bem3d. */
+HEADER_PREFIX void
+assemble_lc_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_ll_near_bem3d. */
+HEADER_PREFIX void
+assemble_ll_simd_near_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref assemble_ll_far_bem3d. */
+HEADER_PREFIX void
+assemble_ll_simd_far_bem3d(const uint * ridx, const uint * cidx, pcbem3d bem,
+    bool ntrans, pamatrix N, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref fill_row_c_bem3d. */
+HEADER_PREFIX void
+fill_row_simd_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem,
+    pamatrix V, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref fill_col_c_bem3d. */
+HEADER_PREFIX void
+fill_col_simd_c_bem3d(const uint * idx, const real (*Z)[3], pcbem3d bem,
+    pamatrix V, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref fill_dnz_row_c_bem3d. */
+HEADER_PREFIX void
+fill_dnz_row_simd_c_bem3d(const uint * idx, const real (*Z)[3],
+    const real (*N)[3], pcbem3d bem, pamatrix V, kernel_simd_func3d kernel);
+
+/** @brief SIMD version of @ref fill_dnz_col_c_bem3d. */
+HEADER_PREFIX void
+fill_dnz_col_simd_c_bem3d(const uint * idx, const real (*Z)[3],
+    const real (*N)[3], pcbem3d bem, pamatrix V, kernel_simd_func3d kernel);
+
+#endif
+
+#endif /* BEM3D_SIMD_H_ */
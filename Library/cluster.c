@@ -1377,3 +1377,70 @@ read_cdfpart_cluster(int nc_file, const char *prefix)
   return t;
 }
 #endif
+
+static void
+write_mmap_part(pccluster t, const uint * idx, pmmapfile mf)
+{
+  uint      i;
+
+  assert(t->idx >= idx);
+
+  write_uint_mmapfile(mf, t->size);
+  write_uint_mmapfile(mf, (uint) (t->idx - idx));
+  write_uint_mmapfile(mf, t->sons);
+  write_uint_mmapfile(mf, t->dim);
+  write_uint_mmapfile(mf, t->type);
+  write_reals_mmapfile(mf, t->dim, t->bmin);
+  write_reals_mmapfile(mf, t->dim, t->bmax);
+
+  for (i = 0; i < t->sons; i++)
+    write_mmap_part(t->son[i], idx, mf);
+}
+
+void
+write_mmappart_cluster(pccluster t, pmmapfile mf)
+{
+  write_uint_mmapfile(mf, t->size);
+  write_uints_mmapfile(mf, t->size, t->idx);
+
+  write_mmap_part(t, t->idx, mf);
+}
+
+static pcluster
+read_mmap_part(pmmapfile mf, uint * idx, uint totalsize)
+{
+  pcluster  t;
+  uint      size, off, sons, dim;
+  uint      i;
+
+  size = read_uint_mmapfile(mf);
+  off = read_uint_mmapfile(mf);
+  sons = read_uint_mmapfile(mf);
+  dim = read_uint_mmapfile(mf);
+  assert(off + size <= totalsize);
+
+  t = new_cluster(size, idx + off, sons, dim);
+  t->type = read_uint_mmapfile(mf);
+  read_reals_mmapfile(mf, dim, t->bmin);
+  read_reals_mmapfile(mf, dim, t->bmax);
+
+  for (i = 0; i < sons; i++)
+    t->son[i] = read_mmap_part(mf, idx, totalsize);
+
+  update_cluster(t);
+
+  return t;
+}
+
+pcluster
+read_mmappart_cluster(pmmapfile mf)
+{
+  const uint *idx;
+  uint      size;
+
+  size = read_uint_mmapfile(mf);
+  idx = read_uints_mmapfile(mf, size);
+
+  /* The cluster tree is read-only, see read_mmapcomplete_hmatrix */
+  return read_mmap_part(mf, (uint *) idx, size);
+}
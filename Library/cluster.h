@@ -29,6 +29,7 @@ typedef const cluster *pccluster;
 
 #include "settings.h"
 #include "clustergeometry.h"
+#include "mmapfile.h"
 
 /** @brief Representation of cluster trees.
  * 
@@ -484,6 +485,23 @@ HEADER_PREFIX pcluster
 read_cdfpart_cluster(int nc_file, const char *prefix);
 #endif
 
+/** @brief Write @ref cluster to a binary container file.
+ *
+ *  @param t Cluster.
+ *  @param mf Binary container file opened by @ref create_mmapfile. */
+HEADER_PREFIX void
+write_mmappart_cluster(pccluster t, pmmapfile mf);
+
+/** @brief Read @ref cluster from a binary container file.
+ *
+ *  The index array of the cluster tree points into the mapping
+ *  and must not be released by the caller.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @returns @ref cluster read from file. */
+HEADER_PREFIX pcluster
+read_mmappart_cluster(pmmapfile mf);
+
 /** @}*/
 
 #endif
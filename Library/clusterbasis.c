@@ -40,6 +40,9 @@ init_raw_clusterbasis(pclusterbasis cb, pccluster t)
 
   cb->Z = NULL;
 
+  cb->kfactors = 0;
+  cb->F = NULL;
+
 #ifdef USE_OPENMP
 #pragma omp atomic
 #endif
@@ -109,6 +112,8 @@ uninit_clusterbasis(pclusterbasis cb)
     freemem(cb->son);
   }
 
+  clearkronecker_clusterbasis(cb);
+
   uninit_amatrix(&cb->V);
   uninit_amatrix(&cb->E);
 
@@ -230,12 +235,15 @@ setrank_clusterbasis(pclusterbasis cb, uint k)
   uint      i;
 
   if (cb->sons > 0) {
-    for (i = 0; i < cb->sons; i++)
+    for (i = 0; i < cb->sons; i++) {
+      clearkronecker_clusterbasis(cb->son[i]);
       resize_amatrix(&cb->son[i]->E, cb->son[i]->k, k);
+    }
   }
   else
     resize_amatrix(&cb->V, cb->t->size, k);
 
+  clearkronecker_clusterbasis(cb);
   resize_amatrix(&cb->E, k, cb->E.cols);
 
   cb->k = k;
@@ -243,6 +251,50 @@ setrank_clusterbasis(pclusterbasis cb, uint k)
   update_clusterbasis(cb);
 }
 
+pamatrix
+setkronecker_clusterbasis(pclusterbasis cb, uint d,
+			  const uint *rows, const uint *cols)
+{
+  uint      i;
+#ifndef NDEBUG
+  uint      r, c;
+#endif
+
+  clearkronecker_clusterbasis(cb);
+
+#ifndef NDEBUG
+  r = c = 1;
+  for (i = 0; i < d; i++) {
+    r *= rows[i];
+    c *= cols[i];
+  }
+  assert(r == cb->E.rows);
+  assert(c == cb->E.cols);
+#endif
+
+  cb->F = (pamatrix) allocmem(sizeof(amatrix) * d);
+  for (i = 0; i < d; i++)
+    init_amatrix(cb->F + i, rows[i], cols[i]);
+  cb->kfactors = d;
+
+  return cb->F;
+}
+
+void
+clearkronecker_clusterbasis(pclusterbasis cb)
+{
+  uint      i;
+
+  if (cb->F) {
+    for (i = 0; i < cb->kfactors; i++)
+      uninit_amatrix(cb->F + i);
+    freemem(cb->F);
+  }
+
+  cb->kfactors = 0;
+  cb->F = NULL;
+}
+
 /* ------------------------------------------------------------
  * Build clusterbasis based on cluster
  * ------------------------------------------------------------ */
@@ -351,6 +403,8 @@ getsize_clusterbasis(pcclusterbasis cb)
   sz = (size_t) sizeof(clusterbasis);
   sz += getsize_heap_amatrix(&cb->V);
   sz += getsize_heap_amatrix(&cb->E);
+  for (i = 0; i < cb->kfactors; i++)
+    sz += getsize_amatrix(cb->F + i);
 
   if (cb->sons > 0) {
     sz += (size_t) sizeof(pclusterbasis) * cb->sons;
@@ -520,6 +574,83 @@ new_coeffs_clusterbasis_avector(pcclusterbasis cb)
   return xt;
 }
 
+/* Multiply by the transfer matrix E of cb or its adjoint,
+ * using the Kronecker factors if they are available */
+static void
+addeval_transfer(field alpha, bool trans, pcclusterbasis cb,
+		 pcavector x, pavector y)
+{
+  const uint d = cb->kfactors;
+  pcamatrix F;
+  amatrix   tmp1, tmp2;
+  pamatrix  Xin, Yout;
+  pfield    buf[2], src, dst;
+  size_t    bufsize, size;
+  uint      pre, post, rows, cols;
+  uint      i, p, b;
+
+  if (d == 0) {
+    if (trans)
+      addevaltrans_amatrix_avector(alpha, &cb->E, x, y);
+    else
+      addeval_amatrix_avector(alpha, &cb->E, x, y);
+    return;
+  }
+
+  if (cb->E.rows == 0 || cb->E.cols == 0)
+    return;
+
+  /* Like the full matrix, only the leading entries of x and y are used */
+  assert(x->dim >= (trans ? cb->E.rows : cb->E.cols));
+  assert(y->dim >= (trans ? cb->E.cols : cb->E.rows));
+
+  /* The intermediate tensors contain the transformed indices for the
+   * first factors and the original indices for the remaining ones */
+  bufsize = 1;
+  for (i = 0; i < d; i++)
+    bufsize *= UINT_MAX(cb->F[i].rows, cb->F[i].cols);
+  buf[0] = allocfield(bufsize);
+  buf[1] = allocfield(bufsize);
+
+  size = (trans ? cb->E.rows : cb->E.cols);
+  src = x->v;
+  b = 0;
+  pre = 1;
+  for (i = 0; i < d; i++) {
+    F = cb->F + i;
+    rows = (trans ? F->cols : F->rows);
+    cols = (trans ? F->rows : F->cols);
+    post = size / (pre * cols);
+    assert(pre * cols * post == size);
+
+    /* Apply the i-th factor along the i-th index,
+     * Y_p = X_p F^T for all p */
+    dst = buf[b];
+    for (p = 0; p < post; p++) {
+      Xin = init_pointer_amatrix(&tmp1, src + (size_t) pre * cols * p,
+				 pre, cols);
+      Yout = init_pointer_amatrix(&tmp2, dst + (size_t) pre * rows * p,
+				  pre, rows);
+      clear_amatrix(Yout);
+      addmul_amatrix(1.0, false, Xin, !trans, F, Yout);
+      uninit_amatrix(Yout);
+      uninit_amatrix(Xin);
+    }
+
+    size = (size_t) pre * rows * post;
+    pre *= rows;
+    src = dst;
+    b = 1 - b;
+  }
+  assert(size == (trans ? cb->E.cols : cb->E.rows));
+
+  for (i = 0; i < size; i++)
+    y->v[i] += alpha * src[i];
+
+  freemem(buf[1]);
+  freemem(buf[0]);
+}
+
 void
 forward_clusterbasis_avector(pcclusterbasis cb, pcavector x, pavector xt)
 {
@@ -546,7 +677,7 @@ forward_clusterbasis_avector(pcclusterbasis cb, pcavector x, pavector xt)
       forward_clusterbasis_avector(cb->son[i], x, xt1);
 
       /* Multiply by transfer matrix */
-      mvm_amatrix_avector(1.0, true, &cb->son[i]->E, xt1, xc);
+      addeval_transfer(1.0, true, cb->son[i], xt1, xc);
 
       uninit_avector(xt1);
 
@@ -609,7 +740,7 @@ forward_parallel_clusterbasis_avector(pcclusterbasis cb, pcavector x,
 					     0 ? pardepth - 1 : 0));
 
     for (i = 0; i < cb->sons; i++) {
-      mvm_amatrix_avector(1.0, true, &cb->son[i]->E, xt1[i], xc);
+      addeval_transfer(1.0, true, cb->son[i], xt1[i], xc);
 
       del_avector(xt1[i]);
     }
@@ -657,7 +788,7 @@ forward_nopermutation_clusterbasis_avector(pcclusterbasis cb, pcavector xp,
       uninit_avector(xp1);
 
       xt1 = init_sub_avector(&loc3, xt, cb->son[i]->k, xtoff);
-      addevaltrans_amatrix_avector(1.0, &cb->son[i]->E, xt1, xc);
+      addeval_transfer(1.0, true, cb->son[i], xt1, xc);
       uninit_avector(xt1);
 
       xpoff += cb->t->son[i]->size;
@@ -767,7 +898,7 @@ backward_clusterbasis_avector(pcclusterbasis cb, pavector yt, pavector y)
       yt1 = init_sub_avector(&loc2, yt, cb->son[i]->ktree, ytoff);
 
       /* Multiply by transfer matrix */
-      mvm_amatrix_avector(1.0, false, &cb->son[i]->E, yc, yt1);
+      addeval_transfer(1.0, false, cb->son[i], yc, yt1);
 
       /* Treat coefficients in the subtree */
       backward_clusterbasis_avector(cb->son[i], yt1, y);
@@ -827,7 +958,7 @@ backward_parallel_clusterbasis_avector(pcclusterbasis cb, pavector yt,
 #pragma omp parallel for if(pardepth>0), num_threads(nthreads)
 #endif
     for (i = 0; i < cb->sons; i++) {
-      mvm_amatrix_avector(1.0, false, &cb->son[i]->E, yc, yt1[i]);
+      addeval_transfer(1.0, false, cb->son[i], yc, yt1[i]);
 
       backward_parallel_clusterbasis_avector(cb->son[i], yt1[i], y,
 					     (pardepth >
@@ -869,7 +1000,7 @@ backward_nopermutation_clusterbasis_avector(pcclusterbasis cb, pavector yt,
     ytoff = cb->k;
     for (i = 0; i < cb->sons; i++) {
       yt1 = init_sub_avector(&loc3, yt, cb->son[i]->k, ytoff);
-      addeval_amatrix_avector(1.0, &cb->son[i]->E, yc, yt1);
+      addeval_transfer(1.0, false, cb->son[i], yc, yt1);
       uninit_avector(yt1);
 
       yp1 = init_sub_avector(&loc2, yp, cb->t->son[i]->size, ypoff);
@@ -992,7 +1123,7 @@ compress_clusterbasis_avector(pcclusterbasis cb, pcavector xp, pavector xt)
       compress_clusterbasis_avector(cb->son[i], xp1, xt1);
 
       /* Multiply by transfer matrix */
-      mvm_amatrix_avector(1.0, true, &cb->son[i]->E, xt1, xc);
+      addeval_transfer(1.0, true, cb->son[i], xt1, xc);
 
       uninit_avector(xp1);
       uninit_avector(xt1);
@@ -1028,7 +1159,7 @@ expand_clusterbasis_avector(pcclusterbasis cb, pavector yt, pavector yp)
       clear_avector(yt1);
 
       /* Multiply by transfer matrix */
-      mvm_amatrix_avector(1.0, false, &cb->son[i]->E, yc, yt1);
+      addeval_transfer(1.0, false, cb->son[i], yc, yt1);
       uninit_avector(yt1);
 
       /* These parts correspond to the subtree rooted in the i-th son */
@@ -1447,7 +1578,7 @@ addeval_clusterbasis_avector(field alpha, pcclusterbasis cb,
      for (i = 0; i < cb->sons; i++) {
      x1 = init_avector(&tmp1, cb->son[i]->k);
      clear_avector(x1);
-     addeval_amatrix_avector(1.0, &cb->son[i]->E, x, x1);
+     addeval_transfer(1.0, false, cb->son[i], x, x1);
      y1 = init_sub_avector(&tmp2, y, cb->son[i]->t->size, off);
      addeval_clusterbasis_avector(cb->son[i], x1, y1);
      uninit_avector(x1);
@@ -1497,7 +1628,7 @@ addevaltrans_clusterbasis_avector(field alpha, pcclusterbasis cb,
      y1 = init_avector(&tmp2, cb->son[i]->k);
      clear_avector(y1);
      addevaltrans_clusterbasis_avector(cb->son[i], x1, y1);
-     addevaltrans_amatrix_avector(1.0, &cb->son[i]->E, y1, y);
+     addeval_transfer(1.0, true, cb->son[i], y1, y);
      uninit_avector(x1);
      uninit_avector(y1);
      off += cb->son[i]->t->size;
@@ -2416,3 +2547,56 @@ read_cdfpart_clusterbasis(int nc_file, const char *prefix, pccluster t)
   return cb;
 }
 #endif
+
+void
+write_mmappart_clusterbasis(pcclusterbasis cb, pmmapfile mf)
+{
+  uint      i;
+
+  write_uint_mmapfile(mf, cb->k);
+  write_uint_mmapfile(mf, cb->sons);
+  write_amatrix_mmapfile(mf, &cb->V);
+  write_amatrix_mmapfile(mf, &cb->E);
+
+  for (i = 0; i < cb->sons; i++)
+    write_mmappart_clusterbasis(cb->son[i], mf);
+}
+
+pclusterbasis
+read_mmappart_clusterbasis(pmmapfile mf, pccluster t)
+{
+  pclusterbasis cb, cb1;
+  uint      k, sons;
+  uint      i;
+
+  k = read_uint_mmapfile(mf);
+  sons = read_uint_mmapfile(mf);
+
+  if (sons > 0) {
+    assert(t->sons == sons);
+    cb = new_clusterbasis(t);
+  }
+  else
+    cb = new_leaf_clusterbasis(t);
+
+  cb->k = k;
+
+  uninit_amatrix(&cb->V);
+  read_amatrix_mmapfile(mf, &cb->V);
+  assert(sons > 0 || cb->V.rows == t->size);
+  assert(sons > 0 || cb->V.cols == k);
+
+  uninit_amatrix(&cb->E);
+  read_amatrix_mmapfile(mf, &cb->E);
+
+  for (i = 0; i < sons; i++) {
+    cb1 = read_mmappart_clusterbasis(mf, t->son[i]);
+    assert(cb1->E.rows == cb1->k);
+    assert(cb1->E.cols == k);
+    ref_clusterbasis(cb->son + i, cb1);
+  }
+
+  update_clusterbasis(cb);
+
+  return cb;
+}
@@ -35,6 +35,7 @@ typedef const clusterbasis *pcclusterbasis;
 #include "clusteroperator.h"
 #include "uniform.h"
 #include "amatrix.h"
+#include "mmapfile.h"
 
 /** @brief Representation of a cluster basis. */
 struct _clusterbasis {
@@ -52,6 +53,13 @@ struct _clusterbasis {
   amatrix V;
   /** @brief Transfer matrix @f$E_t@f$ to father */
   amatrix E;
+  /** @brief Number of Kronecker factors of @f$E_t@f$, zero if
+   *  <tt>E</tt> is only available as a full matrix */
+  uint kfactors;
+  /** @brief Kronecker factors @f$F_0,\ldots,F_{d-1}@f$ with
+   *  @f$E_t = F_{d-1} \otimes \cdots \otimes F_0@f$, used by the
+   *  forward and backward transformations of vectors */
+  pamatrix F;
 
   /** @brief Number of sons, either <tt>t->sons</tt> or zero */
   uint sons;
@@ -247,6 +255,8 @@ resize_clusterbasis(pclusterbasis cb, uint k);
  *  <tt>cb->V</tt> and <tt>cb->E</tt>, as well as <tt>cb->son[i]->E</tt>
  *  for all sons.
  *
+ *  Kronecker factors of these transfer matrices are discarded.
+ *
  *  @remark In typical algorithms, the transfer matrices of the sons
  *  and the leaf matrix will subsequently be set to new values.
  *  In order to keep the basis consistent, it is frequently advisable
@@ -259,6 +269,40 @@ resize_clusterbasis(pclusterbasis cb, uint k);
 HEADER_PREFIX void
 setrank_clusterbasis(pclusterbasis cb, uint k);
 
+/** @brief Prepare Kronecker factors of the transfer matrix
+ *  <tt>cb->E</tt>.
+ *
+ *  Allocates matrices @f$F_0,\ldots,F_{d-1}@f$ of dimensions
+ *  <tt>rows[i]</tt> times <tt>cols[i]</tt> that have to be filled
+ *  by the caller such that
+ *  @f$E_t = F_{d-1} \otimes \cdots \otimes F_0@f$, where the first
+ *  factor corresponds to the fastest running index.
+ *  Tensor interpolation yields transfer matrices of this form, and
+ *  applying the factors dimension by dimension reduces the cost
+ *  of the forward and backward transformations of vectors
+ *  from @f$k^2@f$ to about @f$d k^{1+1/d}@f$.
+ *
+ *  @remark <tt>cb->E</tt> has to be set up as well, since most
+ *  algorithms only use the full matrix.
+ *
+ *  @param cb Cluster basis.
+ *  @param d Number of factors.
+ *  @param rows Numbers of rows of the factors, their product has to
+ *         equal <tt>cb->E.rows</tt>.
+ *  @param cols Numbers of columns of the factors, their product has to
+ *         equal <tt>cb->E.cols</tt>.
+ *  @returns Array of <tt>d</tt> factors. */
+HEADER_PREFIX pamatrix
+setkronecker_clusterbasis(pclusterbasis cb, uint d,
+			  const uint *rows, const uint *cols);
+
+/** @brief Discard the Kronecker factors of the transfer matrix
+ *  <tt>cb->E</tt>.
+ *
+ *  @param cb Cluster basis. */
+HEADER_PREFIX void
+clearkronecker_clusterbasis(pclusterbasis cb);
+
 /* ------------------------------------------------------------
  * Build clusterbasis based on cluster
  * ------------------------------------------------------------ */
@@ -869,6 +913,25 @@ HEADER_PREFIX pclusterbasis
 read_cdfpart_clusterbasis(int nc_file, const char *prefix, pccluster t);
 #endif
 
+/** @brief Write @ref clusterbasis to a binary container file.
+ *
+ *  @param cb Cluster basis.
+ *  @param mf Binary container file opened by @ref create_mmapfile. */
+HEADER_PREFIX void
+write_mmappart_clusterbasis(pcclusterbasis cb, pmmapfile mf);
+
+/** @brief Read @ref clusterbasis from a binary container file.
+ *
+ *  The leaf and transfer matrices point into the mapping of
+ *  <tt>mf</tt>, so the cluster basis is read-only and has to be
+ *  deleted before the file is closed.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @param t Root @ref cluster for cluster basis.
+ *  @returns Cluster basis read from file. */
+HEADER_PREFIX pclusterbasis
+read_mmappart_clusterbasis(pmmapfile mf, pccluster t);
+
 #endif
 
 /* ------------------------------------------------------------
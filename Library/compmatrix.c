@@ -0,0 +1,243 @@
+/* ------------------------------------------------------------
+ * This is the file "compmatrix.c" of the H2Lib package.
+ * All rights reserved, Steffen Boerm 2026
+ * ------------------------------------------------------------ */
+
+#include "compmatrix.h"
+
+#include "basic.h"
+
+/* Largest integer used by the fixed-point format */
+#define FIXED16_MAX 32767
+
+/* Number of integers per coefficient in the fixed-point format */
+#ifdef USE_COMPLEX
+#define FIXED16_PARTS 2
+#else
+#define FIXED16_PARTS 1
+#endif
+
+/* ------------------------------------------------------------
+ * Auxiliary functions
+ * ------------------------------------------------------------ */
+
+static    int16_t
+quantize(real x, real factor)
+{
+  x *= factor;
+
+  return (int16_t) (x >= 0.0 ? x + 0.5 : x - 0.5);
+}
+
+#ifdef USE_COMPLEX
+#define FIXED16_ENTRY(q, k) ((real) (q)[2 * (k)] + (real) (q)[2 * (k) + 1] * I)
+#else
+#define FIXED16_ENTRY(q, k) ((real) (q)[k])
+#endif
+
+/* ------------------------------------------------------------
+ * Constructors and destructors
+ * ------------------------------------------------------------ */
+
+pcompmatrix
+compress_amatrix(pcamatrix a, real eps)
+{
+  pcompmatrix c;
+  longindex lda = a->ld;
+  longindex rows = a->rows;
+  real      norm, scale, factor, error;
+  field     x;
+  uint      i, j;
+
+  norm = normfrob_amatrix(a);
+
+  /* Largest real or imaginary part */
+  scale = 0.0;
+  for (j = 0; j < a->cols; j++)
+    for (i = 0; i < a->rows; i++) {
+      x = a->a[i + j * lda];
+      scale = REAL_MAX(scale, REAL_ABS(REAL(x)));
+      scale = REAL_MAX(scale, REAL_ABS(IMAG(x)));
+    }
+
+  c = (pcompmatrix) allocmem(sizeof(compmatrix));
+  c->rows = a->rows;
+  c->cols = a->cols;
+  c->scale = 0.0;
+  c->fixed = NULL;
+  c->low = NULL;
+
+  /* Rounding to the nearest fixed-point number changes each part by at
+   * most half of the step width */
+  error = 0.5 * scale / FIXED16_MAX
+    * REAL_SQRT((real) FIXED16_PARTS * a->rows * a->cols);
+
+  if (error <= eps * norm) {
+    c->format = COMPMATRIX_FIXED16;
+    c->scale = scale / FIXED16_MAX;
+    c->error = error;
+
+    if (rows > 0 && a->cols > 0) {
+      c->fixed = (int16_t *) allocmem(sizeof(int16_t) * FIXED16_PARTS
+				      * rows * a->cols);
+
+      factor = (scale > 0.0 ? FIXED16_MAX / scale : 0.0);
+      for (j = 0; j < a->cols; j++)
+	for (i = 0; i < a->rows; i++) {
+	  x = a->a[i + j * lda];
+#ifdef USE_COMPLEX
+	  c->fixed[2 * (i + j * rows)] = quantize(REAL(x), factor);
+	  c->fixed[2 * (i + j * rows) + 1] = quantize(IMAG(x), factor);
+#else
+	  c->fixed[i + j * rows] = quantize(x, factor);
+#endif
+	}
+    }
+
+    return c;
+  }
+
+  /* Rounding to single precision is relatively accurate */
+  error = LOWFIELD_EPS * norm;
+
+  if (error <= eps * norm) {
+    c->format = COMPMATRIX_LOWFIELD;
+    c->error = error;
+    c->low = lowprec_amatrix(a);
+
+    return c;
+  }
+
+  freemem(c);
+
+  return NULL;
+}
+
+void
+del_compmatrix(pcompmatrix c)
+{
+  if (c->fixed)
+    freemem(c->fixed);
+  if (c->low)
+    freemem(c->low);
+
+  freemem(c);
+}
+
+void
+decompress_compmatrix(pccompmatrix c, pamatrix a)
+{
+  longindex lda = a->ld;
+  longindex rows = c->rows;
+  uint      i, j;
+
+  assert(a->rows == c->rows);
+  assert(a->cols == c->cols);
+
+  switch (c->format) {
+  case COMPMATRIX_FIXED16:
+    for (j = 0; j < c->cols; j++)
+      for (i = 0; i < c->rows; i++)
+	a->a[i + j * lda] = c->scale * FIXED16_ENTRY(c->fixed, i + j * rows);
+    break;
+
+  case COMPMATRIX_LOWFIELD:
+    fullprec_amatrix(c->low, a);
+    break;
+  }
+}
+
+/* ------------------------------------------------------------
+ * Statistics
+ * ------------------------------------------------------------ */
+
+size_t
+getsize_compmatrix(pccompmatrix c)
+{
+  size_t    sz;
+
+  sz = sizeof(compmatrix);
+
+  switch (c->format) {
+  case COMPMATRIX_FIXED16:
+    sz += (size_t) sizeof(int16_t) * FIXED16_PARTS * c->rows * c->cols;
+    break;
+
+  case COMPMATRIX_LOWFIELD:
+    sz += (size_t) sizeof(lowfield) * c->rows * c->cols;
+    break;
+  }
+
+  return sz;
+}
+
+/* ------------------------------------------------------------
+ * Matrix-vector multiplication
+ * ------------------------------------------------------------ */
+
+void
+addeval_compmatrix_avector(field alpha, pccompmatrix c, pcavector src,
+			   pavector trg)
+{
+  const int16_t *q;
+  field     beta;
+  longindex rows = c->rows;
+  uint      i, j;
+
+  assert(src->dim >= c->cols);
+  assert(trg->dim >= c->rows);
+
+  switch (c->format) {
+  case COMPMATRIX_FIXED16:
+    for (j = 0; j < c->cols; j++) {
+      q = c->fixed + FIXED16_PARTS * j * rows;
+      beta = alpha * c->scale * src->v[j];
+      for (i = 0; i < c->rows; i++)
+	trg->v[i] += beta * FIXED16_ENTRY(q, i);
+    }
+    break;
+
+  case COMPMATRIX_LOWFIELD:
+    addeval_lowprec_avector(alpha, c->rows, c->cols, c->low, src, trg);
+    break;
+  }
+}
+
+void
+addevaltrans_compmatrix_avector(field alpha, pccompmatrix c, pcavector src,
+				pavector trg)
+{
+  const int16_t *q;
+  field     sum;
+  longindex rows = c->rows;
+  uint      i, j;
+
+  assert(src->dim >= c->rows);
+  assert(trg->dim >= c->cols);
+
+  switch (c->format) {
+  case COMPMATRIX_FIXED16:
+    for (j = 0; j < c->cols; j++) {
+      q = c->fixed + FIXED16_PARTS * j * rows;
+      sum = f_zero;
+      for (i = 0; i < c->rows; i++)
+	sum += CONJ(FIXED16_ENTRY(q, i)) * src->v[i];
+      trg->v[j] += alpha * c->scale * sum;
+    }
+    break;
+
+  case COMPMATRIX_LOWFIELD:
+    addevaltrans_lowprec_avector(alpha, c->rows, c->cols, c->low, src, trg);
+    break;
+  }
+}
+
+void
+mvm_compmatrix_avector(field alpha, bool ctrans, pccompmatrix c,
+		       pcavector src, pavector trg)
+{
+  if (ctrans)
+    addevaltrans_compmatrix_avector(alpha, c, src, trg);
+  else
+    addeval_compmatrix_avector(alpha, c, src, trg);
+}
@@ -0,0 +1,167 @@
+/* ------------------------------------------------------------
+ * This is the file "compmatrix.h" of the H2Lib package.
+ * All rights reserved, Steffen Boerm 2026
+ * ------------------------------------------------------------ */
+
+/** @file compmatrix.h
+ *  @author Steffen B&ouml;rm
+ */
+
+#ifndef COMPMATRIX_H
+#define COMPMATRIX_H
+
+/** @defgroup compmatrix compmatrix
+ *  @brief Dense matrices stored in a compressed format with a
+ *  guaranteed error bound.
+ *
+ *  A @ref compmatrix is created from an @ref amatrix and a relative
+ *  tolerance @f$\epsilon@f$.
+ *  The cheapest available format with an a priori bound
+ *  @f$\|A-\widetilde A\|_F \leq \epsilon \|A\|_F@f$ for the
+ *  compression error is chosen:
+ *  - 16-bit fixed-point numbers with one scaling factor per block,
+ *  - single-precision floating-point numbers, see @ref lowfield.
+ *
+ *  Matrix-vector multiplications convert the coefficients column by
+ *  column on the fly and accumulate all sums in @ref field, so the
+ *  full-precision matrix is never formed.
+ *  @{ */
+
+/** @brief Compressed dense matrix. */
+typedef struct _compmatrix compmatrix;
+
+/** @brief Pointer to @ref compmatrix object. */
+typedef compmatrix *pcompmatrix;
+
+/** @brief Pointer to constant @ref compmatrix object. */
+typedef const compmatrix *pccompmatrix;
+
+#include <stdint.h>
+
+#include "settings.h"
+#include "amatrix.h"
+#include "avector.h"
+
+/** @brief Storage formats of a @ref compmatrix. */
+typedef enum {
+  /** @brief 16-bit fixed-point numbers scaled by the largest
+   *  coefficient of the block. */
+  COMPMATRIX_FIXED16,
+  /** @brief Single-precision floating-point numbers. */
+  COMPMATRIX_LOWFIELD
+} compformat;
+
+/** @brief Representation of a compressed dense matrix. */
+struct _compmatrix {
+  /** @brief Number of rows. */
+  uint rows;
+  /** @brief Number of columns. */
+  uint cols;
+
+  /** @brief Storage format. */
+  compformat format;
+
+  /** @brief Scaling factor for @ref COMPMATRIX_FIXED16, the stored
+   *  integers have to be multiplied by this factor. */
+  real scale;
+
+  /** @brief Coefficients for @ref COMPMATRIX_FIXED16 in column-major
+   *  order, real and imaginary parts are stored consecutively if
+   *  <tt>USE_COMPLEX</tt> is set. */
+  int16_t *fixed;
+
+  /** @brief Coefficients for @ref COMPMATRIX_LOWFIELD in column-major
+   *  order. */
+  plowfield low;
+
+  /** @brief Guaranteed upper bound for the Frobenius norm of the
+   *  compression error. */
+  real error;
+};
+
+/* ------------------------------------------------------------
+ * Constructors and destructors
+ * ------------------------------------------------------------ */
+
+/** @brief Compress a dense matrix.
+ *
+ *  Chooses the cheapest format that guarantees
+ *  @f$\|A-\widetilde A\|_F \leq \epsilon \|A\|_F@f$.
+ *
+ *  @remark Should always be matched by a call to @ref del_compmatrix.
+ *
+ *  @param a Source matrix @f$A@f$.
+ *  @param eps Relative tolerance @f$\epsilon@f$.
+ *  @returns Compressed matrix or <tt>NULL</tt> if no format is accurate
+ *    enough. */
+HEADER_PREFIX pcompmatrix
+compress_amatrix(pcamatrix a, real eps);
+
+/** @brief Delete a @ref compmatrix object.
+ *
+ *  @param c Object to be deleted. */
+HEADER_PREFIX void
+del_compmatrix(pcompmatrix c);
+
+/** @brief Restore a dense matrix from its compressed representation.
+ *
+ *  @param c Compressed matrix @f$\widetilde A@f$.
+ *  @param a Target matrix, has to provide storage for the
+ *    coefficients and will be overwritten by @f$\widetilde A@f$. */
+HEADER_PREFIX void
+decompress_compmatrix(pccompmatrix c, pamatrix a);
+
+/* ------------------------------------------------------------
+ * Statistics
+ * ------------------------------------------------------------ */
+
+/** @brief Get size of a given @ref compmatrix object.
+ *
+ *  @param c Compressed matrix.
+ *  @returns Size of allocated storage in bytes. */
+HEADER_PREFIX size_t
+getsize_compmatrix(pccompmatrix c);
+
+/* ------------------------------------------------------------
+ * Matrix-vector multiplication
+ * ------------------------------------------------------------ */
+
+/** @brief Multiply a compressed matrix @f$\widetilde A@f$ by a vector
+ *  @f$x@f$, @f$y \gets y + \alpha \widetilde A x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param c Compressed matrix @f$\widetilde A@f$.
+ *  @param src Source vector @f$x@f$.
+ *  @param trg Target vector @f$y@f$. */
+HEADER_PREFIX void
+addeval_compmatrix_avector(field alpha, pccompmatrix c, pcavector src,
+			   pavector trg);
+
+/** @brief Multiply the adjoint of a compressed matrix
+ *  @f$\widetilde A@f$ by a vector @f$x@f$,
+ *  @f$y \gets y + \alpha \widetilde A^* x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param c Compressed matrix @f$\widetilde A@f$.
+ *  @param src Source vector @f$x@f$.
+ *  @param trg Target vector @f$y@f$. */
+HEADER_PREFIX void
+addevaltrans_compmatrix_avector(field alpha, pccompmatrix c, pcavector src,
+				pavector trg);
+
+/** @brief Multiply a compressed matrix @f$\widetilde A@f$ or its
+ *  adjoint by a vector, @f$y \gets y + \alpha \widetilde A x@f$ or
+ *  @f$y \gets y + \alpha \widetilde A^* x@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param ctrans Set if @f$\widetilde A^*@f$ is to be used.
+ *  @param c Compressed matrix @f$\widetilde A@f$.
+ *  @param src Source vector @f$x@f$.
+ *  @param trg Target vector @f$y@f$. */
+HEADER_PREFIX void
+mvm_compmatrix_avector(field alpha, bool ctrans, pccompmatrix c,
+		       pcavector src, pavector trg);
+
+/** @} */
+
+#endif
@@ -147,7 +147,8 @@ build_regular_dd_cluster(pclustergeometry cg, uint size, uint * idx, uint clf,
 {
 
   pcluster  c;
-  uint      i, j, newd, tmp, tmp2;
+  uint      i, newd, tmp, tmp2;
+  longindex j;
   uint      size0, size1, size2;	/*sizes of sons */
   real      a, b, m;		/*left, right and midpoint of the bounding box in direction direction */
   real      h, diam_max, diam;
@@ -500,7 +501,8 @@ build_adaptive_dd_cluster(pclustergeometry cg, uint size, uint * idx,
 {
   pcluster  c;
 
-  uint      i, j, direction, tmp;
+  uint      i, direction, tmp;
+  longindex j;
   bool      inter;
   uint      size0, size1, size2;
   real      a, m;
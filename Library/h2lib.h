@@ -19,6 +19,7 @@
 #include "settings.h"
 #include "basic.h"
 #include "parameters.h"
+#include "taskpool.h"
 
 /* Vector and matrix types */
 #include "avector.h"
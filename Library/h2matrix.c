@@ -430,6 +430,42 @@ random_h2matrix(ph2matrix h2)
     random_amatrix(h2->f);
 }
 
+void
+lowprec_h2matrix(ph2matrix h2, real eps)
+{
+  uint      rsons = h2->rsons;
+  uint      csons = h2->csons;
+  uint      k, i, j;
+
+  if (h2->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	lowprec_h2matrix(h2->son[i + j * rsons], eps);
+  }
+  else if (h2->u) {
+    k = UINT_MIN(h2->u->S.rows, h2->u->S.cols);
+
+    if (LOWFIELD_EPS * REAL_SQRT((real) k) <= eps)
+      lowprec_uniform(h2->u);
+  }
+}
+
+void
+fullprec_h2matrix(ph2matrix h2)
+{
+  uint      rsons = h2->rsons;
+  uint      csons = h2->csons;
+  uint      i, j;
+
+  if (h2->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	fullprec_h2matrix(h2->son[i + j * rsons]);
+  }
+  else if (h2->u)
+    fullprec_uniform(h2->u);
+}
+
 /* ------------------------------------------------------------
  * Build H^2-matrix based on block tree
  * ------------------------------------------------------------ */
@@ -1221,7 +1257,7 @@ fastaddeval_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
   uint      i, j;
 
   if (h2->u) {
-    addeval_amatrix_avector(alpha, &h2->u->S, xt, yt);
+    mvm_coupling_uniform_avector(alpha, false, h2->u, xt, yt);
   }
   else if (h2->f) {
     xp = init_sub_avector(&loc1, xt, cb->t->size, cb->k);
@@ -1299,7 +1335,7 @@ fastaddevaltrans_h2matrix_avector(field alpha, pch2matrix h2, pavector xt,
   uint      i, j;
 
   if (h2->u) {
-    addevaltrans_amatrix_avector(alpha, &h2->u->S, xt, yt);
+    mvm_coupling_uniform_avector(alpha, true, h2->u, xt, yt);
   }
   else if (h2->f) {
     xp = init_sub_avector(&loc1, xt, rb->t->size, rb->k);
@@ -1399,8 +1435,8 @@ addevalsymm_offdiag(field alpha, pch2matrix h2, pavector xt,
     uninit_avector(xp);
   }
   else if (h2->u) {
-    addeval_amatrix_avector(alpha, &h2->u->S, xt, yt);
-    addevaltrans_amatrix_avector(alpha, &h2->u->S, xta, yta);
+    mvm_coupling_uniform_avector(alpha, false, h2->u, xt, yt);
+    mvm_coupling_uniform_avector(alpha, true, h2->u, xta, yta);
   }
   else {
     assert(h2->son != 0);
@@ -1467,7 +1503,8 @@ addevalsymm_diag(field alpha, pch2matrix h2, pavector xt,
   pcclusterbasis rb = h2->rb;
   pcclusterbasis cb = h2->cb;
   pfield    aa;
-  uint      lda, sons;
+  longindex lda;
+  uint      sons;
   uint      xtoff, ytoff;
   uint      n;
   uint      i, j;
@@ -1624,7 +1661,7 @@ fastaddmul_h2matrix_amatrix_amatrix(field alpha, bool h2trans,
   if (h2->u) {
     Xt1 = init_sub_amatrix(&loc1, (pamatrix) Xt, cb->k, 0, Xt->cols, 0);
     Yt1 = init_sub_amatrix(&loc2, Yt, rb->k, 0, Yt->cols, 0);
-    addmul_amatrix(alpha, h2trans, &h2->u->S, false, Xt1, Yt1);
+    mvm_coupling_uniform_amatrix(alpha, h2trans, h2->u, Xt1, Yt1);
     uninit_amatrix(Yt1);
     uninit_amatrix(Xt1);
   }
@@ -2064,6 +2101,9 @@ write_cdf(pch2matrix G,
     kr = u->rb->k;
     kc = u->cb->k;
 
+    /* Coupling matrices in reduced precision are not supported */
+    assert(u->Slow == NULL);
+
     /* Write type 2 to nc_type[blockidx] */
     start = *blockidx;
     count = 1;
@@ -2640,6 +2680,160 @@ read_cdfcomplete_h2matrix(const char *name)
 }
 #endif
 
+void
+write_mmappart_h2matrix(pch2matrix G, pmmapfile mf)
+{
+  amatrix   tmp;
+  pamatrix  S;
+  uint      rsons, csons;
+  uint      i, j;
+
+  if (G->f) {
+    write_uint_mmapfile(mf, 1);
+    write_amatrix_mmapfile(mf, G->f);
+  }
+  else if (G->u) {
+    write_uint_mmapfile(mf, 2);
+    if (G->u->Slow) {
+      /* Files always store the coupling matrix in full precision */
+      S = init_amatrix(&tmp, G->u->S.rows, G->u->S.cols);
+      fullprec_amatrix(G->u->Slow, S);
+      write_amatrix_mmapfile(mf, S);
+      uninit_amatrix(S);
+    }
+    else
+      write_amatrix_mmapfile(mf, &G->u->S);
+  }
+  else if (G->son) {
+    rsons = G->rsons;
+    csons = G->csons;
+
+    write_uint_mmapfile(mf, 3);
+    write_uint_mmapfile(mf, rsons);
+    write_uint_mmapfile(mf, csons);
+    write_uint_mmapfile(mf, G->son[0]->rb != G->rb);
+    write_uint_mmapfile(mf, G->son[0]->cb != G->cb);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	write_mmappart_h2matrix(G->son[i + j * rsons], mf);
+  }
+  else
+    write_uint_mmapfile(mf, 0);
+}
+
+ph2matrix
+read_mmappart_h2matrix(pmmapfile mf, pclusterbasis rb, pclusterbasis cb)
+{
+  ph2matrix G, G1;
+  pclusterbasis rb1, cb1;
+  uint      rsons, csons;
+  bool      rsplit, csplit;
+  uint      i, j;
+
+  G = NULL;
+
+  switch (read_uint_mmapfile(mf)) {
+  case 0:
+    G = new_h2matrix(rb, cb);
+    break;
+
+  case 1:
+    G = new_h2matrix(rb, cb);
+    G->f = read_amatrix_mmapfile(mf, (pamatrix) allocmem(sizeof(amatrix)));
+    assert(G->f->rows == rb->t->size);
+    assert(G->f->cols == cb->t->size);
+    G->desc = 1;
+    break;
+
+  case 2:
+    G = new_h2matrix(rb, cb);
+    G->u = new_uniform(rb, cb);
+    uninit_amatrix(&G->u->S);
+    read_amatrix_mmapfile(mf, &G->u->S);
+    assert(G->u->S.rows == rb->k);
+    assert(G->u->S.cols == cb->k);
+    G->desc = 1;
+    break;
+
+  case 3:
+    rsons = read_uint_mmapfile(mf);
+    csons = read_uint_mmapfile(mf);
+    rsplit = read_uint_mmapfile(mf);
+    csplit = read_uint_mmapfile(mf);
+    assert(!rsplit || rb->sons == rsons);
+    assert(!csplit || cb->sons == csons);
+
+    G = new_super_h2matrix(rb, cb, rsons, csons);
+    for (j = 0; j < csons; j++) {
+      cb1 = (csplit ? cb->son[j] : cb);
+      for (i = 0; i < rsons; i++) {
+	rb1 = (rsplit ? rb->son[i] : rb);
+
+	G1 = read_mmappart_h2matrix(mf, rb1, cb1);
+	ref_h2matrix(G->son + i + j * rsons, G1);
+      }
+    }
+    update_h2matrix(G);
+    break;
+
+  default:
+    (void) fprintf(stderr, "Unknown block type in binary container file\n");
+    abort();
+  }
+
+  return G;
+}
+
+bool
+write_mmapcomplete_h2matrix(pch2matrix G, const char *name)
+{
+  pmmapfile mf;
+
+  mf = create_mmapfile(name);
+  if (mf == NULL)
+    return false;
+
+  /* Write row cluster tree and row cluster basis */
+  write_mmappart_cluster(G->rb->t, mf);
+  write_mmappart_clusterbasis(G->rb, mf);
+
+  /* Write column cluster tree if it differs from the row tree */
+  write_uint_mmapfile(mf, G->cb->t != G->rb->t);
+  if (G->cb->t != G->rb->t)
+    write_mmappart_cluster(G->cb->t, mf);
+
+  /* Write column cluster basis if it differs from the row basis */
+  write_uint_mmapfile(mf, G->cb != G->rb);
+  if (G->cb != G->rb)
+    write_mmappart_clusterbasis(G->cb, mf);
+
+  /* Write h2matrix */
+  write_mmappart_h2matrix(G, mf);
+
+  return close_mmapfile(mf);
+}
+
+ph2matrix
+read_mmapcomplete_h2matrix(pmmapfile mf)
+{
+  pcluster  rc, cc;
+  pclusterbasis rb, cb;
+
+  /* Read row cluster tree and row cluster basis */
+  rc = read_mmappart_cluster(mf);
+  rb = read_mmappart_clusterbasis(mf, rc);
+
+  /* Read column cluster tree or re-use the row tree */
+  cc = (read_uint_mmapfile(mf) ? read_mmappart_cluster(mf) : rc);
+
+  /* Read column cluster basis or re-use the row basis */
+  cb = (read_uint_mmapfile(mf) ? read_mmappart_clusterbasis(mf, cc) : rb);
+
+  /* Read h2matrix */
+  return read_mmappart_h2matrix(mf, rb, cb);
+}
+
 /* ------------------------------------------------------------
  * Drawing
  * ------------------------------------------------------------ */
@@ -287,6 +287,34 @@ scale_h2matrix(field alpha, ph2matrix h2);
 void
 random_h2matrix(ph2matrix h2);
 
+/** @brief Store suitable coupling matrices of an @ref h2matrix in
+ *  reduced precision.
+ *
+ *  The coupling matrix @f$S_b@f$ of an admissible leaf is converted by
+ *  @ref lowprec_uniform if its rounding error does not exceed the
+ *  truncation tolerance.
+ *  Since the rounding error is bounded by
+ *  @f$\epsilon_{\rm low} \|S_b\|_F \leq \epsilon_{\rm low}
+ *  \sqrt{k} \|S_b\|_2@f$ with the rank @f$k@f$ of @f$S_b@f$, this is
+ *  the case if @f$\epsilon_{\rm low} \sqrt{k} \leq \epsilon@f$
+ *  with the relative precision @ref LOWFIELD_EPS of @ref lowfield.
+ *
+ *  @remark Only the matrix-vector multiplication functions can be
+ *  applied to the matrix afterwards.
+ *  All other operations require a call to @ref fullprec_h2matrix first.
+ *
+ *  @param h2 Target matrix.
+ *  @param eps Relative truncation tolerance of the coupling matrices. */
+HEADER_PREFIX void
+lowprec_h2matrix(ph2matrix h2, real eps);
+
+/** @brief Restore the full-precision representation of all
+ *  coupling matrices of an @ref h2matrix.
+ *
+ *  @param h2 Target matrix. */
+HEADER_PREFIX void
+fullprec_h2matrix(ph2matrix h2);
+
 /* ------------------------------------------------------------
  * Build H^2-matrix based on block tree
  * ------------------------------------------------------------ */
@@ -813,6 +841,49 @@ HEADER_PREFIX ph2matrix
 read_cdfcomplete_h2matrix(const char *name);
 #endif
 
+/** @brief Write @ref h2matrix to a binary container file.
+ *
+ *  @param G Matrix.
+ *  @param mf Binary container file opened by @ref create_mmapfile. */
+HEADER_PREFIX void
+write_mmappart_h2matrix(pch2matrix G, pmmapfile mf);
+
+/** @brief Read @ref h2matrix from a binary container file.
+ *
+ *  The nearfield and coupling matrices point into the mapping of
+ *  <tt>mf</tt>, so the matrix is read-only and has to be deleted
+ *  before the file is closed.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @param rb Row cluster basis.
+ *  @param cb Column cluster basis.
+ *  @returns @ref h2matrix read from file. */
+HEADER_PREFIX ph2matrix
+read_mmappart_h2matrix(pmmapfile mf, pclusterbasis rb, pclusterbasis cb);
+
+/** @brief Write @ref h2matrix to a binary container file, including
+ *  cluster trees and cluster bases.
+ *
+ *  @param G Matrix.
+ *  @param name File name.
+ *  @returns <tt>true</tt> on success, <tt>false</tt> if the file could
+ *    not be created or written. */
+HEADER_PREFIX bool
+write_mmapcomplete_h2matrix(pch2matrix G, const char *name);
+
+/** @brief Read @ref h2matrix from a binary container file, including
+ *  cluster trees and cluster bases.
+ *
+ *  No coefficients are copied, all matrices point into the mapping
+ *  of <tt>mf</tt>.
+ *  The matrix is read-only and has to be deleted, together with its
+ *  cluster trees, before the file is closed.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @returns @ref h2matrix read from file. */
+HEADER_PREFIX ph2matrix
+read_mmapcomplete_h2matrix(pmmapfile mf);
+
 /* ------------------------------------------------------------
  * Drawing
  * ------------------------------------------------------------ */
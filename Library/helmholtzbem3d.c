@@ -20,9 +20,17 @@
 /* PARTICLES */
 /* BEM */
 #include "helmholtzbem3d.h"
+#include "helmholtzbem3d_simd.h"
 
 #define KERNEL_CONST_HELMHOLTZBEM3D 0.0795774715459476679
 
+/* Largest number of terms for sine and cosine in the SIMD kernels */
+#ifdef USE_SIMD
+#define SINCOS_MAXTERMS_HELMHOLTZBEM3D VSINCOS_MAXTERMS
+#else
+#define SINCOS_MAXTERMS_HELMHOLTZBEM3D 10
+#endif
+
 /** @brief Helper structure to pass bem3d and surface data to index-based kernels */
 typedef struct {
   pcbem3d bem;
@@ -60,42 +68,6 @@ slp_kernel_helmholtzbem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-slp_kernel_simd_helmholtzbem3d(const vreal * x,
-			       const vreal * y, const vreal * nx,
-			       const vreal * ny, void *data, vreal * res_re,
-			       vreal * res_im)
-{
-  pcbem3d   bem = (pcbem3d) data;
-  vreal     k_real = vset1(REAL(bem->k));
-  vreal     k_imag = vset1(-IMAG(bem->k));
-  vreal     dist[3];
-  vreal     norm, norm2, rnorm, c, s;
-  (void) nx;
-  (void) ny;
-
-  dist[0] = vsub(x[0], y[0]);
-  dist[1] = vsub(x[1], y[1]);
-  dist[2] = vsub(x[2], y[2]);
-
-  norm2 = vdot3(dist, dist);
-  rnorm = vrsqrt(norm2);
-
-  norm = vmul(norm2, rnorm);
-  if (IMAG(bem->k) != 0.0) {
-    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
-  }
-
-  norm = vmul(k_real, norm);
-
-  vsincos(norm, &c, &s);
-
-  *res_re = vmul(rnorm, c);
-  *res_im = vmul(rnorm, s);
-}
-#endif
-
 static field
 slp_kernel_directional_helmholtzbem3d(const real * x,
 				      const real * y, const real * nx,
@@ -175,42 +147,6 @@ dlp_kernel_helmholtzbem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-dlp_kernel_simd_helmholtzbem3d(const vreal * x,
-			       const vreal * y, const vreal * nx,
-			       const vreal * ny, void *data, vreal * res_re,
-			       vreal * res_im)
-{
-  pcbem3d   bem = (pcbem3d) data;
-  vreal     k_real = vset1(REAL(bem->k));
-  vreal     k_imag = vset1(-IMAG(bem->k));
-  vreal     dist[3];
-  vreal     norm, norm2, rnorm, s, c;
-
-  (void) nx;
-
-  dist[0] = vsub(x[0], y[0]);
-  dist[1] = vsub(x[1], y[1]);
-  dist[2] = vsub(x[2], y[2]);
-  norm2 = vdot3(dist, dist);
-  rnorm = vrsqrt(norm2);
-
-  norm = vmul(norm2, rnorm);
-  rnorm = vmul(vmul(rnorm, vmul(rnorm, rnorm)), vdot3(dist, (vreal *) ny));
-  if (IMAG(bem->k) != 0.0) {
-    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
-  }
-  norm = vmul(k_real, norm);
-
-  vsincos(norm, &c, &s);
-
-  *res_re = vmul(vfmadd(norm, s, c), rnorm);
-  *res_im = vmul(vfnmadd(norm, c, s), rnorm);
-
-}
-#endif
-
 static inline field
 adlp_kernel_helmholtzbem3d(const real * x, const real * y,
 			   const real * nx, const real * ny, void *data)
@@ -244,42 +180,6 @@ adlp_kernel_helmholtzbem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-adlp_kernel_simd_helmholtzbem3d(const vreal * x,
-				const vreal * y, const vreal * nx,
-				const vreal * ny, void *data, vreal * res_re,
-				vreal * res_im)
-{
-  pcbem3d   bem = (pcbem3d) data;
-  vreal     k_real = vset1(REAL(bem->k));
-  vreal     k_imag = vset1(-IMAG(bem->k));
-  vreal     dist[3];
-  vreal     norm, norm2, rnorm, s, c;
-
-  (void) ny;
-
-  dist[0] = vsub(y[0], x[0]);
-  dist[1] = vsub(y[1], x[1]);
-  dist[2] = vsub(y[2], x[2]);
-  norm2 = vdot3(dist, dist);
-  rnorm = vrsqrt(norm2);
-
-  norm = vmul(norm2, rnorm);
-  rnorm = vmul(vmul(rnorm, vmul(rnorm, rnorm)), vdot3(dist, (vreal *) nx));
-  if (IMAG(bem->k) != 0.0) {
-    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
-  }
-  norm = vmul(k_real, norm);
-
-  vsincos(norm, &c, &s);
-
-  *res_re = vmul(vfmadd(norm, s, c), rnorm);
-  *res_im = vmul(vfnmadd(norm, c, s), rnorm);
-
-}
-#endif
-
 static inline field
 hs_kernel_helmholtzbem3d(const real * x, const real * y,
 			 const real * nx, const real * ny, void *data)
@@ -318,46 +218,145 @@ hs_kernel_helmholtzbem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-hs_kernel_simd_helmholtzbem3d(const vreal * x,
-			      const vreal * y, const vreal * nx,
-			      const vreal * ny, void *data, vreal * res_re,
-			      vreal * res_im)
+/* ------------------------------------------------------------
+ * Single layer, double layer and adjoint double layer kernel
+ * sharing |x-y| and the exponential, used for fused assembly
+ * ------------------------------------------------------------ */
+
+static void
+fused_kernel_helmholtzbem3d(const real * x, const real * y,
+			    const real * nx, const real * ny, void *data,
+			    uint m, field * res)
 {
   pcbem3d   bem = (pcbem3d) data;
-  vreal     k_real = vset1(REAL(bem->k));
-  vreal     k_imag = vset1(-IMAG(bem->k));
-  vreal     dist[3];
-  vreal     norm, norm2, rnorm, s, c, dot, dotxy, hr, hi, c3;
-
-  c3 = vset1(3.0);
-
-  dist[0] = vsub(x[0], y[0]);
-  dist[1] = vsub(x[1], y[1]);
-  dist[2] = vsub(x[2], y[2]);
-  norm2 = vdot3(dist, dist);
-  rnorm = vrsqrt(norm2);
-
-  norm = vmul(norm2, rnorm);
-  rnorm = vmul(vmul(rnorm, rnorm), vmul(vmul(rnorm, rnorm), rnorm));
-  if (IMAG(bem->k) != 0.0) {
-    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
+  real      k_real = REAL(bem->k);
+  real      k_imag = IMAG(bem->k);
+  real      dist[3];
+  real      norm, norm2, rnorm, e, kr, s, c, rd, ra;
+
+  (void) m;
+
+  dist[0] = x[0] - y[0];
+  dist[1] = x[1] - y[1];
+  dist[2] = x[2] - y[2];
+  norm2 = REAL_NORMSQR3(dist[0], dist[1], dist[2]);
+  rnorm = REAL_RSQRT(norm2);
+  norm = norm2 * rnorm;
+
+  e = rnorm;
+  if (k_imag != 0.0) {
+    e *= REAL_EXP(-k_imag * norm);
   }
-  norm = vmul(k_real, norm);
+  kr = k_real * norm;
+  s = REAL_SIN(kr);
+  c = REAL_COS(kr);
 
-  vsincos(norm, &c, &s);
+  res[0] = (e * c) + (e * s) * I;
 
-  dot = vdot3(dist, (vreal *) nx) * vdot3(dist, (vreal *) ny);
-  dotxy = vdot3((vreal *) nx, (vreal *) ny);
+  e *= rnorm * rnorm;
+  rd = e * DOT3(dist, ny);
+  ra = -e * DOT3(dist, nx);
+  res[1] = ((c + kr * s) * rd + (s - c * kr) * rd * I);
+  res[2] = ((c + kr * s) * ra + (s - c * kr) * ra * I);
+}
+
+/* ------------------------------------------------------------
+ * Kernel functions for several wave numbers sharing |x-y|
+ * ------------------------------------------------------------ */
+
+static void
+slp_kernel_sweep_helmholtzbem3d(const real * x, const real * y,
+				const real * nx, const real * ny, void *data,
+				uint m, field * res)
+{
+  const bem3d_sweep_data *sd = (const bem3d_sweep_data *) data;
+  real      dist[3];
+  real      norm, norm2, rnorm, r, kr;
+  uint      l;
+
+  (void) nx;
+  (void) ny;
 
-  hr = vadd(vmul(vsub(vmul(norm, norm), c3), dot), vmul(norm2, dotxy));
-  hi = vsub(vmul(c3, vmul(norm, dot)), vmul(norm, vmul(norm2, dotxy)));
+  dist[0] = x[0] - y[0];
+  dist[1] = x[1] - y[1];
+  dist[2] = x[2] - y[2];
+  norm2 = REAL_NORMSQR3(dist[0], dist[1], dist[2]);
+  rnorm = REAL_RSQRT(norm2);
+  norm = norm2 * rnorm;
 
-  *res_re = vmul(rnorm, vsub(vmul(c, hr), vmul(s, hi)));
-  *res_im = vmul(rnorm, vadd(vmul(c, hi), vmul(s, hr)));
+  for (l = 0; l < m; l++) {
+    r = rnorm;
+    if (IMAG(sd->k[l]) != 0.0) {
+      r *= REAL_EXP(-IMAG(sd->k[l]) * norm);
+    }
+    kr = REAL(sd->k[l]) * norm;
+    res[l] = (r * REAL_COS(kr)) + (REAL_SIN(kr) * r) * I;
+  }
+}
+
+static void
+dlp_kernel_sweep_helmholtzbem3d(const real * x, const real * y,
+				const real * nx, const real * ny, void *data,
+				uint m, field * res)
+{
+  const bem3d_sweep_data *sd = (const bem3d_sweep_data *) data;
+  real      dist[3];
+  real      norm, norm2, rnorm, re, r, kr, s, c;
+  uint      l;
+
+  (void) nx;
+
+  dist[0] = x[0] - y[0];
+  dist[1] = x[1] - y[1];
+  dist[2] = x[2] - y[2];
+  norm2 = REAL_NORMSQR3(dist[0], dist[1], dist[2]);
+  rnorm = REAL_RSQRT(norm2);
+  re = (rnorm * rnorm * rnorm) * DOT3(dist, ny);
+  norm = norm2 * rnorm;
+
+  for (l = 0; l < m; l++) {
+    r = re;
+    if (IMAG(sd->k[l]) != 0.0) {
+      r *= REAL_EXP(-IMAG(sd->k[l]) * norm);
+    }
+    kr = REAL(sd->k[l]) * norm;
+    s = REAL_SIN(kr);
+    c = REAL_COS(kr);
+    res[l] = ((c + kr * s) * r + (s - c * kr) * r * I);
+  }
+}
+
+static void
+adlp_kernel_sweep_helmholtzbem3d(const real * x, const real * y,
+				 const real * nx, const real * ny,
+				 void *data, uint m, field * res)
+{
+  const bem3d_sweep_data *sd = (const bem3d_sweep_data *) data;
+  real      dist[3];
+  real      norm, norm2, rnorm, re, r, kr, s, c;
+  uint      l;
+
+  (void) ny;
+
+  dist[0] = y[0] - x[0];
+  dist[1] = y[1] - x[1];
+  dist[2] = y[2] - x[2];
+  norm2 = REAL_NORMSQR3(dist[0], dist[1], dist[2]);
+  rnorm = REAL_RSQRT(norm2);
+  re = (rnorm * rnorm * rnorm) * DOT3(dist, nx);
+  norm = norm2 * rnorm;
+
+  for (l = 0; l < m; l++) {
+    r = re;
+    if (IMAG(sd->k[l]) != 0.0) {
+      r *= REAL_EXP(-IMAG(sd->k[l]) * norm);
+    }
+    kr = REAL(sd->k[l]) * norm;
+    s = REAL_SIN(kr);
+    c = REAL_COS(kr);
+    res[l] = ((c + kr * s) * r + (s - c * kr) * r * I);
+  }
 }
-#endif
 
 /* ------------------------------------------------------------
  * Index-based kernel function wrappers for Helmholtz BEM3D
@@ -424,477 +423,341 @@ hs_kernel_idx_helmholtzbem3d(uint idx_x, uint idx_y, void *data)
   return hs_kernel_helmholtzbem3d(x, y, nx, ny, (void*)kd->bem);
 }
 
-#ifdef USE_SIMD
-static void
-fill_slp_cc_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_cc_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cc_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_cc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_cc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cc_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cc_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_cc_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cc_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_cc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cc_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cc_near_helmholtzbem3d(const uint * ridx,
-				 const uint * cidx, pcbem3d bem, bool ntrans,
-				 pamatrix N)
-{
-  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_cc_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				 pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cc_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cc_far_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_cc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cc_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_cl_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_cl_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cl_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_cl_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_cl_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cl_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cl_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_cl_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cl_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cl_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_cl_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cl_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cl_near_helmholtzbem3d(const uint * ridx,
-				 const uint * cidx, pcbem3d bem, bool ntrans,
-				 pamatrix N)
-{
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_cl_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				 pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cl_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cl_far_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_cl_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cl_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_lc_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_lc_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_lc_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_lc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_lc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_lc_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_lc_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_lc_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_lc_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_lc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_lc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_lc_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_lc_near_helmholtzbem3d(const uint * ridx,
-				 const uint * cidx, pcbem3d bem, bool ntrans,
-				 pamatrix N)
-{
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_lc_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				 pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_lc_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_lc_far_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_lc_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_lc_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_ll_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_ll_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_ll_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_ll_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_slp_ll_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_ll_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_ll_near_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_ll_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_ll_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_ll_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dlp_ll_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_ll_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_ll_near_helmholtzbem3d(const uint * ridx,
-				 const uint * cidx, pcbem3d bem, bool ntrans,
-				 pamatrix N)
-{
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
-			      (kernel_simd_func3d)
-			      adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_ll_near_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				 pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_ll_near_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_ll_far_helmholtzbem3d(const uint * ridx,
-				const uint * cidx, pcbem3d bem, bool ntrans,
-				pamatrix N)
-{
-  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
-			     (kernel_simd_func3d)
-			     adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_adlp_ll_far_helmholtzbem3d(const uint * ridx, const uint * cidx,
 				pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_ll_far_simd_helmholtzbem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_helmholtzbem3d);
 }
-#endif
 static void
 fill_kernel_helmholtzbem3d(pcbem3d bem, const real(*X)[3],
 			   const real(*Y)[3], pamatrix V)
@@ -926,21 +789,18 @@ fill_dnx_dny_kernel_helmholtzbem3d(pcbem3d bem, const real(*X)[3],
   fill_bem3d(bem, X, Y, NX, NY, V, hs_kernel_helmholtzbem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_kernel_c_helmholtzbem3d(const uint * idx, const real(*Z)[3],
-			     pcbem3d bem, pamatrix V)
-{
-  fill_row_simd_c_bem3d(idx, Z, bem, V, slp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_kernel_c_helmholtzbem3d(const uint * idx, const real(*Z)[3],
 			     pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_kernel_c_simd_helmholtzbem3d, (idx, Z, bem, V));
+    return;
+  }
+#endif
   fill_row_c_bem3d(idx, Z, bem, V, slp_kernel_helmholtzbem3d);
 }
-#endif
 
 static void
 fill_kernel_l_helmholtzbem3d(const uint * idx, const real(*Z)[3],
@@ -949,24 +809,19 @@ fill_kernel_l_helmholtzbem3d(const uint * idx, const real(*Z)[3],
   fill_row_l_bem3d(idx, Z, bem, V, slp_kernel_helmholtzbem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dnz_kernel_c_helmholtzbem3d(const uint * idx,
-				 const real(*Z)[3], const real(*N)[3],
-				 pcbem3d bem, pamatrix V)
-{
-  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V,
-			    dlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dnz_kernel_c_helmholtzbem3d(const uint * idx,
 				 const real(*Z)[3], const real(*N)[3],
 				 pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dnz_kernel_c_simd_helmholtzbem3d, (idx, Z, N, bem, V));
+    return;
+  }
+#endif
   fill_dnz_row_c_bem3d(idx, Z, N, bem, V, dlp_kernel_helmholtzbem3d);
 }
-#endif
 
 static void
 fill_dnz_kernel_l_helmholtzbem3d(const uint * idx,
@@ -976,23 +831,19 @@ fill_dnz_kernel_l_helmholtzbem3d(const uint * idx,
   fill_dnz_row_l_bem3d(idx, Z, N, bem, V, dlp_kernel_helmholtzbem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dnzdrow_kernel_c_helmholtzbem3d(const uint * idx,
-				     const real(*Z)[3], const real(*N)[3],
-				     pcbem3d bem, pamatrix V)
-{
-  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dnzdrow_kernel_c_helmholtzbem3d(const uint * idx,
 				     const real(*Z)[3], const real(*N)[3],
 				     pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dnzdrow_kernel_c_simd_helmholtzbem3d, (idx, Z, N, bem, V));
+    return;
+  }
+#endif
   fill_dnz_row_c_bem3d(idx, Z, N, bem, V, hs_kernel_helmholtzbem3d);
 }
-#endif
 
 static void
 fill_dnzdrow_kernel_l_helmholtzbem3d(const uint * idx,
@@ -1002,23 +853,19 @@ fill_dnzdrow_kernel_l_helmholtzbem3d(const uint * idx,
   fill_dnz_row_l_bem3d(idx, Z, N, bem, V, hs_kernel_helmholtzbem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dnzdcol_kernel_c_helmholtzbem3d(const uint * idx,
-				     const real(*Z)[3], const real(*N)[3],
-				     pcbem3d bem, pamatrix V)
-{
-  fill_dnz_col_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_dnzdcol_kernel_c_helmholtzbem3d(const uint * idx,
 				     const real(*Z)[3], const real(*N)[3],
 				     pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dnzdcol_kernel_c_simd_helmholtzbem3d, (idx, Z, N, bem, V));
+    return;
+  }
+#endif
   fill_dnz_col_c_bem3d(idx, Z, N, bem, V, hs_kernel_helmholtzbem3d);
 }
-#endif
 
 static void
 fill_dnzdcol_kernel_l_helmholtzbem3d(const uint * idx,
@@ -1028,21 +875,18 @@ fill_dnzdcol_kernel_l_helmholtzbem3d(const uint * idx,
   fill_dnz_col_l_bem3d(idx, Z, N, bem, V, hs_kernel_helmholtzbem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_drow_kernel_c_helmholtzbem3d(const uint * idx,
-				  const real(*Z)[3], pcbem3d bem, pamatrix V)
-{
-  fill_row_simd_c_bem3d(idx, Z, bem, V, adlp_kernel_simd_helmholtzbem3d);
-}
-#else
 static void
 fill_drow_kernel_c_helmholtzbem3d(const uint * idx,
 				  const real(*Z)[3], pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_drow_kernel_c_simd_helmholtzbem3d, (idx, Z, bem, V));
+    return;
+  }
+#endif
   fill_row_c_bem3d(idx, Z, bem, V, adlp_kernel_helmholtzbem3d);
 }
-#endif
 
 static void
 fill_drow_kernel_l_helmholtzbem3d(const uint * idx,
@@ -1051,22 +895,18 @@ fill_drow_kernel_l_helmholtzbem3d(const uint * idx,
   fill_row_l_bem3d(idx, Z, bem, V, adlp_kernel_helmholtzbem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dcol_kernel_c_helmholtzbem3d(const uint * idx,
-				  const real(*Z)[3], pcbem3d bem, pamatrix V)
-{
-  fill_col_simd_c_bem3d(idx, Z, bem, V, dlp_kernel_simd_helmholtzbem3d);
-}
-
-#else
 static void
 fill_dcol_kernel_c_helmholtzbem3d(const uint * idx,
 				  const real(*Z)[3], pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dcol_kernel_c_simd_helmholtzbem3d, (idx, Z, bem, V));
+    return;
+  }
+#endif
   fill_col_c_bem3d(idx, Z, bem, V, dlp_kernel_helmholtzbem3d);
 }
-#endif
 
 static void
 fill_dcol_kernel_l_helmholtzbem3d(const uint * idx,
@@ -1091,6 +931,7 @@ new_slp_helmholtz_bem3d(field k, pcsurface3d gr, uint q_regular,
 
   bem->kernel_const = KERNEL_CONST_HELMHOLTZBEM3D;
   bem->k = k;
+  set_kernelaccuracy_helmholtzbem3d(bem, 1.0e-15);
   bem->alpha = 0.0;
 
   kernels->fundamental = fill_kernel_helmholtzbem3d;
@@ -1260,6 +1101,7 @@ new_dlp_helmholtz_bem3d(field k, pcsurface3d gr, uint q_regular,
 
   bem->kernel_const = KERNEL_CONST_HELMHOLTZBEM3D;
   bem->k = k;
+  set_kernelaccuracy_helmholtzbem3d(bem, 1.0e-15);
   bem->alpha = alpha;
 
   kernels->fundamental = fill_kernel_helmholtzbem3d;
@@ -1429,6 +1271,7 @@ new_adlp_helmholtz_bem3d(field k, pcsurface3d gr, uint q_regular,
 
   bem->kernel_const = KERNEL_CONST_HELMHOLTZBEM3D;
   bem->k = k;
+  set_kernelaccuracy_helmholtzbem3d(bem, 1.0e-15);
   bem->alpha = alpha;
 
   kernels->fundamental = fill_kernel_helmholtzbem3d;
@@ -1588,6 +1431,168 @@ del_helmholtz_bem3d(pbem3d bem)
   del_bem3d(bem);
 }
 
+void
+set_wavenumber_helmholtzbem3d(pbem3d bem, field k)
+{
+  if (bem->k != k) {
+    bem->k = k;
+    invalidate_kernel_bem3d(bem);
+  }
+}
+
+void
+nearfield_sweep_helmholtzbem3d(const uint * ridx, const uint * cidx,
+			       pbem3d bem, bool ntrans, uint m,
+			       const field * k, pamatrix * N)
+{
+  bem3d_sweep_data sd;
+  kernel_sweep_func3d kernel;
+  field     k0;
+  uint      op, l;
+
+  if (m == 0) {
+    return;
+  }
+
+  sd.bem = bem;
+  sd.k = k;
+
+  kernel = NULL;
+  op = 0;
+  if (bem->nearfield == fill_slp_cc_near_helmholtzbem3d) {
+    kernel = slp_kernel_sweep_helmholtzbem3d;
+    op = 0;
+  }
+  else if (bem->nearfield == fill_dlp_cc_near_helmholtzbem3d) {
+    kernel = dlp_kernel_sweep_helmholtzbem3d;
+    op = 1;
+  }
+  else if (bem->nearfield == fill_adlp_cc_near_helmholtzbem3d) {
+    kernel = adlp_kernel_sweep_helmholtzbem3d;
+    op = 2;
+  }
+
+  if (kernel != NULL) {
+#ifdef USE_SIMD
+    if (use_simd) {
+      SIMD_CALL(nearfield_sweep_simd_helmholtzbem3d,
+		(ridx, cidx, bem, ntrans, m, k, op, N));
+      return;
+    }
+#else
+    (void) op;
+#endif
+    assemble_cc_sweep_near_bem3d(ridx, cidx, bem, ntrans, m, N, NULL, kernel,
+				 &sd);
+    return;
+  }
+
+  /* Linear basis functions: one wave number after the other */
+  k0 = bem->k;
+  for (l = 0; l < m; l++) {
+    set_wavenumber_helmholtzbem3d(bem, k[l]);
+    bem->nearfield(ridx, cidx, bem, ntrans, N[l]);
+  }
+  set_wavenumber_helmholtzbem3d(bem, k0);
+}
+
+/* Check whether bem can be handled as the l-th operator of the fused
+ * kernel together with b0 */
+static    bool
+fusable_helmholtzbem3d(pcbem3d bem, pcbem3d b0, uint l)
+{
+  if (bem->gr != b0->gr || bem->k != b0->k
+      || bem->sq->n_dist != b0->sq->n_dist || bem->sq->n_id != b0->sq->n_id
+      || bem->sq->n_edge != b0->sq->n_edge
+      || bem->sq->n_vert != b0->sq->n_vert) {
+    return false;
+  }
+
+  switch (l) {
+  case 0:
+    return bem->nearfield == fill_slp_cc_near_helmholtzbem3d;
+  case 1:
+    return bem->nearfield == fill_dlp_cc_near_helmholtzbem3d;
+  case 2:
+    return bem->nearfield == fill_adlp_cc_near_helmholtzbem3d;
+  default:
+    return false;
+  }
+}
+
+void
+nearfield_fused_helmholtzbem3d(const uint * ridx, const uint * cidx,
+			       pbem3d * bem, bool ntrans, uint m,
+			       pamatrix * N)
+{
+  pamatrix  Nf[3];
+  field     alpha[3];
+  pbem3d    b0;
+  bool      fused;
+  uint      l;
+
+  assert(m <= 3);
+
+  b0 = NULL;
+  fused = true;
+  for (l = 0; l < 3; l++) {
+    Nf[l] = NULL;
+    alpha[l] = 0.0;
+    if (l < m && bem[l]) {
+      if (b0 == NULL) {
+	b0 = bem[l];
+      }
+      fused = fused && fusable_helmholtzbem3d(bem[l], b0, l);
+      Nf[l] = N[l];
+      alpha[l] = bem[l]->alpha;
+    }
+  }
+
+  if (b0 == NULL) {
+    return;
+  }
+
+  if (fused) {
+#ifdef USE_SIMD
+    if (use_simd) {
+      SIMD_CALL(nearfield_fused_simd_helmholtzbem3d,
+		(ridx, cidx, b0, ntrans, Nf, alpha));
+      return;
+    }
+#endif
+    assemble_cc_sweep_near_bem3d(ridx, cidx, b0, ntrans, 3, Nf, alpha,
+				 fused_kernel_helmholtzbem3d, (void *) b0);
+    return;
+  }
+
+  /* Linear basis functions, different meshes or wave numbers: one
+   * operator after the other */
+  for (l = 0; l < m; l++) {
+    if (bem[l]) {
+      bem[l]->nearfield(ridx, cidx, bem[l], ntrans, N[l]);
+    }
+  }
+}
+
+void
+set_kernelaccuracy_helmholtzbem3d(pbem3d bem, real eps)
+{
+  real      r2, err;
+  uint      n;
+
+  /* The error of the polynomials with n terms on [-pi/4, pi/4] is
+   * bounded by (pi/4)^(2n+2) / (2n+2)! */
+  r2 = REAL_SQR(0.25 * M_PI);
+  n = 1;
+  err = r2 * r2 / 24.0;
+  while (err > eps && n < SINCOS_MAXTERMS_HELMHOLTZBEM3D) {
+    n++;
+    err *= r2 / ((2 * n + 1) * (2 * n + 2));
+  }
+
+  bem->sincos_terms = n;
+}
+
 field
 rhs_dirichlet_point_helmholtzbem3d(const real * x, const real * n,
 				   const void *data)
@@ -154,6 +154,91 @@ new_adlp_helmholtz_bem3d(field k, pcsurface3d gr, uint q_regular,
 HEADER_PREFIX void
 del_helmholtz_bem3d(pbem3d bem);
 
+/**
+ * @brief Choose the accuracy of sine and cosine in the vectorized kernels.
+ *
+ * The SIMD kernels evaluate @f$\cos(\kappa |x-y|)@f$ and
+ * @f$\sin(\kappa |x-y|)@f$ by polynomials whose degree is chosen such that
+ * the absolute error is bounded by <tt>eps</tt>.
+ * If the requested accuracy of the BEM matrices is low, a lower degree
+ * reduces the cost of the kernel evaluations.
+ * The constructors use full double precision, i.e., <tt>eps</tt>
+ * @f$=10^{-15}@f$.
+ *
+ * @param bem @ref _bem3d "Bem3d" object for the Helmholtz equation.
+ * @param eps Absolute accuracy of sine and cosine.
+ */
+HEADER_PREFIX void
+set_kernelaccuracy_helmholtzbem3d(pbem3d bem, real eps);
+
+/**
+ * @brief Change the wave number of a @ref _bem3d "bem3d" object for the
+ * Helmholtz equation.
+ *
+ * Geometry, quadrature rules, precomputed quadrature points and the
+ * approximation parameters are kept, data derived from the kernel function
+ * is discarded by @ref invalidate_kernel_bem3d.
+ * Cluster and block trees do not depend on the wave number unless the
+ * admissibility condition does, so a frequency sweep can reuse them and
+ * refill existing matrices, e.g., by @ref assemble_bem3d_hmatrix.
+ *
+ * @param bem @ref _bem3d "Bem3d" object for the Helmholtz equation.
+ * @param k New wave number @f$\kappa@f$.
+ */
+HEADER_PREFIX void
+set_wavenumber_helmholtzbem3d(pbem3d bem, field k);
+
+/**
+ * @brief Compute nearfield entries for several wave numbers at once.
+ *
+ * For piecewise constant basis functions the matrices for all wave numbers
+ * are assembled in one pass over the quadrature points, so geometric
+ * quantities like @f$|x-y|@f$ are computed only once.
+ * For other basis functions the nearfield is assembled for one wave number
+ * after the other.
+ * The wave number of <tt>bem</tt> is not changed.
+ *
+ * @param ridx Indices of row boundary elements or NULL.
+ * @param cidx Indices of column boundary elements or NULL.
+ * @param bem @ref _bem3d "Bem3d" object created by
+ *        @ref new_slp_helmholtz_bem3d, @ref new_dlp_helmholtz_bem3d or
+ *        @ref new_adlp_helmholtz_bem3d.
+ * @param ntrans Store the entries in a transposed way.
+ * @param m Number of wave numbers.
+ * @param k Wave numbers.
+ * @param N Matrices of identical size, <tt>N[i]</tt> takes the entries for
+ *        the wave number <tt>k[i]</tt>.
+ */
+HEADER_PREFIX void
+nearfield_sweep_helmholtzbem3d(const uint *ridx, const uint *cidx,
+    pbem3d bem, bool ntrans, uint m, const field *k, pamatrix *N);
+
+/**
+ * @brief Compute nearfield entries of the single layer, double layer and
+ * adjoint double layer operator in one pass.
+ *
+ * For piecewise constant basis functions on the same mesh and with the same
+ * wave number the entries of all operators are computed from the same
+ * quadrature points, so @f$|x-y|@f$, the exponential and the trigonometric
+ * functions are evaluated only once.
+ * Otherwise the nearfield of one operator is assembled after the other.
+ * Can be passed to @ref assemble_bem3d_fused_hmatrix and
+ * @ref assemble_bem3d_fused_h2matrix.
+ *
+ * @param ridx Indices of row boundary elements or NULL.
+ * @param cidx Indices of column boundary elements or NULL.
+ * @param bem Objects created by @ref new_slp_helmholtz_bem3d,
+ *        @ref new_dlp_helmholtz_bem3d and @ref new_adlp_helmholtz_bem3d in
+ *        this order, entries may be NULL.
+ * @param ntrans Store the entries in a transposed way.
+ * @param m Number of operators, at most 3.
+ * @param N Matrices of identical size, <tt>N[i]</tt> takes the entries for
+ *        <tt>bem[i]</tt> and is NULL if <tt>bem[i]</tt> is.
+ */
+HEADER_PREFIX void
+nearfield_fused_helmholtzbem3d(const uint *ridx, const uint *cidx,
+    pbem3d *bem, bool ntrans, uint m, pamatrix *N);
+
 /**
  * @brief A function based upon the fundamental solution,
  * that will serve as Dirichlet values.
@@ -0,0 +1,631 @@
+/* ------------------------------------------------------------
+ This is the file "helmholtzbem3d_simd.c" of the H2Lib package.
+ All rights reserved, Sven Christophersen 2015
+ ------------------------------------------------------------ */
+
+/**
+ * @file helmholtzbem3d_simd.c
+ * @author Sven Christophersen
+ * @date 2015
+ *
+ * SIMD kernel functions of @ref helmholtzbem3d.h, compiled once for every
+ * instruction set listed in <tt>SIMD_ISAS</tt>.
+ */
+
+#ifdef USE_COMPLEX
+
+#ifdef USE_SIMD
+
+/* CORE 0 */
+#include "basic.h"
+/* BEM */
+#include "bem3d_simd.h"
+#include "helmholtzbem3d_simd.h"
+
+static inline void
+slp_kernel_simd_helmholtzbem3d(const vreal * x,
+			       const vreal * y, const vreal * nx,
+			       const vreal * ny, void *data, vreal * res_re,
+			       vreal * res_im)
+{
+  pcbem3d   bem = (pcbem3d) data;
+  vreal     k_real = vset1(REAL(bem->k));
+  vreal     k_imag = vset1(-IMAG(bem->k));
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, c, s;
+  (void) nx;
+  (void) ny;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+
+  norm = vmul(norm2, rnorm);
+  if (IMAG(bem->k) != 0.0) {
+    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
+  }
+
+  norm = vmul(k_real, norm);
+
+  vsincosn(norm, bem->sincos_terms, &c, &s);
+
+  *res_re = vmul(rnorm, c);
+  *res_im = vmul(rnorm, s);
+}
+
+static inline void
+dlp_kernel_simd_helmholtzbem3d(const vreal * x,
+			       const vreal * y, const vreal * nx,
+			       const vreal * ny, void *data, vreal * res_re,
+			       vreal * res_im)
+{
+  pcbem3d   bem = (pcbem3d) data;
+  vreal     k_real = vset1(REAL(bem->k));
+  vreal     k_imag = vset1(-IMAG(bem->k));
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, s, c;
+
+  (void) nx;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+
+  norm = vmul(norm2, rnorm);
+  rnorm = vmul(vmul(rnorm, vmul(rnorm, rnorm)), vdot3(dist, (vreal *) ny));
+  if (IMAG(bem->k) != 0.0) {
+    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
+  }
+  norm = vmul(k_real, norm);
+
+  vsincosn(norm, bem->sincos_terms, &c, &s);
+
+  *res_re = vmul(vfmadd(norm, s, c), rnorm);
+  *res_im = vmul(vfnmadd(norm, c, s), rnorm);
+
+}
+
+static inline void
+adlp_kernel_simd_helmholtzbem3d(const vreal * x,
+				const vreal * y, const vreal * nx,
+				const vreal * ny, void *data, vreal * res_re,
+				vreal * res_im)
+{
+  pcbem3d   bem = (pcbem3d) data;
+  vreal     k_real = vset1(REAL(bem->k));
+  vreal     k_imag = vset1(-IMAG(bem->k));
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, s, c;
+
+  (void) ny;
+
+  dist[0] = vsub(y[0], x[0]);
+  dist[1] = vsub(y[1], x[1]);
+  dist[2] = vsub(y[2], x[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+
+  norm = vmul(norm2, rnorm);
+  rnorm = vmul(vmul(rnorm, vmul(rnorm, rnorm)), vdot3(dist, (vreal *) nx));
+  if (IMAG(bem->k) != 0.0) {
+    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
+  }
+  norm = vmul(k_real, norm);
+
+  vsincosn(norm, bem->sincos_terms, &c, &s);
+
+  *res_re = vmul(vfmadd(norm, s, c), rnorm);
+  *res_im = vmul(vfnmadd(norm, c, s), rnorm);
+
+}
+
+static inline void
+hs_kernel_simd_helmholtzbem3d(const vreal * x,
+			      const vreal * y, const vreal * nx,
+			      const vreal * ny, void *data, vreal * res_re,
+			      vreal * res_im)
+{
+  pcbem3d   bem = (pcbem3d) data;
+  vreal     k_real = vset1(REAL(bem->k));
+  vreal     k_imag = vset1(-IMAG(bem->k));
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, s, c, dot, dotxy, hr, hi, c3;
+
+  c3 = vset1(3.0);
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+
+  norm = vmul(norm2, rnorm);
+  rnorm = vmul(vmul(rnorm, rnorm), vmul(vmul(rnorm, rnorm), rnorm));
+  if (IMAG(bem->k) != 0.0) {
+    rnorm = vmul(rnorm, vexp(vmul(k_imag, norm)));
+  }
+  norm = vmul(k_real, norm);
+
+  vsincosn(norm, bem->sincos_terms, &c, &s);
+
+  dot = vdot3(dist, (vreal *) nx) * vdot3(dist, (vreal *) ny);
+  dotxy = vdot3((vreal *) nx, (vreal *) ny);
+
+  hr = vadd(vmul(vsub(vmul(norm, norm), c3), dot), vmul(norm2, dotxy));
+  hi = vsub(vmul(c3, vmul(norm, dot)), vmul(norm, vmul(norm2, dotxy)));
+
+  *res_re = vmul(rnorm, vsub(vmul(c, hr), vmul(s, hi)));
+  *res_im = vmul(rnorm, vadd(vmul(c, hi), vmul(s, hr)));
+}
+
+static void
+fused_kernel_simd_helmholtzbem3d(const vreal * x, const vreal * y,
+				 const vreal * nx, const vreal * ny,
+				 void *data, uint m, vreal * res_re,
+				 vreal * res_im)
+{
+  pcbem3d   bem = (pcbem3d) data;
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, e, kr, c, s, hr, hi, rd, ra;
+
+  (void) m;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+  norm = vmul(norm2, rnorm);
+
+  e = rnorm;
+  if (IMAG(bem->k) != 0.0) {
+    e = vmul(e, vexp(vmul(vset1(-IMAG(bem->k)), norm)));
+  }
+  kr = vmul(vset1(REAL(bem->k)), norm);
+
+  vsincosn(kr, bem->sincos_terms, &c, &s);
+
+  res_re[0] = vmul(e, c);
+  res_im[0] = vmul(e, s);
+
+  e = vmul(e, vmul(rnorm, rnorm));
+  hr = vfmadd(kr, s, c);
+  hi = vfnmadd(kr, c, s);
+  rd = vmul(e, vdot3(dist, (vreal *) ny));
+  ra = vfnmadd(e, vdot3(dist, (vreal *) nx), vsetzero());
+  res_re[1] = vmul(hr, rd);
+  res_im[1] = vmul(hi, rd);
+  res_re[2] = vmul(hr, ra);
+  res_im[2] = vmul(hi, ra);
+}
+
+static void
+slp_kernel_simd_sweep_helmholtzbem3d(const vreal * x, const vreal * y,
+				     const vreal * nx, const vreal * ny,
+				     void *data, uint m, vreal * res_re,
+				     vreal * res_im)
+{
+  const bem3d_sweep_data *sd = (const bem3d_sweep_data *) data;
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, r, kr, c, s;
+  uint      l;
+
+  (void) nx;
+  (void) ny;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+  norm = vmul(norm2, rnorm);
+
+  for (l = 0; l < m; l++) {
+    r = rnorm;
+    if (IMAG(sd->k[l]) != 0.0) {
+      r = vmul(r, vexp(vmul(vset1(-IMAG(sd->k[l])), norm)));
+    }
+    kr = vmul(vset1(REAL(sd->k[l])), norm);
+
+    vsincosn(kr, sd->bem->sincos_terms, &c, &s);
+
+    res_re[l] = vmul(r, c);
+    res_im[l] = vmul(r, s);
+  }
+}
+
+static void
+dlp_kernel_simd_sweep_helmholtzbem3d(const vreal * x, const vreal * y,
+				     const vreal * nx, const vreal * ny,
+				     void *data, uint m, vreal * res_re,
+				     vreal * res_im)
+{
+  const bem3d_sweep_data *sd = (const bem3d_sweep_data *) data;
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, r, kr, c, s;
+  uint      l;
+
+  (void) nx;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+  norm = vmul(norm2, rnorm);
+  rnorm = vmul(vmul(rnorm, vmul(rnorm, rnorm)), vdot3(dist, (vreal *) ny));
+
+  for (l = 0; l < m; l++) {
+    r = rnorm;
+    if (IMAG(sd->k[l]) != 0.0) {
+      r = vmul(r, vexp(vmul(vset1(-IMAG(sd->k[l])), norm)));
+    }
+    kr = vmul(vset1(REAL(sd->k[l])), norm);
+
+    vsincosn(kr, sd->bem->sincos_terms, &c, &s);
+
+    res_re[l] = vmul(vfmadd(kr, s, c), r);
+    res_im[l] = vmul(vfnmadd(kr, c, s), r);
+  }
+}
+
+static void
+adlp_kernel_simd_sweep_helmholtzbem3d(const vreal * x, const vreal * y,
+				      const vreal * nx, const vreal * ny,
+				      void *data, uint m, vreal * res_re,
+				      vreal * res_im)
+{
+  const bem3d_sweep_data *sd = (const bem3d_sweep_data *) data;
+  vreal     dist[3];
+  vreal     norm, norm2, rnorm, r, kr, c, s;
+  uint      l;
+
+  (void) ny;
+
+  dist[0] = vsub(y[0], x[0]);
+  dist[1] = vsub(y[1], x[1]);
+  dist[2] = vsub(y[2], x[2]);
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+  norm = vmul(norm2, rnorm);
+  rnorm = vmul(vmul(rnorm, vmul(rnorm, rnorm)), vdot3(dist, (vreal *) nx));
+
+  for (l = 0; l < m; l++) {
+    r = rnorm;
+    if (IMAG(sd->k[l]) != 0.0) {
+      r = vmul(r, vexp(vmul(vset1(-IMAG(sd->k[l])), norm)));
+    }
+    kr = vmul(vset1(REAL(sd->k[l])), norm);
+
+    vsincosn(kr, sd->bem->sincos_terms, &c, &s);
+
+    res_re[l] = vmul(vfmadd(kr, s, c), r);
+    res_im[l] = vmul(vfnmadd(kr, c, s), r);
+  }
+}
+
+void
+SIMD_NAME(fill_slp_cc_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_cc_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cc_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cc_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cc_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cc_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_cl_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_cl_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cl_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cl_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cl_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cl_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_lc_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_lc_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_lc_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_lc_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_lc_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_lc_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_ll_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_slp_ll_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_ll_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_ll_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_ll_near_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N,
+				(kernel_simd_func3d)
+				adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_ll_far_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N,
+			       (kernel_simd_func3d)
+			       adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_kernel_c_simd_helmholtzbem3d)(const uint * idx,
+			  const real(*Z)[3], pcbem3d bem, pamatrix V)
+{
+  fill_row_simd_c_bem3d(idx, Z, bem, V, slp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dnz_kernel_c_simd_helmholtzbem3d)(const uint * idx,
+			  const real(*Z)[3], const real(*N)[3], pcbem3d bem,
+			  pamatrix V)
+{
+  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V,
+			      dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dnzdrow_kernel_c_simd_helmholtzbem3d)(const uint * idx,
+			  const real(*Z)[3], const real(*N)[3], pcbem3d bem,
+			  pamatrix V)
+{
+  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dnzdcol_kernel_c_simd_helmholtzbem3d)(const uint * idx,
+			  const real(*Z)[3], const real(*N)[3], pcbem3d bem,
+			  pamatrix V)
+{
+  fill_dnz_col_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_drow_kernel_c_simd_helmholtzbem3d)(const uint * idx,
+			  const real(*Z)[3], pcbem3d bem, pamatrix V)
+{
+  fill_row_simd_c_bem3d(idx, Z, bem, V, adlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(fill_dcol_kernel_c_simd_helmholtzbem3d)(const uint * idx,
+			  const real(*Z)[3], pcbem3d bem, pamatrix V)
+{
+  fill_col_simd_c_bem3d(idx, Z, bem, V, dlp_kernel_simd_helmholtzbem3d);
+}
+
+void
+SIMD_NAME(nearfield_sweep_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans, uint m,
+			  const field * k, uint op, pamatrix * N)
+{
+  const kernel_simd_sweep_func3d kernels[3] = {
+    slp_kernel_simd_sweep_helmholtzbem3d,
+    dlp_kernel_simd_sweep_helmholtzbem3d,
+    adlp_kernel_simd_sweep_helmholtzbem3d
+  };
+  bem3d_sweep_data sd;
+
+  assert(op < 3);
+
+  sd.bem = bem;
+  sd.k = k;
+
+  assemble_cc_simd_sweep_near_bem3d(ridx, cidx, bem, ntrans, m, N, NULL,
+				    kernels[op], &sd);
+}
+
+void
+SIMD_NAME(nearfield_fused_simd_helmholtzbem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix * N, const field * alpha)
+{
+  assemble_cc_simd_sweep_near_bem3d(ridx, cidx, bem, ntrans, 3, N, alpha,
+				    fused_kernel_simd_helmholtzbem3d,
+				    (void *) bem);
+}
+
+#endif
+
+#endif
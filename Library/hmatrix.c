@@ -25,6 +25,9 @@ init_hmatrix(phmatrix hm, pccluster rc, pccluster cc)
 
   hm->r = NULL;
   hm->f = NULL;
+  hm->fc = NULL;
+  hm->fe = NULL;
+  hm->fedata = NULL;
 
   hm->son = NULL;
   hm->rsons = 0;
@@ -52,6 +55,9 @@ uninit_hmatrix(phmatrix hm)
     freemem(hm->son);
   }
 
+  if (hm->fc)
+    del_compmatrix(hm->fc);
+
   if (hm->f)
     del_amatrix(hm->f);
 
@@ -261,7 +267,11 @@ getsize_hmatrix(pchmatrix hm)
   if (hm->r)
     sz += getsize_rkmatrix(hm->r);
 
-  if (hm->f)
+  if (hm->fc)
+    sz += sizeof(amatrix) + getsize_compmatrix(hm->fc);
+  else if (hm->fe)
+    sz += sizeof(amatrix);
+  else if (hm->f)
     sz += getsize_amatrix(hm->f);
 
   for (j = 0; j < csons; j++)
@@ -281,7 +291,11 @@ getnearsize_hmatrix(pchmatrix hm)
 
   sz = 0;
 
-  if (hm->f)
+  if (hm->fc)
+    sz += sizeof(amatrix) + getsize_compmatrix(hm->fc);
+  else if (hm->fe)
+    sz += sizeof(amatrix);
+  else if (hm->f)
     sz += getsize_amatrix(hm->f);
 
   for (j = 0; j < csons; j++)
@@ -473,6 +487,144 @@ scale_hmatrix(field alpha, phmatrix hm)
     scale_amatrix(alpha, hm->f);
 }
 
+void
+lowprec_hmatrix(phmatrix hm, real eps)
+{
+  uint      rsons = hm->rsons;
+  uint      csons = hm->csons;
+  real      norma, normb, normr;
+  uint      i, j;
+
+  if (hm->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	lowprec_hmatrix(hm->son[i + j * rsons], eps);
+  }
+  else if (hm->r && hm->r->Alow == NULL && hm->r->k > 0) {
+    norma = normfrob_amatrix(&hm->r->A);
+    normb = normfrob_amatrix(&hm->r->B);
+    normr = normfrob_rkmatrix(hm->r);
+
+    if (LOWFIELD_EPS * norma * normb <= eps * normr)
+      lowprec_rkmatrix(hm->r);
+  }
+}
+
+void
+fullprec_hmatrix(phmatrix hm)
+{
+  uint      rsons = hm->rsons;
+  uint      csons = hm->csons;
+  uint      i, j;
+
+  if (hm->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	fullprec_hmatrix(hm->son[i + j * rsons]);
+  }
+  else if (hm->r)
+    fullprec_rkmatrix(hm->r);
+}
+
+void
+compress_nearfield_hmatrix(phmatrix hm, real eps)
+{
+  uint      rsons = hm->rsons;
+  uint      csons = hm->csons;
+  uint      i, j;
+
+  if (hm->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	compress_nearfield_hmatrix(hm->son[i + j * rsons], eps);
+  }
+  else if (hm->f && hm->fc == NULL && hm->fe == NULL) {
+    assert(hm->f->owner == NULL);
+
+    hm->fc = compress_amatrix(hm->f, eps);
+
+    if (hm->fc && hm->f->a) {
+      freemem(hm->f->a);
+      hm->f->a = NULL;
+    }
+  }
+}
+
+void
+decompress_nearfield_hmatrix(phmatrix hm)
+{
+  uint      rsons = hm->rsons;
+  uint      csons = hm->csons;
+  uint      i, j;
+
+  if (hm->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	decompress_nearfield_hmatrix(hm->son[i + j * rsons]);
+  }
+  else if (hm->fc) {
+    assert(hm->f != NULL);
+
+    hm->f->a = (hm->f->rows > 0 && hm->f->cols > 0 ?
+		allocmatrix(hm->f->rows, hm->f->cols) : NULL);
+    hm->f->ld = hm->f->rows;
+    decompress_compmatrix(hm->fc, hm->f);
+
+    del_compmatrix(hm->fc);
+    hm->fc = NULL;
+  }
+}
+
+void
+matrixfree_nearfield_hmatrix(phmatrix hm, matrixentry_t entry, void *data)
+{
+  uint      rsons = hm->rsons;
+  uint      csons = hm->csons;
+  uint      i, j;
+
+  if (hm->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	matrixfree_nearfield_hmatrix(hm->son[i + j * rsons], entry, data);
+  }
+  else if (hm->f && hm->fc == NULL) {
+    assert(hm->f->owner == NULL);
+
+    if (hm->f->a) {
+      freemem(hm->f->a);
+      hm->f->a = NULL;
+    }
+
+    hm->fe = entry;
+    hm->fedata = data;
+  }
+}
+
+void
+store_nearfield_hmatrix(phmatrix hm)
+{
+  uint      rsons = hm->rsons;
+  uint      csons = hm->csons;
+  uint      i, j;
+
+  if (hm->son) {
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	store_nearfield_hmatrix(hm->son[i + j * rsons]);
+  }
+  else if (hm->fe) {
+    assert(hm->f != NULL);
+
+    hm->f->a = (hm->f->rows > 0 && hm->f->cols > 0 ?
+		allocmatrix(hm->f->rows, hm->f->cols) : NULL);
+    hm->f->ld = hm->f->rows;
+    hm->fe(hm->rc->idx, hm->cc->idx, hm->fedata, false, hm->f);
+
+    hm->fe = NULL;
+    hm->fedata = NULL;
+  }
+}
+
 /* ------------------------------------------------------------
  * Build H-matrix based on block tree
  * ------------------------------------------------------------ */
@@ -564,9 +716,155 @@ mvm_hmatrix_avector(field alpha, bool atrans, pchmatrix a, pcavector x,
     addeval_hmatrix_avector(alpha, a, x, y);
 }
 
+/* Compute the entries of a matrix-free inadmissible leaf in a
+ * temporary matrix */
+static    pamatrix
+init_matrixfree_amatrix(pamatrix tmp, pchmatrix hm)
+{
+  pamatrix  f;
+
+  assert(hm->fe != NULL);
+
+  f = init_amatrix(tmp, hm->f->rows, hm->f->cols);
+  hm->fe(hm->rc->idx, hm->cc->idx, hm->fedata, false, f);
+
+  return f;
+}
+
+static void
+fastaddeval_leaf_hmatrix_avector(field alpha, bool trans, pchmatrix hm,
+				 pcavector x, pavector y)
+{
+  amatrix   tmp;
+  pamatrix  f;
+
+  if (hm->r) {
+    if (trans)
+      addevaltrans_rkmatrix_avector(alpha, hm->r, x, y);
+    else
+      addeval_rkmatrix_avector(alpha, hm->r, x, y);
+  }
+  else if (hm->fc) {
+    if (trans)
+      addevaltrans_compmatrix_avector(alpha, hm->fc, x, y);
+    else
+      addeval_compmatrix_avector(alpha, hm->fc, x, y);
+  }
+  else if (hm->fe) {
+    f = init_matrixfree_amatrix(&tmp, hm);
+    mvm_amatrix_avector(alpha, trans, f, x, y);
+    uninit_amatrix(f);
+  }
+  else if (hm->f) {
+    mvm_amatrix_avector(alpha, trans, hm->f, x, y);
+  }
+}
+
+static void
+fastaddeval_par_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
+				pavector y, uint pardepth)
+{
+  uint      rsons, csons;
+  uint      i;
+#ifdef USE_OPENMP
+  uint      nthreads;
+#endif
+
+  assert(x->dim == hm->cc->size);
+  assert(y->dim == hm->rc->size);
+
+  if (hm->son == NULL) {
+    fastaddeval_leaf_hmatrix_avector(alpha, false, hm, x, y);
+  }
+  else {
+    rsons = hm->rsons;
+    csons = hm->csons;
+
+    /* Block rows write to disjoint parts of y */
+#ifdef USE_OPENMP
+    nthreads = rsons;
+    (void) nthreads;
+#pragma omp parallel for if(pardepth > 0), num_threads(nthreads)
+#endif
+    for (i = 0; i < rsons; i++) {
+      pavector  x1, y1;
+      avector   xtmp, ytmp;
+      uint      xoff, yoff, j, l;
+
+      yoff = 0;
+      for (l = 0; l < i; l++)
+	yoff += hm->son[l]->rc->size;
+      y1 = init_sub_avector(&ytmp, y, hm->son[i]->rc->size, yoff);
+
+      xoff = 0;
+      for (j = 0; j < csons; j++) {
+	x1 = init_sub_avector(&xtmp, (pavector) x,
+			      hm->son[j * rsons]->cc->size, xoff);
+
+	fastaddeval_par_hmatrix_avector(alpha, hm->son[i + j * rsons], x1, y1,
+					(pardepth > 0 ? pardepth - 1 : 0));
+
+	uninit_avector(x1);
+
+	xoff += hm->son[j * rsons]->cc->size;
+      }
+      assert(xoff == hm->cc->size);
+
+      uninit_avector(y1);
+    }
+  }
+}
+
 void
 fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
 			    pavector y)
+{
+  fastaddeval_par_hmatrix_avector(alpha, hm, x, y, max_pardepth);
+}
+
+void
+addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y)
+{
+  pavector  xp, yp;
+  avector   xtmp, ytmp;
+  uint      i, ip;
+
+  assert(x->dim == hm->cc->size);
+  assert(y->dim == hm->rc->size);
+
+  /* Permutation of x */
+  xp = init_avector(&xtmp, x->dim);
+  for (i = 0; i < xp->dim; i++) {
+    ip = hm->cc->idx[i];
+    assert(ip < x->dim);
+    xp->v[i] = x->v[ip];
+  }
+
+  /* Permutation of y */
+  yp = init_avector(&ytmp, y->dim);
+  for (i = 0; i < yp->dim; i++) {
+    ip = hm->rc->idx[i];
+    assert(ip < y->dim);
+    yp->v[i] = y->v[ip];
+  }
+
+  /* Matrix-vector multiplication */
+  fastaddeval_hmatrix_avector(alpha, hm, xp, yp);
+
+  /* Reverse permutation of y */
+  for (i = 0; i < yp->dim; i++) {
+    ip = hm->rc->idx[i];
+    assert(ip < y->dim);
+    y->v[ip] = yp->v[i];
+  }
+
+  uninit_avector(yp);
+  uninit_avector(xp);
+}
+
+void
+fastaddeval_stream_hmatrix_avector(field alpha, pchmatrix hm, pmmapfile mf,
+				   pcavector x, pavector y)
 {
   pavector  x1, y1;
   avector   xtmp, ytmp;
@@ -577,9 +875,30 @@ fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
   assert(y->dim == hm->rc->size);
 
   if (hm->r) {
+    /* B directly follows A in the file, a second call would release
+     * the pages of A before they are read */
+    if (hm->r->A.a && hm->r->B.a) {
+      assert(hm->r->B.a >= hm->r->A.a);
+      stream_mmapfile(mf, hm->r->A.a,
+		      (size_t) ((const char *) (hm->r->B.a + hm->r->B.rows
+						* hm->r->k)
+				- (const char *) hm->r->A.a));
+    }
+    else {
+      /* At most one factor has coefficients */
+      stream_mmapfile(mf, hm->r->A.a,
+		      (size_t) sizeof(field) * hm->r->A.rows * hm->r->k);
+      stream_mmapfile(mf, hm->r->B.a,
+		      (size_t) sizeof(field) * hm->r->B.rows * hm->r->k);
+    }
     addeval_rkmatrix_avector(alpha, hm->r, x, y);
   }
+  else if (hm->fc || hm->fe) {
+    fastaddeval_leaf_hmatrix_avector(alpha, false, hm, x, y);
+  }
   else if (hm->f) {
+    stream_mmapfile(mf, hm->f->a,
+		    (size_t) sizeof(field) * hm->f->rows * hm->f->cols);
     mvm_amatrix_avector(alpha, false, hm->f, x, y);
   }
   else {
@@ -595,7 +914,8 @@ fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
       for (i = 0; i < rsons; i++) {
 	y1 = init_sub_avector(&ytmp, y, hm->son[i]->rc->size, yoff);
 
-	fastaddeval_hmatrix_avector(alpha, hm->son[i + j * rsons], x1, y1);
+	fastaddeval_stream_hmatrix_avector(alpha, hm->son[i + j * rsons], mf,
+					   x1, y1);
 
 	uninit_avector(y1);
 
@@ -612,7 +932,8 @@ fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
 }
 
 void
-addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y)
+addeval_stream_hmatrix_avector(field alpha, pchmatrix hm, pmmapfile mf,
+			       pcavector x, pavector y)
 {
   pavector  xp, yp;
   avector   xtmp, ytmp;
@@ -638,7 +959,7 @@ addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y)
   }
 
   /* Matrix-vector multiplication */
-  fastaddeval_hmatrix_avector(alpha, hm, xp, yp);
+  fastaddeval_stream_hmatrix_avector(alpha, hm, mf, xp, yp);
 
   /* Reverse permutation of y */
   for (i = 0; i < yp->dim; i++) {
@@ -651,30 +972,40 @@ addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y)
   uninit_avector(xp);
 }
 
-void
-fastaddevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
-				 pavector y)
+static void
+fastaddevaltrans_par_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
+				     pavector y, uint pardepth)
 {
-  pavector  x1, y1;
-  avector   xtmp, ytmp;
   uint      rsons, csons;
-  uint      xoff, yoff, i, j;
+  uint      j;
+#ifdef USE_OPENMP
+  uint      nthreads;
+#endif
 
   assert(x->dim == hm->rc->size);
   assert(y->dim == hm->cc->size);
 
-  if (hm->r) {
-    addevaltrans_rkmatrix_avector(alpha, hm->r, x, y);
-  }
-  else if (hm->f) {
-    mvm_amatrix_avector(alpha, true, hm->f, x, y);
+  if (hm->son == NULL) {
+    fastaddeval_leaf_hmatrix_avector(alpha, true, hm, x, y);
   }
   else {
     rsons = hm->rsons;
     csons = hm->csons;
 
-    yoff = 0;
+    /* Block columns write to disjoint parts of y */
+#ifdef USE_OPENMP
+    nthreads = csons;
+    (void) nthreads;
+#pragma omp parallel for if(pardepth > 0), num_threads(nthreads)
+#endif
     for (j = 0; j < csons; j++) {
+      pavector  x1, y1;
+      avector   xtmp, ytmp;
+      uint      xoff, yoff, i, l;
+
+      yoff = 0;
+      for (l = 0; l < j; l++)
+	yoff += hm->son[l * rsons]->cc->size;
       y1 = init_sub_avector(&ytmp, y, hm->son[j * rsons]->cc->size, yoff);
 
       xoff = 0;
@@ -682,8 +1013,9 @@ fastaddevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
 	x1 =
 	  init_sub_avector(&xtmp, (pavector) x, hm->son[i]->rc->size, xoff);
 
-	fastaddevaltrans_hmatrix_avector(alpha, hm->son[i + j * rsons], x1,
-					 y1);
+	fastaddevaltrans_par_hmatrix_avector(alpha, hm->son[i + j * rsons],
+					     x1, y1,
+					     (pardepth > 0 ? pardepth - 1 : 0));
 
 	uninit_avector(x1);
 
@@ -692,13 +1024,17 @@ fastaddevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
       assert(xoff == hm->rc->size);
 
       uninit_avector(y1);
-
-      yoff += hm->son[j * rsons]->cc->size;
     }
-    assert(yoff == hm->cc->size);
   }
 }
 
+void
+fastaddevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
+				 pavector y)
+{
+  fastaddevaltrans_par_hmatrix_avector(alpha, hm, x, y, max_pardepth);
+}
+
 void
 addevaltrans_hmatrix_avector(field alpha, pchmatrix hm, pcavector x,
 			     pavector y)
@@ -746,15 +1082,22 @@ addevalsymm_offdiag(field alpha, pchmatrix hm, uint roff, uint coff,
 {
   avector   tmp1, tmp2;
   pavector  xp1, yp1;
+  amatrix   ftmp;
+  pamatrix  f;
   uint      rsons, csons;
   uint      roff1, coff1;
   uint      i, j;
 
   if (hm->f) {
+    f = (hm->fe ? init_matrixfree_amatrix(&ftmp, hm) : hm->f);
+
     xp1 = init_sub_avector(&tmp1, (pavector) xp, hm->cc->size, coff);
     yp1 = init_sub_avector(&tmp2, yp, hm->rc->size, roff);
 
-    addeval_amatrix_avector(alpha, hm->f, xp1, yp1);
+    if (hm->fc)
+      addeval_compmatrix_avector(alpha, hm->fc, xp1, yp1);
+    else
+      addeval_amatrix_avector(alpha, f, xp1, yp1);
 
     uninit_avector(yp1);
     uninit_avector(xp1);
@@ -762,10 +1105,16 @@ addevalsymm_offdiag(field alpha, pchmatrix hm, uint roff, uint coff,
     xp1 = init_sub_avector(&tmp1, (pavector) xp, hm->rc->size, roff);
     yp1 = init_sub_avector(&tmp2, yp, hm->cc->size, coff);
 
-    addevaltrans_amatrix_avector(alpha, hm->f, xp1, yp1);
+    if (hm->fc)
+      addevaltrans_compmatrix_avector(alpha, hm->fc, xp1, yp1);
+    else
+      addevaltrans_amatrix_avector(alpha, f, xp1, yp1);
 
     uninit_avector(yp1);
     uninit_avector(xp1);
+
+    if (hm->fe)
+      uninit_amatrix(f);
   }
   else if (hm->r) {
     xp1 = init_sub_avector(&tmp1, (pavector) xp, hm->cc->size, coff);
@@ -814,8 +1163,11 @@ addevalsymm_diag(field alpha, pchmatrix hm, uint off, pcavector xp,
 {
   avector   tmp1, tmp2;
   pavector  xp1, yp1;
+  amatrix   ftmp;
+  pamatrix  f;
   pfield    aa;
-  uint      lda, sons;
+  longindex lda;
+  uint      sons;
   uint      roff, coff;
   uint      n;
   uint      i, j;
@@ -826,8 +1178,18 @@ addevalsymm_diag(field alpha, pchmatrix hm, uint off, pcavector xp,
     assert(hm->rc->size == hm->f->rows);
     assert(hm->cc->size == hm->f->cols);
 
-    aa = hm->f->a;
-    lda = hm->f->ld;
+    if (hm->fe)
+      f = init_matrixfree_amatrix(&ftmp, hm);
+    else if (hm->fc) {
+      /* Only the lower triangle is used, so the compressed leaf is
+       * restored temporarily */
+      f = init_amatrix(&ftmp, hm->f->rows, hm->f->cols);
+      decompress_compmatrix(hm->fc, f);
+    }
+    else
+      f = hm->f;
+    aa = f->a;
+    lda = f->ld;
 
     n = hm->rc->size;
     xp1 = init_sub_avector(&tmp1, (pavector) xp, n, off);
@@ -843,6 +1205,9 @@ addevalsymm_diag(field alpha, pchmatrix hm, uint off, pcavector xp,
 
     uninit_avector(yp1);
     uninit_avector(xp1);
+
+    if (f != hm->f)
+      uninit_amatrix(f);
   }
   else {
     assert(hm->son != 0);
@@ -2332,6 +2697,228 @@ read_hlibsymm_hmatrix(const char *filename)
   return G;
 }
 
+void
+write_mmappart_hmatrix(pchmatrix G, pmmapfile mf)
+{
+  uint      rsons, csons;
+  uint      i, j;
+
+  if (mf->failed)
+    return;
+
+  /* Only leaves with full-precision coefficients in memory can be
+   * written, the file is marked as failed otherwise */
+  if ((G->r && G->r->Alow) || G->fc || G->fe) {
+    (void) fprintf(stderr,
+		   "Reduced-precision, compressed or matrix-free leaves"
+		   " cannot be written to a binary container file\n");
+    mf->failed = true;
+    return;
+  }
+
+  if (G->r) {
+    write_uint_mmapfile(mf, 1);
+    write_uint_mmapfile(mf, G->r->k);
+    write_amatrix_mmapfile(mf, &G->r->A);
+    write_amatrix_mmapfile(mf, &G->r->B);
+  }
+  else if (G->f) {
+    write_uint_mmapfile(mf, 2);
+    write_amatrix_mmapfile(mf, G->f);
+  }
+  else if (G->son) {
+    rsons = G->rsons;
+    csons = G->csons;
+
+    write_uint_mmapfile(mf, 3);
+    write_uint_mmapfile(mf, rsons);
+    write_uint_mmapfile(mf, csons);
+    write_uint_mmapfile(mf, G->son[0]->rc != G->rc);
+    write_uint_mmapfile(mf, G->son[0]->cc != G->cc);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	write_mmappart_hmatrix(G->son[i + j * rsons], mf);
+  }
+  else
+    write_uint_mmapfile(mf, 0);
+}
+
+phmatrix
+read_mmappart_hmatrix(pmmapfile mf, pccluster rc, pccluster cc)
+{
+  phmatrix  G, G1;
+  pccluster rc1, cc1;
+  uint      rsons, csons;
+  bool      rsplit, csplit;
+  uint      i, j;
+
+  G = NULL;
+
+  switch (read_uint_mmapfile(mf)) {
+  case 0:
+    G = new_hmatrix(rc, cc);
+    break;
+
+  case 1:
+    G = new_hmatrix(rc, cc);
+    G->r = (prkmatrix) allocmem(sizeof(rkmatrix));
+    G->r->k = read_uint_mmapfile(mf);
+    G->r->Alow = NULL;
+    G->r->Blow = NULL;
+    read_amatrix_mmapfile(mf, &G->r->A);
+    read_amatrix_mmapfile(mf, &G->r->B);
+    assert(G->r->A.rows == rc->size);
+    assert(G->r->B.rows == cc->size);
+    assert(G->r->A.cols == G->r->k);
+    assert(G->r->B.cols == G->r->k);
+    G->desc = 1;
+    break;
+
+  case 2:
+    G = new_hmatrix(rc, cc);
+    G->f = read_amatrix_mmapfile(mf, (pamatrix) allocmem(sizeof(amatrix)));
+    assert(G->f->rows == rc->size);
+    assert(G->f->cols == cc->size);
+    G->desc = 1;
+    break;
+
+  case 3:
+    rsons = read_uint_mmapfile(mf);
+    csons = read_uint_mmapfile(mf);
+    rsplit = read_uint_mmapfile(mf);
+    csplit = read_uint_mmapfile(mf);
+    assert(!rsplit || rc->sons == rsons);
+    assert(!csplit || cc->sons == csons);
+
+    G = new_super_hmatrix(rc, cc, rsons, csons);
+    for (j = 0; j < csons; j++) {
+      cc1 = (csplit ? cc->son[j] : cc);
+      for (i = 0; i < rsons; i++) {
+	rc1 = (rsplit ? rc->son[i] : rc);
+
+	G1 = read_mmappart_hmatrix(mf, rc1, cc1);
+	ref_hmatrix(G->son + i + j * rsons, G1);
+      }
+    }
+    update_hmatrix(G);
+    break;
+
+  default:
+    (void) fprintf(stderr, "Unknown block type in binary container file\n");
+    abort();
+  }
+
+  return G;
+}
+
+bool
+write_mmapcomplete_hmatrix(pchmatrix G, const char *name)
+{
+  pmmapfile mf;
+
+  mf = create_mmapfile(name);
+  if (mf == NULL)
+    return false;
+
+  /* Write row cluster tree */
+  write_mmappart_cluster(G->rc, mf);
+
+  /* Write column cluster tree if it differs from the row tree */
+  write_uint_mmapfile(mf, G->cc != G->rc);
+  if (G->cc != G->rc)
+    write_mmappart_cluster(G->cc, mf);
+
+  /* Write hmatrix */
+  write_mmappart_hmatrix(G, mf);
+
+  return close_mmapfile(mf);
+}
+
+static void
+remap_hmatrix(phmatrix G, pmmapfile mf)
+{
+  uint      rsons, csons;
+  uint      type;
+  uint      i, j;
+
+  type = read_uint_mmapfile(mf);
+
+  if (G->r) {
+    assert(type == 1);
+    (void) read_uint_mmapfile(mf);
+
+    uninit_amatrix(&G->r->A);
+    read_amatrix_mmapfile(mf, &G->r->A);
+    uninit_amatrix(&G->r->B);
+    read_amatrix_mmapfile(mf, &G->r->B);
+  }
+  else if (G->f) {
+    assert(type == 2);
+
+    uninit_amatrix(G->f);
+    read_amatrix_mmapfile(mf, G->f);
+  }
+  else if (G->son) {
+    assert(type == 3);
+    rsons = read_uint_mmapfile(mf);
+    csons = read_uint_mmapfile(mf);
+    (void) read_uint_mmapfile(mf);
+    (void) read_uint_mmapfile(mf);
+    assert(rsons == G->rsons);
+    assert(csons == G->csons);
+
+    for (j = 0; j < csons; j++)
+      for (i = 0; i < rsons; i++)
+	remap_hmatrix(G->son[i + j * rsons], mf);
+  }
+  else
+    assert(type == 0);
+
+  (void) type;
+}
+
+pmmapfile
+spill_hmatrix(phmatrix G, const char *name, size_t budget)
+{
+  pmmapfile mf;
+
+  /* Write leaves in the order used by fastaddeval_hmatrix_avector */
+  mf = create_mmapfile(name);
+  if (mf == NULL)
+    return NULL;
+  write_mmappart_hmatrix(G, mf);
+  if (!close_mmapfile(mf)) {
+    (void) fprintf(stderr, "Could not write \"%s\"\n", name);
+    return NULL;
+  }
+
+  /* Replace the coefficient storage of all leaves by the mapping */
+  mf = open_mmapfile(name);
+  if (mf == NULL)
+    return NULL;
+  remap_hmatrix(G, mf);
+
+  setbudget_mmapfile(mf, budget);
+
+  return mf;
+}
+
+phmatrix
+read_mmapcomplete_hmatrix(pmmapfile mf)
+{
+  pcluster  rc, cc;
+
+  /* Read row cluster tree */
+  rc = read_mmappart_cluster(mf);
+
+  /* Read column cluster tree or re-use the row tree */
+  cc = (read_uint_mmapfile(mf) ? read_mmappart_cluster(mf) : rc);
+
+  /* Read hmatrix */
+  return read_mmappart_hmatrix(mf, rc, cc);
+}
+
 /* ------------------------------------------------------------
  * Drawing
  * ------------------------------------------------------------ */
@@ -2492,8 +3079,10 @@ void
 copy_sparsematrix_hmatrix(psparsematrix sp, phmatrix hm)
 {
 
-  uint      i, j, k, l, m, rsize, csize;
-  uint     *ridx, *cidx, *row, *col;
+  uint      i, j, k, l, rsize, csize;
+  uint     *ridx, *cidx, *col;
+  longindex *row;
+  longindex m;
   pfield    coeff;
   pamatrix  f;
 
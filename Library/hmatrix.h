@@ -39,6 +39,9 @@ typedef const hmatrix *pchmatrix;
 #include "settings.h"
 #include "eigensolvers.h"
 #include "sparsematrix.h"
+#include "mmapfile.h"
+#include "compmatrix.h"
+#include "aca.h"
 
 /** @brief Representation of @f$\mathcal{H}@f$-matrices.
  *
@@ -58,6 +61,20 @@ struct _hmatrix {
   /** @brief Standard matrix, for inadmissible leaves. */
   pamatrix f;
 
+  /** @brief Compressed representation of <tt>f</tt>, if the
+   *  inadmissible leaf has been compressed.
+   *  In this case, <tt>f</tt> keeps its dimensions, but has no
+   *  coefficient storage. */
+  pcompmatrix fc;
+
+  /** @brief Callback computing the entries of <tt>f</tt> on demand, if the
+   *  inadmissible leaf is matrix-free.
+   *  In this case, <tt>f</tt> keeps its dimensions, but has no
+   *  coefficient storage. */
+  matrixentry_t fe;
+  /** @brief Data passed to <tt>fe</tt>. */
+  void *fedata;
+
   /** @brief Submatrices. */
   phmatrix *son;
   /** @brief Number of block rows. */
@@ -348,6 +365,88 @@ random_hmatrix(phmatrix hm, uint kmax);
 HEADER_PREFIX void
 scale_hmatrix(field alpha, phmatrix hm);
 
+/** @brief Store suitable admissible leaves of an @ref hmatrix in
+ *  reduced precision.
+ *
+ *  An admissible leaf @f$R=A B^*@f$ is converted by
+ *  @ref lowprec_rkmatrix if the rounding error of the factors does
+ *  not exceed the truncation tolerance, i.e., if
+ *  @f$\epsilon_{\rm low} \|A\|_F \|B\|_F \leq \epsilon \|R\|_F@f$
+ *  with the relative precision @ref LOWFIELD_EPS of @ref lowfield.
+ *
+ *  @remark Only the matrix-vector multiplication functions can be
+ *  applied to the matrix afterwards.
+ *  All other operations require a call to @ref fullprec_hmatrix first.
+ *
+ *  @param hm Target matrix.
+ *  @param eps Relative truncation tolerance of the admissible leaves. */
+HEADER_PREFIX void
+lowprec_hmatrix(phmatrix hm, real eps);
+
+/** @brief Restore the full-precision representation of all
+ *  admissible leaves of an @ref hmatrix.
+ *
+ *  @param hm Target matrix. */
+HEADER_PREFIX void
+fullprec_hmatrix(phmatrix hm);
+
+/** @brief Compress the inadmissible leaves of an @ref hmatrix.
+ *
+ *  Each inadmissible leaf @f$F@f$ is replaced by a @ref compmatrix
+ *  @f$\widetilde F@f$ with @f$\|F-\widetilde F\|_F \leq \epsilon
+ *  \|F\|_F@f$, so the nearfield error is bounded by
+ *  @f$\epsilon@f$ relative to the Frobenius norm of the nearfield.
+ *  Leaves that cannot be compressed with this accuracy are kept.
+ *
+ *  @remark Only the matrix-vector multiplication functions can be
+ *  applied to the matrix afterwards, the symmetric ones restore
+ *  compressed diagonal leaves temporarily.
+ *  All other operations require a call to
+ *  @ref decompress_nearfield_hmatrix first.
+ *
+ *  @param hm Target matrix.
+ *  @param eps Relative accuracy @f$\epsilon@f$, usually chosen to
+ *    match the truncation accuracy of the admissible leaves. */
+HEADER_PREFIX void
+compress_nearfield_hmatrix(phmatrix hm, real eps);
+
+/** @brief Restore all inadmissible leaves of an @ref hmatrix that have
+ *  been compressed by @ref compress_nearfield_hmatrix.
+ *
+ *  @param hm Target matrix. */
+HEADER_PREFIX void
+decompress_nearfield_hmatrix(phmatrix hm);
+
+/** @brief Discard the coefficients of the inadmissible leaves of an
+ *  @ref hmatrix and recompute them whenever they are needed.
+ *
+ *  The storage of each inadmissible leaf @f$F@f$ is released, the
+ *  matrix-vector multiplication functions call
+ *  <tt>entry(rc->idx, cc->idx, data, false, F)</tt> for a temporary
+ *  matrix instead.
+ *  This trades memory for arithmetic operations, e.g., for boundary
+ *  element matrices that do not fit into memory.
+ *
+ *  @remark Only the matrix-vector multiplication functions can be
+ *  applied to the matrix afterwards.
+ *  All other operations require a call to
+ *  @ref store_nearfield_hmatrix first.
+ *
+ *  @param hm Target matrix.
+ *  @param entry Callback computing the entries of an inadmissible leaf.
+ *  @param data Data passed to <tt>entry</tt>, has to remain valid as long
+ *    as the matrix is used. */
+HEADER_PREFIX void
+matrixfree_nearfield_hmatrix(phmatrix hm, matrixentry_t entry, void *data);
+
+/** @brief Compute and store the coefficients of all inadmissible leaves
+ *  of an @ref hmatrix that have been made matrix-free by
+ *  @ref matrixfree_nearfield_hmatrix.
+ *
+ *  @param hm Target matrix. */
+HEADER_PREFIX void
+store_nearfield_hmatrix(phmatrix hm);
+
 /* ------------------------------------------------------------
  * Build H-matrix based on block tree
  * ------------------------------------------------------------ */
@@ -401,6 +500,7 @@ mvm_hmatrix_avector(field alpha, bool atrans, pchmatrix a, pcavector x,
  *
  *  The matrix is multiplied by the source vector @f$x@f$, the result
  *  is scaled by @f$\alpha@f$ and added to the target vector @f$y@f$.
+ *  Block rows on the upper levels are handled in parallel.
  *
  *  @param alpha Scaling factor @f$\alpha@f$.
  *  @param hm Matrix @f$A@f$.
@@ -425,11 +525,44 @@ fastaddeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector xp,
 HEADER_PREFIX void
 addeval_hmatrix_avector(field alpha, pchmatrix hm, pcavector x, pavector y);
 
+/** @brief Matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$ for a matrix spilled to disk.
+ *
+ *  Works like @ref fastaddeval_hmatrix_avector, but calls
+ *  @ref stream_mmapfile for every leaf, so that the following leaves
+ *  are prefetched asynchronously and leaves that have already been
+ *  processed are released if the matrix does not fit into the
+ *  resident-memory budget of <tt>mf</tt>.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$, spilled by @ref spill_hmatrix.
+ *  @param mf File returned by @ref spill_hmatrix.
+ *  @param xp Source vector @f$x@f$ in cluster numbering
+ *            with respect to <tt>hm->cc</tt>.
+ *  @param yp Target vector @f$y@f$ in cluster numbering
+ *            with respect to <tt>hm->rc</tt>. */
+HEADER_PREFIX void
+fastaddeval_stream_hmatrix_avector(field alpha, pchmatrix hm, pmmapfile mf,
+    pcavector xp, pavector yp);
+
+/** @brief Matrix-vector multiplication
+ *  @f$y \gets y + \alpha A x@f$ for a matrix spilled to disk.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param hm Matrix @f$A@f$, spilled by @ref spill_hmatrix.
+ *  @param mf File returned by @ref spill_hmatrix.
+ *  @param x Source vector @f$x@f$.
+ *  @param y Target vector @f$y@f$. */
+HEADER_PREFIX void
+addeval_stream_hmatrix_avector(field alpha, pchmatrix hm, pmmapfile mf,
+    pcavector x, pavector y);
+
 /** @brief Adjoint matrix-vector multiplication
  *  @f$y \gets y + \alpha A^* x@f$.
  *
  *  The matrix is multiplied by the source vector @f$x@f$, the result
  *  is scaled by @f$\alpha@f$ and added to the target vector @f$y@f$.
+ *  Block columns on the upper levels are handled in parallel.
  *
  *  @param alpha Scaling factor @f$\alpha@f$.
  *  @param hm Matrix @f$A@f$.
@@ -642,6 +775,75 @@ read_hlib_hmatrix(const char *filename);
 HEADER_PREFIX phmatrix
 read_hlibsymm_hmatrix(const char *filename);
 
+/** @brief Write a matrix to a binary container file.
+ *
+ *  Reduced-precision, compressed and matrix-free leaves cannot be
+ *  written, if <tt>G</tt> contains one of them, an error message is
+ *  printed and <tt>mf</tt> is marked as failed.
+ *
+ *  @param G Hierarchical matrix.
+ *  @param mf Binary container file opened by @ref create_mmapfile. */
+HEADER_PREFIX void
+write_mmappart_hmatrix(pchmatrix G, pmmapfile mf);
+
+/** @brief Read a matrix from a binary container file.
+ *
+ *  The coefficients of all leaves point into the mapping of
+ *  <tt>mf</tt>, so the matrix is read-only and has to be deleted
+ *  before the file is closed.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @param rc Row cluster.
+ *  @param cc Column cluster.
+ *  @returns Hierarchical matrix. */
+HEADER_PREFIX phmatrix
+read_mmappart_hmatrix(pmmapfile mf, pccluster rc, pccluster cc);
+
+/** @brief Write @ref hmatrix to a binary container file, including
+ *  cluster trees.
+ *
+ *  @param G Matrix.
+ *  @param name File name.
+ *  @returns <tt>true</tt> on success, <tt>false</tt> if the file could
+ *    not be created or written. */
+HEADER_PREFIX bool
+write_mmapcomplete_hmatrix(pchmatrix G, const char *name);
+
+/** @brief Move the coefficients of a matrix to a file.
+ *
+ *  Writes the coefficients of all leaves to a binary container file,
+ *  in the order used by @ref fastaddeval_hmatrix_avector, releases
+ *  the heap storage of the leaves and maps the file in its place.
+ *
+ *  The matrix becomes read-only and has to be deleted before the
+ *  returned file is closed.
+ *  Use @ref addeval_stream_hmatrix_avector to multiply with the
+ *  matrix while keeping only about <tt>budget</tt> bytes of its
+ *  coefficients in memory.
+ *
+ *  @param G Matrix.
+ *  @param name Name of the file, preferably on a local disk.
+ *  @param budget Resident-memory budget in bytes, zero if unlimited.
+ *  @returns Binary container file holding the coefficients of <tt>G</tt>
+ *    or <tt>NULL</tt> if the file could not be written or <tt>G</tt>
+ *    contains leaves not supported by @ref write_mmappart_hmatrix,
+ *    in this case <tt>G</tt> is left unchanged. */
+HEADER_PREFIX pmmapfile
+spill_hmatrix(phmatrix G, const char *name, size_t budget);
+
+/** @brief Read @ref hmatrix from a binary container file, including
+ *  cluster trees.
+ *
+ *  Neither the coefficients nor the cluster index arrays are copied,
+ *  they point into the mapping of <tt>mf</tt>.
+ *  The matrix is read-only and has to be deleted, together with its
+ *  cluster trees, before the file is closed.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @returns @ref hmatrix read from file. */
+HEADER_PREFIX phmatrix
+read_mmapcomplete_hmatrix(pmmapfile mf);
+
 /* ------------------------------------------------------------
  * Drawing
  * ------------------------------------------------------------ */
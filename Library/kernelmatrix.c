@@ -9,6 +9,8 @@
 
 #include "basic.h"
 
+#include <string.h>
+
 /* ------------------------------------------------------------
  * Create an empty @ref kernelmatrix object
  * ------------------------------------------------------------ */
@@ -29,8 +31,16 @@ new_kernelmatrix(uint dim, uint points, uint m)
   /* Empty kernel callback functions */
   km->kernel = 0;
   km->kernel_internal = 0;
+  km->kernel_block = 0;
   km->data = 0;
 
+  /* Matrices are not shared by default */
+  km->cache = 0;
+
+  /* Same interpolation order on all levels */
+  km->levels = 0;
+  km->m_level = 0;
+
   /* Initialize arrays for point coordinates */
   km->x = (real **) allocmem(sizeof(real *) * points);
   km->x[0] = x0 = allocreal(points * dim);
@@ -54,12 +64,219 @@ new_kernelmatrix(uint dim, uint points, uint m)
 void
 del_kernelmatrix(pkernelmatrix km)
 {
+  setshared_kernelmatrix(km, false);
+
+  if(km->m_level)
+    freemem(km->m_level);
   freemem(km->xi_ref);
   freemem(km->x[0]);
   freemem(km->x);
   freemem(km);
 }
 
+/* ------------------------------------------------------------
+ * Cache for shared coupling and transfer matrices
+ * ------------------------------------------------------------ */
+
+/* Resolution of the quantized offsets and extents relative to the
+ * diameter of the point set, about 12 digits */
+#define KERNELCACHE_SCALE 1099511627776.0
+
+static pkernelcache
+new_kernelcache(pckernelmatrix km)
+{
+  uint dim = km->dim;
+  const real **x = (const real **) km->x;
+  pkernelcache kc;
+  real *bmin, *bmax;
+  real diam;
+  uint i, d;
+
+  kc = (pkernelcache) allocmem(sizeof(kernelcache));
+  kc->buckets = 1024;
+  kc->bucket = (pkernelcacheentry *) allocmem(sizeof(pkernelcacheentry)
+					      * kc->buckets);
+  for(i=0; i<kc->buckets; i++)
+    kc->bucket[i] = 0;
+  kc->entries = 0;
+  kc->size = 0;
+
+  /* Kind and dimensions of the matrix, offset and extents of both boxes */
+  kc->keylen = 3 + 3 * dim;
+
+  /* Quantize relative to the diameter of the point set */
+  bmin = allocreal(dim);
+  bmax = allocreal(dim);
+  for(d=0; d<dim; d++)
+    bmin[d] = bmax[d] = (km->points > 0 ? x[0][d] : 0.0);
+  for(i=1; i<km->points; i++)
+    for(d=0; d<dim; d++) {
+      bmin[d] = REAL_MIN(bmin[d], x[i][d]);
+      bmax[d] = REAL_MAX(bmax[d], x[i][d]);
+    }
+  diam = 0.0;
+  for(d=0; d<dim; d++)
+    diam += REAL_SQR(bmax[d] - bmin[d]);
+  diam = REAL_SQRT(diam);
+  freemem(bmax);
+  freemem(bmin);
+
+  kc->h = (diam > 0.0 ? diam : 1.0) / KERNELCACHE_SCALE;
+
+#ifdef USE_OPENMP
+  omp_init_lock(&kc->lock);
+#endif
+
+  return kc;
+}
+
+static void
+del_kernelcache(pkernelcache kc)
+{
+  pkernelcacheentry e, next;
+  uint i;
+
+  for(i=0; i<kc->buckets; i++)
+    for(e=kc->bucket[i]; e; e=next) {
+      next = e->next;
+      uninit_amatrix(&e->A);
+      freemem(e->key);
+      freemem(e);
+    }
+
+#ifdef USE_OPENMP
+  omp_destroy_lock(&kc->lock);
+#endif
+  freemem(kc->bucket);
+  freemem(kc);
+}
+
+static uint
+hash_kernelcache(uint keylen, const int64_t *key)
+{
+  uint64_t h;
+  uint i;
+
+  /* FNV-1a */
+  h = 14695981039346656037ULL;
+  for(i=0; i<keylen; i++) {
+    h ^= (uint64_t) key[i];
+    h *= 1099511628211ULL;
+  }
+
+  return (uint) (h ^ (h >> 32));
+}
+
+static void
+rehash_kernelcache(pkernelcache kc)
+{
+  pkernelcacheentry *bucket, e, next;
+  uint buckets, i, h;
+
+  buckets = 2 * kc->buckets;
+  bucket = (pkernelcacheentry *) allocmem(sizeof(pkernelcacheentry)
+					  * buckets);
+  for(i=0; i<buckets; i++)
+    bucket[i] = 0;
+
+  for(i=0; i<kc->buckets; i++)
+    for(e=kc->bucket[i]; e; e=next) {
+      next = e->next;
+      h = hash_kernelcache(kc->keylen, e->key) & (buckets - 1);
+      e->next = bucket[h];
+      bucket[h] = e;
+    }
+
+  freemem(kc->bucket);
+  kc->bucket = bucket;
+  kc->buckets = buckets;
+}
+
+/* Find or create the shared matrix for the configuration of the boxes
+ * of t1 and t2, fresh is set if it has still to be filled */
+static pamatrix
+lookup_kernelcache(pkernelcache kc, uint kind, pccluster t1, pccluster t2,
+		   uint rows, uint cols, bool *fresh)
+{
+  uint dim = t1->dim;
+  uint keylen = kc->keylen;
+  real h = kc->h;
+  pkernelcacheentry e;
+  int64_t *key;
+  uint d, b;
+
+  assert(t2->dim == dim);
+  assert(keylen == 3 + 3 * dim);
+
+  key = (int64_t *) allocmem(sizeof(int64_t) * keylen);
+  key[0] = kind;
+  key[1] = rows;
+  key[2] = cols;
+  for(d=0; d<dim; d++) {
+    key[3+3*d] = llround((t2->bmin[d] - t1->bmin[d]) / h);
+    key[4+3*d] = llround((t1->bmax[d] - t1->bmin[d]) / h);
+    key[5+3*d] = llround((t2->bmax[d] - t2->bmin[d]) / h);
+  }
+
+#ifdef USE_OPENMP
+  omp_set_lock(&kc->lock);
+#endif
+
+  b = hash_kernelcache(keylen, key) & (kc->buckets - 1);
+  e = kc->bucket[b];
+  while(e && memcmp(e->key, key, sizeof(int64_t) * keylen) != 0)
+    e = e->next;
+
+  if(e) {
+    assert(e->A.rows == rows);
+    assert(e->A.cols == cols);
+
+    *fresh = false;
+    freemem(key);
+  }
+  else {
+    if(kc->entries >= 2 * kc->buckets) {
+      rehash_kernelcache(kc);
+      b = hash_kernelcache(keylen, key) & (kc->buckets - 1);
+    }
+
+    e = (pkernelcacheentry) allocmem(sizeof(kernelcacheentry));
+    e->key = key;
+    init_amatrix(&e->A, rows, cols);
+    e->next = kc->bucket[b];
+    kc->bucket[b] = e;
+
+    kc->entries++;
+    kc->size += getsize_heap_amatrix(&e->A);
+
+    *fresh = true;
+  }
+
+#ifdef USE_OPENMP
+  omp_unset_lock(&kc->lock);
+#endif
+
+  return &e->A;
+}
+
+void
+setshared_kernelmatrix(pkernelmatrix km, bool shared)
+{
+  if(km->cache) {
+    del_kernelcache(km->cache);
+    km->cache = 0;
+  }
+
+  if(shared)
+    km->cache = new_kernelcache(km);
+}
+
+size_t
+getsharedsize_kernelmatrix(pckernelmatrix km)
+{
+  return (km->cache ? km->cache->size : 0);
+}
+
 /* ------------------------------------------------------------
  * Create a clustergeometry object
  * ------------------------------------------------------------ */
@@ -86,6 +303,25 @@ creategeometry_kernelmatrix(pckernelmatrix km)
  * Fill a dense matrix
  * ------------------------------------------------------------ */
 
+static real *
+gather_points(const uint *idx, uint n, pckernelmatrix km)
+{
+  uint dim = km->dim;
+  const real **x = (const real **) km->x;
+  real *xx;
+  uint i, d;
+
+  assert(idx || n <= km->points);
+
+  xx = allocreal(n * dim);
+
+  for(d=0; d<dim; d++)
+    for(i=0; i<n; i++)
+      xx[i+d*n] = x[idx ? idx[i] : i][d];
+
+  return xx;
+}
+
 void
 fillN_kernelmatrix(const uint *ridx, const uint *cidx, pckernelmatrix km,
 		   pamatrix N)
@@ -94,8 +330,22 @@ fillN_kernelmatrix(const uint *ridx, const uint *cidx, pckernelmatrix km,
   uint cols = N->cols;
   pfield Na = N->a;
   longindex ldN = N->ld;
+  real *xx, *yy;
   uint i, j, ii, jj;
 
+  if(km->kernel_block) {
+    /* Collect the coordinates and fill the entire block at once */
+    xx = gather_points(ridx, rows, km);
+    yy = gather_points(cidx, cols, km);
+
+    km->kernel_block(xx, yy, km->data, N);
+
+    freemem(yy);
+    freemem(xx);
+
+    return;
+  }
+
   if(ridx) {
     if(cidx) {
       for(j=0; j<cols; j++) {
@@ -147,13 +397,22 @@ fillN_kernelmatrix(const uint *ridx, const uint *cidx, pckernelmatrix km,
 
 static real **
 transform_points(uint dim, real *bmin, real *bmax,
-		 uint m, const real *xi_ref)
+		 uint m, pckernelmatrix km)
 {
   real **xi;
-  real *xi0;
+  real *xi0, *xi_ref;
   real mid, rad;
   uint i, j;
 
+  /* Chebyshev points for orders differing from the default one */
+  if(m == km->m)
+    xi_ref = km->xi_ref;
+  else {
+    xi_ref = allocreal(m);
+    for(i=0; i<m; i++)
+      xi_ref[i] = REAL_COS(M_PI * (m - i - 0.5) / m);
+  }
+
   xi = (real **) allocmem(sizeof(real *) * dim);
 
   xi[0] = xi0 = (real *) allocmem(sizeof(real) * m * dim);
@@ -170,9 +429,30 @@ transform_points(uint dim, real *bmin, real *bmax,
       xi[i][j] = mid + rad * xi_ref[j];
   }
 
+  if(xi_ref != km->xi_ref)
+    freemem(xi_ref);
+
   return xi;
 }
 
+/* Interpolation order m with rank k = m^dim */
+static uint
+order_from_rank(uint dim, uint k)
+{
+  uint m, mk, d;
+
+  m = 0;
+  do {
+    m++;
+    mk = 1;
+    for(d=0; d<dim; d++)
+      mk *= m;
+  } while(mk < k);
+  assert(mk == k);
+
+  return m;
+}
+
 /* ------------------------------------------------------------
  * Fill a coupling matrix
  * ------------------------------------------------------------ */
@@ -180,10 +460,9 @@ transform_points(uint dim, real *bmin, real *bmax,
 static void
 fillS_1d(uint dim, uint i0, uint j0,
 	 const real **rxi, const real **cxi,
-	 pckernelmatrix km,
+	 uint rm, uint cm, pckernelmatrix km,
 	 real *xx, real *yy, pamatrix S)
 {
-  uint m = km->m;
   pfield Sa;
   longindex ldS;
   uint i, j;
@@ -191,13 +470,13 @@ fillS_1d(uint dim, uint i0, uint j0,
   if(dim > 1) {
     dim--;
 
-    for(i=0; i<m; i++) {
+    for(i=0; i<rm; i++) {
       xx[dim] = rxi[dim][i];
 
-      for(j=0; j<m; j++) {
+      for(j=0; j<cm; j++) {
 	yy[dim] = cxi[dim][j];
 
-	fillS_1d(dim, i+i0*m, j+j0*m, rxi, cxi, km,
+	fillS_1d(dim, i+i0*rm, j+j0*cm, rxi, cxi, rm, cm, km,
 		 xx, yy, S);
       }
     }
@@ -206,18 +485,18 @@ fillS_1d(uint dim, uint i0, uint j0,
     Sa = S->a;
     ldS = S->ld;
 
-    assert((m-1) + i0*m < S->rows);
-    assert((m-1) + j0*m < S->cols);
+    assert((rm-1) + i0*rm < S->rows);
+    assert((cm-1) + j0*cm < S->cols);
 
     dim--;
 
-    for(i=0; i<m; i++) {
+    for(i=0; i<rm; i++) {
       xx[dim] = rxi[dim][i];
 
-      for(j=0; j<m; j++) {
+      for(j=0; j<cm; j++) {
 	yy[dim] = cxi[dim][j];
 
-	Sa[(i+i0*m)+(j+j0*m)*ldS] = km->kernel_internal(xx, yy, km->data);
+	Sa[(i+i0*rm)+(j+j0*cm)*ldS] = km->kernel_internal(xx, yy, km->data);
       }
     }
   }
@@ -226,10 +505,9 @@ fillS_1d(uint dim, uint i0, uint j0,
 static void
 fillS_2d(uint dim, uint i0, uint j0,
 	 const real **rxi, const real **cxi,
-	 pckernelmatrix km,
+	 uint rm, uint cm, pckernelmatrix km,
 	 real *xx, real *yy, pamatrix S)
 {
-  uint m = km->m;
   pfield Sa;
   longindex ldS;
   uint i1, j1, i2, j2;
@@ -237,19 +515,19 @@ fillS_2d(uint dim, uint i0, uint j0,
   if(dim > 2) {
     dim -= 2;
 
-    for(i1=0; i1<m; i1++) {
+    for(i1=0; i1<rm; i1++) {
       xx[dim] = rxi[dim][i1];
 
-      for(i2=0; i2<m; i2++) {
+      for(i2=0; i2<rm; i2++) {
 	xx[dim+1] = rxi[dim+1][i2];
 
-	for(j1=0; j1<m; j1++) {
+	for(j1=0; j1<cm; j1++) {
 	  yy[dim] = cxi[dim][j1];
 
-	  for(j2=0; j2<m; j2++) {
+	  for(j2=0; j2<cm; j2++) {
 	    yy[dim+1] = cxi[dim+1][j2];
 
-	    fillS_2d(dim, i1+m*(i2+m*i0), j1+m*(j2+m*j0), rxi, cxi, km,
+	    fillS_2d(dim, i1+rm*(i2+rm*i0), j1+cm*(j2+cm*j0), rxi, cxi, rm, cm, km,
 		     xx, yy, S);
 	  }
 	}
@@ -260,24 +538,24 @@ fillS_2d(uint dim, uint i0, uint j0,
     Sa = S->a;
     ldS = S->ld;
 
-    assert((m*m-1) + i0*m*m < S->rows);
-    assert((m*m-1) + j0*m*m < S->cols);
+    assert((rm*rm-1) + i0*rm*rm < S->rows);
+    assert((cm*cm-1) + j0*cm*cm < S->cols);
 
     dim -= 2;
 
-    for(i1=0; i1<m; i1++) {
+    for(i1=0; i1<rm; i1++) {
       xx[dim] = rxi[dim][i1];
 
-      for(i2=0; i2<m; i2++) {
+      for(i2=0; i2<rm; i2++) {
 	xx[dim+1] = rxi[dim+1][i2];
 
-	for(j1=0; j1<m; j1++) {
+	for(j1=0; j1<cm; j1++) {
 	  yy[dim] = cxi[dim][j1];
 
-	  for(j2=0; j2<m; j2++) {
+	  for(j2=0; j2<cm; j2++) {
 	    yy[dim+1] = cxi[dim+1][j2];
 
-	    Sa[(i1+m*(i2+m*i0)) + (j1+m*(j2+m*j0))*ldS] = km->kernel_internal(xx, yy, km->data);
+	    Sa[(i1+rm*(i2+rm*i0)) + (j1+cm*(j2+cm*j0))*ldS] = km->kernel_internal(xx, yy, km->data);
 	  }
 	}
       }
@@ -286,40 +564,74 @@ fillS_2d(uint dim, uint i0, uint j0,
   else {
     assert(dim == 1);
 
-    fillS_1d(dim, i0, j0, rxi, cxi, km, xx, yy, S);
+    fillS_1d(dim, i0, j0, rxi, cxi, rm, cm, km, xx, yy, S);
   }
 }
 
+static real *
+tensor_points(uint dim, uint m, const real **xi, uint k)
+{
+  real *xx;
+  uint i, i0, d;
+
+  xx = allocreal(k * dim);
+
+  /* Same ordering as in fillS_1d and fillS_2d, first coordinate
+   * running fastest */
+  for(i=0; i<k; i++) {
+    i0 = i;
+    for(d=0; d<dim; d++) {
+      xx[i+d*k] = xi[d][i0 % m];
+      i0 /= m;
+    }
+    assert(i0 == 0);
+  }
+
+  return xx;
+}
+
 void
 fillS_kernelmatrix(pccluster rc, pccluster cc,
 		   pckernelmatrix km, pamatrix S)
 {
   uint dim = km->dim;
-  uint m = km->m;
-  const real *xi_ref = km->xi_ref;
+  uint rm, cm;
   real **rxi, **cxi;
   real *xx, *yy;
 
   assert(rc->dim == dim);
   assert(cc->dim == dim);
 
+  /* Interpolation orders of row and column cluster */
+  rm = order_from_rank(dim, S->rows);
+  cm = order_from_rank(dim, S->cols);
+
   /* Compute transformed interpolation points for the row cluster */
-  rxi = transform_points(dim, rc->bmin, rc->bmax, m, xi_ref);
+  rxi = transform_points(dim, rc->bmin, rc->bmax, rm, km);
 
   /* Compute transformed interpolation points for the column cluster */
-  cxi = transform_points(dim, cc->bmin, cc->bmax, m, xi_ref);
+  cxi = transform_points(dim, cc->bmin, cc->bmax, cm, km);
 
-  /* Allocate storage for coordinate vectors */
-  xx = (real *) allocmem(sizeof(real) * dim);
-  yy = (real *) allocmem(sizeof(real) * dim);
+  if(km->kernel_block) {
+    /* Collect the tensor interpolation points and fill S at once */
+    xx = tensor_points(dim, rm, (const real **) rxi, S->rows);
+    yy = tensor_points(dim, cm, (const real **) cxi, S->cols);
 
-  /* Fill S recursively by dimension */
-  if(dim >= 2)
-    fillS_2d(dim, 0, 0, (const real **) rxi, (const real **) cxi,
-	     km, xx, yy, S);
-  else
-    fillS_1d(dim, 0, 0, (const real **) rxi, (const real **) cxi,
-	     km, xx, yy, S);
+    km->kernel_block(xx, yy, km->data, S);
+  }
+  else {
+    /* Allocate storage for coordinate vectors */
+    xx = (real *) allocmem(sizeof(real) * dim);
+    yy = (real *) allocmem(sizeof(real) * dim);
+
+    /* Fill S recursively by dimension */
+    if(dim >= 2)
+      fillS_2d(dim, 0, 0, (const real **) rxi, (const real **) cxi,
+	       rm, cm, km, xx, yy, S);
+    else
+      fillS_1d(dim, 0, 0, (const real **) rxi, (const real **) cxi,
+	       rm, cm, km, xx, yy, S);
+  }
 
   /* Clean up */
   freemem(yy);
@@ -361,11 +673,9 @@ eval_lagrange(uint m, const real *xi, uint i, real t)
 
 static void
 fillV_1d(uint dim, uint i, uint j0,
-	 const real **txi,
-	 pckernelmatrix km,
+	 const real **txi, uint m,
 	 const real *xx, field alpha0, pamatrix V)
 {
-  uint m = km->m;
   pfield Va;
   longindex ldV;
   field alpha;
@@ -377,7 +687,7 @@ fillV_1d(uint dim, uint i, uint j0,
     for(j=0; j<m; j++) {
       alpha = alpha0 * eval_lagrange(m, txi[dim], j, xx[dim]);
 
-      fillV_1d(dim, i, j+j0*m, txi, km, xx, alpha, V);
+      fillV_1d(dim, i, j+j0*m, txi, m, xx, alpha, V);
     }
   }
   else {
@@ -396,21 +706,23 @@ fillV_kernelmatrix(pccluster tc,
 		   pckernelmatrix km, pamatrix V)
 {
   uint dim = km->dim;
-  uint m = km->m;
-  const real *xi_ref = km->xi_ref;
   const real **x = (const real **) km->x;
   const uint *idx = tc->idx;
   real **txi;
+  uint m;
   uint i;
 
   assert(tc->dim == dim);
 
+  /* Interpolation order of the cluster */
+  m = order_from_rank(dim, V->cols);
+
   /* Compute transformed interpolation points for the cluster */
-  txi = transform_points(dim, tc->bmin, tc->bmax, m, xi_ref);
+  txi = transform_points(dim, tc->bmin, tc->bmax, m, km);
 
   /* Fill V recursively by dimension, each row individually */
   for(i=0; i<tc->size; i++)
-    fillV_1d(dim, i, 0, (const real **) txi, km, x[idx[i]], 1.0, V);
+    fillV_1d(dim, i, 0, (const real **) txi, m, x[idx[i]], 1.0, V);
 
   /* Clean up */
   freemem(txi[0]);
@@ -424,10 +736,9 @@ fillV_kernelmatrix(pccluster tc,
 static void
 fillE_1d(uint dim, uint i0, uint j0,
 	 const real **sxi, const real **fxi,
-	 pckernelmatrix km,
+	 uint sm, uint fm,
 	 field alpha0, pamatrix E)
 {
-  uint m = km->m;
   pfield Ea;
   longindex ldE;
   field alpha;
@@ -436,11 +747,11 @@ fillE_1d(uint dim, uint i0, uint j0,
   if(dim > 0) {
     dim--;
     
-    for(i=0; i<m; i++)
-      for(j=0; j<m; j++) {
-	alpha = alpha0 * eval_lagrange(m, fxi[dim], j, sxi[dim][i]);
+    for(i=0; i<sm; i++)
+      for(j=0; j<fm; j++) {
+	alpha = alpha0 * eval_lagrange(fm, fxi[dim], j, sxi[dim][i]);
 
-	fillE_1d(dim, i+i0*m, j+j0*m, sxi, fxi, km, alpha, E);
+	fillE_1d(dim, i+i0*sm, j+j0*fm, sxi, fxi, sm, fm, alpha, E);
       }
   }
   else {
@@ -459,21 +770,26 @@ fillE_kernelmatrix(pccluster sc, pccluster fc,
 		   pckernelmatrix km, pamatrix E)
 {
   uint dim = km->dim;
-  uint m = km->m;
-  const real *xi_ref = km->xi_ref;
+  uint sm, fm;
   real **sxi, **fxi;
 
   assert(sc->dim == dim);
   assert(fc->dim == dim);
 
+  /* Interpolation orders of son and father cluster, if the son's order
+   * is lower, the father's polynomials are interpolated again */
+  sm = order_from_rank(dim, E->rows);
+  fm = order_from_rank(dim, E->cols);
+
   /* Compute transformed interpolation points for the son cluster */
-  sxi = transform_points(dim, sc->bmin, sc->bmax, m, xi_ref);
+  sxi = transform_points(dim, sc->bmin, sc->bmax, sm, km);
 
   /* Compute transformed interpolation points for the father cluster */
-  fxi = transform_points(dim, fc->bmin, fc->bmax, m, xi_ref);
+  fxi = transform_points(dim, fc->bmin, fc->bmax, fm, km);
 
   /* Fill E recursively by dimension */
-  fillE_1d(dim, 0, 0, (const real **) sxi, (const real **) fxi, km, 1.0, E);
+  fillE_1d(dim, 0, 0, (const real **) sxi, (const real **) fxi, sm, fm,
+	   1.0, E);
 
   /* Clean up */
   freemem(fxi[0]);
@@ -482,35 +798,303 @@ fillE_kernelmatrix(pccluster sc, pccluster fc,
   freemem(sxi);
 }
 
+/* Kronecker factors of the transfer matrix, one Lagrange matrix
+ * for each dimension */
+static void
+fill_kronecker(pclusterbasis cb, pccluster fc, pckernelmatrix km)
+{
+  uint dim = km->dim;
+  pccluster sc = cb->t;
+  real **sxi, **fxi;
+  pamatrix F;
+  uint *sm, *fm;
+  uint i, j, d;
+
+  sm = (uint *) allocmem(sizeof(uint) * dim);
+  fm = (uint *) allocmem(sizeof(uint) * dim);
+  sm[0] = order_from_rank(dim, cb->E.rows);
+  fm[0] = order_from_rank(dim, cb->E.cols);
+  for(d=1; d<dim; d++) {
+    sm[d] = sm[0];
+    fm[d] = fm[0];
+  }
+
+  F = setkronecker_clusterbasis(cb, dim, sm, fm);
+
+  sxi = transform_points(dim, sc->bmin, sc->bmax, sm[0], km);
+  fxi = transform_points(dim, fc->bmin, fc->bmax, fm[0], km);
+
+  for(d=0; d<dim; d++)
+    for(j=0; j<fm[d]; j++)
+      for(i=0; i<sm[d]; i++)
+	F[d].a[i+j*F[d].ld] = eval_lagrange(fm[d], fxi[d], j, sxi[d][i]);
+
+  freemem(fxi[0]);
+  freemem(fxi);
+  freemem(sxi[0]);
+  freemem(sxi);
+  freemem(fm);
+  freemem(sm);
+}
+
 /* ------------------------------------------------------------
- * Fill a cluster basis
+ * Fill shared matrices
  * ------------------------------------------------------------ */
 
+/* Replace A by a reference to the shared matrix for the same
+ * configuration, filling it first if it is new */
 static void
-fill_clusterbasis(pckernelmatrix km, uint k, pclusterbasis cb)
+fill_shared(bool transfer, pccluster t1, pccluster t2,
+	    pckernelmatrix km, pamatrix A)
+{
+  pamatrix S;
+  bool fresh;
+
+  assert(km->cache);
+
+  S = lookup_kernelcache(km->cache, (transfer ? 1 : 0), t1, t2,
+			 A->rows, A->cols, &fresh);
+
+  /* Concurrent users only store a reference, so the matrix can be
+   * filled outside of the lock */
+  if(fresh) {
+    if(transfer)
+      fillE_kernelmatrix(t1, t2, km, S);
+    else
+      fillS_kernelmatrix(t1, t2, km, S);
+  }
+
+  uninit_amatrix(A);
+  (void) init_sub_amatrix(A, S, S->rows, 0, S->cols, 0);
+}
+
+/* Give a previously shared matrix its own storage again */
+static void
+unshare_amatrix(pamatrix A)
+{
+  uint rows = A->rows;
+  uint cols = A->cols;
+
+  if(A->owner) {
+    uninit_amatrix(A);
+    (void) init_amatrix(A, rows, cols);
+  }
+}
+
+/* ------------------------------------------------------------
+ * Level-dependent interpolation orders
+ * ------------------------------------------------------------ */
+
+void
+setorders_kernelmatrix(pkernelmatrix km, uint levels, const uint *m)
+{
+  uint l;
+
+  if(km->m_level) {
+    freemem(km->m_level);
+    km->m_level = 0;
+  }
+
+  km->levels = levels;
+
+  if(levels > 0) {
+    km->m_level = (uint *) allocmem(sizeof(uint) * levels);
+    for(l=0; l<levels; l++) {
+      assert(m[l] > 0);
+      km->m_level[l] = m[l];
+    }
+  }
+}
+
+static real
+diameter(pccluster t)
+{
+  real diam;
+  uint d;
+
+  diam = 0.0;
+  for(d=0; d<t->dim; d++)
+    diam += REAL_SQR(t->bmax[d] - t->bmin[d]);
+
+  return REAL_SQRT(diam);
+}
+
+/* Find the largest cluster on each level */
+static void
+largest_clusters(pccluster t, uint level, pccluster *tl)
 {
   uint i;
 
-  for(i=0; i<cb->sons; i++)
-    fill_clusterbasis(km, k, cb->son[i]);
+  if(tl[level] == 0 || diameter(t) > diameter(tl[level]))
+    tl[level] = t;
 
-  setrank_clusterbasis(cb, k);
+  for(i=0; i<t->sons; i++)
+    largest_clusters(t->son[i], level+1, tl);
+}
 
-  if(cb->sons > 0) {
-    for(i=0; i<cb->sons; i++)
-      fillE_kernelmatrix(cb->son[i]->t, cb->t, km, &cb->son[i]->E);
+/* Relative error of the interpolation of order m of k(.,y) in the box
+ * of t, measured at the test points zz */
+static real
+interpolation_error(pccluster t, const real *y, uint m,
+		    uint kt, const real *zz, pckernelmatrix km)
+{
+  uint dim = km->dim;
+  real **xi;
+  real *xx, *x, *z, *L;
+  pfield f;
+  field g, p, lambda;
+  real err, norm;
+  uint k, i, i0, l, d, j;
+
+  k = 1;
+  for(d=0; d<dim; d++)
+    k *= m;
+
+  /* Values of the kernel function in the interpolation points */
+  xi = transform_points(dim, t->bmin, t->bmax, m, km);
+  xx = tensor_points(dim, m, (const real **) xi, k);
+  x = allocreal(dim);
+  f = allocfield(k);
+  for(i=0; i<k; i++) {
+    for(d=0; d<dim; d++)
+      x[d] = xx[i+d*k];
+    f[i] = km->kernel_internal(x, y, km->data);
   }
-  else
-    fillV_kernelmatrix(cb->t, km, &cb->V);
 
-  update_clusterbasis(cb);
+  /* Compare the interpolant to the kernel function */
+  z = allocreal(dim);
+  L = allocreal(m * dim);
+  err = norm = 0.0;
+  for(l=0; l<kt; l++) {
+    for(d=0; d<dim; d++) {
+      z[d] = zz[l+d*kt];
+      for(j=0; j<m; j++)
+	L[j+d*m] = eval_lagrange(m, xi[d], j, z[d]);
+    }
+
+    p = 0.0;
+    for(i=0; i<k; i++) {
+      lambda = f[i];
+      i0 = i;
+      for(d=0; d<dim; d++) {
+	lambda *= L[(i0 % m)+d*m];
+	i0 /= m;
+      }
+      p += lambda;
+    }
+
+    g = km->kernel_internal(z, y, km->data);
+
+    err = REAL_MAX(err, ABS(g - p));
+    norm = REAL_MAX(norm, ABS(g));
+  }
+
+  freemem(L);
+  freemem(z);
+  freemem(f);
+  freemem(x);
+  freemem(xx);
+  freemem(xi[0]);
+  freemem(xi);
+
+  return (norm > 0.0 ? err / norm : err);
 }
 
 void
-fill_clusterbasis_kernelmatrix(pckernelmatrix km, pclusterbasis cb)
+chooseorders_kernelmatrix(pkernelmatrix km, pccluster root,
+			  real eta, real eps)
+{
+  uint dim = km->dim;
+  uint mt = km->m + 1;
+  pccluster *tl;
+  pccluster t;
+  real **zi;
+  real *zz, *y;
+  uint *m_level;
+  real dist, err;
+  uint levels, kt, l, d, s, j, m;
+
+  assert(root->dim == dim);
+  assert(eta > 0.0);
+
+  levels = getdepth_cluster(root) + 1;
+
+  tl = (pccluster *) allocmem(sizeof(pccluster) * levels);
+  for(l=0; l<levels; l++)
+    tl[l] = 0;
+  largest_clusters(root, 0, tl);
+
+  kt = 1;
+  for(d=0; d<dim; d++)
+    kt *= mt;
+
+  y = allocreal(dim);
+  m_level = (uint *) allocmem(sizeof(uint) * levels);
+
+  for(l=0; l<levels; l++) {
+    t = tl[l];
+    assert(t != 0);
+
+    /* Order one is exact if the box is a single point */
+    dist = diameter(t) / eta;
+    if(dist == 0.0) {
+      m_level[l] = 1;
+      continue;
+    }
+
+    /* Test points, different from the interpolation points */
+    zi = transform_points(dim, t->bmin, t->bmax, mt, km);
+    zz = tensor_points(dim, mt, (const real **) zi, kt);
+
+    /* Smallest order reaching the accuracy for the closest points
+     * allowed by the admissibility condition in all directions */
+    for(m=1; m<km->m; m++) {
+      err = 0.0;
+      for(d=0; d<dim && err <= eps; d++)
+	for(s=0; s<2 && err <= eps; s++) {
+	  for(j=0; j<dim; j++)
+	    y[j] = 0.5 * (t->bmax[j] + t->bmin[j]);
+	  y[d] = (s == 0 ? t->bmax[d] + dist : t->bmin[d] - dist);
+
+	  err = interpolation_error(t, y, m, kt, zz, km);
+	}
+
+      if(err <= eps)
+	break;
+    }
+    m_level[l] = m;
+
+    freemem(zz);
+    freemem(zi[0]);
+    freemem(zi);
+  }
+
+  setorders_kernelmatrix(km, levels, m_level);
+
+  freemem(m_level);
+  freemem(y);
+  freemem(tl);
+}
+
+/* ------------------------------------------------------------
+ * Fill a cluster basis
+ * ------------------------------------------------------------ */
+
+/* Interpolation order for a cluster on the given level */
+static uint
+getorder(pckernelmatrix km, uint level)
+{
+  if(km->levels == 0)
+    return km->m;
+
+  return km->m_level[(level < km->levels ? level : km->levels-1)];
+}
+
+static void
+fill_clusterbasis(pckernelmatrix km, uint level, pclusterbasis cb)
 {
   uint dim = km->dim;
-  uint m = km->m;
+  uint m = getorder(km, level);
   uint k;
   uint i;
 
@@ -518,7 +1102,36 @@ fill_clusterbasis_kernelmatrix(pckernelmatrix km, pclusterbasis cb)
   for(i=0; i<dim; i++)
     k *= m;
 
-  fill_clusterbasis(km, k, cb);
+  /* Transfer matrices shared by an earlier fill cannot be resized */
+  unshare_amatrix(&cb->E);
+
+  for(i=0; i<cb->sons; i++)
+    fill_clusterbasis(km, level+1, cb->son[i]);
+
+  setrank_clusterbasis(cb, k);
+
+  if(cb->sons > 0) {
+    for(i=0; i<cb->sons; i++) {
+      if(km->cache)
+	fill_shared(true, cb->son[i]->t, cb->t, km, &cb->son[i]->E);
+      else
+	fillE_kernelmatrix(cb->son[i]->t, cb->t, km, &cb->son[i]->E);
+
+      /* Factorized transfer matrix for forward and backward
+       * transformations */
+      fill_kronecker(cb->son[i], cb->t, km);
+    }
+  }
+  else
+    fillV_kernelmatrix(cb->t, km, &cb->V);
+
+  update_clusterbasis(cb);
+}
+
+void
+fill_clusterbasis_kernelmatrix(pckernelmatrix km, pclusterbasis cb)
+{
+  fill_clusterbasis(km, 0, cb);
 }
 
 /* ------------------------------------------------------------
@@ -528,21 +1141,35 @@ fill_clusterbasis_kernelmatrix(pckernelmatrix km, pclusterbasis cb)
 void
 fill_h2matrix_kernelmatrix(pckernelmatrix km, ph2matrix G)
 {
-  uint rsons, csons;
-  uint i, j;
+  ph2matrix *enum_G;
+  uint desc = G->desc;
+  uint i;
 
-  if(G->son) {
-    rsons = G->rsons;
-    csons = G->csons;
+  /* Leaves are independent, so they can be filled in any order */
+  enum_G = enumerate_h2matrix(G);
 
-    for(j=0; j<csons; j++)
-      for(i=0; i<rsons; i++)
-	fill_h2matrix_kernelmatrix(km, G->son[i+j*rsons]);
-  }
-  else if(G->u)
-    fillS_kernelmatrix(G->rb->t, G->cb->t, km, &G->u->S);
-  else {
-    assert(G->f);
-    fillN_kernelmatrix(G->rb->t->idx, G->cb->t->idx, km, G->f);
+#ifdef USE_OPENMP
+#pragma omp parallel for if(!omp_in_parallel() && desc > 1) schedule(dynamic,1)
+#endif
+  for(i=0; i<desc; i++) {
+    ph2matrix G1 = enum_G[i];
+
+    if(G1->son)
+      continue;
+
+    if(G1->u) {
+      if(km->cache)
+	fill_shared(false, G1->rb->t, G1->cb->t, km, &G1->u->S);
+      else {
+	unshare_amatrix(&G1->u->S);
+	fillS_kernelmatrix(G1->rb->t, G1->cb->t, km, &G1->u->S);
+      }
+    }
+    else {
+      assert(G1->f);
+      fillN_kernelmatrix(G1->rb->t->idx, G1->cb->t->idx, km, G1->f);
+    }
   }
+
+  freemem(enum_G);
 }
@@ -24,11 +24,33 @@ typedef kernelmatrix *pkernelmatrix;
 /** @brief Pointer to a constant @ref kernelmatrix object. */
 typedef const kernelmatrix *pckernelmatrix;
 
+/** @brief Cache of coupling and transfer matrices shared between
+ *  translated configurations of bounding boxes. */
+typedef struct _kernelcache kernelcache;
+
+/** @brief Pointer to a @ref kernelcache object. */
+typedef kernelcache *pkernelcache;
+
+/** @brief Pointer to a constant @ref kernelcache object. */
+typedef const kernelcache *pckernelcache;
+
+/** @brief Entry of a @ref kernelcache. */
+typedef struct _kernelcacheentry kernelcacheentry;
+
+/** @brief Pointer to a @ref kernelcacheentry object. */
+typedef kernelcacheentry *pkernelcacheentry;
+
+#include <stdint.h>
+
 #include "settings.h"
 #include "h2matrix.h"
 #include "cluster.h"
 #include "clustergeometry.h"
 
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
 /** @brief Representation of a kernel matrix an its approximation.
  *
  *  A kernel matrix is a matrix with entries of the form
@@ -48,6 +70,19 @@ struct _kernelmatrix {
   /** @brief Internal kernel function using coordinates (for interpolation). */
   field (*kernel_internal)(const real *xx, const real *yy, void *data);
 
+  /** @brief Optional block kernel function using coordinates.
+   *
+   *  If set, fills an entire matrix @f$n_{ij} = k(x_i,y_j)@f$ at once
+   *  instead of calling <tt>kernel</tt> or <tt>kernel_internal</tt> for each
+   *  entry, so that the loops over the entries can be vectorized.
+   *  The coordinates are stored component by component, i.e.,
+   *  the @f$d@f$-th coordinate of @f$x_i@f$ is <tt>xx[i+d*N->rows]</tt>
+   *  and the @f$d@f$-th coordinate of @f$y_j@f$ is
+   *  <tt>yy[j+d*N->cols]</tt>.
+   *  Has to be consistent with <tt>kernel_internal</tt>. */
+  void (*kernel_block)(const real *xx, const real *yy, void *data,
+		       pamatrix N);
+
   /** @brief Data for the kernel function. */
   void *data;
 
@@ -57,11 +92,73 @@ struct _kernelmatrix {
   /** @brief Coordinates of points. */
   real **x;
 
-  /** @brief Interpolation order (i.e., number of interpolation points). */
+  /** @brief Interpolation order (i.e., number of interpolation points),
+   *  used on all levels unless <tt>m_level</tt> is set. */
   uint m;
 
+  /** @brief Number of entries of <tt>m_level</tt>, zero if the order
+   *  <tt>m</tt> is used on all levels. */
+  uint levels;
+
+  /** @brief Interpolation orders for the levels of the cluster tree,
+   *  the last entry is also used for all finer levels,
+   *  see @ref setorders_kernelmatrix. */
+  uint *m_level;
+
   /** @brief Interpolation points for the reference interval @f$[-1,1@f$. */
   real *xi_ref;
+
+  /** @brief Cache of shared coupling and transfer matrices,
+   *  null if matrices are not shared, see @ref setshared_kernelmatrix. */
+  pkernelcache cache;
+};
+
+/** @brief Coupling or transfer matrix for one configuration of
+ *  bounding boxes. */
+struct _kernelcacheentry {
+  /** @brief Quantized description of the configuration: kind of
+   *  matrix, offset between the boxes and extents of both boxes. */
+  int64_t *key;
+
+  /** @brief Shared matrix. */
+  amatrix A;
+
+  /** @brief Next entry in the same bucket. */
+  pkernelcacheentry next;
+};
+
+/** @brief Hash table of coupling and transfer matrices.
+ *
+ *  Coupling matrices for a translation-invariant kernel function
+ *  only depend on the relative position and the extents of the row
+ *  and column bounding boxes, and transfer matrices only depend on
+ *  the relative position and extents of the son and father boxes.
+ *  For quasi-uniform point sets, e.g., regular grids, only a few of
+ *  these configurations exist, so one matrix can be shared by many
+ *  blocks or clusters. */
+struct _kernelcache {
+  /** @brief Buckets of the hash table. */
+  pkernelcacheentry *bucket;
+
+  /** @brief Number of buckets, a power of two. */
+  uint buckets;
+
+  /** @brief Number of entries. */
+  uint entries;
+
+  /** @brief Length of the keys. */
+  uint keylen;
+
+  /** @brief Resolution used to quantize coordinates. */
+  real h;
+
+  /** @brief Storage used by the shared matrices in bytes. */
+  size_t size;
+
+#ifdef USE_OPENMP
+  /** @brief Lock for parallel fills. */
+  omp_lock_t lock;
+#endif
 };
 
 /** @brief Create an empty @ref kernelmatrix object.
@@ -79,6 +176,85 @@ new_kernelmatrix(uint dim, uint points, uint m);
 HEADER_PREFIX void
 del_kernelmatrix(pkernelmatrix km);
 
+/** @brief Share coupling and transfer matrices between translated
+ *  configurations of bounding boxes.
+ *
+ *  If sharing is switched on, @ref fill_clusterbasis_kernelmatrix and
+ *  @ref fill_h2matrix_kernelmatrix compare the offset and extents of
+ *  the bounding boxes, relative to the diameter of the point set, and
+ *  let all transfer and coupling matrices with the same configuration
+ *  refer to one matrix stored in <tt>km->cache</tt>.
+ *  This is only correct if the kernel function is translation-invariant,
+ *  i.e., @f$k(x+z,y+z) = k(x,y)@f$.
+ *
+ *  @remark The shared matrices belong to <tt>km</tt>, so the
+ *  cluster bases and @ref h2matrix objects filled with it have to be
+ *  deleted before <tt>km</tt> is deleted or sharing is switched off,
+ *  and they must not be modified.
+ *
+ *  @param km Description of the kernel matrix, the points have to be
+ *         set up already.
+ *  @param shared Set to <tt>true</tt> to switch sharing on,
+ *         <tt>false</tt> to switch it off and release the shared
+ *         matrices. */
+HEADER_PREFIX void
+setshared_kernelmatrix(pkernelmatrix km, bool shared);
+
+/** @brief Use different interpolation orders on different levels
+ *  of the cluster tree.
+ *
+ *  Clusters on level @f$\ell@f$ use the order <tt>m[</tt>@f$\ell@f$<tt>]</tt>,
+ *  or the last order if @f$\ell \geq @f$ <tt>levels</tt>, so the ranks
+ *  of the cluster bases can shrink towards the leaves.
+ *  The orders are taken into account by
+ *  @ref fill_clusterbasis_kernelmatrix, while @ref fillS_kernelmatrix,
+ *  @ref fillV_kernelmatrix and @ref fillE_kernelmatrix determine the
+ *  orders from the dimensions of the matrices they fill.
+ *  If a son uses a lower order than its father, the transfer matrix
+ *  interpolates the father's polynomials again.
+ *
+ *  @remark Orders other than <tt>km->m</tt> always use Chebyshev points.
+ *
+ *  @param km Description of the kernel matrix.
+ *  @param levels Number of orders, zero to use <tt>km->m</tt> on
+ *         all levels.
+ *  @param m Interpolation orders for the levels. */
+HEADER_PREFIX void
+setorders_kernelmatrix(pkernelmatrix km, uint levels, const uint *m);
+
+/** @brief Choose the interpolation orders of all levels of a cluster tree
+ *  by an error estimate.
+ *
+ *  For the largest cluster on each level, the kernel function
+ *  @f$k(\cdot,y)@f$ is interpolated in the bounding box for points
+ *  @f$y@f$ at the smallest distance permitted by the admissibility
+ *  parameter in all coordinate directions, and the error is measured
+ *  in a grid of test points.
+ *  The smallest order reaching the relative accuracy <tt>eps</tt> is
+ *  chosen, but not more than <tt>km->m</tt>.
+ *  Kernel functions with a fixed length scale, e.g., Gaussians, need
+ *  far fewer interpolation points in clusters that are small compared
+ *  to it.
+ *
+ *  @param km Description of the kernel matrix, <tt>kernel_internal</tt>
+ *         has to be set.
+ *  @param root Root of the cluster tree.
+ *  @param eta Admissibility parameter, the distance between admissible
+ *         clusters is assumed to be at least their diameter divided by
+ *         <tt>eta</tt>.
+ *  @param eps Relative accuracy. */
+HEADER_PREFIX void
+chooseorders_kernelmatrix(pkernelmatrix km, pccluster root,
+			  real eta, real eps);
+
+/** @brief Storage used by the shared coupling and transfer matrices.
+ *
+ *  @param km Description of the kernel matrix.
+ *  @returns Size of the shared matrices in bytes, zero if sharing
+ *    is switched off. */
+HEADER_PREFIX size_t
+getsharedsize_kernelmatrix(pckernelmatrix km);
+
 /** @brief Create a @ref clustergeometry object for a @ref kernelmatrix
  *  object.
  *
@@ -88,6 +264,8 @@ HEADER_PREFIX pclustergeometry
 creategeometry_kernelmatrix(pckernelmatrix km);
 
 /** @brief Fill nearfield matrices.
+ *
+ *  Uses the block kernel function if it is available.
  *
  *  @param ridx Row indices.
  *  @param cidx Column indices.
@@ -98,6 +276,8 @@ fillN_kernelmatrix(const uint *ridx, const uint *cidx, pckernelmatrix km,
 		   pamatrix N);
 
 /** @brief Fill coupling matrices with interpolation coefficients.
+ *
+ *  Uses the block kernel function if it is available.
  *
  *  @param rc Row cluster.
  *  @param cc Column cluster.
@@ -127,6 +307,12 @@ fillE_kernelmatrix(pccluster sc, pccluster fc,
 		   pckernelmatrix km, pamatrix E);
 
 /** @brief Fill a @ref clusterbasis using interpolation.
+ *
+ *  Transfer matrices are shared if @ref setshared_kernelmatrix has
+ *  been called.
+ *  Their Kronecker factors, one one-dimensional Lagrange matrix for
+ *  each coordinate, are stored as well, see
+ *  @ref setkronecker_clusterbasis.
  *
  *  @param km Description of the kernel matrix.
  *  @param cb Cluster basis to be filled. */
@@ -134,6 +320,10 @@ HEADER_PREFIX void
 fill_clusterbasis_kernelmatrix(pckernelmatrix km, pclusterbasis cb);
 
 /** @brief Fill a @ref h2matrix using interpolation.
+ *
+ *  The leaves are filled in parallel if OpenMP is enabled, and
+ *  coupling matrices are shared if @ref setshared_kernelmatrix has
+ *  been called.
  *
  *  @param km Description of the kernel matrix.
  *  @param G Matrix to be filled. */
@@ -175,6 +175,8 @@ void
 step_cg(addeval_t addeval, void *matrix, pcavector b, pavector x,
 	pavector r, pavector p, pavector a)
 {
+  pcavector xs[2], ys[2];
+  field     d[2];
   field     gamma, lambda, mu;
 
   (void) b;
@@ -182,16 +184,20 @@ step_cg(addeval_t addeval, void *matrix, pcavector b, pavector x,
   clear_avector(a);		/* a = A p */
   addeval(1.0, matrix, p, a);
 
-  gamma = dotprod_avector(p, a);	/* lambda = <p, r> / <p, a> */
-  lambda = dotprod_avector(p, r) / gamma;
+  xs[0] = p;			/* lambda = <p, r> / <p, a> */
+  ys[0] = a;
+  xs[1] = p;
+  ys[1] = r;
+  dotprods_avector(2, xs, ys, d);
+  gamma = d[0];
+  lambda = d[1] / gamma;
 
   add_avector(lambda, p, x);	/* x = x + lambda p */
 
-  add_avector(-lambda, a, r);	/* r = r - lambda a */
+  /* r = r - lambda a, mu = <a, r> / <p, a> */
+  mu = adddotprod_avector(-lambda, a, r, a) / gamma;
 
-  mu = dotprod_avector(a, r) / gamma; /* p = r - mu p */
-  scale_avector(-mu, p);
-  add_avector(1.0, r, p);
+  scaleadd_avector(1.0, r, -mu, p);	/* p = r - mu p */
 }
 
 real
@@ -237,6 +243,8 @@ step_pcg(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata, pcavector b,
 	 pavector p,		/* Search direction */
 	 pavector a)
 {
+  pcavector xs[2], ys[2];
+  field     d[2];
   field     gamma, lambda, mu;
 
   (void) b;
@@ -244,8 +252,13 @@ step_pcg(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata, pcavector b,
   clear_avector(a);		/* a = A p */
   addeval(1.0, matrix, p, a);
 
-  gamma = dotprod_avector(p, a);	/* lambda = <p, r> / <p, a> */
-  lambda = dotprod_avector(p, r) / gamma;
+  xs[0] = p;			/* lambda = <p, r> / <p, a> */
+  ys[0] = a;
+  xs[1] = p;
+  ys[1] = r;
+  dotprods_avector(2, xs, ys, d);
+  gamma = d[0];
+  lambda = d[1] / gamma;
 
   add_avector(lambda, p, x);	/* x = x + lambda p */
 
@@ -256,9 +269,8 @@ step_pcg(addeval_t addeval, void *matrix, prcd_t prcd, void *pdata, pcavector b,
     prcd(pdata, q);
 
   mu = dotprod_avector(a, q) / gamma; /* mu = <a, q> / <p, a> */
-  
-  scale_avector(-mu, p);	/* p = r - mu p */
-  add_avector(1.0, q, p);
+
+  scaleadd_avector(1.0, q, -mu, p);	/* p = q - mu p */
 }
 
 /* ------------------------------------------------------------
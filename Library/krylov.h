@@ -40,6 +40,22 @@
  *  @param y Target vector @f$y@f$. */
 typedef void (*addeval_t)(field alpha, void *matrix, pcavector x, pavector y);
 
+/** @brief Block matrix callback.
+ *
+ *  Used to evaluate the system matrix @f$A@f$ for several vectors
+ *  at once, i.e., to perform @f$Y \gets Y + \alpha A X@f$.
+ *
+ *  Compared to @ref addeval_t, callbacks of this type allow
+ *  hierarchical matrices to be traversed only once for all columns
+ *  of @f$X@f$.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param matrix Matrix data describing @f$A@f$.
+ *  @param X Source matrix @f$X@f$.
+ *  @param Y Target matrix @f$Y@f$. */
+typedef void (*addevalmat_t)(field alpha, void *matrix, pcamatrix X,
+    pamatrix Y);
+
 /** @brief Matrix callback.
  *
  *  Used to evaluate the system matrix @f$A@f$ or its adjoint,
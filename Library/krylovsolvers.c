@@ -9,6 +9,8 @@
 #include "krylovsolvers.h"
 #include "basic.h"
 #include "krylov.h"
+#include "harith.h"
+#include "h2arith.h"
 
 /* ------------------------------------------------------------
  * Conjugated gradients method
@@ -176,51 +178,297 @@ solve_pcg_dh2matrix_avector(pcdh2matrix A, prcd_t prcd, void *pdata,
 }
 
 /* ------------------------------------------------------------
- * Generalized minimal residual method
+ * GMRES workspace
  * ------------------------------------------------------------ */
 
-uint
-solve_gmres_avector(void *A, addeval_t addeval_A, pcavector b, pavector x,
-		    real eps, uint maxiter, uint kmax)
+pgmresworkspace
+new_gmresworkspace(uint dim, uint kmax)
 {
-  pavector  rhat, r, q, tau;
-  pamatrix  qr;
-  real      norm, error;
-  uint      n, iter, k;
+  pgmresworkspace ws;
 
-  n = x->dim;
+  assert(kmax >= 2);
 
-  assert(b->dim == n);
+  ws = (pgmresworkspace) allocmem(sizeof(gmresworkspace));
 
-  rhat = new_avector(n);
-  r = new_avector(n);
-  q = new_avector(n);
-  qr = new_amatrix(n, kmax);
-  tau = new_avector(kmax);
+  ws->dim = dim;
+  ws->kmax = kmax;
+  ws->V = new_amatrix(dim, kmax);
+  ws->H = new_amatrix(kmax, kmax - 1);
+  ws->g = new_avector(kmax);
+  ws->c = new_realavector(kmax);
+  ws->s = new_avector(kmax);
+  ws->h = new_avector(kmax);
+  ws->r = new_avector(dim);
+  ws->Z = 0;
 
-  norm = norm2_avector(b);
+  return ws;
+}
 
-  init_gmres(addeval_A, A, b, x, rhat, q, &k, qr, tau);
-  error = residualnorm_gmres(rhat, k);
+void
+del_gmresworkspace(pgmresworkspace ws)
+{
+  if (ws->Z)
+    del_amatrix(ws->Z);
+  del_avector(ws->r);
+  del_avector(ws->h);
+  del_avector(ws->s);
+  del_realavector(ws->c);
+  del_avector(ws->g);
+  del_amatrix(ws->H);
+  del_amatrix(ws->V);
+
+  freemem(ws);
+}
+
+/* Set up the first basis vector from the (preconditioned) residual
+ * and return its norm */
+static    real
+start_gmres(void *A, addeval_t addeval_A, prcd_t prcd, void *pdata,
+	    pgmresworkspace ws, pcavector b, pcavector x)
+{
+  avector   tmp;
+  pavector  v;
+  real      beta;
+
+  v = init_column_avector(&tmp, ws->V, 0);
+  copy_avector(b, v);
+  addeval_A(-1.0, A, x, v);
+  if (prcd)
+    prcd(pdata, v);
+
+  beta = norm2_avector(v);
+  if (beta > 0.0)
+    scale_avector(1.0 / beta, v);
+  uninit_avector(v);
+
+  clear_avector(ws->g);
+  ws->g->v[0] = beta;
+
+  return beta;
+}
+
+/* Apply the preceding Givens rotations to the new column hk of the
+ * Hessenberg matrix, eliminate its subdiagonal entry hk[k+1] and update
+ * the transformed residual g. Returns the new residual norm. */
+static    real
+rotate_gmres(field *hk, uint k, prealavector cv, pavector sv, pavector g)
+{
+  field     a, b, s;
+  real      c, nu, r;
+  uint      i;
+
+  for (i = 0; i < k; i++) {
+    c = cv->v[i];
+    s = sv->v[i];
+    a = hk[i];
+    b = hk[i + 1];
+    hk[i] = c * a + s * b;
+    hk[i + 1] = c * b - CONJ(s) * a;
+  }
+
+  a = hk[k];
+  nu = REAL(hk[k + 1]);
+  r = REAL_SQRT(ABSSQR(a) + nu * nu);
+  if (r == 0.0) {
+    c = 1.0;
+    s = 0.0;
+  }
+  else if (ABS(a) == 0.0) {
+    c = 0.0;
+    s = 1.0;
+  }
+  else {
+    c = ABS(a) / r;
+    s = a / ABS(a) * nu / r;
+  }
+  cv->v[k] = c;
+  sv->v[k] = s;
+  hk[k] = c * a + s * nu;
+  hk[k + 1] = 0.0;
+
+  a = g->v[k];
+  g->v[k] = c * a;
+  g->v[k + 1] = -CONJ(s) * a;
+
+  return ABS(g->v[k + 1]);
+}
+
+/* Extend the Krylov basis by A v_k, or A N v_k in the flexible case,
+ * orthogonalize by CGS2 and update the triangular factor and the
+ * transformed residual */
+static    real
+step_gmres_workspace(void *A, addeval_t addeval_A, prcd_t prcd, void *pdata,
+		     bool flexible, pgmresworkspace ws, uint k)
+{
+  avector   tmp1, tmp2, tmp3, tmp4;
+  amatrix   tmp5;
+  pavector  v, w, z, hk, h;
+  pamatrix  Vk;
+  field    *Hk;
+  real      nu;
+
+  assert(k + 1 < ws->kmax);
+
+  v = init_column_avector(&tmp1, ws->V, k);
+  w = init_column_avector(&tmp2, ws->V, k + 1);
+  clear_avector(w);
+  if (flexible) {
+    z = init_column_avector(&tmp3, ws->Z, k);
+    copy_avector(v, z);
+    prcd(pdata, z);
+    addeval_A(1.0, A, z, w);
+    uninit_avector(z);
+  }
+  else {
+    addeval_A(1.0, A, v, w);
+    if (prcd)
+      prcd(pdata, w);
+  }
+  uninit_avector(v);
+
+  /* Classical Gram-Schmidt against all previous vectors at once,
+   * repeated once to restore orthogonality lost to cancellation */
+  Vk = init_sub_amatrix(&tmp5, ws->V, ws->dim, 0, k + 1, 0);
+  Hk = ws->H->a + (size_t) k * ws->H->ld;
+  hk = init_pointer_avector(&tmp3, Hk, k + 1);
+  clear_avector(hk);
+  addevaltrans_amatrix_avector(1.0, Vk, w, hk);
+  addeval_amatrix_avector(-1.0, Vk, hk, w);
+
+  h = init_sub_avector(&tmp4, ws->h, k + 1, 0);
+  clear_avector(h);
+  addevaltrans_amatrix_avector(1.0, Vk, w, h);
+  addeval_amatrix_avector(-1.0, Vk, h, w);
+  add_avector(1.0, h, hk);
+  uninit_avector(h);
+  uninit_avector(hk);
+  uninit_amatrix(Vk);
+
+  nu = norm2_avector(w);
+  if (nu > 0.0)
+    scale_avector(1.0 / nu, w);
+  uninit_avector(w);
+
+  Hk[k + 1] = nu;
+
+  return rotate_gmres(Hk, k, ws->c, ws->s, ws->g);
+}
+
+/* Update the solution with the first k (preconditioned) basis vectors */
+static void
+finish_gmres_workspace(bool flexible, pgmresworkspace ws, uint k,
+		       pavector x)
+{
+  avector   tmp1;
+  amatrix   tmp2, tmp3;
+  pavector  y;
+  pamatrix  Hk, Vk;
+
+  if (k == 0)
+    return;
+
+  y = init_sub_avector(&tmp1, ws->g, k, 0);
+  Hk = init_sub_amatrix(&tmp2, ws->H, k, 0, k, 0);
+  triangularsolve_amatrix_avector(false, false, false, Hk, y);
+  uninit_amatrix(Hk);
+
+  Vk = init_sub_amatrix(&tmp3, (flexible ? ws->Z : ws->V), ws->dim, 0, k,
+			0);
+  addeval_amatrix_avector(1.0, Vk, y, x);
+  uninit_amatrix(Vk);
+  uninit_avector(y);
+}
+
+static    uint
+solve_gmres_prcd(void *A, addeval_t addeval_A, prcd_t prcd, void *pdata,
+		 bool flexible, pgmresworkspace ws, pcavector b, pavector x,
+		 real eps, uint maxiter)
+{
+  pavector  r;
+  prcd_t    left;
+  real      norm, error;
+  uint      iter, k;
+
+  assert(b->dim == ws->dim);
+  assert(x->dim == ws->dim);
+
+  /* Preconditioner applied from the left, only in the standard case */
+  left = (flexible ? 0 : prcd);
+
+  if (left) {
+    r = ws->r;
+    copy_avector(b, r);
+    prcd(pdata, r);
+    norm = norm2_avector(r);
+  }
+  else
+    norm = norm2_avector(b);
+
+  error = start_gmres(A, addeval_A, left, pdata, ws, b, x);
+  k = 0;
 
   iter = 0;
   while (error > eps * norm && iter + 1 != maxiter) {
-    if (k + 1 >= kmax) {
-      finish_gmres(addeval_A, A, b, x, rhat, q, &k, qr, tau);
+    if (k + 1 >= ws->kmax) {
+      finish_gmres_workspace(flexible, ws, k, x);
+      error = start_gmres(A, addeval_A, left, pdata, ws, b, x);
+      k = 0;
     }
 
-    step_gmres(addeval_A, A, b, x, rhat, q, &k, qr, tau);
-    error = residualnorm_gmres(rhat, k);
+    error = step_gmres_workspace(A, addeval_A, prcd, pdata, flexible, ws, k);
+    k++;
 
     iter++;
   }
-  finish_gmres(addeval_A, A, b, x, rhat, q, &k, qr, tau);
+  finish_gmres_workspace(flexible, ws, k, x);
 
-  del_avector(tau);
-  del_amatrix(qr);
-  del_avector(q);
-  del_avector(r);
-  del_avector(rhat);
+  return iter;
+}
+
+uint
+solve_gmres_workspace_avector(void *A, addeval_t addeval_A,
+			      pgmresworkspace ws, pcavector b, pavector x,
+			      real eps, uint maxiter)
+{
+  return solve_gmres_prcd(A, addeval_A, 0, 0, false, ws, b, x, eps,
+			  maxiter);
+}
+
+uint
+solve_pgmres_workspace_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+			       void *pdata, pgmresworkspace ws, pcavector b,
+			       pavector x, real eps, uint maxiter)
+{
+  return solve_gmres_prcd(A, addeval_A, prcd, pdata, false, ws, b, x, eps,
+			  maxiter);
+}
+
+uint
+solve_fgmres_workspace_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+			       void *pdata, pgmresworkspace ws, pcavector b,
+			       pavector x, real eps, uint maxiter)
+{
+  if (ws->Z == 0)
+    ws->Z = new_amatrix(ws->dim, ws->kmax - 1);
+
+  return solve_gmres_prcd(A, addeval_A, prcd, pdata, true, ws, b, x, eps,
+			  maxiter);
+}
+
+/* ------------------------------------------------------------
+ * Generalized minimal residual method
+ * ------------------------------------------------------------ */
+
+uint
+solve_gmres_avector(void *A, addeval_t addeval_A, pcavector b, pavector x,
+		    real eps, uint maxiter, uint kmax)
+{
+  pgmresworkspace ws;
+  uint      iter;
+
+  ws = new_gmresworkspace(x->dim, kmax);
+  iter = solve_gmres_workspace_avector(A, addeval_A, ws, b, x, eps, maxiter);
+  del_gmresworkspace(ws);
 
   return iter;
 }
@@ -276,48 +524,13 @@ solve_pgmres_avector(void *A, addeval_t addeval_A, prcd_t prcd,
 		     void *pdata, pcavector b, pavector x, real eps,
 		     uint maxiter, uint kmax)
 {
-  pavector  rhat, r, q, tau;
-  pamatrix  qr;
-  real      norm, error;
-  uint      n, iter, k;
-
-  n = x->dim;
-
-  assert(b->dim == n);
-
-  rhat = new_avector(n);
-  r = new_avector(n);
-  q = new_avector(n);
-  qr = new_amatrix(n, kmax);
-  tau = new_avector(kmax);
-
-  copy_avector(b, r);
-  prcd(pdata, r);
-  norm = norm2_avector(r);
-
-  init_pgmres(addeval_A, A, prcd, pdata, b, x, rhat, q, &k, qr, tau);
-  error = residualnorm_pgmres(rhat, k);
-
-  iter = 0;
-  while (error > eps * norm && iter + 1 != maxiter) {
-    if (k + 1 >= kmax) {
-      finish_pgmres(addeval_A, A, prcd, pdata, b, x, rhat, q, &k, qr, tau);
-    }
+  pgmresworkspace ws;
+  uint      iter;
 
-    step_pgmres(addeval_A, A, prcd, pdata, b, x, rhat, q, &k, qr, tau);
-    error = residualnorm_pgmres(rhat, k);
-
-    iter++;
-  }
-
-  if (k > 0)
-    finish_pgmres(addeval_A, A, prcd, pdata, b, x, rhat, q, &k, qr, tau);
-
-  del_avector(tau);
-  del_amatrix(qr);
-  del_avector(q);
-  del_avector(r);
-  del_avector(rhat);
+  ws = new_gmresworkspace(x->dim, kmax);
+  iter = solve_pgmres_workspace_avector(A, addeval_A, prcd, pdata, ws, b, x,
+					eps, maxiter);
+  del_gmresworkspace(ws);
 
   return iter;
 }
@@ -369,3 +582,1281 @@ solve_pgmres_dh2matrix_avector(pcdh2matrix A, prcd_t prcd, void *pdata,
 			      (addeval_t) addeval_dh2matrix_avector, prcd,
 			      pdata, b, x, eps, maxiter, kmax);
 }
+
+/* ------------------------------------------------------------
+ * Flexible generalized minimal residual method
+ * ------------------------------------------------------------ */
+
+uint
+solve_fgmres_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+		     void *pdata, pcavector b, pavector x, real eps,
+		     uint maxiter, uint kmax)
+{
+  pgmresworkspace ws;
+  uint      iter;
+
+  ws = new_gmresworkspace(x->dim, kmax);
+  iter = solve_fgmres_workspace_avector(A, addeval_A, prcd, pdata, ws, b, x,
+					eps, maxiter);
+  del_gmresworkspace(ws);
+
+  return iter;
+}
+
+uint
+solve_fgmres_amatrix_avector(pcamatrix A, prcd_t prcd, void *pdata,
+			     pcavector b, pavector x, real eps, uint maxiter,
+			     uint kmax)
+{
+  return solve_fgmres_avector((void *) A, (addeval_t) addeval_amatrix_avector,
+			      prcd, pdata, b, x, eps, maxiter, kmax);
+}
+
+uint
+solve_fgmres_hmatrix_avector(pchmatrix A, prcd_t prcd, void *pdata,
+			     pcavector b, pavector x, real eps, uint maxiter,
+			     uint kmax)
+{
+  return solve_fgmres_avector((void *) A, (addeval_t) addeval_hmatrix_avector,
+			      prcd, pdata, b, x, eps, maxiter, kmax);
+}
+
+uint
+solve_fgmres_h2matrix_avector(pch2matrix A, prcd_t prcd, void *pdata,
+			      pcavector b, pavector x, real eps,
+			      uint maxiter, uint kmax)
+{
+  return solve_fgmres_avector((void *) A,
+			      (addeval_t) addeval_h2matrix_avector, prcd,
+			      pdata, b, x, eps, maxiter, kmax);
+}
+
+/* ------------------------------------------------------------
+ * Coarse LU preconditioners
+ * ------------------------------------------------------------ */
+
+pcoarselu
+build_hmatrix_coarselu(pchmatrix A, pctruncmode tm, real eps, size_t budget)
+{
+  pcoarselu lu;
+  phmatrix  LR;
+
+  assert(eps > 0.0);
+
+  lu = (pcoarselu) allocmem(sizeof(coarselu));
+  lu->L = 0;
+  lu->R = 0;
+
+  /* Coarsen the truncation until the factors fit into the budget */
+  LR = clone_hmatrix(A);
+  lrdecomp_hmatrix(LR, tm, eps);
+  while (budget > 0 && getsize_hmatrix(LR) > budget && eps < 0.5) {
+    del_hmatrix(LR);
+    eps *= 2.0;
+    LR = clone_hmatrix(A);
+    lrdecomp_hmatrix(LR, tm, eps);
+  }
+
+  lu->LR = LR;
+  lu->eps = eps;
+  lu->size = getsize_hmatrix(LR);
+
+  return lu;
+}
+
+/* Factorize a copy of A into the lower and upper H2-matrices L and R */
+static void
+lrdecomp_copy_h2matrix(pch2matrix A, pcblock b, ptruncmode tm, real eps,
+		       ph2matrix * Lp, ph2matrix * Rp)
+{
+  pclusterbasis rb, cb, rblow, cblow, rbup, cbup;
+  ph2matrix A2, L, R;
+  pclusteroperator rwf, cwf, rwflow, cwflow, rwfup, cwfup;
+
+  rb = clone_clusterbasis(A->rb);
+  cb = clone_clusterbasis(A->cb);
+  A2 = clone_h2matrix(A, rb, cb);
+
+  rblow = build_from_cluster_clusterbasis(A->rb->t);
+  cblow = build_from_cluster_clusterbasis(A->cb->t);
+  L = build_from_block_lower_h2matrix(b, rblow, cblow);
+
+  rbup = build_from_cluster_clusterbasis(A->rb->t);
+  cbup = build_from_cluster_clusterbasis(A->cb->t);
+  R = build_from_block_upper_h2matrix(b, rbup, cbup);
+
+  rwf = prepare_row_clusteroperator(A2->rb, A2->cb, tm);
+  cwf = prepare_col_clusteroperator(A2->rb, A2->cb, tm);
+  rwflow = prepare_row_clusteroperator(L->rb, L->cb, tm);
+  cwflow = prepare_col_clusteroperator(L->rb, L->cb, tm);
+  rwfup = prepare_row_clusteroperator(R->rb, R->cb, tm);
+  cwfup = prepare_col_clusteroperator(R->rb, R->cb, tm);
+
+  lrdecomp_h2matrix(A2, rwf, cwf, L, rwflow, cwflow, R, rwfup, cwfup, tm,
+		    eps);
+
+  del_clusteroperator(cwfup);
+  del_clusteroperator(rwfup);
+  del_clusteroperator(cwflow);
+  del_clusteroperator(rwflow);
+  del_clusteroperator(cwf);
+  del_clusteroperator(rwf);
+  del_h2matrix(A2);
+
+  *Lp = L;
+  *Rp = R;
+}
+
+pcoarselu
+build_h2matrix_coarselu(pch2matrix A, ptruncmode tm, real eps,
+			size_t budget)
+{
+  pcoarselu lu;
+  pblock    b;
+  ph2matrix L, R;
+
+  assert(eps > 0.0);
+
+  lu = (pcoarselu) allocmem(sizeof(coarselu));
+  lu->LR = 0;
+
+  b = build_from_h2matrix_block(A);
+
+  /* Coarsen the truncation until the factors fit into the budget */
+  lrdecomp_copy_h2matrix(A, b, tm, eps, &L, &R);
+  while (budget > 0
+	 && getsize_h2matrix(L) + getsize_h2matrix(R) > budget && eps < 0.5) {
+    del_h2matrix(R);
+    del_h2matrix(L);
+    eps *= 2.0;
+    lrdecomp_copy_h2matrix(A, b, tm, eps, &L, &R);
+  }
+
+  del_block(b);
+
+  lu->L = L;
+  lu->R = R;
+  lu->eps = eps;
+  lu->size = getsize_h2matrix(L) + getsize_h2matrix(R);
+
+  return lu;
+}
+
+void
+del_coarselu(pcoarselu lu)
+{
+  if (lu->LR)
+    del_hmatrix(lu->LR);
+  if (lu->L)
+    del_h2matrix(lu->L);
+  if (lu->R)
+    del_h2matrix(lu->R);
+
+  freemem(lu);
+}
+
+void
+prcd_coarselu(void *pdata, pavector r)
+{
+  pcoarselu lu = (pcoarselu) pdata;
+
+  if (lu->LR)
+    lrsolve_hmatrix_avector(false, lu->LR, r);
+  else
+    lrsolve_h2matrix_avector(lu->L, lu->R, r);
+}
+
+/* ------------------------------------------------------------
+ * Block generalized minimal residual method
+ * ------------------------------------------------------------ */
+
+/* Orthonormalize the columns of W by CGS2, dropping columns whose
+ * remaining norm is below tol times their original norm wnorm.
+ * Accepted columns are moved to the front, their coefficients are
+ * stored in C, so that W_old = W_new C. Returns the number of
+ * accepted columns. */
+static    uint
+orthonormalize_blockgmres(pamatrix W, pcrealavector wnorm, real tol,
+			  pamatrix C, pavector h)
+{
+  avector   tmp1, tmp2, tmp3, tmp4;
+  amatrix   tmp5;
+  pavector  w, c, hq, wq;
+  pamatrix  Q;
+  real      nu;
+  uint      i, q;
+
+  assert(C->rows >= W->cols);
+  assert(C->cols == W->cols);
+
+  clear_amatrix(C);
+
+  q = 0;
+  for (i = 0; i < W->cols; i++) {
+    w = init_column_avector(&tmp1, W, i);
+    Q = init_sub_amatrix(&tmp5, W, W->rows, 0, q, 0);
+
+    c = init_column_avector(&tmp2, C, i);
+    hq = init_sub_avector(&tmp3, h, q, 0);
+    addevaltrans_amatrix_avector(1.0, Q, w, c);
+    addeval_amatrix_avector(-1.0, Q, c, w);
+    clear_avector(hq);
+    addevaltrans_amatrix_avector(1.0, Q, w, hq);
+    addeval_amatrix_avector(-1.0, Q, hq, w);
+    add_avector(1.0, hq, c);
+    uninit_avector(hq);
+    uninit_amatrix(Q);
+
+    nu = norm2_avector(w);
+    if (nu > tol * wnorm->v[i]) {
+      c->v[q] = nu;
+      wq = init_column_avector(&tmp4, W, q);
+      if (q < i)
+	copy_avector(w, wq);
+      scale_avector(1.0 / nu, wq);
+      uninit_avector(wq);
+      q++;
+    }
+    uninit_avector(c);
+    uninit_avector(w);
+  }
+
+  for (i = q; i < W->cols; i++) {
+    w = init_column_avector(&tmp1, W, i);
+    clear_avector(w);
+    uninit_avector(w);
+  }
+
+  return q;
+}
+
+static void
+copycolumn_amatrix(pcamatrix A, uint j, pamatrix B, uint i)
+{
+  avector   tmp1, tmp2;
+  pavector  a, b;
+
+  a = init_column_avector(&tmp1, (pamatrix) A, j);
+  b = init_column_avector(&tmp2, B, i);
+  copy_avector(a, b);
+  uninit_avector(b);
+  uninit_avector(a);
+}
+
+static void
+colnorms_amatrix(pcamatrix A, prealavector norms)
+{
+  avector   tmp;
+  pavector  a;
+  uint      j;
+
+  for (j = 0; j < A->cols; j++) {
+    a = init_column_avector(&tmp, (pamatrix) A, j);
+    norms->v[j] = norm2_avector(a);
+    uninit_avector(a);
+  }
+}
+
+/* Solve the least-squares problem for the first cols columns of the
+ * block Hessenberg matrix H with rows rows and right-hand side G.
+ * On exit, the first cols rows of Gc contain the solution and the
+ * remaining rows the transformed residuals. */
+static void
+leastsquares_blockgmres(pcamatrix H, pcamatrix G, uint rows, uint cols,
+			pamatrix Hc, pamatrix Gc, pavector tau)
+{
+  amatrix   tmp1, tmp2;
+  pamatrix  H1, G1;
+
+  H1 = init_sub_amatrix(&tmp1, (pamatrix) H, rows, 0, cols, 0);
+  copy_amatrix(false, H1, Hc);
+  uninit_amatrix(H1);
+
+  G1 = init_sub_amatrix(&tmp2, (pamatrix) G, rows, 0, Gc->cols, 0);
+  copy_amatrix(false, G1, Gc);
+  uninit_amatrix(G1);
+
+  qrdecomp_amatrix(Hc, tau);
+  qreval_amatrix(true, Hc, tau, Gc);
+}
+
+uint
+solve_blockgmres_amatrix(void *A, addevalmat_t addeval_A, pcamatrix B,
+			 pamatrix X, real eps, uint maxiter, uint kmax)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4, tmp5, tmp6, tmp7, tmp8;
+  pamatrix  V, H, G, Xa, Ba, Hc, Gc, D;
+  pamatrix  R, W, Vm, C, Vo, Y, Xv;
+  pavector  tau, h;
+  prealavector bnorm, wnorm;
+  uint     *idx;
+  real      tol, scale, est;
+  uint      n, nrhs, nact, i, j, o, m, p, q, iter;
+  bool      converged;
+
+  n = X->rows;
+  nrhs = X->cols;
+
+  assert(B->rows == n);
+  assert(B->cols == nrhs);
+
+  if (nrhs == 0)
+    return 0;
+
+  if (kmax < 2 * nrhs)
+    kmax = 2 * nrhs;
+
+  /* Relative threshold for dropping linearly dependent directions */
+  tol = 1e-2 * eps;
+
+  V = new_amatrix(n, kmax);
+  H = new_amatrix(kmax, kmax);
+  G = new_amatrix(kmax, nrhs);
+  D = new_amatrix(kmax, nrhs);
+  Xa = new_amatrix(n, nrhs);
+  Ba = new_amatrix(n, nrhs);
+  tau = new_avector(kmax);
+  h = new_avector(kmax);
+  bnorm = new_realavector(nrhs);
+  wnorm = new_realavector(kmax);
+  idx = allocuint(nrhs);
+
+  copy_amatrix(false, X, Xa);
+  copy_amatrix(false, B, Ba);
+  colnorms_amatrix(B, bnorm);
+  for (j = 0; j < nrhs; j++)
+    idx[j] = j;
+  nact = nrhs;
+
+  iter = 0;
+  while (true) {
+    /* Residuals of the active columns in the first columns of V */
+    R = init_sub_amatrix(&tmp1, V, n, 0, nact, 0);
+    Xv = init_sub_amatrix(&tmp2, Xa, n, 0, nact, 0);
+    copy_sub_amatrix(false, Ba, R);
+    addeval_A(-1.0, A, Xv, R);
+    uninit_amatrix(Xv);
+    colnorms_amatrix(R, wnorm);
+
+    /* Remove converged columns */
+    i = 0;
+    for (j = 0; j < nact; j++) {
+      if (wnorm->v[j] <= eps * bnorm->v[j])
+	copycolumn_amatrix(Xa, j, X, idx[j]);
+      else {
+	if (i < j) {
+	  copycolumn_amatrix(Xa, j, Xa, i);
+	  copycolumn_amatrix(Ba, j, Ba, i);
+	  copycolumn_amatrix(R, j, R, i);
+	}
+	idx[i] = idx[j];
+	bnorm->v[i] = bnorm->v[j];
+	wnorm->v[i] = wnorm->v[j];
+	i++;
+      }
+    }
+    uninit_amatrix(R);
+    nact = i;
+
+    if (nact == 0 || iter + 1 == maxiter)
+      break;
+
+    /* Orthonormal basis of the residuals, coefficients in G */
+    R = init_sub_amatrix(&tmp1, V, n, 0, nact, 0);
+    C = init_sub_amatrix(&tmp2, G, nact, 0, nact, 0);
+    clear_amatrix(G);
+    p = orthonormalize_blockgmres(R, wnorm, tol, C, h);
+    uninit_amatrix(C);
+    uninit_amatrix(R);
+
+    clear_amatrix(H);
+    o = 0;
+    m = p;
+    converged = (p == 0);
+
+    while (!converged && m + (m - o) <= kmax && iter + 1 != maxiter) {
+      p = m - o;
+
+      /* Apply A to the current block, streaming A only once */
+      Vo = init_sub_amatrix(&tmp1, V, n, 0, p, o);
+      W = init_sub_amatrix(&tmp2, V, n, 0, p, m);
+      clear_amatrix(W);
+      addeval_A(1.0, A, Vo, W);
+      uninit_amatrix(Vo);
+      colnorms_amatrix(W, wnorm);
+
+      /* Block CGS2 against the entire basis */
+      Vm = init_sub_amatrix(&tmp3, V, n, 0, m, 0);
+      C = init_sub_amatrix(&tmp4, H, m, 0, p, o);
+      addmul_amatrix(1.0, true, Vm, false, W, C);
+      addmul_amatrix(-1.0, false, Vm, false, C, W);
+      Y = init_sub_amatrix(&tmp5, D, m, 0, p, 0);
+      clear_amatrix(Y);
+      addmul_amatrix(1.0, true, Vm, false, W, Y);
+      addmul_amatrix(-1.0, false, Vm, false, Y, W);
+      add_amatrix(1.0, false, Y, C);
+      uninit_amatrix(Y);
+      uninit_amatrix(C);
+      uninit_amatrix(Vm);
+
+      /* Orthonormalize within the block, dropping dependent directions */
+      C = init_sub_amatrix(&tmp4, H, p, m, p, o);
+      q = orthonormalize_blockgmres(W, wnorm, tol, C, h);
+      uninit_amatrix(C);
+      uninit_amatrix(W);
+
+      o = m;
+      m += q;
+      iter++;
+
+      /* Estimate the residuals of all active columns */
+      Hc = init_amatrix(&tmp6, m, o);
+      Gc = init_amatrix(&tmp7, m, nact);
+      leastsquares_blockgmres(H, G, m, o, Hc, Gc, tau);
+      converged = true;
+      for (j = 0; j < nact && converged; j++) {
+	est = 0.0;
+	for (i = o; i < m; i++)
+	  est += ABSSQR(Gc->a[i + j * Gc->ld]);
+	scale = eps * bnorm->v[j];
+	converged = (est <= scale * scale);
+      }
+      uninit_amatrix(Gc);
+      uninit_amatrix(Hc);
+
+      if (q == 0)
+	converged = true;
+    }
+
+    /* Update the solutions by the least-squares solution */
+    if (o > 0) {
+      Hc = init_amatrix(&tmp6, m, o);
+      Gc = init_amatrix(&tmp7, m, nact);
+      leastsquares_blockgmres(H, G, m, o, Hc, Gc, tau);
+      Y = init_sub_amatrix(&tmp5, Gc, o, 0, nact, 0);
+      C = init_sub_amatrix(&tmp4, Hc, o, 0, o, 0);
+      triangularsolve_amatrix(false, false, false, C, false, Y);
+      Vm = init_sub_amatrix(&tmp8, V, n, 0, o, 0);
+      Xv = init_sub_amatrix(&tmp1, Xa, n, 0, nact, 0);
+      addmul_amatrix(1.0, false, Vm, false, Y, Xv);
+      uninit_amatrix(Xv);
+      uninit_amatrix(Vm);
+      uninit_amatrix(C);
+      uninit_amatrix(Y);
+      uninit_amatrix(Gc);
+      uninit_amatrix(Hc);
+    }
+  }
+
+  /* Copy the remaining active columns back */
+  for (j = 0; j < nact; j++)
+    copycolumn_amatrix(Xa, j, X, idx[j]);
+
+  freemem(idx);
+  del_realavector(wnorm);
+  del_realavector(bnorm);
+  del_avector(h);
+  del_avector(tau);
+  del_amatrix(Ba);
+  del_amatrix(Xa);
+  del_amatrix(D);
+  del_amatrix(G);
+  del_amatrix(H);
+  del_amatrix(V);
+
+  return iter;
+}
+
+static void
+addeval_amatrix_amatrix(field alpha, void *A, pcamatrix X, pamatrix Y)
+{
+  addmul_amatrix(alpha, false, (pcamatrix) A, false, X, Y);
+}
+
+static void
+addeval_hmatrix_amatrix(field alpha, void *A, pcamatrix X, pamatrix Y)
+{
+  addmul_hmatrix_amatrix_amatrix(alpha, false, (pchmatrix) A, false, X,
+				 false, Y);
+}
+
+static void
+addeval_h2matrix_amatrix(field alpha, void *A, pcamatrix X, pamatrix Y)
+{
+  addmul_h2matrix_amatrix_amatrix(alpha, false, (pch2matrix) A, false, X,
+				  Y);
+}
+
+uint
+solve_blockgmres_amatrix_amatrix(pcamatrix A, pcamatrix B, pamatrix X,
+				 real eps, uint maxiter, uint kmax)
+{
+  return solve_blockgmres_amatrix((void *) A, addeval_amatrix_amatrix, B, X,
+				  eps, maxiter, kmax);
+}
+
+uint
+solve_blockgmres_hmatrix_amatrix(pchmatrix A, pcamatrix B, pamatrix X,
+				 real eps, uint maxiter, uint kmax)
+{
+  return solve_blockgmres_amatrix((void *) A, addeval_hmatrix_amatrix, B, X,
+				  eps, maxiter, kmax);
+}
+
+uint
+solve_blockgmres_h2matrix_amatrix(pch2matrix A, pcamatrix B, pamatrix X,
+				  real eps, uint maxiter, uint kmax)
+{
+  return solve_blockgmres_amatrix((void *) A, addeval_h2matrix_amatrix, B, X,
+				  eps, maxiter, kmax);
+}
+
+/* ------------------------------------------------------------
+ * GCRO-DR method with subspace recycling
+ * ------------------------------------------------------------ */
+
+precyclespace
+new_recyclespace(uint dim, uint m, uint k)
+{
+  precyclespace rs;
+
+  assert(m >= 1);
+
+  rs = (precyclespace) allocmem(sizeof(recyclespace));
+
+  rs->dim = dim;
+  rs->m = m;
+  rs->k = k;
+  rs->kc = 0;
+  rs->U = new_amatrix(dim, k);
+  rs->C = new_amatrix(dim, k);
+  rs->Unew = new_amatrix(dim, k);
+  rs->Cnew = new_amatrix(dim, k);
+  rs->V = new_amatrix(dim, m + 1);
+  rs->H = new_amatrix(m + 1, m);
+  rs->T = new_amatrix(m + 1, m);
+  rs->B = new_amatrix(k, m);
+  rs->g = new_avector(m + 1);
+  rs->c = new_realavector(m + 1);
+  rs->s = new_avector(m + 1);
+
+  return rs;
+}
+
+void
+del_recyclespace(precyclespace rs)
+{
+  del_avector(rs->s);
+  del_realavector(rs->c);
+  del_avector(rs->g);
+  del_amatrix(rs->B);
+  del_amatrix(rs->T);
+  del_amatrix(rs->H);
+  del_amatrix(rs->V);
+  del_amatrix(rs->Cnew);
+  del_amatrix(rs->Unew);
+  del_amatrix(rs->C);
+  del_amatrix(rs->U);
+
+  freemem(rs);
+}
+
+/* Thin QR factorization M = Q R, Q overwrites M */
+static void
+qrthin_gcrodr(pamatrix M, pamatrix R)
+{
+  pamatrix  Q;
+  pavector  tau;
+  uint      i, j;
+
+  assert(R->rows == M->cols);
+  assert(R->cols == M->cols);
+
+  tau = new_avector(M->cols);
+  qrdecomp_amatrix(M, tau);
+
+  clear_amatrix(R);
+  for (j = 0; j < M->cols; j++)
+    for (i = 0; i <= j; i++)
+      R->a[i + j * R->ld] = M->a[i + j * M->ld];
+
+  Q = new_amatrix(M->rows, M->cols);
+  qrexpand_amatrix(M, tau, Q);
+  copy_amatrix(false, Q, M);
+  del_amatrix(Q);
+
+  del_avector(tau);
+}
+
+/* Recompute C = A U for the current matrix and restore C^* C = I */
+static void
+refresh_gcrodr(void *A, addeval_t addeval_A, precyclespace rs)
+{
+  avector   tmp1, tmp2;
+  amatrix   tmp3, tmp4;
+  pavector  u, c;
+  pamatrix  U, C, R;
+  uint      kc = rs->kc;
+  uint      j;
+
+  for (j = 0; j < kc; j++) {
+    u = init_column_avector(&tmp1, rs->U, j);
+    c = init_column_avector(&tmp2, rs->C, j);
+    clear_avector(c);
+    addeval_A(1.0, A, u, c);
+    uninit_avector(c);
+    uninit_avector(u);
+  }
+
+  U = init_sub_amatrix(&tmp3, rs->U, rs->dim, 0, kc, 0);
+  C = init_sub_amatrix(&tmp4, rs->C, rs->dim, 0, kc, 0);
+  R = new_amatrix(kc, kc);
+  qrthin_gcrodr(C, R);
+  triangularsolve_amatrix(false, false, true, R, true, U);
+  del_amatrix(R);
+  uninit_amatrix(C);
+  uninit_amatrix(U);
+}
+
+/* Replace the recycled subspace by the directions in [U V_j] that
+ * correspond to the smallest singular values of the matrix
+ *   G = [ I B ]
+ *       [ 0 H ]
+ * representing A [U V_j] = [C V_{j+1}] G. */
+static void
+update_gcrodr(precyclespace rs, uint j)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4, tmp5;
+  pamatrix  G, Gs, Vt, P, GP, R, M, Z, Ms;
+  prealavector sigma;
+  uint      kc = rs->kc;
+  uint      rows = kc + j + 1;
+  uint      cols = kc + j;
+  uint      kn = UINT_MIN(rs->k, cols);
+  uint      i, l;
+
+  if (kn == 0)
+    return;
+
+  G = new_zero_amatrix(rows, cols);
+  for (i = 0; i < kc; i++)
+    G->a[i + i * G->ld] = 1.0;
+  for (l = 0; l < j; l++) {
+    for (i = 0; i < kc; i++)
+      G->a[i + (kc + l) * G->ld] = rs->B->a[i + l * rs->B->ld];
+    for (i = 0; i <= l + 1; i++)
+      G->a[(kc + i) + (kc + l) * G->ld] = rs->H->a[i + l * rs->H->ld];
+  }
+
+  /* Right singular vectors for the kn smallest singular values */
+  Gs = new_amatrix(rows, cols);
+  copy_amatrix(false, G, Gs);
+  sigma = new_realavector(cols);
+  Vt = new_amatrix(cols, cols);
+  svd_amatrix(Gs, sigma, 0, Vt);
+  P = new_amatrix(cols, kn);
+  for (l = 0; l < kn; l++)
+    for (i = 0; i < cols; i++)
+      P->a[i + l * P->ld] = CONJ(Vt->a[(cols - kn + l) + i * Vt->ld]);
+  del_amatrix(Vt);
+  del_realavector(sigma);
+  del_amatrix(Gs);
+
+  /* G P = Q R gives C = [C V_{j+1}] Q and U = [U V_j] P R^{-1} */
+  GP = new_zero_amatrix(rows, kn);
+  addmul_amatrix(1.0, false, G, false, P, GP);
+  R = new_amatrix(kn, kn);
+  qrthin_gcrodr(GP, R);
+
+  M = init_sub_amatrix(&tmp1, rs->Cnew, rs->dim, 0, kn, 0);
+  clear_amatrix(M);
+  Z = init_sub_amatrix(&tmp2, rs->C, rs->dim, 0, kc, 0);
+  Ms = init_sub_amatrix(&tmp3, GP, kc, 0, kn, 0);
+  addmul_amatrix(1.0, false, Z, false, Ms, M);
+  uninit_amatrix(Ms);
+  uninit_amatrix(Z);
+  Z = init_sub_amatrix(&tmp2, rs->V, rs->dim, 0, j + 1, 0);
+  Ms = init_sub_amatrix(&tmp3, GP, j + 1, kc, kn, 0);
+  addmul_amatrix(1.0, false, Z, false, Ms, M);
+  uninit_amatrix(Ms);
+  uninit_amatrix(Z);
+  uninit_amatrix(M);
+
+  M = init_sub_amatrix(&tmp1, rs->Unew, rs->dim, 0, kn, 0);
+  clear_amatrix(M);
+  Z = init_sub_amatrix(&tmp2, rs->U, rs->dim, 0, kc, 0);
+  Ms = init_sub_amatrix(&tmp3, P, kc, 0, kn, 0);
+  addmul_amatrix(1.0, false, Z, false, Ms, M);
+  uninit_amatrix(Ms);
+  uninit_amatrix(Z);
+  Z = init_sub_amatrix(&tmp4, rs->V, rs->dim, 0, j, 0);
+  Ms = init_sub_amatrix(&tmp5, P, j, kc, kn, 0);
+  addmul_amatrix(1.0, false, Z, false, Ms, M);
+  uninit_amatrix(Ms);
+  uninit_amatrix(Z);
+  triangularsolve_amatrix(false, false, true, R, true, M);
+  uninit_amatrix(M);
+
+  del_amatrix(R);
+  del_amatrix(GP);
+  del_amatrix(P);
+  del_amatrix(G);
+
+  M = rs->U;
+  rs->U = rs->Unew;
+  rs->Unew = M;
+  M = rs->C;
+  rs->C = rs->Cnew;
+  rs->Cnew = M;
+  rs->kc = kn;
+}
+
+uint
+solve_gcrodr_avector(void *A, addeval_t addeval_A, precyclespace rs,
+		     pcavector b, pavector x, real eps, uint maxiter)
+{
+  avector   tmp1, tmp2, tmp3, tmp4, tmp5;
+  amatrix   tmp6, tmp7, tmp8;
+  pavector  r, v, w, bj, hj, d, y;
+  pamatrix  C, U, Vj, T;
+  real      norm, beta, error, nu;
+  uint      n, m, kc, iter, j;
+
+  n = rs->dim;
+  m = rs->m;
+
+  assert(b->dim == n);
+  assert(x->dim == n);
+
+  norm = norm2_avector(b);
+  r = new_avector(n);
+  d = new_avector(UINT_MAX(rs->k, m + 1));
+
+  if (rs->kc > 0)
+    refresh_gcrodr(A, addeval_A, rs);
+
+  iter = 0;
+  while (true) {
+    kc = rs->kc;
+    C = init_sub_amatrix(&tmp6, rs->C, n, 0, kc, 0);
+    U = init_sub_amatrix(&tmp7, rs->U, n, 0, kc, 0);
+
+    /* Residual, projected to the complement of range(C) */
+    copy_avector(b, r);
+    addeval_A(-1.0, A, x, r);
+    hj = init_sub_avector(&tmp1, d, kc, 0);
+    clear_avector(hj);
+    addevaltrans_amatrix_avector(1.0, C, r, hj);
+    addeval_amatrix_avector(1.0, U, hj, x);
+    addeval_amatrix_avector(-1.0, C, hj, r);
+    uninit_avector(hj);
+
+    beta = norm2_avector(r);
+    if (beta <= eps * norm || iter + 1 == maxiter) {
+      uninit_amatrix(U);
+      uninit_amatrix(C);
+      break;
+    }
+
+    v = init_column_avector(&tmp1, rs->V, 0);
+    copy_avector(r, v);
+    scale_avector(1.0 / beta, v);
+    uninit_avector(v);
+    clear_avector(rs->g);
+    rs->g->v[0] = beta;
+    clear_amatrix(rs->H);
+    clear_amatrix(rs->B);
+
+    /* Arnoldi process for (I - C C^*) A */
+    error = beta;
+    j = 0;
+    while (j < m && error > eps * norm && iter + 1 != maxiter) {
+      v = init_column_avector(&tmp1, rs->V, j);
+      w = init_column_avector(&tmp2, rs->V, j + 1);
+      clear_avector(w);
+      addeval_A(1.0, A, v, w);
+      uninit_avector(v);
+
+      /* CGS2 against [C V_j], one block pass for each part */
+      Vj = init_sub_amatrix(&tmp8, rs->V, n, 0, j + 1, 0);
+      bj = init_pointer_avector(&tmp3, rs->B->a + (size_t) j * rs->B->ld,
+				kc);
+      hj = init_pointer_avector(&tmp4, rs->H->a + (size_t) j * rs->H->ld,
+				j + 1);
+      addevaltrans_amatrix_avector(1.0, C, w, bj);
+      addevaltrans_amatrix_avector(1.0, Vj, w, hj);
+      addeval_amatrix_avector(-1.0, C, bj, w);
+      addeval_amatrix_avector(-1.0, Vj, hj, w);
+
+      y = init_sub_avector(&tmp5, d, kc, 0);
+      clear_avector(y);
+      addevaltrans_amatrix_avector(1.0, C, w, y);
+      addeval_amatrix_avector(-1.0, C, y, w);
+      add_avector(1.0, y, bj);
+      uninit_avector(y);
+      y = init_sub_avector(&tmp5, d, j + 1, 0);
+      clear_avector(y);
+      addevaltrans_amatrix_avector(1.0, Vj, w, y);
+      addeval_amatrix_avector(-1.0, Vj, y, w);
+      add_avector(1.0, y, hj);
+      uninit_avector(y);
+      uninit_avector(hj);
+      uninit_avector(bj);
+      uninit_amatrix(Vj);
+
+      nu = norm2_avector(w);
+      rs->H->a[(j + 1) + j * rs->H->ld] = nu;
+      if (nu > 0.0)
+	scale_avector(1.0 / nu, w);
+      uninit_avector(w);
+
+      /* Residual estimate from the rotated Hessenberg matrix */
+      hj = init_column_avector(&tmp3, rs->H, j);
+      y = init_column_avector(&tmp4, rs->T, j);
+      copy_avector(hj, y);
+      error = rotate_gmres(y->v, j, rs->c, rs->s, rs->g);
+      uninit_avector(y);
+      uninit_avector(hj);
+
+      j++;
+      iter++;
+
+      if (nu == 0.0)
+	error = 0.0;
+    }
+
+    /* x += V_j y - U B y with the least-squares solution y */
+    if (j > 0) {
+      y = init_sub_avector(&tmp1, rs->g, j, 0);
+      T = init_sub_amatrix(&tmp8, rs->T, j, 0, j, 0);
+      triangularsolve_amatrix_avector(false, false, false, T, y);
+      uninit_amatrix(T);
+      Vj = init_sub_amatrix(&tmp8, rs->V, n, 0, j, 0);
+      addeval_amatrix_avector(1.0, Vj, y, x);
+      uninit_amatrix(Vj);
+      hj = init_sub_avector(&tmp2, d, kc, 0);
+      clear_avector(hj);
+      T = init_sub_amatrix(&tmp8, rs->B, kc, 0, j, 0);
+      addeval_amatrix_avector(1.0, T, y, hj);
+      uninit_amatrix(T);
+      addeval_amatrix_avector(-1.0, U, hj, x);
+      uninit_avector(hj);
+      uninit_avector(y);
+    }
+    uninit_amatrix(U);
+    uninit_amatrix(C);
+
+    if (j > 0)
+      update_gcrodr(rs, j);
+  }
+
+  del_avector(d);
+  del_avector(r);
+
+  return iter;
+}
+
+uint
+solve_gcrodr_amatrix_avector(pcamatrix A, precyclespace rs, pcavector b,
+			     pavector x, real eps, uint maxiter)
+{
+  return solve_gcrodr_avector((void *) A, (addeval_t) addeval_amatrix_avector,
+			      rs, b, x, eps, maxiter);
+}
+
+uint
+solve_gcrodr_hmatrix_avector(pchmatrix A, precyclespace rs, pcavector b,
+			     pavector x, real eps, uint maxiter)
+{
+  return solve_gcrodr_avector((void *) A, (addeval_t) addeval_hmatrix_avector,
+			      rs, b, x, eps, maxiter);
+}
+
+uint
+solve_gcrodr_h2matrix_avector(pch2matrix A, precyclespace rs, pcavector b,
+			      pavector x, real eps, uint maxiter)
+{
+  return solve_gcrodr_avector((void *) A,
+			      (addeval_t) addeval_h2matrix_avector, rs, b, x,
+			      eps, maxiter);
+}
+
+uint
+solve_gcrodr_dh2matrix_avector(pcdh2matrix A, precyclespace rs,
+			       pcavector b, pavector x, real eps,
+			       uint maxiter)
+{
+  return solve_gcrodr_avector((void *) A,
+			      (addeval_t) addeval_dh2matrix_avector, rs, b, x,
+			      eps, maxiter);
+}
+
+/* ------------------------------------------------------------
+ * Pipelined conjugate gradient method
+ * ------------------------------------------------------------ */
+
+uint
+solve_pipecg_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+		     void *pdata, pcavector b, pavector x, real eps,
+		     uint maxiter)
+{
+  pavector  r, u, w, m, nv, z, q, s, p;
+  pcavector xs[3], ys[3];
+  field     d[3];
+  field     gamma, delta, gamma_old, alpha, alpha_old, beta;
+  real      norm, rho;
+  uint      n, iter;
+
+  n = x->dim;
+
+  assert(b->dim == n);
+
+  r = new_avector(n);
+  u = new_avector(n);
+  w = new_avector(n);
+  m = new_avector(n);
+  nv = new_avector(n);
+  z = new_zero_avector(n);
+  q = new_zero_avector(n);
+  s = new_zero_avector(n);
+  p = new_zero_avector(n);
+
+  norm = norm2_avector(b);
+
+  copy_avector(b, r);		/* r = b - A x */
+  addeval_A(-1.0, A, x, r);
+  copy_avector(r, u);		/* u = N r */
+  if (prcd)
+    prcd(pdata, u);
+  clear_avector(w);		/* w = A u */
+  addeval_A(1.0, A, u, w);
+
+  xs[0] = r;			/* gamma = <r, u>, delta = <w, u>, rho = <r, r> */
+  ys[0] = u;
+  xs[1] = w;
+  ys[1] = u;
+  xs[2] = r;
+  ys[2] = r;
+
+  gamma_old = alpha_old = 1.0;
+
+  iter = 0;
+  while (true) {
+    /* The reductions do not depend on the next evaluation of N and A,
+     * so both can run at the same time */
+#ifdef USE_OPENMP
+#pragma omp parallel sections num_threads(2) if(max_pardepth > 0)
+#endif
+    {
+#ifdef USE_OPENMP
+#pragma omp section
+#endif
+      dotprods_avector(3, xs, ys, d);
+#ifdef USE_OPENMP
+#pragma omp section
+#endif
+      {
+	copy_avector(w, m);	/* m = N w */
+	if (prcd)
+	  prcd(pdata, m);
+	clear_avector(nv);	/* n = A m */
+	addeval_A(1.0, A, m, nv);
+      }
+    }
+
+    gamma = d[0];
+    delta = d[1];
+    rho = REAL(d[2]);
+
+    if (REAL_SQRT(rho) <= eps * norm || iter + 1 == maxiter)
+      break;
+
+    if (iter == 0) {
+      beta = 0.0;
+      alpha = gamma / delta;
+    }
+    else {
+      beta = gamma / gamma_old;
+      alpha = gamma / (delta - beta * gamma / alpha_old);
+    }
+
+    scaleadd_avector(1.0, nv, beta, z);	/* z = n + beta z */
+    scaleadd_avector(1.0, m, beta, q);	/* q = m + beta q */
+    scaleadd_avector(1.0, w, beta, s);	/* s = w + beta s */
+    scaleadd_avector(1.0, u, beta, p);	/* p = u + beta p */
+
+    add_avector(alpha, p, x);	/* x = x + alpha p */
+    add_avector(-alpha, s, r);	/* r = r - alpha s */
+    add_avector(-alpha, q, u);	/* u = u - alpha q */
+    add_avector(-alpha, z, w);	/* w = w - alpha z */
+
+    gamma_old = gamma;
+    alpha_old = alpha;
+
+    iter++;
+  }
+
+  del_avector(p);
+  del_avector(s);
+  del_avector(q);
+  del_avector(z);
+  del_avector(nv);
+  del_avector(m);
+  del_avector(w);
+  del_avector(u);
+  del_avector(r);
+
+  return iter;
+}
+
+uint
+solve_pipecg_amatrix_avector(pcamatrix A, prcd_t prcd, void *pdata,
+			     pcavector b, pavector x, real eps, uint maxiter)
+{
+  return solve_pipecg_avector((void *) A, (addeval_t) addeval_amatrix_avector,
+			      prcd, pdata, b, x, eps, maxiter);
+}
+
+uint
+solve_pipecg_sparsematrix_avector(pcsparsematrix A, prcd_t prcd,
+				  void *pdata, pcavector b, pavector x,
+				  real eps, uint maxiter)
+{
+  return solve_pipecg_avector((void *) A,
+			      (addeval_t) addeval_sparsematrix_avector, prcd,
+			      pdata, b, x, eps, maxiter);
+}
+
+uint
+solve_pipecg_hmatrix_avector(pchmatrix A, prcd_t prcd, void *pdata,
+			     pcavector b, pavector x, real eps, uint maxiter)
+{
+  return solve_pipecg_avector((void *) A, (addeval_t) addeval_hmatrix_avector,
+			      prcd, pdata, b, x, eps, maxiter);
+}
+
+uint
+solve_pipecg_h2matrix_avector(pch2matrix A, prcd_t prcd, void *pdata,
+			      pcavector b, pavector x, real eps,
+			      uint maxiter)
+{
+  return solve_pipecg_avector((void *) A,
+			      (addeval_t) addeval_h2matrix_avector, prcd,
+			      pdata, b, x, eps, maxiter);
+}
+
+/* ------------------------------------------------------------
+ * Pipelined generalized minimal residual method
+ * ------------------------------------------------------------ */
+
+/* Smallest ratio |v_{k+1}|^2 / |z|^2 for which the norm of the new basis
+ * vector is taken from the Pythagorean identity */
+#define PIPEGMRES_CANCEL 1e-4
+
+/* One step of p(1)-GMRES: with z = Z_k = (A - sigma I) v_k, the
+ * projection coefficients V^* z and |z|^2 are computed while
+ * (A - sigma I) z is evaluated. The new basis vector v_{k+1} and its
+ * image z_{k+1} = (A - sigma I) v_{k+1} then follow from linear
+ * combinations without another matrix evaluation. The errors in z_{k+1}
+ * grow like |A - sigma I| / |v_{k+1}| per step, the shift keeps this
+ * factor small. */
+static    real
+step_pipegmres(void *A, addeval_t addeval_A, field sigma,
+	       pgmresworkspace ws, uint k)
+{
+  avector   tmp1, tmp2, tmp3, tmp4, tmp7;
+  amatrix   tmp5, tmp6;
+  pavector  z, v, w, hk, h;
+  pamatrix  Vk, Zk;
+  field    *Hk;
+  real      zeta, nu;
+  bool      next;
+
+  assert(k + 1 < ws->kmax);
+
+  /* z_{k+1} is only needed if the basis can be extended further */
+  next = (k + 2 < ws->kmax);
+
+  z = init_column_avector(&tmp1, ws->Z, k);
+  v = init_column_avector(&tmp2, ws->V, k + 1);
+  w = (next ? init_column_avector(&tmp3, ws->Z, k + 1) : 0);
+  Vk = init_sub_amatrix(&tmp5, ws->V, ws->dim, 0, k + 1, 0);
+  Hk = ws->H->a + (size_t) k * ws->H->ld;
+  hk = init_pointer_avector(&tmp4, Hk, k + 1);
+
+#ifdef USE_OPENMP
+#pragma omp parallel sections num_threads(2) if(max_pardepth > 0)
+#endif
+  {
+#ifdef USE_OPENMP
+#pragma omp section
+#endif
+    {
+      clear_avector(hk);
+      addevaltrans_amatrix_avector(1.0, Vk, z, hk);
+      zeta = REAL(dotprod_avector(z, z));
+    }
+#ifdef USE_OPENMP
+#pragma omp section
+#endif
+    if (w) {
+      clear_avector(w);
+      addeval_A(1.0, A, z, w);
+      add_avector(-sigma, z, w);
+    }
+  }
+
+  nu = zeta - REAL(dotprod_avector(hk, hk));
+
+  copy_avector(z, v);
+  addeval_amatrix_avector(-1.0, Vk, hk, v);
+
+  if (nu > PIPEGMRES_CANCEL * zeta) {
+    nu = REAL_SQRT(nu);
+
+    /* z_{k+1} = ((A - sigma I) z_k - sum_j h_j z_j) / nu */
+    if (w) {
+      Zk = init_sub_amatrix(&tmp6, ws->Z, ws->dim, 0, k + 1, 0);
+      addeval_amatrix_avector(-1.0, Zk, hk, w);
+      scale_avector(1.0 / nu, w);
+      uninit_amatrix(Zk);
+    }
+  }
+  else {
+    /* Cancellation, fall back to re-orthogonalization and evaluate
+     * z_{k+1} explicitly */
+    h = init_sub_avector(&tmp7, ws->h, k + 1, 0);
+    clear_avector(h);
+    addevaltrans_amatrix_avector(1.0, Vk, v, h);
+    addeval_amatrix_avector(-1.0, Vk, h, v);
+    add_avector(1.0, h, hk);
+    uninit_avector(h);
+    nu = norm2_avector(v);
+
+    if (w && nu > 0.0) {
+      clear_avector(w);
+      addeval_A(1.0 / nu, A, v, w);
+      add_avector(-sigma / nu, v, w);
+    }
+  }
+
+  if (nu > 0.0)
+    scale_avector(1.0 / nu, v);
+
+  if (w)
+    uninit_avector(w);
+  uninit_avector(hk);
+  uninit_amatrix(Vk);
+  uninit_avector(v);
+  uninit_avector(z);
+
+  /* Undo the shift, V^* A v_k = V^* z_k + sigma e_k */
+  Hk[k] += sigma;
+  Hk[k + 1] = nu;
+
+  return rotate_gmres(Hk, k, ws->c, ws->s, ws->g);
+}
+
+/* Set up v_0 from the residual and z_0 = (A - sigma I) v_0, where the
+ * shift is the Rayleigh quotient of v_0 */
+static    real
+start_pipegmres(void *A, addeval_t addeval_A, pgmresworkspace ws,
+		pcavector b, pcavector x, field *sigma)
+{
+  avector   tmp1, tmp2;
+  pavector  v, z;
+  real      beta;
+
+  beta = start_gmres(A, addeval_A, 0, 0, ws, b, x);
+
+  v = init_column_avector(&tmp1, ws->V, 0);
+  z = init_column_avector(&tmp2, ws->Z, 0);
+  clear_avector(z);
+  addeval_A(1.0, A, v, z);
+  *sigma = dotprod_avector(v, z);
+  add_avector(-(*sigma), v, z);
+  uninit_avector(z);
+  uninit_avector(v);
+
+  return beta;
+}
+
+uint
+solve_pipegmres_workspace_avector(void *A, addeval_t addeval_A,
+				  pgmresworkspace ws, pcavector b,
+				  pavector x, real eps, uint maxiter)
+{
+  field     sigma;
+  real      norm, error;
+  uint      iter, k;
+
+  assert(b->dim == ws->dim);
+  assert(x->dim == ws->dim);
+
+  if (ws->Z == 0)
+    ws->Z = new_amatrix(ws->dim, ws->kmax - 1);
+
+  norm = norm2_avector(b);
+
+  error = start_pipegmres(A, addeval_A, ws, b, x, &sigma);
+  k = 0;
+
+  iter = 0;
+  while (error > eps * norm && iter + 1 != maxiter) {
+    if (k + 1 >= ws->kmax) {
+      finish_gmres_workspace(false, ws, k, x);
+      error = start_pipegmres(A, addeval_A, ws, b, x, &sigma);
+      k = 0;
+    }
+
+    error = step_pipegmres(A, addeval_A, sigma, ws, k);
+    k++;
+
+    iter++;
+  }
+  finish_gmres_workspace(false, ws, k, x);
+
+  return iter;
+}
+
+uint
+solve_pipegmres_avector(void *A, addeval_t addeval_A, pcavector b,
+			pavector x, real eps, uint maxiter, uint kmax)
+{
+  pgmresworkspace ws;
+  uint      iter;
+
+  ws = new_gmresworkspace(x->dim, kmax);
+  iter = solve_pipegmres_workspace_avector(A, addeval_A, ws, b, x, eps,
+					   maxiter);
+  del_gmresworkspace(ws);
+
+  return iter;
+}
+
+uint
+solve_pipegmres_amatrix_avector(pcamatrix A, pcavector b, pavector x,
+				real eps, uint maxiter, uint kmax)
+{
+  return solve_pipegmres_avector((void *) A,
+				 (addeval_t) addeval_amatrix_avector, b, x,
+				 eps, maxiter, kmax);
+}
+
+uint
+solve_pipegmres_hmatrix_avector(pchmatrix A, pcavector b, pavector x,
+				real eps, uint maxiter, uint kmax)
+{
+  return solve_pipegmres_avector((void *) A,
+				 (addeval_t) addeval_hmatrix_avector, b, x,
+				 eps, maxiter, kmax);
+}
+
+uint
+solve_pipegmres_h2matrix_avector(pch2matrix A, pcavector b, pavector x,
+				 real eps, uint maxiter, uint kmax)
+{
+  return solve_pipegmres_avector((void *) A,
+				 (addeval_t) addeval_h2matrix_avector, b, x,
+				 eps, maxiter, kmax);
+}
@@ -10,10 +10,12 @@
 #define KRYLOVSOLVERS_H
 
 #include "amatrix.h"
+#include "realavector.h"
 #include "sparsematrix.h"
 #include "hmatrix.h"
 #include "h2matrix.h"
 #include "dh2matrix.h"
+#include "truncation.h"
 #include "krylov.h"
 
 /** @defgroup krylovsolvers krylovsolvers
@@ -217,6 +219,149 @@ HEADER_PREFIX uint
 solve_pcg_dh2matrix_avector(pcdh2matrix A, prcd_t prcd, void *pdata,
     pcavector b, pavector x, real eps, uint maxiter);
 
+/** @brief Workspace for the GMRES solvers.
+ *
+ *  Holds the Krylov basis, the Hessenberg matrix and the Givens
+ *  rotations, so that repeated solves with the same dimension and
+ *  restart length do not have to allocate storage again.
+ *
+ *  New basis vectors are orthogonalized by the classical Gram-Schmidt
+ *  method with one re-orthogonalization step (CGS2). Both passes are
+ *  performed as matrix-vector products with the entire basis, i.e.,
+ *  each of them reads the basis only once. */
+typedef struct _gmresworkspace gmresworkspace;
+
+/** @brief Pointer to a @ref gmresworkspace object. */
+typedef gmresworkspace *pgmresworkspace;
+
+/** @brief Pointer to a constant @ref gmresworkspace object. */
+typedef const gmresworkspace *pcgmresworkspace;
+
+/** @brief Representation of a GMRES workspace. */
+struct _gmresworkspace {
+  /** @brief Dimension of the vectors. */
+  uint dim;
+
+  /** @brief Maximal dimension of the Krylov subspace plus one. */
+  uint kmax;
+
+  /** @brief Orthonormal basis of the Krylov subspace, one vector per column,
+   *  <tt>dim</tt> rows and <tt>kmax</tt> columns. */
+  pamatrix V;
+
+  /** @brief Hessenberg matrix, reduced to upper triangular form by
+   *  Givens rotations, <tt>kmax</tt> rows and <tt>kmax-1</tt> columns. */
+  pamatrix H;
+
+  /** @brief Transformed residual, dimension <tt>kmax</tt>. */
+  pavector g;
+
+  /** @brief Cosines of the Givens rotations, dimension <tt>kmax</tt>. */
+  prealavector c;
+
+  /** @brief Sines of the Givens rotations, dimension <tt>kmax</tt>. */
+  pavector s;
+
+  /** @brief Auxiliary vector for the re-orthogonalization,
+   *  dimension <tt>kmax</tt>. */
+  pavector h;
+
+  /** @brief Auxiliary vector for the preconditioned right-hand side,
+   *  dimension <tt>dim</tt>. */
+  pavector r;
+
+  /** @brief Preconditioned basis vectors for the flexible method or
+   *  images of the basis vectors for the pipelined method,
+   *  <tt>dim</tt> rows and <tt>kmax-1</tt> columns, allocated on
+   *  first use. */
+  pamatrix Z;
+};
+
+/** @brief Create a new @ref gmresworkspace object.
+ *
+ *  @param dim Dimension of the vectors.
+ *  @param kmax Maximal dimension of the Krylov subspace plus one,
+ *         has to be at least two.
+ *  @returns New workspace. */
+HEADER_PREFIX pgmresworkspace
+new_gmresworkspace(uint dim, uint kmax);
+
+/** @brief Delete a @ref gmresworkspace object.
+ *
+ *  @param ws Workspace that will be deleted. */
+HEADER_PREFIX void
+del_gmresworkspace(pgmresworkspace ws);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  generalized minimal residual method using a given workspace.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param ws Workspace, its dimension has to match <tt>b</tt> and
+ *         <tt>x</tt>. The restart length is taken from <tt>ws->kmax</tt>.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_gmres_workspace_avector(void *A, addeval_t addeval_A,
+    pgmresworkspace ws, pcavector b, pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  preconditioned generalized minimal residual method using a given
+ *  workspace.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param prcd Callback function for preconditioner @f$N@f$.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param ws Workspace, its dimension has to match <tt>b</tt> and
+ *         <tt>x</tt>. The restart length is taken from <tt>ws->kmax</tt>.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|N(Ax-b)\|_2 \leq \epsilon \|N b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pgmres_workspace_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+    void *pdata, pgmresworkspace ws, pcavector b, pavector x, real eps,
+    uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  flexible generalized minimal residual method using a given
+ *  workspace.
+ *
+ *  The preconditioner is applied from the right and may change from
+ *  one step to the next, e.g., if it is an inexact factorization or
+ *  an inner iterative solver. The preconditioned vectors are kept in
+ *  <tt>ws->Z</tt>.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param prcd Callback function for preconditioner @f$N@f$.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param ws Workspace, its dimension has to match <tt>b</tt> and
+ *         <tt>x</tt>. The restart length is taken from <tt>ws->kmax</tt>.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_fgmres_workspace_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+    void *pdata, pgmresworkspace ws, pcavector b, pavector x, real eps,
+    uint maxiter);
+
 /** @brief Solve a linear system @f$Ax=b@f$ with the
  *  generalized minimal residual method.
  *
@@ -425,6 +570,587 @@ uint
 solve_pgmres_dh2matrix_avector(pcdh2matrix A, prcd_t prcd, void *pdata,
     pcavector b, pavector x, real eps, uint maxiter, uint kmax);
 
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  flexible generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param prcd Callback function for preconditioner @f$N@f$, applied
+ *         from the right.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_fgmres_avector(void *A, addeval_t addeval_A, prcd_t prcd,
+    void *pdata, pcavector b, pavector x, real eps, uint maxiter, uint kmax);
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  flexible generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param prcd Callback function for preconditioner @f$N@f$, applied
+ *         from the right.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_fgmres_amatrix_avector(pcamatrix A, prcd_t prcd, void *pdata,
+    pcavector b, pavector x, real eps, uint maxiter, uint kmax);
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  flexible generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param prcd Callback function for preconditioner @f$N@f$, applied
+ *         from the right.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_fgmres_hmatrix_avector(pchmatrix A, prcd_t prcd, void *pdata,
+    pcavector b, pavector x, real eps, uint maxiter, uint kmax);
+/** @brief Solve a linear system @f$Ax=b@f$ with the
+ *  flexible generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param prcd Callback function for preconditioner @f$N@f$, applied
+ *         from the right.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_fgmres_h2matrix_avector(pch2matrix A, prcd_t prcd, void *pdata,
+    pcavector b, pavector x, real eps, uint maxiter, uint kmax);
+/** @brief Coarse LU factorization of a hierarchical matrix, used as
+ *  a preconditioner.
+ *
+ *  A factorization with a large truncation tolerance, e.g.,
+ *  @f$10^{-2}@f$, is far cheaper than an accurate one and typically
+ *  reduces the number of Krylov iterations to a handful. Since the
+ *  preconditioner is inexact, it should be combined with
+ *  @ref solve_fgmres_avector. */
+typedef struct _coarselu coarselu;
+
+/** @brief Pointer to a @ref coarselu object. */
+typedef coarselu *pcoarselu;
+
+/** @brief Pointer to a constant @ref coarselu object. */
+typedef const coarselu *pccoarselu;
+
+/** @brief Representation of a coarse LU factorization. */
+struct _coarselu {
+  /** @brief Combined H-matrix factors, or null. */
+  phmatrix LR;
+
+  /** @brief Lower triangular H2-matrix factor, or null. */
+  ph2matrix L;
+
+  /** @brief Upper triangular H2-matrix factor, or null. */
+  ph2matrix R;
+
+  /** @brief Truncation tolerance actually used. */
+  real eps;
+
+  /** @brief Storage of the factors in bytes. */
+  size_t size;
+};
+
+/** @brief Build a coarse H-LU factorization of an @ref hmatrix.
+ *
+ *  If the factors exceed the memory budget, the factorization is
+ *  repeated with twice the tolerance until it fits or the tolerance
+ *  reaches @f$0.5@f$.
+ *
+ *  @param A Matrix, will not be changed.
+ *  @param tm Truncation mode.
+ *  @param eps Truncation tolerance.
+ *  @param budget Memory budget in bytes, zero means unlimited.
+ *  @returns Factorization, can be used with @ref prcd_coarselu. */
+HEADER_PREFIX pcoarselu
+build_hmatrix_coarselu(pchmatrix A, pctruncmode tm, real eps,
+    size_t budget);
+
+/** @brief Build a coarse H2-LU factorization of an @ref h2matrix.
+ *
+ *  If the factors exceed the memory budget, the factorization is
+ *  repeated with twice the tolerance until it fits or the tolerance
+ *  reaches @f$0.5@f$.
+ *
+ *  @param A Matrix, will not be changed.
+ *  @param tm Truncation mode.
+ *  @param eps Truncation tolerance.
+ *  @param budget Memory budget in bytes, zero means unlimited.
+ *  @returns Factorization, can be used with @ref prcd_coarselu. */
+HEADER_PREFIX pcoarselu
+build_h2matrix_coarselu(pch2matrix A, ptruncmode tm, real eps,
+    size_t budget);
+
+/** @brief Delete a @ref coarselu object.
+ *
+ *  @param lu Object that will be deleted. */
+HEADER_PREFIX void
+del_coarselu(pcoarselu lu);
+
+/** @brief Preconditioner callback for a @ref coarselu object,
+ *  compatible with @ref prcd_t.
+ *
+ *  @param pdata Pointer to a @ref coarselu object.
+ *  @param r Source vector, will be overwritten by the solution of
+ *         @f$LRx=r@f$. */
+HEADER_PREFIX void
+prcd_coarselu(void *pdata, pavector r);
+
+/** @brief Solve a linear system @f$AX=B@f$ with several right-hand
+ *  sides by the block generalized minimal residual method.
+ *
+ *  All right-hand sides share one block Krylov subspace, so the matrix
+ *  is applied to a block of vectors in each iteration. Linearly
+ *  dependent directions are dropped from the block, and columns that
+ *  have converged are removed from the iteration at each restart.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General block callback function for evaluation of
+ *         a matrix <tt>A</tt>.
+ *  @param B Right-hand side matrix.
+ *  @param X Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax_i-b_i\|_2 \leq \epsilon \|b_i\|_2@f$ holds for all
+ *         columns.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of the block Krylov subspace, will be
+ *         increased to twice the number of columns of <tt>B</tt> if it
+ *         is smaller.
+ *  @returns Number of iterations, i.e., of block matrix evaluations. */
+HEADER_PREFIX uint
+solve_blockgmres_amatrix(void *A, addevalmat_t addeval_A, pcamatrix B,
+    pamatrix X, real eps, uint maxiter, uint kmax);
+
+/** @brief Solve a linear system @f$AX=B@f$ with several right-hand
+ *  sides by the block generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param B Right-hand side matrix.
+ *  @param X Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax_i-b_i\|_2 \leq \epsilon \|b_i\|_2@f$ holds for all
+ *         columns.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of the block Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_blockgmres_amatrix_amatrix(pcamatrix A, pcamatrix B, pamatrix X,
+    real eps, uint maxiter, uint kmax);
+
+/** @brief Solve a linear system @f$AX=B@f$ with several right-hand
+ *  sides by the block generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param B Right-hand side matrix.
+ *  @param X Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax_i-b_i\|_2 \leq \epsilon \|b_i\|_2@f$ holds for all
+ *         columns.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of the block Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_blockgmres_hmatrix_amatrix(pchmatrix A, pcamatrix B, pamatrix X,
+    real eps, uint maxiter, uint kmax);
+
+/** @brief Solve a linear system @f$AX=B@f$ with several right-hand
+ *  sides by the block generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param B Right-hand side matrix.
+ *  @param X Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax_i-b_i\|_2 \leq \epsilon \|b_i\|_2@f$ holds for all
+ *         columns.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of the block Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_blockgmres_h2matrix_amatrix(pch2matrix A, pcamatrix B, pamatrix X,
+    real eps, uint maxiter, uint kmax);
+
+/** @brief Recycled subspace for sequences of GMRES solves.
+ *
+ *  Carries a deflation subspace @f$U@f$ with @f$C=AU@f$,
+ *  @f$C^*C=I@f$, from one solve to the next, as in the GCRO-DR method.
+ *  The subspace is spanned by approximations of the right singular
+ *  vectors of @f$A@f$ corresponding to the smallest singular values,
+ *  taken from the Krylov spaces of previous cycles. If the system
+ *  matrix changes only slowly between solves, these directions remain
+ *  useful and the number of iterations is reduced. */
+typedef struct _recyclespace recyclespace;
+
+/** @brief Pointer to a @ref recyclespace object. */
+typedef recyclespace *precyclespace;
+
+/** @brief Pointer to a constant @ref recyclespace object. */
+typedef const recyclespace *pcrecyclespace;
+
+/** @brief Representation of a recycled subspace. */
+struct _recyclespace {
+  /** @brief Dimension of the vectors. */
+  uint dim;
+
+  /** @brief Number of Arnoldi steps per cycle. */
+  uint m;
+
+  /** @brief Maximal dimension of the recycled subspace. */
+  uint k;
+
+  /** @brief Current dimension of the recycled subspace. */
+  uint kc;
+
+  /** @brief Recycled subspace @f$U@f$, <tt>dim</tt> rows and
+   *  <tt>k</tt> columns, the first <tt>kc</tt> of which are used. */
+  pamatrix U;
+
+  /** @brief Orthonormal image @f$C=AU@f$, <tt>dim</tt> rows and
+   *  <tt>k</tt> columns. */
+  pamatrix C;
+
+  /** @brief Auxiliary matrix for updating <tt>U</tt>. */
+  pamatrix Unew;
+
+  /** @brief Auxiliary matrix for updating <tt>C</tt>. */
+  pamatrix Cnew;
+
+  /** @brief Orthonormal Arnoldi basis, <tt>dim</tt> rows and
+   *  <tt>m+1</tt> columns. */
+  pamatrix V;
+
+  /** @brief Hessenberg matrix, <tt>m+1</tt> rows and <tt>m</tt>
+   *  columns. */
+  pamatrix H;
+
+  /** @brief Hessenberg matrix reduced to triangular form by Givens
+   *  rotations. */
+  pamatrix T;
+
+  /** @brief Coefficients @f$C^* A V@f$, <tt>k</tt> rows and <tt>m</tt>
+   *  columns. */
+  pamatrix B;
+
+  /** @brief Transformed residual, dimension <tt>m+1</tt>. */
+  pavector g;
+
+  /** @brief Cosines of the Givens rotations. */
+  prealavector c;
+
+  /** @brief Sines of the Givens rotations. */
+  pavector s;
+};
+
+/** @brief Create a new @ref recyclespace object.
+ *
+ *  The recycled subspace is empty until the first solve.
+ *
+ *  @param dim Dimension of the vectors.
+ *  @param m Number of Arnoldi steps per cycle.
+ *  @param k Maximal dimension of the recycled subspace.
+ *  @returns New object. */
+HEADER_PREFIX precyclespace
+new_recyclespace(uint dim, uint m, uint k);
+
+/** @brief Delete a @ref recyclespace object.
+ *
+ *  @param rs Object that will be deleted. */
+HEADER_PREFIX void
+del_recyclespace(precyclespace rs);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the GCRO-DR method,
+ *  recycling a subspace from previous solves.
+ *
+ *  If <tt>rs</tt> already contains a subspace @f$U@f$, @f$C=AU@f$
+ *  is recomputed for the current matrix at the start, requiring
+ *  <tt>rs->kc</tt> additional matrix-vector multiplications. The
+ *  subspace is updated at the end of each cycle.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param rs Recycled subspace, its dimension has to match <tt>b</tt>
+ *         and <tt>x</tt>.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_gcrodr_avector(void *A, addeval_t addeval_A, precyclespace rs,
+    pcavector b, pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the GCRO-DR method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param rs Recycled subspace.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_gcrodr_amatrix_avector(pcamatrix A, precyclespace rs, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the GCRO-DR method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param rs Recycled subspace.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_gcrodr_hmatrix_avector(pchmatrix A, precyclespace rs, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the GCRO-DR method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param rs Recycled subspace.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_gcrodr_h2matrix_avector(pch2matrix A, precyclespace rs, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the GCRO-DR method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param rs Recycled subspace.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_gcrodr_dh2matrix_avector(pcdh2matrix A, precyclespace rs,
+    pcavector b, pavector x, real eps, uint maxiter);
+
+/** @brief Solve a self-adjoint positive definite system @f$Ax=b@f$
+ *  with the pipelined preconditioned conjugate gradient method.
+ *
+ *  This is the variant of Ghysels and Vanroose: all inner products of
+ *  one step are computed in a single pass, and since they do not depend
+ *  on the next evaluation of the preconditioner and the matrix, both
+ *  are carried out at the same time by two threads if nested
+ *  parallelism is enabled. The price are four additional vectors and
+ *  a recursively updated residual that may differ slightly from the
+ *  true one.
+ *
+ *  @param A System matrix, has to be self-adjoint and positive definite.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param prcd Callback function for preconditioner, may be null.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|r\|_2 \leq \epsilon \|b\|_2@f$ for the recursively
+ *         updated residual @f$r@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipecg_avector(void *A, addeval_t addeval_A, prcd_t prcd, void *pdata,
+    pcavector b, pavector x, real eps, uint maxiter);
+
+/** @brief Solve a self-adjoint positive definite system @f$Ax=b@f$
+ *  with the pipelined preconditioned conjugate gradient method.
+ *
+ *  @param A System matrix, has to be self-adjoint and positive definite.
+ *  @param prcd Callback function for preconditioner, may be null.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipecg_amatrix_avector(pcamatrix A, prcd_t prcd, void *pdata, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a self-adjoint positive definite system @f$Ax=b@f$
+ *  with the pipelined preconditioned conjugate gradient method.
+ *
+ *  @param A System matrix, has to be self-adjoint and positive definite.
+ *  @param prcd Callback function for preconditioner, may be null.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipecg_sparsematrix_avector(pcsparsematrix A, prcd_t prcd, void *pdata, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a self-adjoint positive definite system @f$Ax=b@f$
+ *  with the pipelined preconditioned conjugate gradient method.
+ *
+ *  @param A System matrix, has to be self-adjoint and positive definite.
+ *  @param prcd Callback function for preconditioner, may be null.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipecg_hmatrix_avector(pchmatrix A, prcd_t prcd, void *pdata, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a self-adjoint positive definite system @f$Ax=b@f$
+ *  with the pipelined preconditioned conjugate gradient method.
+ *
+ *  @param A System matrix, has to be self-adjoint and positive definite.
+ *  @param prcd Callback function for preconditioner, may be null.
+ *  @param pdata Data for <tt>prcd</tt> callback function.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipecg_h2matrix_avector(pch2matrix A, prcd_t prcd, void *pdata, pcavector b,
+    pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the pipelined
+ *  generalized minimal residual method using a given workspace.
+ *
+ *  This is the p(1)-GMRES method: besides the basis vectors
+ *  @f$v_j@f$, their shifted images @f$z_j = (A - \sigma I) v_j@f$ are
+ *  kept in <tt>ws->Z</tt>, where @f$\sigma@f$ is the Rayleigh quotient
+ *  of the first basis vector of each cycle. In each step, the projection coefficients and the
+ *  norm of @f$z_k@f$ are computed in one pass while @f$A z_k@f$ is
+ *  evaluated, and @f$v_{k+1}@f$ and @f$z_{k+1}@f$ follow from linear
+ *  combinations. If the norm of the new vector suffers from
+ *  cancellation, the step falls back to re-orthogonalization and an
+ *  additional matrix evaluation.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param ws Workspace, its dimension has to match <tt>b</tt> and
+ *         <tt>x</tt>. The restart length is taken from <tt>ws->kmax</tt>.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipegmres_workspace_avector(void *A, addeval_t addeval_A,
+    pgmresworkspace ws, pcavector b, pavector x, real eps, uint maxiter);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the pipelined
+ *  generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param addeval_A General callback function for evaluation of a matrix
+ *         <tt>A</tt>.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipegmres_avector(void *A, addeval_t addeval_A, pcavector b,
+    pavector x, real eps, uint maxiter, uint kmax);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the pipelined
+ *  generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipegmres_amatrix_avector(pcamatrix A, pcavector b, pavector x,
+    real eps, uint maxiter, uint kmax);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the pipelined
+ *  generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipegmres_hmatrix_avector(pchmatrix A, pcavector b, pavector x,
+    real eps, uint maxiter, uint kmax);
+
+/** @brief Solve a linear system @f$Ax=b@f$ with the pipelined
+ *  generalized minimal residual method.
+ *
+ *  @param A System matrix, should be invertible.
+ *  @param b Right-hand side vector.
+ *  @param x Initial guess, will be overwritten by approximate solution.
+ *  @param eps Relative accuracy @f$\epsilon@f$, the method stops if
+ *         @f$\|Ax-b\|_2 \leq \epsilon \|b\|_2@f$.
+ *  @param maxiter Maximal number of iterations. <tt>maxiter=0</tt>
+ *         means that the number of iterations is not bounded.
+ *  @param kmax Maximal dimension of Krylov subspace.
+ *  @returns Number of iterations. */
+HEADER_PREFIX uint
+solve_pipegmres_h2matrix_avector(pch2matrix A, pcavector b, pavector x,
+    real eps, uint maxiter, uint kmax);
+
 /** @} */
 
 #endif
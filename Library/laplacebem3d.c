@@ -24,6 +24,7 @@
 /* PARTICLES */
 /* BEM */
 #include "laplacebem3d.h"
+#include "laplacebem3d_simd.h"
 #include "singquad2d.h"
 
 /* This constant comes from the fundamental solution of the Laplace-equation,
@@ -55,31 +56,6 @@ slp_kernel_laplacebem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-slp_kernel_simd_laplacebem3d(const vreal * x,
-			     const vreal * y, const vreal * nx,
-			     const vreal * ny, void *data, vreal * res_re,
-			     vreal * res_im)
-{
-  vreal     dist[3];
-  vreal     rnorm;
-
-  (void) nx;
-  (void) ny;
-  (void) data;
-
-  dist[0] = vsub(x[0], y[0]);
-  dist[1] = vsub(x[1], y[1]);
-  dist[2] = vsub(x[2], y[2]);
-
-  rnorm = vrsqrt(vdot3(dist, dist));
-
-  *res_re = rnorm;
-  *res_im = vset1(0.0);
-}
-#endif
-
 static inline field
 dlp_kernel_laplacebem3d(const real * x, const real * y,
 			const real * nx, const real * ny, void *data)
@@ -105,33 +81,6 @@ dlp_kernel_laplacebem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-dlp_kernel_simd_laplacebem3d(const vreal * x,
-			     const vreal * y, const vreal * nx,
-			     const vreal * ny, void *data, vreal * res_re,
-			     vreal * res_im)
-{
-  vreal     dist[3];
-  vreal     rnorm, res;
-
-  (void) nx;
-  (void) ny;
-  (void) data;
-
-  dist[0] = vsub(x[0], y[0]);
-  dist[1] = vsub(x[1], y[1]);
-  dist[2] = vsub(x[2], y[2]);
-
-  rnorm = vrsqrt(vdot3(dist, dist));
-  rnorm = vmul(vmul(rnorm, rnorm), rnorm);
-  res = vmul(vdot3(dist, (vreal *) ny), rnorm);
-
-  *res_re = res;
-  *res_im = vset1(0.0);
-}
-#endif
-
 static inline field
 adlp_kernel_laplacebem3d(const real * x, const real * y,
 			 const real * nx, const real * ny, void *data)
@@ -157,32 +106,6 @@ adlp_kernel_laplacebem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-adlp_kernel_simd_laplacebem3d(const vreal * x,
-			      const vreal * y, const vreal * nx,
-			      const vreal * ny, void *data, vreal * res_re,
-			      vreal * res_im)
-{
-  vreal     dist[3];
-  vreal     rnorm, res;
-
-  (void) ny;
-  (void) data;
-
-  dist[0] = vsub(y[0], x[0]);
-  dist[1] = vsub(y[1], x[1]);
-  dist[2] = vsub(y[2], x[2]);
-
-  rnorm = vrsqrt(vdot3(dist, dist));
-  rnorm = vmul(vmul(rnorm, rnorm), rnorm);
-  res = vmul(vdot3(dist, (vreal *) nx), rnorm);
-
-  *res_re = res;
-  *res_im = vset1(0.0);
-}
-#endif
-
 static inline field
 hs_kernel_laplacebem3d(const real * x, const real * y,
 		       const real * nx, const real * ny, void *data)
@@ -209,35 +132,33 @@ hs_kernel_laplacebem3d(const real * x, const real * y,
   return res;
 }
 
-#ifdef USE_SIMD
-static inline void
-hs_kernel_simd_laplacebem3d(const vreal * x, const vreal * y,
-			    const vreal * nx, const vreal * ny, void *data,
-			    vreal * res_re, vreal * res_im)
+/* ------------------------------------------------------------
+ * Single layer, double layer and adjoint double layer kernel
+ * sharing |x-y|, used for fused assembly
+ * ------------------------------------------------------------ */
+
+static void
+fused_kernel_laplacebem3d(const real * x, const real * y,
+			  const real * nx, const real * ny, void *data,
+			  uint m, field * res)
 {
-  vreal     dist[3];
-  vreal     norm2, rnorm, res, dot, c3;
+  real      dist[3];
+  real      rnorm, rnorm3;
 
   (void) data;
+  (void) m;
 
-  c3 = vset1(-3.0);
-
-  dist[0] = vsub(x[0], y[0]);
-  dist[1] = vsub(x[1], y[1]);
-  dist[2] = vsub(x[2], y[2]);
-
-  norm2 = vdot3(dist, dist);
-  rnorm = vrsqrt(norm2);
-  rnorm = vmul(vmul(rnorm, rnorm), vmul(vmul(rnorm, rnorm), rnorm));
-  dot = vmul(vdot3(dist, (vreal *) nx), vdot3(dist, (vreal *) ny));
+  dist[0] = x[0] - y[0];
+  dist[1] = x[1] - y[1];
+  dist[2] = x[2] - y[2];
 
-  res = vmul(norm2, vdot3((vreal *) nx, (vreal *) ny));
-  res = vmul(rnorm, vadd(vmul(c3, dot), res));
+  rnorm = REAL_RSQRT(REAL_NORMSQR3(dist[0], dist[1], dist[2]));
+  rnorm3 = rnorm * rnorm * rnorm;
 
-  *res_re = res;
-  *res_im = vset1(0.0);
+  res[0] = rnorm;
+  res[1] = REAL_DOT3(dist, ny) * rnorm3;
+  res[2] = -REAL_DOT3(dist, nx) * rnorm3;
 }
-#endif
 
 /* ------------------------------------------------------------
  * Index-based kernel function wrappers
@@ -310,437 +231,341 @@ hs_kernel_idx_laplacebem3d(uint idx_x, uint idx_y, void *data)
   return hs_kernel_laplacebem3d(x, y, nx, ny, (void*)kd->bem);
 }
 
-#ifdef USE_SIMD
-static void
-fill_slp_cc_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_cc_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cc_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_cc_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_cc_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cc_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cc_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_cc_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cc_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cc_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_cc_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cc_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cc_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_cc_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cc_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cc_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_cc_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cc_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_cl_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_cl_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cl_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_cl_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_cl_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_cl_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cl_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_cl_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cl_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_cl_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_cl_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_cl_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cl_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_cl_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cl_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_cl_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_cl_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_cl_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_cl_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_lc_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_lc_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_lc_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_lc_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_lc_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_lc_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_lc_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_lc_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_lc_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_lc_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_lc_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_lc_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_lc_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_lc_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_lc_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_lc_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_lc_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_lc_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_lc_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_ll_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_ll_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_ll_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_slp_ll_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_slp_ll_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_slp_ll_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) slp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_ll_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_ll_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_ll_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_dlp_ll_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			     pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dlp_ll_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			     pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dlp_ll_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) dlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_ll_near_laplacebem3d(const uint * ridx, const uint * cidx,
-			       pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			      adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_ll_near_laplacebem3d(const uint * ridx, const uint * cidx,
 			       pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_ll_near_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_near_bem3d(ridx, cidx, bem, ntrans, N,
 			 (kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
-#ifdef USE_SIMD
-static void
-fill_adlp_ll_far_laplacebem3d(const uint * ridx, const uint * cidx,
-			      pcbem3d bem, bool ntrans, pamatrix N)
-{
-  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
-			     adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_adlp_ll_far_laplacebem3d(const uint * ridx, const uint * cidx,
 			      pcbem3d bem, bool ntrans, pamatrix N)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_adlp_ll_far_simd_laplacebem3d, (ridx, cidx, bem, ntrans, N));
+    return;
+  }
+#endif
   assemble_ll_far_bem3d(ridx, cidx, bem, ntrans, N,
 			(kernel_func3d) adlp_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_kernel_laplacebem3d(pcbem3d bem, const real(*X)[3],
@@ -765,21 +590,18 @@ fill_dnx_dny_kernel_laplacebem3d(pcbem3d bem, const real(*X)[3],
   fill_bem3d(bem, X, Y, NX, NY, V, hs_kernel_laplacebem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
-			   pcbem3d bem, pamatrix V)
-{
-  fill_row_simd_c_bem3d(idx, Z, bem, V, slp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
 			   pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_kernel_c_simd_laplacebem3d, (idx, Z, bem, V));
+    return;
+  }
+#endif
   fill_row_c_bem3d(idx, Z, bem, V, slp_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
@@ -788,22 +610,19 @@ fill_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   fill_row_l_bem3d(idx, Z, bem, V, slp_kernel_laplacebem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dnz_kernel_c_laplacebem3d(const uint * idx, const real(*Z)[3],
-			       const real(*N)[3], pcbem3d bem, pamatrix V)
-{
-  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V, dlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dnz_kernel_c_laplacebem3d(const uint * idx,
 			       const real(*Z)[3], const real(*N)[3],
 			       pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dnz_kernel_c_simd_laplacebem3d, (idx, Z, N, bem, V));
+    return;
+  }
+#endif
   fill_dnz_row_c_bem3d(idx, Z, N, bem, V, dlp_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
@@ -812,23 +631,19 @@ fill_dnz_kernel_l_laplacebem3d(const uint * idx, const real(*Z)[3],
   fill_dnz_row_l_bem3d(idx, Z, N, bem, V, dlp_kernel_laplacebem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dnzdrow_kernel_c_laplacebem3d(const uint * idx,
-				   const real(*Z)[3], const real(*N)[3],
-				   pcbem3d bem, pamatrix V)
-{
-  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dnzdrow_kernel_c_laplacebem3d(const uint * idx,
 				   const real(*Z)[3], const real(*N)[3],
 				   pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dnzdrow_kernel_c_simd_laplacebem3d, (idx, Z, N, bem, V));
+    return;
+  }
+#endif
   fill_dnz_row_c_bem3d(idx, Z, N, bem, V, hs_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_dnzdrow_kernel_l_laplacebem3d(const uint * idx,
@@ -838,23 +653,19 @@ fill_dnzdrow_kernel_l_laplacebem3d(const uint * idx,
   fill_dnz_row_l_bem3d(idx, Z, N, bem, V, hs_kernel_laplacebem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dnzdcol_kernel_c_laplacebem3d(const uint * idx,
-				   const real(*Z)[3], const real(*N)[3],
-				   pcbem3d bem, pamatrix V)
-{
-  fill_dnz_col_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_dnzdcol_kernel_c_laplacebem3d(const uint * idx,
 				   const real(*Z)[3], const real(*N)[3],
 				   pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dnzdcol_kernel_c_simd_laplacebem3d, (idx, Z, N, bem, V));
+    return;
+  }
+#endif
   fill_dnz_col_c_bem3d(idx, Z, N, bem, V, hs_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
@@ -864,21 +675,18 @@ fill_dnzdcol_kernel_l_laplacebem3d(const uint * idx,
   fill_dnz_col_l_bem3d(idx, Z, N, bem, V, hs_kernel_laplacebem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_drow_kernel_c_laplacebem3d(const uint * idx,
-				const real(*Z)[3], pcbem3d bem, pamatrix V)
-{
-  fill_row_simd_c_bem3d(idx, Z, bem, V, adlp_kernel_simd_laplacebem3d);
-}
-#else
 static void
 fill_drow_kernel_c_laplacebem3d(const uint * idx,
 				const real(*Z)[3], pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_drow_kernel_c_simd_laplacebem3d, (idx, Z, bem, V));
+    return;
+  }
+#endif
   fill_row_c_bem3d(idx, Z, bem, V, adlp_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_drow_kernel_l_laplacebem3d(const uint * idx,
@@ -887,22 +695,18 @@ fill_drow_kernel_l_laplacebem3d(const uint * idx,
   fill_row_l_bem3d(idx, Z, bem, V, adlp_kernel_laplacebem3d);
 }
 
-#ifdef USE_SIMD
-static void
-fill_dcol_kernel_c_laplacebem3d(const uint * idx,
-				const real(*Z)[3], pcbem3d bem, pamatrix V)
-{
-  fill_col_simd_c_bem3d(idx, Z, bem, V, dlp_kernel_simd_laplacebem3d);
-}
-
-#else
 static void
 fill_dcol_kernel_c_laplacebem3d(const uint * idx,
 				const real(*Z)[3], pcbem3d bem, pamatrix V)
 {
+#ifdef USE_SIMD
+  if (use_simd) {
+    SIMD_CALL(fill_dcol_kernel_c_simd_laplacebem3d, (idx, Z, bem, V));
+    return;
+  }
+#endif
   fill_col_c_bem3d(idx, Z, bem, V, dlp_kernel_laplacebem3d);
 }
-#endif
 
 static void
 fill_dcol_kernel_l_laplacebem3d(const uint * idx,
@@ -1421,6 +1225,82 @@ del_laplace_bem3d(pbem3d bem)
   del_bem3d(bem);
 }
 
+/* Check whether bem can be handled as the l-th operator of the fused
+ * kernel together with b0 */
+static    bool
+fusable_laplacebem3d(pcbem3d bem, pcbem3d b0, uint l)
+{
+  if (bem->gr != b0->gr || bem->sq->n_dist != b0->sq->n_dist
+      || bem->sq->n_id != b0->sq->n_id || bem->sq->n_edge != b0->sq->n_edge
+      || bem->sq->n_vert != b0->sq->n_vert) {
+    return false;
+  }
+
+  switch (l) {
+  case 0:
+    return bem->nearfield == fill_slp_cc_near_laplacebem3d;
+  case 1:
+    return bem->nearfield == fill_dlp_cc_near_laplacebem3d;
+  case 2:
+    return bem->nearfield == fill_adlp_cc_near_laplacebem3d;
+  default:
+    return false;
+  }
+}
+
+void
+nearfield_fused_laplacebem3d(const uint * ridx, const uint * cidx,
+			     pbem3d * bem, bool ntrans, uint m, pamatrix * N)
+{
+  pamatrix  Nf[3];
+  field     alpha[3];
+  pbem3d    b0;
+  bool      fused;
+  uint      l;
+
+  assert(m <= 3);
+
+  b0 = NULL;
+  fused = true;
+  for (l = 0; l < 3; l++) {
+    Nf[l] = NULL;
+    alpha[l] = 0.0;
+    if (l < m && bem[l]) {
+      if (b0 == NULL) {
+	b0 = bem[l];
+      }
+      fused = fused && fusable_laplacebem3d(bem[l], b0, l);
+      Nf[l] = N[l];
+      alpha[l] = bem[l]->alpha;
+    }
+  }
+
+  if (b0 == NULL) {
+    return;
+  }
+
+  if (fused) {
+#ifdef USE_SIMD
+    if (use_simd) {
+      SIMD_CALL(nearfield_fused_simd_laplacebem3d,
+		(ridx, cidx, b0, ntrans, Nf, alpha));
+      return;
+    }
+#endif
+    assemble_cc_sweep_near_bem3d(ridx, cidx, b0, ntrans, 3, Nf, alpha,
+				 fused_kernel_laplacebem3d, NULL);
+    return;
+  }
+
+  /* Linear basis functions or different meshes: one operator after the
+   * other */
+  for (l = 0; l < m; l++) {
+    if (bem[l]) {
+      bem[l]->nearfield(ridx, cidx, bem[l], ntrans, N[l]);
+    }
+  }
+}
+
 field
 eval_dirichlet_linear_laplacebem3d(const real * x, const real * n, void *data)
 {
@@ -131,6 +131,31 @@ new_adlp_laplace_bem3d(pcsurface3d gr, uint q_regular, uint q_singular,
  */
 HEADER_PREFIX void del_laplace_bem3d(pbem3d bem);
 
+/**
+ * @brief Compute nearfield entries of the single layer, double layer and
+ * adjoint double layer operator in one pass.
+ *
+ * For piecewise constant basis functions on the same mesh the entries of
+ * all operators are computed from the same quadrature points, so
+ * @f$|x-y|@f$ and its inverse are evaluated only once.
+ * Otherwise the nearfield of one operator is assembled after the other.
+ * Can be passed to @ref assemble_bem3d_fused_hmatrix and
+ * @ref assemble_bem3d_fused_h2matrix.
+ *
+ * @param ridx Indices of row boundary elements or NULL.
+ * @param cidx Indices of column boundary elements or NULL.
+ * @param bem Objects created by @ref new_slp_laplace_bem3d,
+ *        @ref new_dlp_laplace_bem3d and @ref new_adlp_laplace_bem3d in this
+ *        order, entries may be NULL.
+ * @param ntrans Store the entries in a transposed way.
+ * @param m Number of operators, at most 3.
+ * @param N Matrices of identical size, <tt>N[i]</tt> takes the entries for
+ *        <tt>bem[i]</tt> and is NULL if <tt>bem[i]</tt> is.
+ */
+HEADER_PREFIX void
+nearfield_fused_laplacebem3d(const uint *ridx, const uint *cidx,
+    pbem3d *bem, bool ntrans, uint m, pamatrix *N);
+
 /* ------------------------------------------------------------
  Examples for Dirichlet- / Neumann-data to test linear system
  ------------------------------------------------------------ */
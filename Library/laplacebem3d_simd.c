@@ -0,0 +1,420 @@
+/* ------------------------------------------------------------
+ This is the file "laplacebem3d_simd.c" of the H2Lib package.
+ All rights reserved, Sven Christophersen 2011
+ ------------------------------------------------------------ */
+
+/**
+ * @file laplacebem3d_simd.c
+ * @author Sven Christophersen
+ * @date 2011
+ *
+ * SIMD kernel functions of @ref laplacebem3d.h, compiled once for every
+ * instruction set listed in <tt>SIMD_ISAS</tt>.
+ */
+
+#ifdef USE_SIMD
+
+/* CORE 0 */
+#include "basic.h"
+/* BEM */
+#include "bem3d_simd.h"
+#include "laplacebem3d_simd.h"
+
+static inline void
+slp_kernel_simd_laplacebem3d(const vreal * x,
+			     const vreal * y, const vreal * nx,
+			     const vreal * ny, void *data, vreal * res_re,
+			     vreal * res_im)
+{
+  vreal     dist[3];
+  vreal     rnorm;
+
+  (void) nx;
+  (void) ny;
+  (void) data;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+
+  rnorm = vrsqrt(vdot3(dist, dist));
+
+  *res_re = rnorm;
+  *res_im = vset1(0.0);
+}
+
+static inline void
+dlp_kernel_simd_laplacebem3d(const vreal * x,
+			     const vreal * y, const vreal * nx,
+			     const vreal * ny, void *data, vreal * res_re,
+			     vreal * res_im)
+{
+  vreal     dist[3];
+  vreal     rnorm, res;
+
+  (void) nx;
+  (void) ny;
+  (void) data;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+
+  rnorm = vrsqrt(vdot3(dist, dist));
+  rnorm = vmul(vmul(rnorm, rnorm), rnorm);
+  res = vmul(vdot3(dist, (vreal *) ny), rnorm);
+
+  *res_re = res;
+  *res_im = vset1(0.0);
+}
+
+static inline void
+adlp_kernel_simd_laplacebem3d(const vreal * x,
+			      const vreal * y, const vreal * nx,
+			      const vreal * ny, void *data, vreal * res_re,
+			      vreal * res_im)
+{
+  vreal     dist[3];
+  vreal     rnorm, res;
+
+  (void) ny;
+  (void) data;
+
+  dist[0] = vsub(y[0], x[0]);
+  dist[1] = vsub(y[1], x[1]);
+  dist[2] = vsub(y[2], x[2]);
+
+  rnorm = vrsqrt(vdot3(dist, dist));
+  rnorm = vmul(vmul(rnorm, rnorm), rnorm);
+  res = vmul(vdot3(dist, (vreal *) nx), rnorm);
+
+  *res_re = res;
+  *res_im = vset1(0.0);
+}
+
+static inline void
+hs_kernel_simd_laplacebem3d(const vreal * x, const vreal * y,
+			    const vreal * nx, const vreal * ny, void *data,
+			    vreal * res_re, vreal * res_im)
+{
+  vreal     dist[3];
+  vreal     norm2, rnorm, res, dot, c3;
+
+  (void) data;
+
+  c3 = vset1(-3.0);
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+
+  norm2 = vdot3(dist, dist);
+  rnorm = vrsqrt(norm2);
+  rnorm = vmul(vmul(rnorm, rnorm), vmul(vmul(rnorm, rnorm), rnorm));
+  dot = vmul(vdot3(dist, (vreal *) nx), vdot3(dist, (vreal *) ny));
+
+  res = vmul(norm2, vdot3((vreal *) nx, (vreal *) ny));
+  res = vmul(rnorm, vadd(vmul(c3, dot), res));
+
+  *res_re = res;
+  *res_im = vset1(0.0);
+}
+
+static void
+fused_kernel_simd_laplacebem3d(const vreal * x, const vreal * y,
+			       const vreal * nx, const vreal * ny,
+			       void *data, uint m, vreal * res_re,
+			       vreal * res_im)
+{
+  vreal     dist[3];
+  vreal     rnorm, rnorm3;
+
+  (void) data;
+  (void) m;
+
+  dist[0] = vsub(x[0], y[0]);
+  dist[1] = vsub(x[1], y[1]);
+  dist[2] = vsub(x[2], y[2]);
+
+  rnorm = vrsqrt(vdot3(dist, dist));
+  rnorm3 = vmul(vmul(rnorm, rnorm), rnorm);
+
+  res_re[0] = rnorm;
+  res_re[1] = vmul(vdot3(dist, (vreal *) ny), rnorm3);
+  res_re[2] = vfnmadd(vdot3(dist, (vreal *) nx), rnorm3, vsetzero());
+  res_im[0] = vsetzero();
+  res_im[1] = vsetzero();
+  res_im[2] = vsetzero();
+}
+
+void
+SIMD_NAME(fill_slp_cc_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_cc_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cc_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cc_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cc_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cc_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_cl_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_cl_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cl_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_cl_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cl_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_cl_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_cl_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_lc_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_lc_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_lc_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_lc_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_lc_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_lc_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_lc_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_ll_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_slp_ll_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_ll_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dlp_ll_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_ll_near_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_near_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+				adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_adlp_ll_far_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix N)
+{
+  assemble_ll_simd_far_bem3d(ridx, cidx, bem, ntrans, N, (kernel_simd_func3d)
+			       adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_kernel_c_simd_laplacebem3d)(const uint * idx, const real(*Z)[3],
+			  pcbem3d bem, pamatrix V)
+{
+  fill_row_simd_c_bem3d(idx, Z, bem, V, slp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dnz_kernel_c_simd_laplacebem3d)(const uint * idx,
+			  const real(*Z)[3], const real(*N)[3], pcbem3d bem,
+			  pamatrix V)
+{
+  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V, dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dnzdrow_kernel_c_simd_laplacebem3d)(const uint * idx,
+			  const real(*Z)[3], const real(*N)[3], pcbem3d bem,
+			  pamatrix V)
+{
+  fill_dnz_row_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dnzdcol_kernel_c_simd_laplacebem3d)(const uint * idx,
+			  const real(*Z)[3], const real(*N)[3], pcbem3d bem,
+			  pamatrix V)
+{
+  fill_dnz_col_simd_c_bem3d(idx, Z, N, bem, V, hs_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_drow_kernel_c_simd_laplacebem3d)(const uint * idx,
+			  const real(*Z)[3], pcbem3d bem, pamatrix V)
+{
+  fill_row_simd_c_bem3d(idx, Z, bem, V, adlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(fill_dcol_kernel_c_simd_laplacebem3d)(const uint * idx,
+			  const real(*Z)[3], pcbem3d bem, pamatrix V)
+{
+  fill_col_simd_c_bem3d(idx, Z, bem, V, dlp_kernel_simd_laplacebem3d);
+}
+
+void
+SIMD_NAME(nearfield_fused_simd_laplacebem3d)(const uint * ridx,
+			  const uint * cidx, pcbem3d bem, bool ntrans,
+			  pamatrix * N, const field * alpha)
+{
+  assemble_cc_simd_sweep_near_bem3d(ridx, cidx, bem, ntrans, 3, N, alpha,
+				    fused_kernel_simd_laplacebem3d, NULL);
+}
+
+#endif
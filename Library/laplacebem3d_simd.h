@@ -0,0 +1,156 @@
+/* ------------------------------------------------------------
+ This is the file "laplacebem3d_simd.h" of the H2Lib package.
+ All rights reserved, Sven Christophersen 2011
+ ------------------------------------------------------------ */
+
+/**
+ * @file laplacebem3d_simd.h
+ * @author Sven Christophersen
+ * @date 2011
+ *
+ * SIMD versions of the nearfield and farfield routines of @ref laplacebem3d.h.
+ *
+ * Every routine exists once for every instruction set listed in
+ * <tt>SIMD_ISAS</tt>, see @ref SIMD_DECLARE. They are not called directly,
+ * but selected by @ref SIMD_CALL.
+ */
+
+#ifndef LAPLACEBEM3D_SIMD_H_
+#define LAPLACEBEM3D_SIMD_H_
+
+#ifdef USE_SIMD
+
+/* CORE 0 */
+#include "basic.h"
+/* BEM */
+#include "laplacebem3d.h"
+
+/** @brief SIMD version of @ref fill_slp_cc_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_cc_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_cc_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_cc_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_cc_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_cc_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_cc_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_cc_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_cc_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_cc_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_cc_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_cc_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_cl_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_cl_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_cl_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_cl_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_cl_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_cl_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_cl_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_cl_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_cl_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_cl_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_cl_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_cl_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_lc_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_lc_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_lc_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_lc_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_lc_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_lc_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_lc_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_lc_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_lc_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_lc_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_lc_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_lc_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_ll_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_ll_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_slp_ll_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_slp_ll_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_ll_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_ll_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_dlp_ll_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_dlp_ll_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_ll_near_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_ll_near_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_adlp_ll_far_laplacebem3d. */
+SIMD_DECLARE(void, fill_adlp_ll_far_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix N));
+
+/** @brief SIMD version of @ref fill_kernel_c_laplacebem3d. */
+SIMD_DECLARE(void, fill_kernel_c_simd_laplacebem3d, (const uint * idx,
+	     const real(*Z)[3], pcbem3d bem, pamatrix V));
+
+/** @brief SIMD version of @ref fill_dnz_kernel_c_laplacebem3d. */
+SIMD_DECLARE(void, fill_dnz_kernel_c_simd_laplacebem3d, (const uint * idx,
+	     const real(*Z)[3], const real(*N)[3], pcbem3d bem, pamatrix V));
+
+/** @brief SIMD version of @ref fill_dnzdrow_kernel_c_laplacebem3d. */
+SIMD_DECLARE(void, fill_dnzdrow_kernel_c_simd_laplacebem3d, (const uint * idx,
+	     const real(*Z)[3], const real(*N)[3], pcbem3d bem, pamatrix V));
+
+/** @brief SIMD version of @ref fill_dnzdcol_kernel_c_laplacebem3d. */
+SIMD_DECLARE(void, fill_dnzdcol_kernel_c_simd_laplacebem3d, (const uint * idx,
+	     const real(*Z)[3], const real(*N)[3], pcbem3d bem, pamatrix V));
+
+/** @brief SIMD version of @ref fill_drow_kernel_c_laplacebem3d. */
+SIMD_DECLARE(void, fill_drow_kernel_c_simd_laplacebem3d, (const uint * idx,
+	     const real(*Z)[3], pcbem3d bem, pamatrix V));
+
+/** @brief SIMD version of @ref fill_dcol_kernel_c_laplacebem3d. */
+SIMD_DECLARE(void, fill_dcol_kernel_c_simd_laplacebem3d, (const uint * idx,
+	     const real(*Z)[3], pcbem3d bem, pamatrix V));
+
+/** @brief SIMD version of @ref nearfield_fused_laplacebem3d, <tt>N</tt>
+ *  and <tt>alpha</tt> hold the three fused operators. */
+SIMD_DECLARE(void, nearfield_fused_simd_laplacebem3d, (const uint * ridx,
+	     const uint * cidx, pcbem3d bem, bool ntrans, pamatrix * N,
+	     const field * alpha));
+
+#endif
+
+#endif /* LAPLACEBEM3D_SIMD_H_ */
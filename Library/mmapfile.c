@@ -0,0 +1,380 @@
+/* ------------------------------------------------------------
+ * This is the file "mmapfile.c" of the H2Lib package.
+ * All rights reserved, Steffen Boerm 2026
+ * ------------------------------------------------------------ */
+
+#include "mmapfile.h"
+
+#include "basic.h"
+
+#include <string.h>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+/* Magic string at the start of every file */
+static const char mmapfile_magic[8] = { 'H', '2', 'L', 'i', 'b', 'M', 'a', 'p' };
+
+/* Used to detect files written on machines with different byte order */
+static const uint mmapfile_byteorder = 0x01020304;
+
+/* ------------------------------------------------------------
+ * Auxiliary functions
+ * ------------------------------------------------------------ */
+
+static void
+write_raw(pmmapfile mf, size_t sz, const void *x)
+{
+  size_t    written;
+
+  assert(mf->out != NULL);
+
+  written = fwrite(x, 1, sz, mf->out);
+  if (written != sz)
+    mf->failed = true;
+
+  mf->pos += sz;
+}
+
+static void
+write_align(pmmapfile mf)
+{
+  char      zero[MMAPFILE_ALIGN];
+  size_t    pad;
+
+  pad = ROUNDUP(mf->pos, MMAPFILE_ALIGN) - mf->pos;
+  if (pad > 0) {
+    memset(zero, 0, pad);
+    write_raw(mf, pad, zero);
+  }
+}
+
+static const void *
+read_raw(pmmapfile mf, size_t sz)
+{
+  const void *x;
+
+  assert(mf->base != NULL);
+
+  if (mf->pos + sz > mf->size) {
+    (void) fprintf(stderr, "Unexpected end of binary container file\n");
+    abort();
+  }
+
+  x = mf->base + mf->pos;
+  mf->pos += sz;
+
+  return x;
+}
+
+static void
+read_align(pmmapfile mf)
+{
+  mf->pos = ROUNDUP(mf->pos, MMAPFILE_ALIGN);
+}
+
+/* ------------------------------------------------------------
+ * Constructors and destructors
+ * ------------------------------------------------------------ */
+
+pmmapfile
+create_mmapfile(const char *name)
+{
+  pmmapfile mf;
+  FILE     *out;
+  uint      version, byteorder;
+  uint      sizes[4];
+
+  out = fopen(name, "wb");
+  if (out == NULL) {
+    (void) fprintf(stderr, "Could not create \"%s\"\n", name);
+    return NULL;
+  }
+
+  mf = (pmmapfile) allocmem(sizeof(mmapfile));
+  mf->out = out;
+  mf->failed = false;
+  mf->base = NULL;
+  mf->size = 0;
+  mf->pos = 0;
+  mf->mapped = false;
+  mf->budget = 0;
+  mf->prefetched = 0;
+  mf->released = 0;
+
+  version = MMAPFILE_VERSION;
+  byteorder = mmapfile_byteorder;
+  sizes[0] = sizeof(uint);
+  sizes[1] = sizeof(real);
+  sizes[2] = sizeof(field);
+  sizes[3] = MMAPFILE_ALIGN;
+
+  write_raw(mf, sizeof(mmapfile_magic), mmapfile_magic);
+  write_raw(mf, sizeof(uint), &version);
+  write_raw(mf, sizeof(uint), &byteorder);
+  write_raw(mf, sizeof(sizes), sizes);
+  write_align(mf);
+
+  return mf;
+}
+
+pmmapfile
+open_mmapfile(const char *name)
+{
+  pmmapfile mf;
+  uint      version, byteorder;
+  uint      sizes[4];
+#ifdef _WIN32
+  FILE     *in;
+  long      len;
+#else
+  struct stat st;
+  void     *base;
+  int       fd;
+#endif
+
+  mf = (pmmapfile) allocmem(sizeof(mmapfile));
+  mf->out = NULL;
+  mf->failed = false;
+  mf->pos = 0;
+  mf->budget = 0;
+  mf->prefetched = 0;
+  mf->released = 0;
+
+#ifdef _WIN32
+  in = fopen(name, "rb");
+  if (in == NULL) {
+    (void) fprintf(stderr, "Could not open \"%s\"\n", name);
+    freemem(mf);
+    return NULL;
+  }
+  fseek(in, 0, SEEK_END);
+  len = ftell(in);
+  fseek(in, 0, SEEK_SET);
+
+  mf->size = (size_t) len;
+  mf->base = (char *) allocmem(mf->size);
+  mf->mapped = false;
+  if (fread(mf->base, 1, mf->size, in) != mf->size) {
+    (void) fprintf(stderr, "Could not read \"%s\"\n", name);
+    fclose(in);
+    freemem(mf->base);
+    freemem(mf);
+    return NULL;
+  }
+  fclose(in);
+#else
+  fd = open(name, O_RDONLY);
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    (void) fprintf(stderr, "Could not open \"%s\"\n", name);
+    if (fd >= 0)
+      close(fd);
+    freemem(mf);
+    return NULL;
+  }
+
+  mf->size = (size_t) st.st_size;
+  base = (mf->size > 0 ?
+	  mmap(NULL, mf->size, PROT_READ, MAP_SHARED, fd, 0) : MAP_FAILED);
+  close(fd);
+  if (base == MAP_FAILED) {
+    (void) fprintf(stderr, "Could not map \"%s\"\n", name);
+    freemem(mf);
+    return NULL;
+  }
+  mf->base = (char *) base;
+  mf->mapped = true;
+#endif
+
+  /* Check header */
+  if (mf->size < sizeof(mmapfile_magic) + 6 * sizeof(uint)
+      || memcmp(mf->base, mmapfile_magic, sizeof(mmapfile_magic)) != 0) {
+    (void) fprintf(stderr, "\"%s\" is not a binary container file\n", name);
+    close_mmapfile(mf);
+    return NULL;
+  }
+  mf->pos = sizeof(mmapfile_magic);
+
+  version = read_uint_mmapfile(mf);
+  byteorder = read_uint_mmapfile(mf);
+  memcpy(sizes, read_raw(mf, sizeof(sizes)), sizeof(sizes));
+
+  if (version != MMAPFILE_VERSION || byteorder != mmapfile_byteorder
+      || sizes[0] != sizeof(uint) || sizes[1] != sizeof(real)
+      || sizes[2] != sizeof(field) || sizes[3] != MMAPFILE_ALIGN) {
+    (void) fprintf(stderr,
+		   "\"%s\" was written by an incompatible configuration\n",
+		   name);
+    close_mmapfile(mf);
+    return NULL;
+  }
+  read_align(mf);
+
+  return mf;
+}
+
+bool
+close_mmapfile(pmmapfile mf)
+{
+  bool      ok;
+
+  assert(mf != NULL);
+
+  ok = !mf->failed;
+
+  if (mf->out) {
+    if (fclose(mf->out) != 0)
+      ok = false;
+  }
+  else if (mf->base) {
+#ifndef _WIN32
+    if (mf->mapped)
+      munmap(mf->base, mf->size);
+    else
+#endif
+      freemem(mf->base);
+  }
+
+  freemem(mf);
+
+  return ok;
+}
+
+void
+setbudget_mmapfile(pmmapfile mf, size_t budget)
+{
+  mf->budget = budget;
+  mf->prefetched = 0;
+  mf->released = 0;
+}
+
+void
+stream_mmapfile(pmmapfile mf, const void *ptr, size_t sz)
+{
+#ifndef _WIN32
+  size_t    pagesize, off, start, end;
+
+  if (sz == 0 || !mf->mapped || mf->budget == 0 || mf->size <= mf->budget)
+    return;
+
+  assert((const char *) ptr >= mf->base);
+  assert((const char *) ptr + sz <= mf->base + mf->size);
+
+  pagesize = (size_t) sysconf(_SC_PAGESIZE);
+  off = (size_t) ((const char *) ptr - mf->base);
+
+  /* A new pass through the file has started */
+  if (off < mf->released) {
+    mf->released = 0;
+    mf->prefetched = 0;
+  }
+
+  /* Release everything in front of the current page */
+  end = off / pagesize * pagesize;
+  if (end > mf->released) {
+    (void) madvise(mf->base + mf->released, end - mf->released,
+		   MADV_DONTNEED);
+    mf->released = end;
+  }
+
+  /* Prefetch up to the budget ahead of the current position */
+  end = off + (sz > mf->budget ? sz : mf->budget);
+  if (end > mf->size)
+    end = mf->size;
+  if (end > mf->prefetched) {
+    start = (mf->prefetched > off ? mf->prefetched : off);
+    start = start / pagesize * pagesize;
+    (void) madvise(mf->base + start, end - start, MADV_WILLNEED);
+    mf->prefetched = end;
+  }
+#else
+  (void) mf;
+  (void) ptr;
+  (void) sz;
+#endif
+}
+
+/* ------------------------------------------------------------
+ * Writing
+ * ------------------------------------------------------------ */
+
+void
+write_uint_mmapfile(pmmapfile mf, uint x)
+{
+  write_raw(mf, sizeof(uint), &x);
+}
+
+void
+write_uints_mmapfile(pmmapfile mf, size_t n, const uint * x)
+{
+  write_align(mf);
+  write_raw(mf, sizeof(uint) * n, x);
+}
+
+void
+write_reals_mmapfile(pmmapfile mf, size_t n, pcreal x)
+{
+  write_raw(mf, sizeof(real) * n, x);
+}
+
+void
+write_amatrix_mmapfile(pmmapfile mf, pcamatrix a)
+{
+  longindex lda = a->ld;
+  uint      j;
+
+  write_uint_mmapfile(mf, a->rows);
+  write_uint_mmapfile(mf, a->cols);
+
+  write_align(mf);
+  for (j = 0; j < a->cols; j++)
+    write_raw(mf, sizeof(field) * a->rows, a->a + j * lda);
+}
+
+/* ------------------------------------------------------------
+ * Reading
+ * ------------------------------------------------------------ */
+
+uint
+read_uint_mmapfile(pmmapfile mf)
+{
+  uint      x;
+
+  memcpy(&x, read_raw(mf, sizeof(uint)), sizeof(uint));
+
+  return x;
+}
+
+const uint *
+read_uints_mmapfile(pmmapfile mf, size_t n)
+{
+  read_align(mf);
+
+  return (const uint *) read_raw(mf, sizeof(uint) * n);
+}
+
+void
+read_reals_mmapfile(pmmapfile mf, size_t n, preal x)
+{
+  memcpy(x, read_raw(mf, sizeof(real) * n), sizeof(real) * n);
+}
+
+pamatrix
+read_amatrix_mmapfile(pmmapfile mf, pamatrix a)
+{
+  uint      rows, cols;
+  pfield    src;
+
+  rows = read_uint_mmapfile(mf);
+  cols = read_uint_mmapfile(mf);
+
+  read_align(mf);
+  src = (pfield) read_raw(mf, sizeof(field) * rows * cols);
+
+  return init_pointer_amatrix(a, (rows > 0 && cols > 0 ? src : NULL),
+			      rows, cols);
+}
@@ -0,0 +1,241 @@
+/* ------------------------------------------------------------
+ * This is the file "mmapfile.h" of the H2Lib package.
+ * All rights reserved, Steffen Boerm 2026
+ * ------------------------------------------------------------ */
+
+/** @file mmapfile.h
+ *  @author Steffen B&ouml;rm
+ */
+
+#ifndef MMAPFILE_H
+#define MMAPFILE_H
+
+/** @defgroup mmapfile mmapfile
+ *  @brief Binary container files that can be mapped into memory.
+ *
+ *  The @ref mmapfile class writes matrices in a binary format that
+ *  mirrors the in-memory layout of @ref amatrix coefficients.
+ *  A file starts with a header describing the version and the sizes
+ *  of the basic types, followed by the topology of the stored trees
+ *  interleaved with coefficient blocks aligned to
+ *  @ref MMAPFILE_ALIGN bytes.
+ *
+ *  When a file is read, it is mapped into the address space and
+ *  the coefficient arrays of the resulting matrices point directly
+ *  into the mapping, so no coefficients are copied.
+ *
+ *  If a resident-memory budget is set, @ref stream_mmapfile can be
+ *  used to access the file sequentially: the following parts of
+ *  the file are prefetched asynchronously and parts that have already
+ *  been processed are released, so that only about <tt>budget</tt>
+ *  bytes of the mapping are kept in memory.
+ *  @{ */
+
+/** @brief Binary container file. */
+typedef struct _mmapfile mmapfile;
+
+/** @brief Pointer to @ref mmapfile object. */
+typedef mmapfile *pmmapfile;
+
+/** @brief Pointer to constant @ref mmapfile object. */
+typedef const mmapfile *pcmmapfile;
+
+#include <stdio.h>
+
+#include "settings.h"
+#include "amatrix.h"
+
+/** @brief Version of the file format. */
+#define MMAPFILE_VERSION 1
+
+/** @brief Alignment of coefficient blocks in bytes. */
+#define MMAPFILE_ALIGN 64
+
+/** @brief Representation of a binary container file. */
+struct _mmapfile {
+  /** @brief Output stream if the file has been opened for writing. */
+  FILE *out;
+
+  /** @brief Set if writing to <tt>out</tt> has failed or the data
+   *  cannot be represented in the file. */
+  bool failed;
+
+  /** @brief Start of the file contents if the file has been opened
+   *  for reading. */
+  char *base;
+
+  /** @brief Total size of the file in bytes. */
+  size_t size;
+
+  /** @brief Current position in bytes. */
+  size_t pos;
+
+  /** @brief Set if <tt>base</tt> has been obtained by <tt>mmap</tt>. */
+  bool mapped;
+
+  /** @brief Resident-memory budget in bytes for streaming access,
+   *  zero if unlimited. */
+  size_t budget;
+
+  /** @brief End of the part of the mapping that has been prefetched. */
+  size_t prefetched;
+
+  /** @brief End of the part of the mapping that has been released. */
+  size_t released;
+};
+
+/* ------------------------------------------------------------
+ * Constructors and destructors
+ * ------------------------------------------------------------ */
+
+/** @brief Create a new binary container file for writing.
+ *
+ *  Opens the file and writes the header.
+ *
+ *  @remark Should always be matched by a call to @ref close_mmapfile.
+ *
+ *  @param name File name.
+ *  @returns New @ref mmapfile object or <tt>NULL</tt> if the file
+ *    could not be created. */
+HEADER_PREFIX pmmapfile
+create_mmapfile(const char *name);
+
+/** @brief Open an existing binary container file for reading.
+ *
+ *  Maps the file read-only into memory and checks the header.
+ *  Matrices read from the file use the mapping as coefficient storage,
+ *  so the @ref mmapfile object has to be kept open until all of them
+ *  have been deleted.
+ *  Since the mapping is read-only, these matrices must not be modified.
+ *
+ *  @remark Should always be matched by a call to @ref close_mmapfile.
+ *
+ *  @param name File name.
+ *  @returns New @ref mmapfile object or <tt>NULL</tt> if the file
+ *    could not be opened or was written with an incompatible
+ *    configuration. */
+HEADER_PREFIX pmmapfile
+open_mmapfile(const char *name);
+
+/** @brief Close a binary container file.
+ *
+ *  Flushes and closes the output stream or removes the mapping
+ *  and deletes the object.
+ *
+ *  @param mf File to be closed.
+ *  @returns <tt>true</tt> if the file was opened for reading or
+ *    all data have been written successfully, <tt>false</tt> if
+ *    a write operation has failed. */
+HEADER_PREFIX bool
+close_mmapfile(pmmapfile mf);
+
+/** @brief Set the resident-memory budget for streaming access.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @param budget Budget in bytes, zero if unlimited. */
+HEADER_PREFIX void
+setbudget_mmapfile(pmmapfile mf, size_t budget);
+
+/** @brief Prepare access to part of the mapping.
+ *
+ *  Should be called before the coefficients starting at <tt>ptr</tt>
+ *  are used.
+ *  If the file is larger than the budget, the part of the mapping
+ *  in front of <tt>ptr</tt> is released and the following
+ *  <tt>budget</tt> bytes are prefetched asynchronously.
+ *  Accessing the file in increasing order of addresses therefore
+ *  results in sequential I/O.
+ *
+ *  @param mf Binary container file opened by @ref open_mmapfile.
+ *  @param ptr Start of the data inside the mapping.
+ *  @param sz Size of the data in bytes. */
+HEADER_PREFIX void
+stream_mmapfile(pmmapfile mf, const void *ptr, size_t sz);
+
+/* ------------------------------------------------------------
+ * Writing
+ * ------------------------------------------------------------ */
+
+/** @brief Write an unsigned integer.
+ *
+ *  Errors are recorded in <tt>mf</tt> and reported by
+ *  @ref close_mmapfile, this also holds for the other write functions.
+ *
+ *  @param mf Target file.
+ *  @param x Value. */
+HEADER_PREFIX void
+write_uint_mmapfile(pmmapfile mf, uint x);
+
+/** @brief Write an array of unsigned integers, starting at an
+ *  aligned position.
+ *
+ *  @param mf Target file.
+ *  @param n Number of entries.
+ *  @param x Array of at least <tt>n</tt> entries. */
+HEADER_PREFIX void
+write_uints_mmapfile(pmmapfile mf, size_t n, const uint *x);
+
+/** @brief Write an array of real numbers.
+ *
+ *  @param mf Target file.
+ *  @param n Number of entries.
+ *  @param x Array of at least <tt>n</tt> entries. */
+HEADER_PREFIX void
+write_reals_mmapfile(pmmapfile mf, size_t n, pcreal x);
+
+/** @brief Write a matrix.
+ *
+ *  Writes the dimensions and the coefficients in column-major order
+ *  with leading dimension <tt>a->rows</tt>, starting at an aligned
+ *  position.
+ *
+ *  @param mf Target file.
+ *  @param a Matrix. */
+HEADER_PREFIX void
+write_amatrix_mmapfile(pmmapfile mf, pcamatrix a);
+
+/* ------------------------------------------------------------
+ * Reading
+ * ------------------------------------------------------------ */
+
+/** @brief Read an unsigned integer.
+ *
+ *  @param mf Source file.
+ *  @returns Value. */
+HEADER_PREFIX uint
+read_uint_mmapfile(pmmapfile mf);
+
+/** @brief Read an array of unsigned integers written by
+ *  @ref write_uints_mmapfile.
+ *
+ *  @param mf Source file.
+ *  @param n Number of entries.
+ *  @returns Pointer to the entries inside the read-only mapping. */
+HEADER_PREFIX const uint *
+read_uints_mmapfile(pmmapfile mf, size_t n);
+
+/** @brief Read an array of real numbers.
+ *
+ *  @param mf Source file.
+ *  @param n Number of entries.
+ *  @param x Array of at least <tt>n</tt> entries that will receive
+ *    the values. */
+HEADER_PREFIX void
+read_reals_mmapfile(pmmapfile mf, size_t n, preal x);
+
+/** @brief Read a matrix written by @ref write_amatrix_mmapfile.
+ *
+ *  Initializes <tt>a</tt> to use the coefficients inside the mapping.
+ *
+ *  @remark Should always be matched by a call to @ref uninit_amatrix that
+ *  will <em>not</em> release the coefficient storage.
+ *
+ *  @param mf Source file.
+ *  @param a Object to be initialized.
+ *  @returns Initialized @ref amatrix object. */
+HEADER_PREFIX pamatrix
+read_amatrix_mmapfile(pmmapfile mf, pamatrix a);
+
+/** @} */
+
+#endif
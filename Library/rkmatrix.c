@@ -17,6 +17,8 @@ init_rkmatrix(prkmatrix r, uint rows, uint cols, uint k)
   init_amatrix(&r->A, rows, k);
   init_amatrix(&r->B, cols, k);
   r->k = k;
+  r->Alow = NULL;
+  r->Blow = NULL;
 
   return r;
 }
@@ -29,8 +31,12 @@ init_sub_rkmatrix(prkmatrix r, pcrkmatrix src, uint rows, uint roff,
   uint      k = src->k;
 
   init_sub_amatrix(&r->A, &wsrc->A, rows, roff, k, 0);
+  assert(src->Alow == NULL);
+
   init_sub_amatrix(&r->B, &wsrc->B, cols, coff, k, 0);
   r->k = k;
+  r->Alow = NULL;
+  r->Blow = NULL;
 
   return r;
 }
@@ -38,6 +44,11 @@ init_sub_rkmatrix(prkmatrix r, pcrkmatrix src, uint rows, uint roff,
 void
 uninit_rkmatrix(prkmatrix r)
 {
+  if (r->Alow)
+    freemem(r->Alow);
+  if (r->Blow)
+    freemem(r->Blow);
+
   uninit_amatrix(&r->B);
   uninit_amatrix(&r->A);
 }
@@ -100,8 +111,7 @@ getsize_rkmatrix(pcrkmatrix r)
   size_t    sz;
 
   sz = sizeof(rkmatrix);
-  sz += getsize_heap_amatrix(&r->A);
-  sz += getsize_heap_amatrix(&r->B);
+  sz += getsize_heap_rkmatrix(r);
 
   return sz;
 }
@@ -111,8 +121,14 @@ getsize_heap_rkmatrix(pcrkmatrix r)
 {
   size_t    sz;
 
-  sz = getsize_heap_amatrix(&r->A);
-  sz += getsize_heap_amatrix(&r->B);
+  if (r->Alow) {
+    sz = (size_t) sizeof(lowfield) * r->A.rows * r->A.cols;
+    sz += (size_t) sizeof(lowfield) * r->B.rows * r->B.cols;
+  }
+  else {
+    sz = getsize_heap_amatrix(&r->A);
+    sz += getsize_heap_amatrix(&r->B);
+  }
 
   return sz;
 }
@@ -136,6 +152,9 @@ clone_rkmatrix(pcrkmatrix r)
 void
 copy_rkmatrix(bool atrans, pcrkmatrix a, prkmatrix b)
 {
+  assert(a->Alow == NULL);
+  assert(b->Alow == NULL);
+
   if (atrans) {
     assert(a->A.rows == b->B.rows);
     assert(a->B.rows == b->A.rows);
@@ -172,6 +191,94 @@ random_rkmatrix(prkmatrix r, uint kmax)
   random_amatrix(&r->B);
 }
 
+/* ------------------------------------------------------------
+ Reduced-precision storage
+ ------------------------------------------------------------ */
+
+void
+lowprec_rkmatrix(prkmatrix r)
+{
+  if (r->Alow || r->A.rows * r->A.cols + r->B.rows * r->B.cols == 0)
+    return;
+
+  r->Alow = lowprec_amatrix(&r->A);
+  r->Blow = lowprec_amatrix(&r->B);
+
+  if (r->A.owner == NULL && r->A.a != NULL)
+    freemem(r->A.a);
+  r->A.a = NULL;
+  r->A.ld = r->A.rows;
+
+  if (r->B.owner == NULL && r->B.a != NULL)
+    freemem(r->B.a);
+  r->B.a = NULL;
+  r->B.ld = r->B.rows;
+}
+
+void
+fullprec_rkmatrix(prkmatrix r)
+{
+  if (r->Alow == NULL && r->Blow == NULL)
+    return;
+
+  r->A.a = (r->A.rows > 0 && r->A.cols > 0 ?
+	    allocmatrix(r->A.rows, r->A.cols) : NULL);
+  r->A.ld = r->A.rows;
+  r->A.owner = NULL;
+  if (r->Alow) {
+    fullprec_amatrix(r->Alow, &r->A);
+    freemem(r->Alow);
+    r->Alow = NULL;
+  }
+
+  r->B.a = (r->B.rows > 0 && r->B.cols > 0 ?
+	    allocmatrix(r->B.rows, r->B.cols) : NULL);
+  r->B.ld = r->B.rows;
+  r->B.owner = NULL;
+  if (r->Blow) {
+    fullprec_amatrix(r->Blow, &r->B);
+    freemem(r->Blow);
+    r->Blow = NULL;
+  }
+}
+
+real
+normfrob_rkmatrix(pcrkmatrix r)
+{
+  amatrix   tmp1, tmp2, tmp3, tmp4;
+  pamatrix  A, B, Ga, Gb;
+  field     sum;
+  uint      k = r->k;
+  uint      i, j;
+
+  assert(r->Alow == NULL);
+
+  if (k == 0)
+    return 0.0;
+
+  /* Gram matrices of the first k columns of both factors */
+  A = init_sub_amatrix(&tmp1, (pamatrix) &r->A, r->A.rows, 0, k, 0);
+  B = init_sub_amatrix(&tmp2, (pamatrix) &r->B, r->B.rows, 0, k, 0);
+  Ga = init_amatrix(&tmp3, k, k);
+  Gb = init_amatrix(&tmp4, k, k);
+  clear_amatrix(Ga);
+  clear_amatrix(Gb);
+  addmul_amatrix(1.0, true, A, false, A, Ga);
+  addmul_amatrix(1.0, true, B, false, B, Gb);
+
+  sum = 0.0;
+  for (j = 0; j < k; j++)
+    for (i = 0; i < k; i++)
+      sum += Ga->a[i + j * Ga->ld] * Gb->a[j + i * Gb->ld];
+
+  uninit_amatrix(Gb);
+  uninit_amatrix(Ga);
+  uninit_amatrix(B);
+  uninit_amatrix(A);
+
+  return (REAL(sum) > 0.0 ? REAL_SQRT(REAL(sum)) : 0.0);
+}
+
 /* ------------------------------------------------------------
  Matrix-vector multiplication
  ------------------------------------------------------------ */
@@ -189,6 +296,16 @@ addeval_rkmatrix_avector(field alpha, pcrkmatrix r, pcavector x, pavector y)
   assert(r->k <= r->A.cols);
   assert(r->k <= r->B.cols);
 
+  if (r->Alow) {
+    /* Reduced precision: t = B^* x, y = y + alpha A t */
+    ac = init_avector(&atmp, r->k);
+    clear_avector(ac);
+    addevaltrans_lowprec_avector(1.0, r->B.rows, r->k, r->Blow, x, ac);
+    addeval_lowprec_avector(alpha, r->A.rows, r->k, r->Alow, ac, y);
+    uninit_avector(ac);
+    return;
+  }
+
   for (nu = 0; nu < r->k; nu++) {
     ac = init_column_avector(&atmp, (pamatrix) &r->A, nu);
     bc = init_column_avector(&btmp, (pamatrix) &r->B, nu);
@@ -215,6 +332,16 @@ addevaltrans_rkmatrix_avector(field alpha, pcrkmatrix r, pcavector x,
   assert(r->k <= r->A.cols);
   assert(r->k <= r->B.cols);
 
+  if (r->Alow) {
+    /* Reduced precision: t = A^* x, y = y + alpha B t */
+    ac = init_avector(&atmp, r->k);
+    clear_avector(ac);
+    addevaltrans_lowprec_avector(1.0, r->A.rows, r->k, r->Alow, x, ac);
+    addeval_lowprec_avector(alpha, r->B.rows, r->k, r->Blow, ac, y);
+    uninit_avector(ac);
+    return;
+  }
+
   for (nu = 0; nu < r->k; nu++) {
     ac = init_column_avector(&atmp, (pamatrix) &r->A, nu);
     bc = init_column_avector(&btmp, (pamatrix) &r->B, nu);
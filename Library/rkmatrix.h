@@ -41,6 +41,13 @@ struct _rkmatrix {
 
   /** Maximal rank, i.e., number of columns of @f$A@f$ and @f$B@f$. */
   uint k;
+
+  /** Reduced-precision copy of @f$A@f$, <tt>NULL</tt> if the matrix
+   *  is stored in full precision. */
+  plowfield Alow;
+  /** Reduced-precision copy of @f$B@f$, <tt>NULL</tt> if the matrix
+   *  is stored in full precision. */
+  plowfield Blow;
 };
 
 /* ------------------------------------------------------------
@@ -244,6 +251,46 @@ scale_rkmatrix(field alpha, prkmatrix r);
 HEADER_PREFIX void
 random_rkmatrix(prkmatrix r, uint kmax);
 
+/* ------------------------------------------------------------
+ * Reduced-precision storage
+ * ------------------------------------------------------------ */
+
+/** @brief Store an @ref rkmatrix in reduced precision.
+ *
+ *  The factors @f$A@f$ and @f$B@f$ are rounded to @ref lowfield and
+ *  their full-precision storage is released, roughly halving the
+ *  memory requirements of the matrix.
+ *  The dimensions of <tt>r->A</tt> and <tt>r->B</tt> are kept.
+ *
+ *  @remark While the matrix is stored in reduced precision, only
+ *  the matrix-vector multiplication functions can be used.
+ *  All other operations require a call to @ref fullprec_rkmatrix first.
+ *
+ *  @param r Target matrix. */
+HEADER_PREFIX void
+lowprec_rkmatrix(prkmatrix r);
+
+/** @brief Restore the full-precision representation of an
+ *  @ref rkmatrix stored in reduced precision.
+ *
+ *  Does nothing if the matrix is already stored in full precision.
+ *
+ *  @param r Target matrix. */
+HEADER_PREFIX void
+fullprec_rkmatrix(prkmatrix r);
+
+/** @brief Compute the Frobenius norm @f$\|R\|_F@f$ of a low-rank
+ *  matrix @f$R=A B^*@f$.
+ *
+ *  Uses the identity @f$\|A B^*\|_F^2 = \operatorname{trace}
+ *  ((A^* A) (B^* B))@f$, so only @f$k\times k@f$ matrices have to
+ *  be formed.
+ *
+ *  @param r Matrix @f$R@f$, has to be stored in full precision.
+ *  @returns @f$\|R\|_F@f$. */
+HEADER_PREFIX real
+normfrob_rkmatrix(pcrkmatrix r);
+
 /* ------------------------------------------------------------
  * Matrix-vector multiplication
  * ------------------------------------------------------------ */
@@ -254,6 +301,8 @@ random_rkmatrix(prkmatrix r, uint kmax);
  *  The matrix @f$R@f$ is multiplied by the source vector @f$x@f$,
  *  the result is scaled by @f$\alpha@f$ and added to the
  *  target vector @f$y@f$.
+ *  If @f$R@f$ is stored in reduced precision, the factors are
+ *  converted on the fly and the result is accumulated in @ref field.
  *
  *  @param alpha Scaling factor @f$\alpha@f$.
  *  @param r Matrix @f$R@f$.
@@ -22,10 +22,6 @@
 #include <complex.h>
 #endif
 
-#ifdef USE_SIMD
-#include "simd.h"
-#endif
-
 /* ------------------------------------------------------------
  * Compilation settings
  * ------------------------------------------------------------ */
@@ -90,24 +86,30 @@ typedef double real;
 #endif
 
 /**
- * @brief Fallback vector length for float if vectorization is not enabled.
+ * @brief Padding of quadrature arrays.
+ *
+ * Arrays that are processed by the SIMD kernels are padded to a
+ * multiple of this length, which is a multiple of the vector length
+ * of every supported instruction set.
+ * This keeps the memory layout independent of the instruction set
+ * chosen at run-time, see @ref simd_isa.
  */
-#ifndef VFLOAT
-#define VFLOAT 1
+#ifdef USE_SIMD
+#ifdef USE_FLOAT
+#define VREAL_PAD 16
+#else
+#define VREAL_PAD 8
 #endif
-
-/**
- * @brief Fallback vector length for double if vectorization is not enabled.
- */
-#ifndef VDOUBLE
-#define VDOUBLE 1
+#else
+#define VREAL_PAD 1
 #endif
 
-/**
- * @brief Fallback vector length for real if vectorization is not enabled.
- */
-#ifndef VREAL
-#define VREAL 1
+#ifdef USE_SIMD
+/** @brief Alignment of memory allocated by @ref h2_malloc in bytes. */
+#define VALIGN 64
+
+/** @brief Maximal number of terms of the series used by <tt>vsincosn</tt>. */
+#define VSINCOS_MAXTERMS 10
 #endif
 
 #ifdef USE_FLOAT
@@ -179,6 +181,28 @@ typedef field *pfield;
 /** @brief Pointer to constant @ref field array. */
 typedef const field *pcfield;
 
+/** @brief Reduced-precision field type.
+ *
+ *  This type is used to store the coefficients of matrices that
+ *  do not require the full precision of @ref field, e.g., factors
+ *  of low-rank approximations computed with a coarse tolerance.
+ *  All arithmetic operations are still carried out in @ref field. */
+#ifdef USE_COMPLEX
+typedef float _Complex lowfield;
+#else
+typedef float lowfield;
+#endif
+
+/** @brief Pointer to @ref lowfield array. */
+typedef lowfield *plowfield;
+
+/** @brief Pointer to constant @ref lowfield array. */
+typedef const lowfield *pclowfield;
+
+/** @brief Relative precision of @ref lowfield, i.e., the machine
+ *  epsilon of single precision. */
+#define LOWFIELD_EPS 1.1920928955078125e-7
+
 /** @brief @ref field constant zero */
 extern const field f_zero;
 
@@ -3,8 +3,14 @@
 
 #ifdef USE_SIMD
 
+#include <assert.h>
 #include <immintrin.h>
 
+#include "settings.h"
+
+#ifdef __AVX512F__
+#include "simd_avx512.h"
+#else
 #ifdef __AVX__
 #include "simd_avx.h"
 #else
@@ -16,6 +22,28 @@
 #endif
 #endif
 #endif
+#endif
+
+/****************************************************
+ * Instruction set the SIMD kernels are compiled for.
+ * Every translation unit including this header is
+ * compiled once per instruction set, see SIMD_ISAS
+ * in CMakeLists.txt, and SIMD_NAME gives its entry
+ * points distinct names, see SIMD_CALL in basic.h.
+ ****************************************************/
+
+#if defined(__AVX512F__)
+#define SIMD_ISA "avx512"
+#define SIMD_NAME(f) f##_avx512
+#elif defined(__AVX2__) && defined(__FMA__)
+#define SIMD_ISA "avx2"
+#define SIMD_NAME(f) f##_avx2
+#elif defined(__SSE2__)
+#define SIMD_ISA "sse2"
+#define SIMD_NAME(f) f##_sse2
+#else
+#error "The SIMD kernels require at least SSE2"
+#endif
 
 /****************************************************
  * Define vector sizes
@@ -27,12 +55,18 @@
 #define VREAL VDOUBLE
 #endif
 
+/* Replaces the scalar fallback from settings.h */
+#undef VFIELD
 #ifdef USE_COMPLEX
 #define VFIELD (VREAL/2)
 #else
 #define VFIELD VREAL
 #endif
 
+#if VREAL_PAD % VREAL != 0
+#error "VREAL_PAD has to be a multiple of the vector length"
+#endif
+
 /****************************************************
  * Define vector types
  ****************************************************/
@@ -82,11 +116,13 @@ typedef vreal vfield;
 #define vcos vcos_ps
 #define vsincos vsincos_ps
 #define vexp vexp_ps
+#define vfloor vfloor_ps
 #else
 #define vsin vsin_pd
 #define vcos vcos_pd
 #define vsincos vsincos_pd
 #define vexp vexp_pd
+#define vfloor vfloor_pd
 #endif
 
 /****************************************************
@@ -175,6 +211,70 @@ typedef vreal vfield;
 #define vdot3 vdot3_pd
 #endif
 
+/****************************************************
+ * Sine and cosine with selectable accuracy
+ *
+ * The argument is reduced to [-pi/4, pi/4] and the
+ * quadrant, so short Taylor polynomials suffice.
+ * With n terms, cosine and sine are approximated by
+ * polynomials of degree 2n and 2n+1, the absolute
+ * error is bounded by (pi/4)^(2n+2) / (2n+2)!, e.g.,
+ * 1.2e-10 for n=5, 3.9e-13 for n=6 and 1.0e-15 for
+ * n=7.
+ ****************************************************/
+
+static const double vsincos_ccoeff[VSINCOS_MAXTERMS] = {
+    1.0 / (1.0 * 2.0), 1.0 / (3.0 * 4.0), 1.0 / (5.0 * 6.0),
+    1.0 / (7.0 * 8.0), 1.0 / (9.0 * 10.0), 1.0 / (11.0 * 12.0),
+    1.0 / (13.0 * 14.0), 1.0 / (15.0 * 16.0), 1.0 / (17.0 * 18.0),
+    1.0 / (19.0 * 20.0) };
+static const double vsincos_scoeff[VSINCOS_MAXTERMS] = {
+    1.0 / (2.0 * 3.0), 1.0 / (4.0 * 5.0), 1.0 / (6.0 * 7.0),
+    1.0 / (8.0 * 9.0), 1.0 / (10.0 * 11.0), 1.0 / (12.0 * 13.0),
+    1.0 / (14.0 * 15.0), 1.0 / (16.0 * 17.0), 1.0 / (18.0 * 19.0),
+    1.0 / (20.0 * 21.0) };
+
+/* pi/2 split into a leading part and a correction */
+static const double vsincos_pio2_hi = 1.57079632679489655800e+00;
+static const double vsincos_pio2_lo = 6.12323399573676603587e-17;
+static const double vsincos_twoopi = 6.36619772367581382433e-01;
+
+/* terms has to be between 1 and VSINCOS_MAXTERMS */
+static inline void vsincosn(vreal x, int terms, vreal *cp, vreal *sp) {
+  vreal v_one, v_half, q, j, r, r2, c, s, swap, cneg, sneg, sign;
+  int i;
+
+  assert(terms >= 1 && terms <= VSINCOS_MAXTERMS);
+
+  v_one = vset1(1.0);
+  v_half = vset1(0.5);
+
+  /* x = q pi/2 + r with |r| <= pi/4 */
+  q = vfloor(vfmadd(x, vset1(vsincos_twoopi), v_half));
+  r = vfnmadd(q, vset1(vsincos_pio2_hi), x);
+  r = vfnmadd(q, vset1(vsincos_pio2_lo), r);
+  r2 = vmul(r, r);
+
+  /* Horner scheme for both polynomials at once */
+  c = v_one;
+  s = v_one;
+  for (i = terms - 1; i >= 0; i--) {
+    c = vfnmadd(vmul(r2, vset1(vsincos_ccoeff[i])), c, v_one);
+    s = vfnmadd(vmul(r2, vset1(vsincos_scoeff[i])), s, v_one);
+  }
+  s = vmul(r, s);
+
+  /* Quadrant j = q mod 4 swaps and negates the results */
+  j = vfnmadd(vset1(4.0), vfloor(vmul(q, vset1(0.25))), q);
+  swap = vor(vcmpeq(j, v_one), vcmpeq(j, vset1(3.0)));
+  cneg = vand(vcmpgt(j, v_half), vcmplt(j, vset1(2.5)));
+  sneg = vcmpgt(j, vset1(1.5));
+  sign = vset1(-0.0);
+
+  *cp = vxor(vor(vand(swap, s), vandnot(swap, c)), vand(cneg, sign));
+  *sp = vxor(vor(vand(swap, c), vandnot(swap, s)), vand(sneg, sign));
+}
+
 
 #endif
 
@@ -7,12 +7,11 @@
 #include <immintrin.h>
 
 /****************************************************
- * Define vector sizes and alignment
+ * Define vector sizes
  ****************************************************/
 
 #define VFLOAT 8
 #define VDOUBLE 4
-#define VALIGN 64
 
 /****************************************************
  * Define vector types
@@ -35,10 +34,10 @@
 #define vdiv_ps _mm256_div_ps
 #define vsqrt_ps _mm256_sqrt_ps
 #define vrsqrt_ps _mm256_rsqrt_ps_
-#define vfmadd_ps _mm256_fmadd_ps
-#define vfmsub_ps _mm256_fmsub_ps
-#define vfnmadd_ps _mm256_fnmadd_ps
-#define vfnmsub_ps _mm256_fnmsub_ps
+#define vfmadd_ps _mm256_fmadd_ps_
+#define vfmsub_ps _mm256_fmsub_ps_
+#define vfnmadd_ps _mm256_fnmadd_ps_
+#define vfnmsub_ps _mm256_fnmsub_ps_
 
 /****************************************************
  * Arithmetic operations for double
@@ -50,10 +49,10 @@
 #define vdiv_pd _mm256_div_pd
 #define vsqrt_pd _mm256_sqrt_pd
 #define vrsqrt_pd _mm256_rsqrt_pd_
-#define vfmadd_pd _mm256_fmadd_pd
-#define vfmsub_pd _mm256_fmsub_pd
-#define vfnmadd_pd _mm256_fnmadd_pd
-#define vfnmsub_pd _mm256_fnmsub_pd
+#define vfmadd_pd _mm256_fmadd_pd_
+#define vfmsub_pd _mm256_fmsub_pd_
+#define vfnmadd_pd _mm256_fnmadd_pd_
+#define vfnmsub_pd _mm256_fnmsub_pd_
 
 /****************************************************
  * Define advanced arithmetic operations
@@ -67,6 +66,7 @@
 #define vcos_ps _mm256_cos_ps_
 #define vsincos_ps _mm256_sincos_ps_
 #define vexp_ps _mm256_exp_ps_
+#define vfloor_ps _mm256_floor_ps
 
 /****************************************************
  * Advanced arithmetic operations for double
@@ -76,6 +76,7 @@
 #define vcos_pd _mm256_cos_pd_
 #define vsincos_pd _mm256_sincos_pd_
 #define vexp_pd _mm256_exp_pd_
+#define vfloor_pd _mm256_floor_pd
 
 /****************************************************
  * Define load/store operations
@@ -201,20 +202,36 @@
  * Implementation of FMA function, if needed for float
  ****************************************************/
 
-#ifndef __FMA__
-static inline vecf _mm256_fmadd_ps(vecf a, vecf b, vecf c) {
+#ifdef __FMA__
+static inline vecf _mm256_fmadd_ps_(vecf a, vecf b, vecf c) {
+  return _mm256_fmadd_ps(a, b, c);
+}
+
+static inline vecf _mm256_fmsub_ps_(vecf a, vecf b, vecf c) {
+  return _mm256_fmsub_ps(a, b, c);
+}
+
+static inline vecf _mm256_fnmadd_ps_(vecf a, vecf b, vecf c) {
+  return _mm256_fnmadd_ps(a, b, c);
+}
+
+static inline vecf _mm256_fnmsub_ps_(vecf a, vecf b, vecf c) {
+  return _mm256_fnmsub_ps(a, b, c);
+}
+#else
+static inline vecf _mm256_fmadd_ps_(vecf a, vecf b, vecf c) {
   return vadd_ps(vmul_ps(a, b), c);
 }
 
-static inline vecf _mm256_fmsub_ps(vecf a, vecf b, vecf c) {
+static inline vecf _mm256_fmsub_ps_(vecf a, vecf b, vecf c) {
   return vsub_ps(vmul_ps(a, b), c);
 }
 
-static inline vecf _mm256_fnmadd_ps(vecf a, vecf b, vecf c) {
+static inline vecf _mm256_fnmadd_ps_(vecf a, vecf b, vecf c) {
   return vsub_ps(c, vmul_ps(a, b));
 }
 
-static inline vecf _mm256_fnmsub_ps(vecf a, vecf b, vecf c) {
+static inline vecf _mm256_fnmsub_ps_(vecf a, vecf b, vecf c) {
   return vmul_ps(vset1_ps(-1.0f), vadd_ps(vmul_ps(a, b), c));
 }
 #endif
@@ -223,20 +240,36 @@ static inline vecf _mm256_fnmsub_ps(vecf a, vecf b, vecf c) {
  * Implementation of FMA function, if needed for double
  ****************************************************/
 
-#ifndef __FMA__
-static inline vecd _mm256_fmadd_pd(vecd a, vecd b, vecd c) {
+#ifdef __FMA__
+static inline vecd _mm256_fmadd_pd_(vecd a, vecd b, vecd c) {
+  return _mm256_fmadd_pd(a, b, c);
+}
+
+static inline vecd _mm256_fmsub_pd_(vecd a, vecd b, vecd c) {
+  return _mm256_fmsub_pd(a, b, c);
+}
+
+static inline vecd _mm256_fnmadd_pd_(vecd a, vecd b, vecd c) {
+  return _mm256_fnmadd_pd(a, b, c);
+}
+
+static inline vecd _mm256_fnmsub_pd_(vecd a, vecd b, vecd c) {
+  return _mm256_fnmsub_pd(a, b, c);
+}
+#else
+static inline vecd _mm256_fmadd_pd_(vecd a, vecd b, vecd c) {
   return vadd_pd(vmul_pd(a, b), c);
 }
 
-static inline vecd _mm256_fmsub_pd(vecd a, vecd b, vecd c) {
+static inline vecd _mm256_fmsub_pd_(vecd a, vecd b, vecd c) {
   return vsub_pd(vmul_pd(a, b), c);
 }
 
-static inline vecd _mm256_fnmadd_pd(vecd a, vecd b, vecd c) {
+static inline vecd _mm256_fnmadd_pd_(vecd a, vecd b, vecd c) {
   return vsub_pd(c, vmul_pd(a, b));
 }
 
-static inline vecd _mm256_fnmsub_pd(vecd a, vecd b, vecd c) {
+static inline vecd _mm256_fnmsub_pd_(vecd a, vecd b, vecd c) {
   return vmul_pd(vset1_pd(-1.0), vadd_pd(vmul_pd(a, b), c));
 }
 #endif
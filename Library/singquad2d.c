@@ -5,6 +5,7 @@
 
 /* C STD LIBRARY */
 #include <stdio.h>
+#include <string.h>
 
 /* CORE 0 */
 #include "basic.h"
@@ -22,9 +23,23 @@
 /* BEM */
 #include "singquad2d.h"
 
+/* Quadrature arrays are padded to a multiple of VREAL_PAD, the SIMD
+ * kernels read the padding and mask the results, so it has to be finite */
+static real *alloc_padded_singquad2d(size_t sz) {
+  real *x;
+  size_t i;
+
+  x = allocreal(sz);
+  for (i = 0; i < sz; ++i) {
+    x[i] = 0.0;
+  }
+
+  return x;
+}
+
 static void build_triangle_singquad2d(psingquad2d sq, real * xq, real * wq) {
   uint nq = sq->n_single;
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
   real *xx = sq->x_single;
   real *yy = sq->y_single;
   real *ww = sq->w_single + 3 * vnq;
@@ -49,7 +64,7 @@ static void build_triangle_singquad2d(psingquad2d sq, real * xq, real * wq) {
 
 static void build_pow_dist_singquad2d(psingquad2d sq, real * xq, real * wq) {
   uint nq = sq->n_dist;
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
   real *xx = sq->x_dist;
   real *yy = sq->y_dist;
   real *ww = sq->w_dist + 9 * vnq;
@@ -79,7 +94,7 @@ static void build_pow_dist_singquad2d(psingquad2d sq, real * xq, real * wq) {
 
 static void build_pow_vert_singquad2d(psingquad2d sq, real * xq, real * wq) {
   uint nq = sq->n_vert;
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
   real *xx = sq->x_vert;
   real *yy = sq->y_vert;
   real *ww = sq->w_vert + 9 * vnq;
@@ -128,7 +143,7 @@ static void build_pow_vert_singquad2d(psingquad2d sq, real * xq, real * wq) {
 
 static void build_pow_edge_singquad2d(psingquad2d sq, real * xq, real * wq) {
   uint nq = sq->n_edge;
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
   real *xx = sq->x_edge;
   real *yy = sq->y_edge;
   real *ww = sq->w_edge + 9 * vnq;
@@ -205,7 +220,7 @@ static void build_pow_edge_singquad2d(psingquad2d sq, real * xq, real * wq) {
 
 static void build_pow_id_singquad2d(psingquad2d sq, real * xq, real * wq) {
   uint nq = sq->n_id;
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
   real *xx = sq->x_id;
   real *yy = sq->y_id;
   real *ww = sq->w_id + 9 * vnq;
@@ -280,42 +295,148 @@ static void build_pow_id_singquad2d(psingquad2d sq, real * xq, real * wq) {
 
 }
 
-#ifdef USE_TRIQUADPOINTS
-static void init_triquadpoints(pcsurface3d gr, psingquad2d sq) {
+static int compare_triquadpoints(const void *a, const void *b) {
+  const uint *ta = (const uint *) a;
+  const uint *tb = (const uint *) b;
+
+  /* Pairs of count and triangle, decreasing count, ties broken by the
+   * triangle index */
+  if (ta[0] != tb[0])
+    return (ta[0] > tb[0] ? -1 : 1);
+  return (ta[1] < tb[1] ? -1 : (ta[1] > tb[1] ? 1 : 0));
+}
+
+uint setup_triquadpoints_singquad2d(pcsurface3d gr, psingquad2d sq,
+    const uint *count, uint mincount, size_t budget) {
   uint n = gr->triangles;
   uint(*gr_t)[3] = gr->t;
   real(*gr_x)[3] = gr->x;
-  uint q2 = sq->q * sq->q;
-  uint q2ld = ROUNDUP(q2, VREAL);
+  uint q2 = sq->n_single;
+  uint q2ld = ROUNDUP(q2, VREAL_PAD);
   real *xx = sq->x_single;
   real *yy = sq->y_single;
 
   real *tri_x, *tri_y, *tri_z, *A, *B, *C;
   real tx, sx, Ax, Bx, Cx;
-  uint q, t;
+  uint *slot, *cand;
+  size_t maxslots;
+  uint slots, cands, q, t, k;
 
-  sq->tri_x = tri_x = allocreal(n * q2ld);
-  sq->tri_y = tri_y = allocreal(n * q2ld);
-  sq->tri_z = tri_z = allocreal(n * q2ld);
+  del_triquadpoints_singquad2d(sq);
+
+  /* Candidates as pairs of count and triangle */
+  cand = allocuint((size_t) 2 * n);
+  cands = 0;
+  for (t = 0; t < n; ++t) {
+    if (count == NULL || count[t] > mincount) {
+      cand[2 * cands] = (count == NULL ? 0 : count[t]);
+      cand[2 * cands + 1] = t;
+      cands++;
+    }
+  }
+
+  /* Keep the most frequently used triangles within the budget */
+  if (budget > 0) {
+    maxslots = budget / (3 * sizeof(real) * q2ld);
+    if (cands > maxslots) {
+      if (count != NULL) {
+        qsort(cand, cands, 2 * sizeof(uint), compare_triquadpoints);
+      }
+      cands = (uint) maxslots;
+    }
+  }
 
+  slot = allocuint(n);
   for (t = 0; t < n; ++t) {
+    slot[t] = TRIQUADPOINTS_NONE;
+  }
+  for (k = 0; k < cands; ++k) {
+    slot[cand[2 * k + 1]] = 0;
+  }
+  freemem(cand);
+
+  /* Number the slots by triangle to keep neighbours close in memory */
+  slots = 0;
+  for (t = 0; t < n; ++t) {
+    if (slot[t] != TRIQUADPOINTS_NONE) {
+      slot[t] = slots++;
+    }
+  }
+
+  if (slots == 0) {
+    freemem(slot);
+    return 0;
+  }
+
+  sq->tri_slot = slot;
+  sq->tri_slots = slots;
+  sq->tri_x = tri_x = allocreal((size_t) slots * q2ld);
+  sq->tri_y = tri_y = allocreal((size_t) slots * q2ld);
+  sq->tri_z = tri_z = allocreal((size_t) slots * q2ld);
+
+  for (t = 0; t < n; ++t) {
+    if (slot[t] == TRIQUADPOINTS_NONE) {
+      continue;
+    }
+    k = slot[t];
     A = gr_x[gr_t[t][0]];
     B = gr_x[gr_t[t][1]];
     C = gr_x[gr_t[t][2]];
-    for (q = 0; q < q2; ++q) {
-      tx = xx[q];
-      sx = yy[q];
-      Ax = 1.0 - tx;
-      Bx = tx - sx;
-      Cx = sx;
-
-      tri_x[q + t * q2ld] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
-      tri_y[q + t * q2ld] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
-      tri_z[q + t * q2ld] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
+    for (q = 0; q < q2ld; ++q) {
+      if (q < q2) {
+        tx = xx[q];
+        sx = yy[q];
+        Ax = 1.0 - tx;
+        Bx = tx - sx;
+        Cx = sx;
+      }
+      else {
+        /* Padding for vectorized loops, masked out there */
+        Ax = 1.0;
+        Bx = Cx = 0.0;
+      }
+
+      tri_x[q + (size_t) k * q2ld] = A[0] * Ax + B[0] * Bx + C[0] * Cx;
+      tri_y[q + (size_t) k * q2ld] = A[1] * Ax + B[1] * Bx + C[1] * Cx;
+      tri_z[q + (size_t) k * q2ld] = A[2] * Ax + B[2] * Bx + C[2] * Cx;
     }
   }
+
+  return slots;
+}
+
+void del_triquadpoints_singquad2d(psingquad2d sq) {
+  if (sq->tri_x != NULL) {
+    freemem(sq->tri_x);
+  }
+  if (sq->tri_y != NULL) {
+    freemem(sq->tri_y);
+  }
+  if (sq->tri_z != NULL) {
+    freemem(sq->tri_z);
+  }
+  if (sq->tri_slot != NULL) {
+    freemem(sq->tri_slot);
+  }
+
+  sq->tri_x = NULL;
+  sq->tri_y = NULL;
+  sq->tri_z = NULL;
+  sq->tri_slot = NULL;
+  sq->tri_slots = 0;
+}
+
+size_t getsize_triquadpoints_singquad2d(pcsingquad2d sq) {
+  size_t sz;
+
+  sz = 0;
+  if (sq->tri_slot != NULL) {
+    sz = (size_t) 3 * sizeof(real) * sq->tri_slots
+        * ROUNDUP(sq->n_single, VREAL_PAD);
+  }
+
+  return sz;
 }
-#endif
 
 psingquad2d build_singquad2d(pcsurface3d gr, uint q, uint q2) {
   uint i, nq, nq2;
@@ -347,25 +468,34 @@ psingquad2d build_singquad2d(pcsurface3d gr, uint q, uint q2) {
   sq->q2 = q2;
 
   sq->n_id = 6 * nq2;
-  sq->x_id = allocreal((size_t) 2 * ROUNDUP(sq->n_id, VREAL));
-  sq->y_id = allocreal((size_t) 2 * ROUNDUP(sq->n_id, VREAL));
-  sq->w_id = allocreal((size_t) 10 * ROUNDUP(sq->n_id, VREAL));
+  sq->x_id = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_id, VREAL_PAD));
+  sq->y_id = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_id, VREAL_PAD));
+  sq->w_id = alloc_padded_singquad2d(
+      (size_t) 10 * ROUNDUP(sq->n_id, VREAL_PAD));
   sq->base_id = 0.0;
 
   build_pow_id_singquad2d(sq, x2, w2);
 
   sq->n_edge = 6 * nq2;
-  sq->x_edge = allocreal((size_t) 2 * ROUNDUP(sq->n_edge, VREAL));
-  sq->y_edge = allocreal((size_t) 2 * ROUNDUP(sq->n_edge, VREAL));
-  sq->w_edge = allocreal((size_t) 10 * ROUNDUP(sq->n_edge, VREAL));
+  sq->x_edge = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_edge, VREAL_PAD));
+  sq->y_edge = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_edge, VREAL_PAD));
+  sq->w_edge = alloc_padded_singquad2d(
+      (size_t) 10 * ROUNDUP(sq->n_edge, VREAL_PAD));
   sq->base_edge = 0.0;
 
   build_pow_edge_singquad2d(sq, x2, w2);
 
   sq->n_vert = 2 * nq2;
-  sq->x_vert = allocreal((size_t) 2 * ROUNDUP(sq->n_vert, VREAL));
-  sq->y_vert = allocreal((size_t) 2 * ROUNDUP(sq->n_vert, VREAL));
-  sq->w_vert = allocreal((size_t) 10 * ROUNDUP(sq->n_vert, VREAL));
+  sq->x_vert = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_vert, VREAL_PAD));
+  sq->y_vert = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_vert, VREAL_PAD));
+  sq->w_vert = alloc_padded_singquad2d(
+      (size_t) 10 * ROUNDUP(sq->n_vert, VREAL_PAD));
   sq->base_vert = 0.0;
 
   build_pow_vert_singquad2d(sq, x2, w2);
@@ -373,25 +503,38 @@ psingquad2d build_singquad2d(pcsurface3d gr, uint q, uint q2) {
   sq->q = q;
 
   sq->n_dist = nq;
-  sq->x_dist = allocreal((size_t) 2 * ROUNDUP(sq->n_dist, VREAL));
-  sq->y_dist = allocreal((size_t) 2 * ROUNDUP(sq->n_dist, VREAL));
-  sq->w_dist = allocreal((size_t) 10 * ROUNDUP(sq->n_dist, VREAL));
+  sq->x_dist = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_dist, VREAL_PAD));
+  sq->y_dist = alloc_padded_singquad2d(
+      (size_t) 2 * ROUNDUP(sq->n_dist, VREAL_PAD));
+  /* The SIMD kernels for precomputed quadrature points read up to
+   * VREAL_PAD entries beyond the tensor product weights */
+  sq->w_dist = alloc_padded_singquad2d(
+      (size_t) 10 * ROUNDUP(sq->n_dist, VREAL_PAD) + VREAL_PAD);
   sq->base_dist = 0.0;
 
   build_pow_dist_singquad2d(sq, x, w);
 
   sq->n_single = q * q;
-  sq->x_single = allocreal((size_t) ROUNDUP(sq->n_single, VREAL));
-  sq->y_single = allocreal((size_t) ROUNDUP(sq->n_single, VREAL));
-  sq->w_single = allocreal((size_t) 4 * ROUNDUP(sq->n_single, VREAL));
+  sq->x_single = allocreal((size_t) ROUNDUP(sq->n_single, VREAL_PAD));
+  sq->y_single = allocreal((size_t) ROUNDUP(sq->n_single, VREAL_PAD));
+  sq->w_single = allocreal((size_t) 4 * ROUNDUP(sq->n_single, VREAL_PAD));
   sq->base_single = 0.0;
 
   build_triangle_singquad2d(sq, x, w);
 
   sq->nmax = 6 * nq2;
 
+  sq->cache = NULL;
+
+  sq->tri_x = NULL;
+  sq->tri_y = NULL;
+  sq->tri_z = NULL;
+  sq->tri_slot = NULL;
+  sq->tri_slots = 0;
+
 #ifdef USE_TRIQUADPOINTS
-  init_triquadpoints(gr, sq);
+  (void) setup_triquadpoints_singquad2d(gr, sq, NULL, 0, 0);
 #endif
 
   freemem(x);
@@ -438,23 +581,16 @@ void del_singquad2d(psingquad2d sq) {
   if (sq->y_single != NULL)
     freemem(sq->y_single);
 
-#ifdef USE_TRIQUADPOINTS
-  if (sq->tri_x != NULL) {
-    freemem(sq->tri_x);
-  }
-  if (sq->tri_y != NULL) {
-    freemem(sq->tri_y);
-  }
-  if (sq->tri_z != NULL) {
-    freemem(sq->tri_z);
-  }
-#endif
+  del_triquadpoints_singquad2d(sq);
+
+  if (sq->cache != NULL)
+    del_singcache(sq->cache);
 
   freemem(sq);
 }
 
 void weight_basisfunc_ll_singquad2d(real * x, real * y, real * w, uint nq) {
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
 
   uint i, j, k, idx;
   real bx, by;
@@ -480,7 +616,7 @@ void weight_basisfunc_ll_singquad2d(real * x, real * y, real * w, uint nq) {
 }
 
 void weight_basisfunc_cl_singquad2d(real * x, real * y, real * w, uint nq) {
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
 
   uint i, k;
   real by;
@@ -498,7 +634,7 @@ void weight_basisfunc_cl_singquad2d(real * x, real * y, real * w, uint nq) {
 }
 
 void weight_basisfunc_lc_singquad2d(real * x, real * y, real * w, uint nq) {
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
 
   uint i, k;
   real by;
@@ -516,7 +652,7 @@ void weight_basisfunc_lc_singquad2d(real * x, real * y, real * w, uint nq) {
 }
 
 void weight_basisfunc_l_singquad2d(real * x, real * y, real * w, uint nq) {
-  uint vnq = ROUNDUP(nq, VREAL);
+  uint vnq = ROUNDUP(nq, VREAL_PAD);
 
   uint i, k;
   real bx;
@@ -631,3 +767,242 @@ uint select_quadrature_singquad2d(pcsingquad2d sq, const uint * tv,
   return p;
 
 }
+
+/* ------------------------------------------------------------
+ Cache for singular integrals
+ ------------------------------------------------------------ */
+
+/* Resolution of the quantized geometric quantities, about 12 digits */
+#define SINGCACHE_SCALE 1099511627776.0
+
+psingcache new_singcache(size_t maxsize) {
+  psingcache sc;
+  uint i;
+
+  sc = (psingcache) allocmem(sizeof(singcache));
+  sc->buckets = 1024;
+  sc->bucket = (psingcacheentry *) allocmem(
+      sizeof(psingcacheentry) * sc->buckets);
+  for (i = 0; i < sc->buckets; i++)
+    sc->bucket[i] = NULL;
+  sc->entries = 0;
+  sc->size = 0;
+  sc->maxsize = maxsize;
+  sc->hits = 0;
+  sc->misses = 0;
+#ifdef USE_OPENMP
+  omp_init_lock(&sc->lock);
+#endif
+
+  return sc;
+}
+
+void clear_singcache(psingcache sc) {
+  psingcacheentry e, next;
+  uint i;
+
+  for (i = 0; i < sc->buckets; i++) {
+    for (e = sc->bucket[i]; e != NULL; e = next) {
+      next = e->next;
+      freemem(e);
+    }
+    sc->bucket[i] = NULL;
+  }
+  sc->entries = 0;
+  sc->size = 0;
+  sc->hits = 0;
+  sc->misses = 0;
+}
+
+void del_singcache(psingcache sc) {
+  clear_singcache(sc);
+
+#ifdef USE_OPENMP
+  omp_destroy_lock(&sc->lock);
+#endif
+  freemem(sc->bucket);
+  freemem(sc);
+}
+
+static uint parity3(const uint *p) {
+  return ((p[0] > p[1]) + (p[0] > p[2]) + (p[1] > p[2])) & 1;
+}
+
+static real det3(const real *X, const real *A, const real *B, const real *C) {
+  real a[3], b[3], c[3];
+  uint i;
+
+  for (i = 0; i < 3; i++) {
+    a[i] = A[i] - X[i];
+    b[i] = B[i] - X[i];
+    c[i] = C[i] - X[i];
+  }
+
+  return a[0] * (b[1] * c[2] - b[2] * c[1]) + a[1] * (b[2] * c[0] - b[0] * c[2])
+      + a[2] * (b[0] * c[1] - b[1] * c[0]);
+}
+
+void key_singcache(uint values, uint p, const uint *tp, const uint *sp,
+    const real *A_t, const real *B_t, const real *C_t, const real *A_s,
+    const real *B_s, const real *C_s, int64_t *key) {
+  const real *X[6];
+  real d[10], h2, h3, m;
+  uint n, i, j, k;
+  int e;
+
+  assert(p <= 3);
+
+  /* Distinct vertices, the first p vertices of both triangles coincide */
+  X[0] = A_t;
+  X[1] = B_t;
+  X[2] = C_t;
+  n = 3;
+  if (p < 1)
+    X[n++] = A_s;
+  if (p < 2)
+    X[n++] = B_s;
+  if (p < 3)
+    X[n++] = C_s;
+
+  for (i = 0; i < SINGCACHE_KEYLEN; i++)
+    key[i] = 0;
+
+  key[0] = values;
+  key[1] = p;
+  key[2] = parity3(tp);
+  key[3] = parity3(sp);
+
+  /* Squared distances between all vertices, relative to the largest one */
+  h2 = 0.0;
+  k = 0;
+  for (i = 1; i < n && k < 10; i++)
+    for (j = 0; j < i && k < 10; j++) {
+      d[k] = REAL_SQR(X[i][0] - X[j][0]) + REAL_SQR(X[i][1] - X[j][1])
+          + REAL_SQR(X[i][2] - X[j][2]);
+      h2 = REAL_MAX(h2, d[k]);
+      k++;
+    }
+  assert(h2 > 0.0);
+
+  m = frexp(h2, &e);
+  key[4] = e;
+  key[5] = llround(m * SINGCACHE_SCALE);
+  for (i = 0; i < k; i++)
+    key[6 + i] = llround(d[i] / h2 * SINGCACHE_SCALE);
+
+  /* Signed volumes distinguish mirror images */
+  h3 = h2 * REAL_SQRT(h2);
+  if (n >= 4)
+    key[16] = llround(det3(X[0], X[1], X[2], X[3]) / h3 * SINGCACHE_SCALE);
+  if (n >= 5)
+    key[17] = llround(det3(X[0], X[1], X[2], X[4]) / h3 * SINGCACHE_SCALE);
+}
+
+static uint hash_singcache(const int64_t *key) {
+  uint64_t h;
+  uint i;
+
+  /* FNV-1a */
+  h = 14695981039346656037ULL;
+  for (i = 0; i < SINGCACHE_KEYLEN; i++) {
+    h ^= (uint64_t) key[i];
+    h *= 1099511628211ULL;
+  }
+
+  return (uint) (h ^ (h >> 32));
+}
+
+static psingcacheentry find_singcache(pcsingcache sc, const int64_t *key) {
+  psingcacheentry e;
+
+  e = sc->bucket[hash_singcache(key) & (sc->buckets - 1)];
+  while (e != NULL && memcmp(e->key, key, sizeof(e->key)) != 0)
+    e = e->next;
+
+  return e;
+}
+
+static void rehash_singcache(psingcache sc) {
+  psingcacheentry *bucket, e, next;
+  uint buckets, i, h;
+
+  buckets = 2 * sc->buckets;
+  bucket = (psingcacheentry *) allocmem(sizeof(psingcacheentry) * buckets);
+  for (i = 0; i < buckets; i++)
+    bucket[i] = NULL;
+
+  for (i = 0; i < sc->buckets; i++)
+    for (e = sc->bucket[i]; e != NULL; e = next) {
+      next = e->next;
+      h = hash_singcache(e->key) & (buckets - 1);
+      e->next = bucket[h];
+      bucket[h] = e;
+    }
+
+  freemem(sc->bucket);
+  sc->bucket = bucket;
+  sc->buckets = buckets;
+}
+
+bool lookup_singcache(psingcache sc, const int64_t *key, uint values,
+    field *val) {
+  psingcacheentry e;
+  uint i;
+
+  assert(values <= SINGCACHE_VALUES);
+
+#ifdef USE_OPENMP
+  omp_set_lock(&sc->lock);
+#endif
+
+  e = find_singcache(sc, key);
+  if (e != NULL) {
+    for (i = 0; i < values; i++)
+      val[i] = e->val[i];
+    sc->hits++;
+  }
+  else
+    sc->misses++;
+
+#ifdef USE_OPENMP
+  omp_unset_lock(&sc->lock);
+#endif
+
+  return (e != NULL);
+}
+
+void insert_singcache(psingcache sc, const int64_t *key, uint values,
+    const field *val) {
+  psingcacheentry e;
+  uint i, h;
+
+  assert(values <= SINGCACHE_VALUES);
+
+#ifdef USE_OPENMP
+  omp_set_lock(&sc->lock);
+#endif
+
+  if (sc->size + sizeof(singcacheentry) <= sc->maxsize
+      && find_singcache(sc, key) == NULL) {
+    if (sc->entries >= 2 * sc->buckets)
+      rehash_singcache(sc);
+
+    e = (psingcacheentry) allocmem(sizeof(singcacheentry));
+    memcpy(e->key, key, sizeof(e->key));
+    for (i = 0; i < values; i++)
+      e->val[i] = val[i];
+    for (; i < SINGCACHE_VALUES; i++)
+      e->val[i] = 0.0;
+
+    h = hash_singcache(key) & (sc->buckets - 1);
+    e->next = sc->bucket[h];
+    sc->bucket[h] = e;
+
+    sc->entries++;
+    sc->size += sizeof(singcacheentry);
+  }
+
+#ifdef USE_OPENMP
+  omp_unset_lock(&sc->lock);
+#endif
+}
@@ -12,10 +12,11 @@
 
 /* C STD LIBRARY */
 #include <assert.h>
-/* CORE 0 */
-#ifdef USE_SIMD
-#include "simd.h"
+#include <stdint.h>
+#ifdef USE_OPENMP
+#include <omp.h>
 #endif
+/* CORE 0 */
 #include "settings.h"
 /* CORE 1 */
 #include "gaussquad.h"
@@ -31,6 +32,101 @@
  *  that will be applied by @ref bem3d and derived modules such as @ref laplacebem3d.
  *  @{ */
 
+/**
+ * @brief Slot number of triangles without precomputed quadrature points.
+ */
+#define TRIQUADPOINTS_NONE ((uint) -1)
+
+/**
+ * @brief Cache for singular integrals of congruent pairs of triangles.
+ */
+typedef struct _singcache singcache;
+
+/**
+ * Pointer to a @ref singcache object.
+ */
+typedef singcache *psingcache;
+
+/**
+ * Pointer to a constant @ref singcache object.
+ */
+typedef const singcache *pcsingcache;
+
+/**
+ * @brief Entry of a @ref singcache.
+ */
+typedef struct _singcacheentry singcacheentry;
+
+/**
+ * Pointer to a @ref singcacheentry object.
+ */
+typedef singcacheentry *psingcacheentry;
+
+/**
+ * @brief Maximal number of integrals stored for one pair of triangles, i.e.,
+ * the number of combinations of linear basis functions.
+ */
+#define SINGCACHE_VALUES 9
+
+/**
+ * @brief Length of the keys describing the congruence class of a pair of
+ * triangles.
+ */
+#define SINGCACHE_KEYLEN 18
+
+/**
+ * @brief Integrals for one congruence class of triangle pairs.
+ */
+struct _singcacheentry {
+  /** @brief Quantized description of the congruence class, see
+   * @ref key_singcache.*/
+  int64_t key[SINGCACHE_KEYLEN];
+  /** @brief Integrals for all combinations of basis functions, without the
+   * constant offset of the quadrature rule.*/
+  field val[SINGCACHE_VALUES];
+  /** @brief Next entry in the same bucket.*/
+  psingcacheentry next;
+};
+
+/**
+ * @brief Hash table of singular integrals for pairs of triangles sharing
+ * a vertex, an edge or both triangles.
+ *
+ * Kernel functions of boundary integral operators only depend on
+ * @f$x-y@f$ and the normal vectors, so the integrals for two pairs of
+ * triangles coincide if one pair is mapped to the other by a rotation and
+ * a translation.
+ * The pairs are identified by their number of common vertices, the
+ * orientation of the permutations chosen by
+ * @ref select_quadrature_singquad2d, the distances between all vertices
+ * and the volumes spanned by them, all rounded to about 12 significant
+ * digits.
+ * On structured meshes, e.g., meshes created by
+ * @ref build_from_macrosurface3d_surface3d, only a few classes exist, so
+ * most singular integrals are computed only once.
+ */
+struct _singcache {
+  /** @brief Buckets of the hash table.*/
+  psingcacheentry *bucket;
+  /** @brief Number of buckets, a power of two.*/
+  uint buckets;
+  /** @brief Number of entries.*/
+  uint entries;
+  /** @brief Storage used by the entries in bytes.*/
+  size_t size;
+  /** @brief Maximal storage for the entries in bytes, no new entries are
+   * added once it is reached.*/
+  size_t maxsize;
+  /** @brief Number of successful look-ups.*/
+  size_t hits;
+  /** @brief Number of failed look-ups.*/
+  size_t misses;
+#ifdef USE_OPENMP
+  /** @brief Lock protecting the hash table.*/
+  omp_lock_t lock;
+#endif
+};
+
 /**
  * @brief This struct collects all type of quadrature formulas needed by the
  * computation of matrix entries within BEM.
@@ -117,22 +213,32 @@ struct _singquad2d {
   /** @brief Number of quadrature points for a single triangle.*/
   uint n_single;
 
-#ifdef USE_TRIQUADPOINTS
   /**
-   * @brief 3D transformed quadrature points for every triangle - x-components.
+   * @brief 3D transformed quadrature points for selected triangles -
+   * x-components, <tt>NULL</tt> if not used.
    */
   real *tri_x;
 
   /**
-   * @brief 3D transformed quadrature points for every triangle - y-components.
+   * @brief 3D transformed quadrature points for selected triangles -
+   * y-components, <tt>NULL</tt> if not used.
    */
   real *tri_y;
 
   /**
-   * @brief 3D transformed quadrature points for every triangle - z-components.
+   * @brief 3D transformed quadrature points for selected triangles -
+   * z-components, <tt>NULL</tt> if not used.
    */
   real *tri_z;
-#endif
+
+  /**
+   * @brief Slot of every triangle in <tt>tri_x</tt>, <tt>tri_y</tt> and
+   * <tt>tri_z</tt> or @ref TRIQUADPOINTS_NONE if its points are not stored.
+   */
+  uint *tri_slot;
+
+  /** @brief Number of triangles with precomputed quadrature points.*/
+  uint tri_slots;
 
   /** @brief Order of basic quadrature rule for single and regular double
    integrals.*/
@@ -141,6 +247,10 @@ struct _singquad2d {
   uint q2;
   /** @brief maximal number of quadrature points.*/
   uint nmax;
+
+  /** @brief Optional cache for singular integrals of congruent pairs of
+   * triangles, <tt>NULL</tt> if not used.*/
+  psingcache cache;
 };
 
 /**
@@ -188,6 +298,47 @@ build_singquad2d(pcsurface3d gr, uint q, uint q2);
 HEADER_PREFIX void
 del_singquad2d(psingquad2d sq);
 
+/**
+ * @brief Precompute the 3D quadrature points of the single triangle rule
+ * for some or all triangles of a geometry.
+ *
+ * Regular double integrals and the evaluation of kernel functions in
+ * the farfield can use these points instead of transforming the
+ * reference points again for every pair of triangles.
+ * Previously precomputed points are discarded.
+ *
+ * @param gr Geometry, has to match the one used by @ref build_singquad2d.
+ * @param sq @ref _singquad2d "singquad2d" object.
+ * @param count Optional weight of every triangle, e.g., the number of
+ * nearfield blocks it appears in. If not <tt>NULL</tt>, only triangles
+ * with <tt>count[t] > mincount</tt> are selected.
+ * @param mincount Threshold for <tt>count</tt>.
+ * @param budget Maximal storage for the points in bytes, zero means
+ * unlimited. If the budget does not suffice, triangles with larger
+ * <tt>count</tt> are preferred.
+ * @return Returns the number of triangles with precomputed points.
+ */
+HEADER_PREFIX uint
+setup_triquadpoints_singquad2d(pcsurface3d gr, psingquad2d sq,
+    const uint *count, uint mincount, size_t budget);
+
+/**
+ * @brief Discard all precomputed 3D quadrature points.
+ *
+ * @param sq @ref _singquad2d "singquad2d" object.
+ */
+HEADER_PREFIX void
+del_triquadpoints_singquad2d(psingquad2d sq);
+
+/**
+ * @brief Get storage occupied by precomputed 3D quadrature points.
+ *
+ * @param sq @ref _singquad2d "singquad2d" object.
+ * @return Size of the point arrays and slot numbers in bytes.
+ */
+HEADER_PREFIX size_t
+getsize_triquadpoints_singquad2d(pcsingquad2d sq);
+
 /* ------------------------------------------------------------
  Weighting quadrature rules
  ------------------------------------------------------------ */
@@ -302,6 +453,90 @@ HEADER_PREFIX uint
 select_quadrature_singquad2d(pcsingquad2d sq, const uint *tv, const uint *sv,
     uint *tp, uint *sp, real **x, real **y, real **w, uint *n, real *base);
 
+/* ------------------------------------------------------------
+ Cache for singular integrals
+ ------------------------------------------------------------ */
+
+/**
+ * @brief Create a new @ref singcache object.
+ *
+ * @param maxsize Maximal storage for the entries in bytes.
+ * @return Returns a new, empty @ref singcache object.
+ */
+HEADER_PREFIX psingcache
+new_singcache(size_t maxsize);
+
+/**
+ * @brief Delete a @ref singcache object.
+ *
+ * @param sc @ref singcache object to be deleted.
+ */
+HEADER_PREFIX void
+del_singcache(psingcache sc);
+
+/**
+ * @brief Remove all entries of a @ref singcache, e.g., because the kernel
+ * function has changed.
+ *
+ * @param sc @ref singcache object.
+ */
+HEADER_PREFIX void
+clear_singcache(psingcache sc);
+
+/**
+ * @brief Compute the key describing the congruence class of a pair of
+ * triangles.
+ *
+ * The vertices have to be given in the order defined by the permutations
+ * returned by @ref select_quadrature_singquad2d, i.e., the first @p p
+ * vertices of both triangles coincide.
+ *
+ * @param values Number of integrals stored for the pair.
+ * @param p Number of common vertices.
+ * @param tp Permutation of the vertices of triangle @f$ t @f$.
+ * @param sp Permutation of the vertices of triangle @f$ s @f$.
+ * @param A_t First permuted vertex of @f$ t @f$.
+ * @param B_t Second permuted vertex of @f$ t @f$.
+ * @param C_t Third permuted vertex of @f$ t @f$.
+ * @param A_s First permuted vertex of @f$ s @f$.
+ * @param B_s Second permuted vertex of @f$ s @f$.
+ * @param C_s Third permuted vertex of @f$ s @f$.
+ * @param key Array of @ref SINGCACHE_KEYLEN entries that will receive the
+ * key.
+ */
+HEADER_PREFIX void
+key_singcache(uint values, uint p, const uint *tp, const uint *sp,
+    const real *A_t, const real *B_t, const real *C_t, const real *A_s,
+    const real *B_s, const real *C_s, int64_t *key);
+
+/**
+ * @brief Look up the integrals for a congruence class.
+ *
+ * @param sc @ref singcache object.
+ * @param key Key computed by @ref key_singcache.
+ * @param values Number of integrals.
+ * @param val Array of at least @p values entries that will receive the
+ * integrals if the class is found.
+ * @return <tt>true</tt> if the class was found.
+ */
+HEADER_PREFIX bool
+lookup_singcache(psingcache sc, const int64_t *key, uint values, field *val);
+
+/**
+ * @brief Store the integrals for a congruence class.
+ *
+ * Nothing happens if the memory limit has been reached or if the class is
+ * already present.
+ *
+ * @param sc @ref singcache object.
+ * @param key Key computed by @ref key_singcache.
+ * @param values Number of integrals.
+ * @param val Integrals.
+ */
+HEADER_PREFIX void
+insert_singcache(psingcache sc, const int64_t *key, uint values,
+    const field *val);
+
 /** @} */
 
 #endif /* SINGQUAD2D_H_ */
@@ -14,14 +14,14 @@
  * ------------------------------------------------------------ */
 
 psparsematrix
-new_raw_sparsematrix(uint rows, uint cols, uint nz)
+new_raw_sparsematrix(uint rows, uint cols, longindex nz)
 {
   uint      i;
 
   psparsematrix sp;
 
   sp = (psparsematrix) allocmem(sizeof(sparsematrix));
-  sp->row = allocuint(rows + 1);
+  sp->row = alloclongindex((size_t) rows + 1);
   sp->col = allocuint(nz);
   sp->coeff = allocfield(nz);
 
@@ -46,7 +46,7 @@ new_identity_sparsematrix(uint rows, uint cols)
   n = UINT_MIN(rows, cols);
 
   sp = (psparsematrix) allocmem(sizeof(sparsematrix));
-  sp->row = allocuint(rows + 1);
+  sp->row = alloclongindex((size_t) rows + 1);
   sp->col = allocuint(n);
   sp->coeff = allocfield(n);
 
@@ -71,12 +71,12 @@ new_zero_sparsematrix(psparsepattern sp)
 {
   psparsematrix A;
   ppatentry e;
-  uint     *row;
+  longindex *row;
   uint     *col;
   pfield    coeff;
   uint      rows, cols;
-  uint      nz;
-  uint      i, j;
+  longindex nz, j;
+  uint      i;
 
   assert(sp != NULL);
 
@@ -136,7 +136,7 @@ del_sparsematrix(psparsematrix a)
 field
 addentry_sparsematrix(psparsematrix a, uint row, uint col, field x)
 {
-  uint      i;
+  longindex i;
 
   assert(a != NULL);
   assert(row < a->rows);
@@ -153,7 +153,7 @@ addentry_sparsematrix(psparsematrix a, uint row, uint col, field x)
 void
 setentry_sparsematrix(psparsematrix a, uint row, uint col, field x)
 {
-  uint      i;
+  longindex i;
 
   assert(a != NULL);
   assert(row < a->rows);
@@ -176,7 +176,7 @@ getsize_sparsematrix(pcsparsematrix a)
   size_t    sz;
 
   sz = (size_t) sizeof(sparsematrix);
-  sz += (size_t) sizeof(uint) * (a->rows + 1);
+  sz += (size_t) sizeof(longindex) * (a->rows + 1);
   sz += (size_t) sizeof(uint) * a->nz;
   sz += (size_t) sizeof(field) * a->nz;
 
@@ -188,7 +188,7 @@ getsize_sparsematrix(pcsparsematrix a)
  * ------------------------------------------------------------ */
 
 static void
-swap(uint i1, uint i2, uint * col, pfield coeff)
+swap(longindex i1, longindex i2, uint * col, pfield coeff)
 {
   uint      hcol;
   field     hcoeff;
@@ -205,11 +205,12 @@ swap(uint i1, uint i2, uint * col, pfield coeff)
 void
 sort_sparsematrix(psparsematrix a)
 {
-  uint     *row = a->row;
+  longindex *row = a->row;
   uint     *col = a->col;
   pfield    coeff = a->coeff;
   uint      rows = a->rows;
-  uint      i, j, k;
+  longindex j, k;
+  uint      i;
 
   for (i = 0; i < rows; i++) {
     k = row[i];
@@ -222,7 +223,7 @@ sort_sparsematrix(psparsematrix a)
 void
 clear_sparsematrix(psparsematrix a)
 {
-  uint      i;
+  longindex i;
 
   for (i = 0; i < a->nz; i++)
     a->coeff[i] = 0.0;
@@ -231,11 +232,12 @@ clear_sparsematrix(psparsematrix a)
 void
 print_sparsematrix(pcsparsematrix a)
 {
-  uint     *row;
+  longindex *row;
   uint     *col;
   pfield    coeff;
   uint      rows;
-  uint      i, j;
+  longindex j;
+  uint      i;
 
   assert(a != NULL);
 
@@ -244,7 +246,8 @@ print_sparsematrix(pcsparsematrix a)
   coeff = a->coeff;
   rows = a->rows;
 
-  (void) printf("sparsematrix(%u,%u,%u)\n", rows, a->cols, a->nz);
+  (void) printf("sparsematrix(%u,%u,%lu)\n", rows, a->cols,
+		(unsigned long) a->nz);
   if (a->nz > 0) {
     for (i = 0; i < rows; i++) {
       (void) printf("  %u:", i);
@@ -261,13 +264,14 @@ print_sparsematrix(pcsparsematrix a)
 void
 print_eps_sparsematrix(pcsparsematrix a, const char *filename, uint offset)
 {
-  const uint *row;
+  const longindex *row;
   const uint *col;
   const field *coeff;
-  uint      rows, cols, nz;
+  uint      rows, cols;
+  longindex nz, r;
   FILE     *out;
   real      val, maxval, scale;
-  uint      i, j, r;
+  uint      i, j;
 
   assert(a != NULL);
 
@@ -281,8 +285,8 @@ print_eps_sparsematrix(pcsparsematrix a, const char *filename, uint offset)
   maxval = 0.0;
   if (nz > 0) {
     maxval = ABS(coeff[0]);
-    for (i = 1; i < nz; i++) {
-      val = ABS(coeff[i]);
+    for (r = 1; r < nz; r++) {
+      val = ABS(coeff[r]);
       if (maxval < val)
 	maxval = val;
     }
@@ -324,14 +328,15 @@ void
 addeval_sparsematrix_avector(field alpha, pcsparsematrix a, pcavector x,
 			     pavector y)
 {
-  uint     *row;
+  longindex *row;
   uint     *col;
   field    *coeff;
   uint      rows;
   pcfield   xv;
   pfield    yv;
   register field sum;
-  uint      i, j;
+  longindex j;
+  uint      i;
 
   assert(a != NULL);
   assert(x != NULL);
@@ -359,14 +364,15 @@ void
 addevaltrans_sparsematrix_avector(field alpha, pcsparsematrix a,
 				  pcavector x, pavector y)
 {
-  uint     *row;
+  longindex *row;
   uint     *col;
   field    *coeff;
   uint      rows;
   pcfield   xv;
   pfield    yv;
   register field val;
-  uint      i, j;
+  longindex j;
+  uint      i;
 
   assert(a != NULL);
   assert(x != NULL);
@@ -420,13 +426,14 @@ void
 add_sparsematrix_amatrix(field alpha, bool atrans, pcsparsematrix a,
 			 pamatrix b)
 {
-  const uint *row = a->row;
+  const longindex *row = a->row;
   const uint *col = a->col;
   pcfield   coeff = a->coeff;
   uint      rows = a->rows;
   uint      cols = a->cols;
-  uint      ldb = b->ld;
-  uint      i, j, k;
+  longindex ldb = b->ld;
+  longindex k;
+  uint      i, j;
 
 #ifdef HARITH_SPARSEMATRIX_QUICK_EXIT
   if (a->nz == 0)
@@ -44,12 +44,15 @@ struct _sparsematrix {
   uint rows;
   /** @brief Number of columns. */
   uint cols;
-  /** @brief Number of non-zero entries. */
-  uint nz;
+  /** @brief Number of non-zero entries.
+   *
+   *  Stored as @ref longindex, since the number of non-zero entries
+   *  of large matrices can exceed the range of @ref uint. */
+  longindex nz;
 
   /** @brief Starting indices for row representations in @c col and
    *  @c coeff. */
-  uint *row;
+  longindex *row;
   /** @brief Column indices of non-zero entries. */
   uint *col;
   /** @brief Coefficients of non-zero entries. */
@@ -70,7 +73,7 @@ struct _sparsematrix {
  *  @returns Allocated @ref sparsematrix object, arrays @c row,
  *     @c col and @c coeff are uninitialized. */
 HEADER_PREFIX psparsematrix
-new_raw_sparsematrix(uint rows, uint cols, uint nz);
+new_raw_sparsematrix(uint rows, uint cols, longindex nz);
 
 /**
  * @brief Creates a new @ref _sparsematrix "sparsematrix" object and
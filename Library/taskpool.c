@@ -0,0 +1,311 @@
+/* ------------------------------------------------------------
+ * This is the file "taskpool.c" of the H2Lib package.
+ * All rights reserved, Steffen Boerm 2026
+ * ------------------------------------------------------------ */
+
+#include "taskpool.h"
+
+#include "basic.h"
+
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+
+#ifdef USE_OPENMP
+#include <omp.h>
+#endif
+
+/* ------------------------------------------------------------
+ * Auxiliary functions
+ * ------------------------------------------------------------ */
+
+/* Wall-clock time in seconds, clock() would measure the processor
+ * time of the whole process instead */
+static    real
+wtime()
+{
+#ifdef USE_OPENMP
+  return omp_get_wtime();
+#else
+  struct timespec ts;
+
+  (void) timespec_get(&ts, TIME_UTC);
+
+  return (real) ts.tv_sec + 1.0e-9 * ts.tv_nsec;
+#endif
+}
+
+static int
+compare_taskentry(const void *a, const void *b)
+{
+  const taskentry *ta = (const taskentry *) a;
+  const taskentry *tb = (const taskentry *) b;
+
+  /* Decreasing cost, ties broken by the order of the ids to keep the
+   * schedule reproducible */
+  if (ta->cost > tb->cost)
+    return -1;
+  if (ta->cost < tb->cost)
+    return 1;
+  if (ta->id < tb->id)
+    return -1;
+  if (ta->id > tb->id)
+    return 1;
+  return 0;
+}
+
+static void
+resize_statistics(ptaskpool tp, uint threads)
+{
+  uint      i;
+
+  if (tp->threads != threads) {
+    freemem(tp->busy);
+    freemem(tp->idle);
+    freemem(tp->done);
+    freemem(tp->stolen);
+
+    tp->threads = threads;
+    tp->busy = allocreal(threads);
+    tp->idle = allocreal(threads);
+    tp->done = allocuint(threads);
+    tp->stolen = allocuint(threads);
+  }
+
+  for (i = 0; i < threads; i++) {
+    tp->busy[i] = 0.0;
+    tp->idle[i] = 0.0;
+    tp->done[i] = 0;
+    tp->stolen[i] = 0;
+  }
+}
+
+/* ------------------------------------------------------------
+ * Constructors and destructors
+ * ------------------------------------------------------------ */
+
+ptaskpool
+new_taskpool()
+{
+  ptaskpool tp;
+
+  tp = (ptaskpool) allocmem(sizeof(taskpool));
+  tp->task = NULL;
+  tp->tasks = 0;
+  tp->maxtasks = 0;
+  tp->groups = 0;
+  tp->threads = 0;
+  tp->wall = 0.0;
+  tp->busy = NULL;
+  tp->idle = NULL;
+  tp->done = NULL;
+  tp->stolen = NULL;
+
+  return tp;
+}
+
+void
+del_taskpool(ptaskpool tp)
+{
+  freemem(tp->task);
+  freemem(tp->busy);
+  freemem(tp->idle);
+  freemem(tp->done);
+  freemem(tp->stolen);
+
+  freemem(tp);
+}
+
+void
+clear_taskpool(ptaskpool tp)
+{
+  tp->tasks = 0;
+  tp->groups = 0;
+}
+
+/* ------------------------------------------------------------
+ * Adding and running tasks
+ * ------------------------------------------------------------ */
+
+void
+add_taskpool(ptaskpool tp, uint id, real cost, uint group)
+{
+  ptaskentry task;
+  uint      maxtasks;
+
+  if (tp->tasks == tp->maxtasks) {
+    maxtasks = (tp->maxtasks > 0 ? 2 * tp->maxtasks : 64);
+    task = (ptaskentry) allocmem(sizeof(taskentry) * maxtasks);
+    if (tp->tasks > 0)
+      memcpy(task, tp->task, sizeof(taskentry) * tp->tasks);
+    freemem(tp->task);
+    tp->task = task;
+    tp->maxtasks = maxtasks;
+  }
+
+  tp->task[tp->tasks].cost = cost;
+  tp->task[tp->tasks].id = id;
+  tp->task[tp->tasks].group = group;
+  tp->tasks++;
+
+  if (group != TASKPOOL_NOGROUP && group >= tp->groups)
+    tp->groups = group + 1;
+}
+
+#ifdef USE_OPENMP
+static void
+run_parallel(ptaskpool tp, uint threads,
+	     void (*work) (uint id, void *data), void *data)
+{
+  pctaskentry task = tp->task;
+  uint      tasks = tp->tasks;
+  uint     *front, *back, *queue;
+  omp_lock_t *qlock, *glock;
+  uint      i, j, k;
+
+  /* Deal the sorted tasks round-robin, queue i occupies
+   * queue[front[i]..back[i]-1] */
+  queue = allocuint(tasks);
+  front = allocuint(threads);
+  back = allocuint(threads);
+  k = 0;
+  for (i = 0; i < threads; i++) {
+    front[i] = k;
+    for (j = i; j < tasks; j += threads)
+      queue[k++] = j;
+    back[i] = k;
+  }
+  assert(k == tasks);
+
+  qlock = (omp_lock_t *) allocmem(sizeof(omp_lock_t) * threads);
+  for (i = 0; i < threads; i++)
+    omp_init_lock(qlock + i);
+
+  glock = NULL;
+  if (tp->groups > 0) {
+    glock = (omp_lock_t *) allocmem(sizeof(omp_lock_t) * tp->groups);
+    for (i = 0; i < tp->groups; i++)
+      omp_init_lock(glock + i);
+  }
+
+#pragma omp parallel num_threads(threads)
+  {
+    uint      t = omp_get_thread_num();
+    uint      v, n;
+    bool      found;
+    real      start;
+
+    n = 0;
+    for (;;) {
+      /* Most expensive task of the own queue */
+      omp_set_lock(qlock + t);
+      found = (front[t] < back[t]);
+      if (found)
+	n = queue[front[t]++];
+      omp_unset_lock(qlock + t);
+
+      /* Cheapest task of another queue */
+      for (v = 1; !found && v < threads; v++) {
+	omp_set_lock(qlock + (t + v) % threads);
+	found = (front[(t + v) % threads] < back[(t + v) % threads]);
+	if (found) {
+	  n = queue[--back[(t + v) % threads]];
+	  tp->stolen[t]++;
+	}
+	omp_unset_lock(qlock + (t + v) % threads);
+      }
+
+      if (!found)
+	break;
+
+      if (task[n].group != TASKPOOL_NOGROUP)
+	omp_set_lock(glock + task[n].group);
+
+      start = omp_get_wtime();
+      work(task[n].id, data);
+      tp->busy[t] += omp_get_wtime() - start;
+      tp->done[t]++;
+
+      if (task[n].group != TASKPOOL_NOGROUP)
+	omp_unset_lock(glock + task[n].group);
+    }
+  }
+
+  if (glock) {
+    for (i = 0; i < tp->groups; i++)
+      omp_destroy_lock(glock + i);
+    freemem(glock);
+  }
+  for (i = 0; i < threads; i++)
+    omp_destroy_lock(qlock + i);
+  freemem(qlock);
+  freemem(back);
+  freemem(front);
+  freemem(queue);
+}
+#endif
+
+void
+run_taskpool(ptaskpool tp, void (*work) (uint id, void *data), void *data)
+{
+  uint      threads;
+  real      start;
+  uint      i;
+
+  if (tp->tasks > 1)
+    qsort(tp->task, tp->tasks, sizeof(taskentry), compare_taskentry);
+
+  threads = 1;
+#ifdef USE_OPENMP
+  if (!omp_in_parallel())
+    threads = omp_get_max_threads();
+  if (threads > tp->tasks)
+    threads = (tp->tasks > 0 ? tp->tasks : 1);
+#endif
+
+  resize_statistics(tp, threads);
+
+  start = wtime();
+
+#ifdef USE_OPENMP
+  if (threads > 1)
+    run_parallel(tp, threads, work, data);
+  else
+#endif
+    for (i = 0; i < tp->tasks; i++) {
+      work(tp->task[i].id, data);
+      tp->done[0]++;
+    }
+
+  tp->wall = wtime() - start;
+
+  if (threads == 1)
+    tp->busy[0] = tp->wall;
+  for (i = 0; i < threads; i++)
+    tp->idle[i] = REAL_MAX(tp->wall - tp->busy[i], 0.0);
+}
+
+/* ------------------------------------------------------------
+ * Statistics
+ * ------------------------------------------------------------ */
+
+void
+print_taskpool(pctaskpool tp)
+{
+  real      busy;
+  uint      i;
+
+  busy = 0.0;
+  for (i = 0; i < tp->threads; i++)
+    busy += tp->busy[i];
+
+  (void) printf("%u tasks, %u threads, %.3f seconds, %.1f%% busy\n",
+		tp->tasks, tp->threads, tp->wall,
+		(tp->wall > 0.0 && tp->threads > 0 ?
+		 100.0 * busy / (tp->wall * tp->threads) : 100.0));
+
+  for (i = 0; i < tp->threads; i++)
+    (void) printf("  Thread %3u: %6u tasks (%u stolen),"
+		  " busy %.3f, idle %.3f seconds\n",
+		  i, tp->done[i], tp->stolen[i], tp->busy[i], tp->idle[i]);
+}
@@ -0,0 +1,172 @@
+/* ------------------------------------------------------------
+ * This is the file "taskpool.h" of the H2Lib package.
+ * All rights reserved, Steffen Boerm 2026
+ * ------------------------------------------------------------ */
+
+/** @file taskpool.h
+ *  @author Steffen B&ouml;rm
+ */
+
+#ifndef TASKPOOL_H
+#define TASKPOOL_H
+
+/** @defgroup taskpool taskpool
+ *  @brief Work-stealing pool for independent tasks of different cost.
+ *
+ *  A @ref taskpool collects independent tasks, e.g., the leaves of a
+ *  block tree, together with an estimate of their cost.
+ *  @ref run_taskpool sorts the tasks by decreasing cost and deals
+ *  them round-robin to one queue per thread.
+ *  Every thread processes its own queue starting with the most
+ *  expensive task.
+ *  A thread whose queue has run empty steals the cheapest remaining
+ *  task from another queue, so all threads stay busy until the pool
+ *  is exhausted.
+ *
+ *  Tasks can be assigned to an exclusive group, e.g., the row cluster
+ *  if the tasks write to shared row data.
+ *  Tasks of the same group are never executed concurrently.
+ *
+ *  The busy and idle times of all threads are recorded and can be
+ *  inspected by @ref print_taskpool.
+ *  @{ */
+
+/** @brief Pool of independent tasks. */
+typedef struct _taskpool taskpool;
+
+/** @brief Pointer to @ref taskpool object. */
+typedef taskpool *ptaskpool;
+
+/** @brief Pointer to constant @ref taskpool object. */
+typedef const taskpool *pctaskpool;
+
+/** @brief Single entry of a @ref taskpool. */
+typedef struct _taskentry taskentry;
+
+/** @brief Pointer to @ref taskentry object. */
+typedef taskentry *ptaskentry;
+
+/** @brief Pointer to constant @ref taskentry object. */
+typedef const taskentry *pctaskentry;
+
+#include "settings.h"
+
+/** @brief Group number for tasks that are not exclusive. */
+#define TASKPOOL_NOGROUP ((uint) -1)
+
+/** @brief Representation of a task. */
+struct _taskentry {
+  /** @brief Estimated cost. */
+  real cost;
+
+  /** @brief Number passed to the callback function. */
+  uint id;
+
+  /** @brief Exclusive group or @ref TASKPOOL_NOGROUP. */
+  uint group;
+};
+
+/** @brief Representation of a task pool. */
+struct _taskpool {
+  /** @brief Tasks. */
+  ptaskentry task;
+
+  /** @brief Number of tasks. */
+  uint tasks;
+
+  /** @brief Capacity of <tt>task</tt>. */
+  uint maxtasks;
+
+  /** @brief Number of exclusive groups, i.e., one more than the
+   *  largest group number used so far. */
+  uint groups;
+
+  /** @brief Number of threads used by the last call to
+   *  @ref run_taskpool. */
+  uint threads;
+
+  /** @brief Wall-clock time of the last call to @ref run_taskpool
+   *  in seconds. */
+  real wall;
+
+  /** @brief Time in seconds every thread has spent executing tasks. */
+  preal busy;
+
+  /** @brief Time in seconds every thread has spent waiting, i.e.,
+   *  <tt>wall</tt> minus <tt>busy</tt>. */
+  preal idle;
+
+  /** @brief Number of tasks executed by every thread. */
+  uint *done;
+
+  /** @brief Number of tasks every thread has stolen from other
+   *  queues. */
+  uint *stolen;
+};
+
+/* ------------------------------------------------------------
+ * Constructors and destructors
+ * ------------------------------------------------------------ */
+
+/** @brief Create an empty @ref taskpool object.
+ *
+ *  @remark Should always be matched by a call to @ref del_taskpool.
+ *
+ *  @returns New @ref taskpool object. */
+HEADER_PREFIX ptaskpool
+new_taskpool();
+
+/** @brief Delete a @ref taskpool object.
+ *
+ *  @param tp Object to be deleted. */
+HEADER_PREFIX void
+del_taskpool(ptaskpool tp);
+
+/** @brief Remove all tasks, but keep the statistics of the last run.
+ *
+ *  @param tp Task pool. */
+HEADER_PREFIX void
+clear_taskpool(ptaskpool tp);
+
+/* ------------------------------------------------------------
+ * Adding and running tasks
+ * ------------------------------------------------------------ */
+
+/** @brief Add a task.
+ *
+ *  @param tp Task pool.
+ *  @param id Number passed to the callback function.
+ *  @param cost Estimated cost, only the ratios between the costs of
+ *    different tasks are relevant.
+ *  @param group Exclusive group or @ref TASKPOOL_NOGROUP. */
+HEADER_PREFIX void
+add_taskpool(ptaskpool tp, uint id, real cost, uint group);
+
+/** @brief Execute all tasks.
+ *
+ *  If OpenMP is used and this function is not called inside a parallel
+ *  region, the tasks are executed by <tt>omp_get_max_threads()</tt>
+ *  threads with work stealing.
+ *  Otherwise they are executed sequentially by decreasing cost.
+ *
+ *  @param tp Task pool.
+ *  @param work Callback function, called once for every task with its
+ *    <tt>id</tt>.
+ *  @param data Additional data passed to the callback function. */
+HEADER_PREFIX void
+run_taskpool(ptaskpool tp, void (*work) (uint id, void *data), void *data);
+
+/* ------------------------------------------------------------
+ * Statistics
+ * ------------------------------------------------------------ */
+
+/** @brief Print busy and idle times of all threads for the last call
+ *  to @ref run_taskpool.
+ *
+ *  @param tp Task pool. */
+HEADER_PREFIX void
+print_taskpool(pctaskpool tp);
+
+/** @} */
+
+#endif
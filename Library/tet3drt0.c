@@ -129,11 +129,12 @@ psparsematrix build_tet3drt0_A_sparsematrix(pctet3drt0 dc) {
   uint tetrahedra = dc->t3->tetrahedra;
   uint faces = dc->t3->faces;
   psparsematrix A;
-  uint *row_nnz;
-  uint i, j, ii, jj, d, f, ft[4], nnz, nnz2, is_dof_i, is_dof_j;
+  longindex *row_nnz;
+  longindex nnz, nnz2, k;
+  uint i, j, ii, jj, d, f, ft[4], is_dof_i, is_dof_j;
 
   A = new_raw_sparsematrix(ndof, ndof, 0);
-  row_nnz = allocuint(ndof);
+  row_nnz = alloclongindex(ndof);
 
   for (f = 0; f < ndof; ++f) {
     row_nnz[f] = 0;
@@ -203,8 +204,8 @@ psparsematrix build_tet3drt0_A_sparsematrix(pctet3drt0 dc) {
   freemem(A->coeff); freemem(A->col);
   
   A->coeff = allocfield(nnz);
-  for (f = 0; f < nnz; ++f) {
-    A->coeff[f] = 0.0;
+  for (k = 0; k < nnz; ++k) {
+    A->coeff[k] = 0.0;
   }
   A->col = allocuint(nnz);
   A->nz = nnz;
@@ -303,11 +304,12 @@ psparsematrix build_tet3drt0_A_interaction_sparsematrix(pctet3drt0 dc) {
   uint ndof = dc->ndof;
   uint nfix = dc->nfix;
   psparsematrix Af;
-  uint *row_nnz;
-  uint i, j, ii, jj, t, f, ft[4], nnz, nnz2, is_dof_i, is_dof_j;
+  longindex *row_nnz;
+  longindex nnz, nnz2, k;
+  uint i, j, ii, jj, t, f, ft[4], is_dof_i, is_dof_j;
 
   Af = new_raw_sparsematrix(ndof, nfix, 0);
-  row_nnz = allocuint(ndof);
+  row_nnz = alloclongindex(ndof);
 
   for (f = 0; f < ndof; ++f) {
     row_nnz[f] = 0;
@@ -365,8 +367,8 @@ psparsematrix build_tet3drt0_A_interaction_sparsematrix(pctet3drt0 dc) {
   freemem(Af->coeff); freemem(Af->col);
   
   Af->coeff = allocfield(nnz);
-  for (f = 0; f < nnz; ++f) {
-    Af->coeff[f] = 0.0;
+  for (k = 0; k < nnz; ++k) {
+    Af->coeff[k] = 0.0;
   }
   Af->col = allocuint(nnz);
   Af->nz = nnz;
@@ -448,13 +450,14 @@ psparsematrix build_tet3drt0_B_sparsematrix(pctet3drt0 dc) {
   uint ndof = dc->ndof;
   uint tetrahedra = dc->t3->tetrahedra;
   psparsematrix A;
-  uint *row_nnz;
-  uint i, ii, d, ft[4], f, nt, nnz, nnz2, is_dof_i;
+  longindex *row_nnz;
+  longindex nnz, nnz2, k;
+  uint i, ii, d, ft[4], f, nt, is_dof_i;
 
   nt = dc->t3->tetrahedra;
 
   A = new_raw_sparsematrix(nt, ndof, 0);
-  row_nnz = allocuint(nt);
+  row_nnz = alloclongindex(nt);
 
   for (f = 0; f < nt; ++f) {
     row_nnz[f] = 0;
@@ -504,8 +507,8 @@ psparsematrix build_tet3drt0_B_sparsematrix(pctet3drt0 dc) {
   freemem(A->coeff); freemem(A->col);
   
   A->coeff = allocfield(nnz);
-  for (f = 0; f < nnz; ++f) {
-    A->coeff[f] = 0.0;
+  for (k = 0; k < nnz; ++k) {
+    A->coeff[k] = 0.0;
   }
   A->col = allocuint(nnz);
   A->nz = nnz;
@@ -581,12 +584,13 @@ psparsematrix build_tet3drt0_B_interaction_sparsematrix(pctet3drt0 dc) {
   uint nfix = dc->nfix;
   uint tetrahedra = dc->t3->tetrahedra;
   psparsematrix Af;
-  uint *row_nnz;
-  uint i, ii, d, ft[4], f, nt, nnz, nnz2, is_dof_i;
+  longindex *row_nnz;
+  longindex nnz, nnz2, k;
+  uint i, ii, d, ft[4], f, nt, is_dof_i;
 
   nt = dc->t3->tetrahedra;
   Af = new_raw_sparsematrix(nt, nfix, 0);
-  row_nnz = allocuint(nt);
+  row_nnz = alloclongindex(nt);
 
   for (f = 0; f < nt; ++f) {
     row_nnz[f] = 0;
@@ -636,8 +640,8 @@ psparsematrix build_tet3drt0_B_interaction_sparsematrix(pctet3drt0 dc) {
   freemem(Af->coeff); freemem(Af->col);
   
   Af->coeff = allocfield(nnz);
-  for (f = 0; f < nnz; ++f) {
-    Af->coeff[f] = 0.0;
+  for (k = 0; k < nnz; ++k) {
+    Af->coeff[k] = 0.0;
   }
   Af->col = allocuint(nnz);
   Af->nz = nnz;
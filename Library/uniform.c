@@ -27,6 +27,7 @@ new_uniform(pclusterbasis rb, pclusterbasis cb)
   ref_col_uniform(u, cb);
 
   init_amatrix(&u->S, rb->k, cb->k);
+  u->Slow = NULL;
 
   return u;
 }
@@ -36,6 +37,8 @@ del_uniform(puniform u)
 {
   assert(u != 0);
 
+  if (u->Slow)
+    freemem(u->Slow);
   uninit_amatrix(&u->S);
 
   unref_row_uniform(u);
@@ -146,7 +149,10 @@ getsize_uniform(pcuniform u)
   size_t    sz;
 
   sz = sizeof(uniform);
-  sz += getsize_heap_amatrix(&u->S);
+  if (u->Slow)
+    sz += (size_t) sizeof(lowfield) * u->S.rows * u->S.cols;
+  else
+    sz += getsize_heap_amatrix(&u->S);
 
   return sz;
 }
@@ -201,10 +207,77 @@ random_uniform(puniform u)
   random_amatrix(&u->S);
 }
 
+void
+lowprec_uniform(puniform u)
+{
+  if (u->Slow || u->S.rows == 0 || u->S.cols == 0)
+    return;
+
+  u->Slow = lowprec_amatrix(&u->S);
+
+  if (u->S.owner == NULL)
+    freemem(u->S.a);
+  u->S.a = NULL;
+  u->S.ld = u->S.rows;
+}
+
+void
+fullprec_uniform(puniform u)
+{
+  if (u->Slow == NULL)
+    return;
+
+  u->S.a = allocmatrix(u->S.rows, u->S.cols);
+  u->S.ld = u->S.rows;
+  u->S.owner = NULL;
+  fullprec_amatrix(u->Slow, &u->S);
+
+  freemem(u->Slow);
+  u->Slow = NULL;
+}
+
 /* ------------------------------------------------------------
    Matrix-vector multiplication
    ------------------------------------------------------------ */
 
+void
+mvm_coupling_uniform_avector(field alpha, bool trans, pcuniform u,
+			     pcavector x, pavector y)
+{
+  if (u->Slow) {
+    if (trans)
+      addevaltrans_lowprec_avector(alpha, u->S.rows, u->S.cols, u->Slow, x,
+				   y);
+    else
+      addeval_lowprec_avector(alpha, u->S.rows, u->S.cols, u->Slow, x, y);
+  }
+  else
+    mvm_amatrix_avector(alpha, trans, &u->S, x, y);
+}
+
+void
+mvm_coupling_uniform_amatrix(field alpha, bool trans, pcuniform u,
+			     pcamatrix X, pamatrix Y)
+{
+  avector   tmp1, tmp2;
+  pavector  x, y;
+  uint      j;
+
+  assert(X->cols == Y->cols);
+
+  if (u->Slow) {
+    for (j = 0; j < X->cols; j++) {
+      x = init_column_avector(&tmp1, (pamatrix) X, j);
+      y = init_column_avector(&tmp2, Y, j);
+      mvm_coupling_uniform_avector(alpha, trans, u, x, y);
+      uninit_avector(y);
+      uninit_avector(x);
+    }
+  }
+  else
+    addmul_amatrix(alpha, trans, &u->S, false, X, Y);
+}
+
 void
 mvm_uniform_avector(field alpha, bool trans, pcuniform u,
 		    pcavector x, pavector y)
@@ -220,7 +293,7 @@ mvm_uniform_avector(field alpha, bool trans, pcuniform u,
 
     clear_avector(yt);
 
-    mvm_amatrix_avector(alpha, true, &u->S, xt, yt);
+    mvm_coupling_uniform_avector(alpha, true, u, xt, yt);
 
     expand_clusterbasis_avector(u->cb, yt, y);
 
@@ -235,7 +308,7 @@ mvm_uniform_avector(field alpha, bool trans, pcuniform u,
 
     clear_avector(yt);
 
-    mvm_amatrix_avector(alpha, false, &u->S, xt, yt);
+    mvm_coupling_uniform_avector(alpha, false, u, xt, yt);
 
     expand_clusterbasis_avector(u->rb, yt, y);
 
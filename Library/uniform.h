@@ -73,6 +73,9 @@ struct _uniform {
   pclusterbasis cb;
   /** @brief Coupling matrix */
   amatrix S;
+  /** @brief Reduced-precision copy of the coupling matrix,
+   *  <tt>NULL</tt> if it is stored in full precision */
+  plowfield Slow;
   /** @brief Next row block in list */
   puniform rnext;
   /** @brief Previous row block in list */
@@ -222,6 +225,30 @@ scale_uniform(field alpha, puniform u);
 HEADER_PREFIX void
 random_uniform(puniform u);
 
+/** @brief Store the coupling matrix in reduced precision.
+ *
+ *  The coefficients of @f$S@f$ are rounded to @ref lowfield and
+ *  the full-precision storage is released.
+ *  The dimensions of <tt>u->S</tt> are kept.
+ *
+ *  @remark While the coupling matrix is stored in reduced precision,
+ *  only the matrix-vector multiplication functions can be used.
+ *  All other operations require a call to @ref fullprec_uniform first.
+ *
+ *  @param u Target matrix. */
+HEADER_PREFIX void
+lowprec_uniform(puniform u);
+
+/** @brief Restore the full-precision coupling matrix of a uniform
+ *  matrix stored in reduced precision.
+ *
+ *  Does nothing if the coupling matrix is already stored in full
+ *  precision.
+ *
+ *  @param u Target matrix. */
+HEADER_PREFIX void
+fullprec_uniform(puniform u);
+
 ///**
 // * @brief Computes the euclidean-norm of the coupling matrix and or the product
 // * of weight matrices with the coupling matrix.
@@ -289,6 +316,37 @@ random_uniform(puniform u);
 HEADER_PREFIX void
 mvm_uniform_avector(field alpha, bool trans, pcuniform u, pcavector x, pavector y);
 
+/** @brief Multiply the coupling matrix by a coefficient vector,
+ *  @f$y \gets y + \alpha S x@f$ or @f$y \gets y + \alpha S^* x@f$.
+ *
+ *  Uses the reduced-precision copy of @f$S@f$ if it exists, in this
+ *  case the coefficients are converted on the fly and all sums are
+ *  accumulated in @ref field.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param trans Set if @f$S^*@f$ is to be used instead of @f$S@f$.
+ *  @param u Matrix containing the coupling matrix @f$S@f$.
+ *  @param x Source coefficient vector @f$x@f$.
+ *  @param y Target coefficient vector @f$y@f$. */
+HEADER_PREFIX void
+mvm_coupling_uniform_avector(field alpha, bool trans, pcuniform u,
+    pcavector x, pavector y);
+
+/** @brief Multiply the coupling matrix by a coefficient matrix,
+ *  @f$Y \gets Y + \alpha S X@f$ or @f$Y \gets Y + \alpha S^* X@f$.
+ *
+ *  Uses the reduced-precision copy of @f$S@f$ if it exists, see
+ *  @ref mvm_coupling_uniform_avector.
+ *
+ *  @param alpha Scaling factor @f$\alpha@f$.
+ *  @param trans Set if @f$S^*@f$ is to be used instead of @f$S@f$.
+ *  @param u Matrix containing the coupling matrix @f$S@f$.
+ *  @param X Source coefficient matrix @f$X@f$.
+ *  @param Y Target coefficient matrix @f$Y@f$. */
+HEADER_PREFIX void
+mvm_coupling_uniform_amatrix(field alpha, bool trans, pcuniform u,
+    pcamatrix X, pamatrix Y);
+
 /* ------------------------------------------------------------
  * Conversion operations
  * ------------------------------------------------------------ */
@@ -573,6 +573,74 @@ check_clear_copy_lower(pcamatrix a)
   uninit_amatrix(a3);
 }
 
+static void
+check_fused_avector(uint n)
+{
+  pavector  x, y, z, y2;
+  pcavector xs[3], ys[3];
+  field     d[3], e[3];
+  field     dot;
+  real      norm, error;
+
+  x = new_avector(n);
+  y = new_avector(n);
+  z = new_avector(n);
+  y2 = new_avector(n);
+  random_avector(x);
+  random_avector(y);
+  random_avector(z);
+
+  copy_avector(y, y2);
+  scale_avector(-alpha, y2);
+  add_avector(alpha, x, y2);
+  scaleadd_avector(alpha, x, -alpha, y);
+  add_avector(-1.0, y2, y);
+  error = norm2_avector(y) / norm2_avector(y2);
+  (void) printf("Checking scaleadd_avector, dim %u\n"
+		"  Accuracy %g, %sokay\n", n, error,
+		(error < tolerance ? "" : "    NOT "));
+  if (error >= tolerance)
+    problems++;
+
+  copy_avector(y2, y);
+  dot = adddotprod_avector(alpha, x, y, z);
+  add_avector(alpha, x, y2);
+  error = ABS(dot - dotprod_avector(z, y2)) / ABS(dot);
+  norm = addnorm2_avector(alpha, x, y);
+  add_avector(alpha, x, y2);
+  error += REAL_ABS(norm - norm2_avector(y2)) / norm;
+  add_avector(-1.0, y2, y);
+  error += norm2_avector(y) / norm2_avector(y2);
+  (void) printf("Checking adddotprod_avector and addnorm2_avector, dim %u\n"
+		"  Accuracy %g, %sokay\n", n, error,
+		(error < tolerance ? "" : "    NOT "));
+  if (error >= tolerance)
+    problems++;
+
+  xs[0] = x;
+  ys[0] = y2;
+  xs[1] = z;
+  ys[1] = x;
+  xs[2] = x;
+  ys[2] = x;
+  dotprods_avector(3, xs, ys, d);
+  e[0] = dotprod_avector(x, y2);
+  e[1] = dotprod_avector(z, x);
+  e[2] = norm2_avector(x) * norm2_avector(x);
+  error = ABS(d[0] - e[0]) / ABS(e[0]) + ABS(d[1] - e[1]) / ABS(e[1])
+    + ABS(d[2] - e[2]) / ABS(e[2]);
+  (void) printf("Checking dotprods_avector, dim %u\n"
+		"  Accuracy %g, %sokay\n", n, error,
+		(error < tolerance ? "" : "    NOT "));
+  if (error >= tolerance)
+    problems++;
+
+  del_avector(y2);
+  del_avector(z);
+  del_avector(y);
+  del_avector(x);
+}
+
 static void
 set_unit(pamatrix R)
 {
@@ -650,6 +718,11 @@ main()
 
   del_amatrix(a);
 
+  (void) printf("----------------------------------------\n"
+		"Check blocked and fused vector operations\n");
+  check_fused_avector(rows);
+  check_fused_avector(100003);
+
   (void) printf("----------------------------------------\n"
 		"Check random %u x %u Cholesky factorization\n", rows, rows);
 
@@ -5,6 +5,7 @@
 #include "h2matrix.h"
 #include "h2arith.h"
 #include "truncation.h"
+#include "krylovsolvers.h"
 
 #include "laplacebem2d.h"
 
@@ -31,17 +32,20 @@ static real tolerance = 1.0e-12;
 int
 main()
 {
-  ph2matrix h2, h2copy, L, R;
+  ph2matrix h2, h2copy, L, R, h2map, h2file;
+  pmmapfile mf;
   pclusterbasis rb, cb, rbcopy, cbcopy, rblow, cblow, rbup, cbup;
   pclusteroperator rwf, cwf, rwflow, cwflow, rwfup, cwfup, rwfh2, cwfh2;
   ptruncmode tm;
 
-  pavector  x, b;
-  uint      n;
+  pavector  x, b, y;
+  pamatrix  X, Y;
+  pcoarselu lu;
+  uint      n, iter;
   real      error;
   pcurve2d  gr2;
   pbem2d    bem2;
-  pcluster  root2;
+  pcluster  root2, root;
   pblock    block2;
   uint      clf, m;
   real      tol, eta, delta, eps_aca;
@@ -124,6 +128,63 @@ main()
   if (!IS_IN_RANGE(0.0, error, 25.0 * tol))
     problems++;
 
+  (void) printf("Checking binary container file\n");
+  if (!write_mmapcomplete_h2matrix(h2, "test_h2matrix.h2b"))
+    problems++;
+  mf = open_mmapfile("test_h2matrix.h2b");
+  assert(mf != NULL);
+  h2map = read_mmapcomplete_h2matrix(mf);
+  error = norm2diff_h2matrix(h2, h2map) / norm2_h2matrix(h2);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		error <= tol ? "" : "    NOT ");
+  if (error > tol)
+    problems++;
+  root = (pcluster) h2map->rb->t;
+  del_h2matrix(h2map);
+  del_cluster(root);
+  close_mmapfile(mf);
+  (void) remove("test_h2matrix.h2b");
+
+  (void) printf("Checking reduced-precision matrix\n");
+  h2map = clone_h2matrix(h2, h2->rb, h2->cb);
+  lowprec_h2matrix(h2map, 1.0e-4);
+  error = norm2diff_h2matrix(h2, h2map) / norm2_h2matrix(h2);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		error <= 1.0e-4 ? "" : "    NOT ");
+  if (error > 1.0e-4)
+    problems++;
+
+  X = new_amatrix(h2->cb->t->size, 3);
+  Y = new_amatrix(h2->rb->t->size, 3);
+  random_amatrix(X);
+  clear_amatrix(Y);
+  addmul_h2matrix_amatrix_amatrix(alpha, false, h2, false, X, Y);
+  addmul_h2matrix_amatrix_amatrix(-alpha, false, h2map, false, X, Y);
+  error = normfrob_amatrix(Y) / normfrob_amatrix(X) / norm2_h2matrix(h2);
+  (void) printf("  Multiplication with amatrix %g, %sokay\n", error,
+		error <= 1.0e-4 ? "" : "    NOT ");
+  if (error > 1.0e-4)
+    problems++;
+  del_amatrix(Y);
+  del_amatrix(X);
+
+  if (!write_mmapcomplete_h2matrix(h2map, "test_h2matrix.h2b"))
+    problems++;
+  mf = open_mmapfile("test_h2matrix.h2b");
+  assert(mf != NULL);
+  h2file = read_mmapcomplete_h2matrix(mf);
+  error = norm2diff_h2matrix(h2map, h2file) / norm2_h2matrix(h2map);
+  (void) printf("  Binary container file %g, %sokay\n", error,
+		error <= tol ? "" : "    NOT ");
+  if (error > tol)
+    problems++;
+  root = (pcluster) h2file->rb->t;
+  del_h2matrix(h2file);
+  del_cluster(root);
+  close_mmapfile(mf);
+  (void) remove("test_h2matrix.h2b");
+  del_h2matrix(h2map);
+
   del_h2matrix(h2copy);
   del_h2matrix(h2);
   del_h2matrix(L);
@@ -194,6 +255,24 @@ main()
   if (!IS_IN_RANGE(0.0, error, 25.0 * tol))
     problems++;
 
+  (void) printf("Solving by FGMRES with coarse LR factorization\n");
+  lu = build_h2matrix_coarselu(h2copy, tm, 1e-2, 0);
+  clear_avector(b);
+  mvm_h2matrix_avector(1.0, false, h2copy, x, b);
+  y = new_avector(n);
+  clear_avector(y);
+  iter = solve_fgmres_h2matrix_avector(h2copy, prcd_coarselu, lu, b, y,
+				       100.0 * tol, 0, 20);
+  mvm_h2matrix_avector(-1.0, false, h2copy, y, b);
+  error = norm2_avector(b) / norm2_avector(x);
+  (void) printf("  %u steps, %.1f KB factors\n"
+		"  Residual %g, %sokay\n", iter, lu->size / 1024.0, error,
+		IS_IN_RANGE(0.0, error, 100.0 * tol) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 100.0 * tol) || iter > 15)
+    problems++;
+  del_avector(y);
+  del_coarselu(lu);
+
   rwfh2 = prepare_row_clusteroperator(h2copy->rb, h2copy->cb, tm);
   cwfh2 = prepare_col_clusteroperator(h2copy->rb, h2copy->cb, tm);
 
@@ -4,6 +4,11 @@
 #include "krylov.h"
 #include "helmholtzbem3d.h"
 #include "matrixnorms.h"
+#ifdef USE_SIMD
+#include "simd.h"
+#endif
+
+#include <float.h>
 
 #ifdef USE_CAIRO
 #include <cairo.h>
@@ -75,7 +80,7 @@ eval_brakhage_werner_c(pcbem3d bem, pcavector w, field eta, real * x)
   const uint rows = gr->triangles;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
@@ -143,7 +148,7 @@ eval_brakhage_werner_l(pcbem3d bem, pcavector w, field eta, real * x)
   real      k = bem->k;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single;
@@ -458,6 +463,79 @@ test_system(matrixtype mattype, const char *apprxtype,
   freemem(hdata.kvec);
 }
 
+/* Compare the nearfield for several wave numbers assembled in one pass
+ * with the nearfield for one wave number after the other */
+static void
+test_sweep(pbem3d bem, const char *name, uint rows, uint cols)
+{
+  pamatrix  N[3], G;
+  field     k[3], k0;
+  real      error, norm;
+  uint      l;
+
+  k0 = bem->k;
+  k[0] = k0;
+  k[1] = 2.0 * k0;
+  k[2] = 0.5 * k0 + 0.25 * I;
+
+  for (l = 0; l < 3; l++)
+    N[l] = new_amatrix(rows, cols);
+  nearfield_sweep_helmholtzbem3d(NULL, NULL, bem, false, 3, k, N);
+
+  G = new_amatrix(rows, cols);
+  error = 0.0;
+  for (l = 0; l < 3; l++) {
+    set_wavenumber_helmholtzbem3d(bem, k[l]);
+    bem->nearfield(NULL, NULL, bem, false, G);
+    norm = normfrob_amatrix(G);
+    add_amatrix(-1.0, false, G, N[l]);
+    error = REAL_MAX(error, normfrob_amatrix(N[l]) / norm);
+  }
+  set_wavenumber_helmholtzbem3d(bem, k0);
+
+  (void) printf("Sweep over 3 wave numbers (%s):\n"
+		"  rel. error %.3e      %s\n\n", name, error,
+		(error < 1.0e-12 ? "    okay" : "NOT okay"));
+  if (error >= 1.0e-12)
+    problems++;
+
+  del_amatrix(G);
+  for (l = 0; l < 3; l++)
+    del_amatrix(N[l]);
+}
+
+static void
+test_fused(pbem3d bem_slp, pbem3d bem_dlp, pcamatrix Vfull,
+	   pcamatrix KMfull)
+{
+  pbem3d    bem[3];
+  pamatrix  N[3];
+  real      error;
+
+  bem[0] = bem_slp;
+  bem[1] = bem_dlp;
+  bem[2] = NULL;
+
+  N[0] = new_amatrix(Vfull->rows, Vfull->cols);
+  N[1] = new_amatrix(KMfull->rows, KMfull->cols);
+  N[2] = NULL;
+  nearfield_fused_helmholtzbem3d(NULL, NULL, bem, false, 3, N);
+
+  add_amatrix(-1.0, false, Vfull, N[0]);
+  add_amatrix(-1.0, false, KMfull, N[1]);
+  error = REAL_MAX(normfrob_amatrix(N[0]) / normfrob_amatrix(Vfull),
+		   normfrob_amatrix(N[1]) / normfrob_amatrix(KMfull));
+
+  (void) printf("Fused SLP/DLP nearfield:\n"
+		"  rel. error %.3e      %s\n\n", error,
+		(error < 1.0e-12 ? "    okay" : "NOT okay"));
+  if (error >= 1.0e-12)
+    problems++;
+
+  del_amatrix(N[1]);
+  del_amatrix(N[0]);
+}
+
 void
 test_suite(pcsurface3d gr, field k, uint q, uint clf, real eta,
 	   basisfunctionbem3d row_basis, basisfunctionbem3d col_basis,
@@ -498,6 +576,15 @@ test_suite(pcsurface3d gr, field k, uint q, uint clf, real eta,
   bem_slp->nearfield(NULL, NULL, bem_slp, false, Vfull);
   bem_dlp->nearfield(NULL, NULL, bem_dlp, false, KMfull);
 
+  /*
+   * Test frequency sweep
+   */
+
+  test_sweep(bem_slp, "SLP", nn, nn);
+  test_sweep(bem_dlp, "DLP", nn, nd);
+  if (nn == nd)
+    test_fused(bem_slp, bem_dlp, Vfull, KMfull);
+
   /*
    * Test Interpolation
    */
@@ -690,6 +777,89 @@ test_suite(pcsurface3d gr, field k, uint q, uint clf, real eta,
   del_helmholtz_bem3d(bem_dlp);
 }
 
+#ifdef USE_SIMD
+/* Compare the accuracy-selectable vsincosn with vsincos and libm for
+ * arguments k |x-y| in [0, 100] */
+static void
+test_sincos_simd()
+{
+  pstopwatch sw;
+  real     *x, *c, *s;
+  vreal     vc, vs, sum;
+  real      t, bound, error, r2, tol;
+  uint      n, i, j, terms, rep;
+
+  n = 1 << 14;
+  rep = 64;
+  x = (real *) allocmem(sizeof(real) * n);
+  c = (real *) allocmem(sizeof(real) * n);
+  s = (real *) allocmem(sizeof(real) * n);
+  for (i = 0; i < n; i++)
+    x[i] = 100.0 * i / n;
+
+  sw = new_stopwatch();
+
+  (void) printf("Vectorized sine and cosine, %u arguments:\n", n * rep);
+
+  sum = vsetzero();
+  start_stopwatch(sw);
+  for (j = 0; j < rep; j++)
+    for (i = 0; i + VREAL <= n; i += VREAL) {
+      vsincos(vloadu(x + i), &vc, &vs);
+      sum = vadd(sum, vadd(vc, vs));
+    }
+  t = stop_stopwatch(sw);
+  (void) printf("  vsincos       %.3f s       (%.1f)\n", t, vreduce(sum));
+
+  /* Rounding errors of the range reduction grow with the argument */
+#ifdef USE_FLOAT
+  tol = 4.0 * x[n - 1] * FLT_EPSILON;
+#else
+  tol = 4.0 * x[n - 1] * DBL_EPSILON;
+#endif
+
+  r2 = REAL_SQR(0.25 * M_PI);
+  bound = r2 * r2 / 24.0;
+  for (terms = 1; terms <= VSINCOS_MAXTERMS; terms++) {
+    if (terms >= 4) {
+      sum = vsetzero();
+      start_stopwatch(sw);
+      for (j = 0; j < rep; j++)
+	for (i = 0; i + VREAL <= n; i += VREAL) {
+	  vsincosn(vloadu(x + i), terms, &vc, &vs);
+	  sum = vadd(sum, vadd(vc, vs));
+	}
+      t = stop_stopwatch(sw);
+
+      for (i = 0; i + VREAL <= n; i += VREAL) {
+	vsincosn(vloadu(x + i), terms, &vc, &vs);
+	vstoreu(c + i, vc);
+	vstoreu(s + i, vs);
+      }
+      error = 0.0;
+      for (i = 0; i < n; i++) {
+	error = REAL_MAX(error, REAL_ABS(c[i] - REAL_COS(x[i])));
+	error = REAL_MAX(error, REAL_ABS(s[i] - REAL_SIN(x[i])));
+      }
+
+      (void) printf("  vsincosn(%2u)  %.3f s  error %.2e  bound %.2e  %s\n",
+		    terms, t, error, bound,
+		    (error <= bound + tol ? "    okay" : "NOT okay"));
+      if (error > bound + tol)
+	problems++;
+    }
+
+    bound *= r2 / ((2 * terms + 3) * (2 * terms + 4));
+  }
+  (void) printf("\n");
+
+  del_stopwatch(sw);
+  freemem(s);
+  freemem(c);
+  freemem(x);
+}
+#endif
+
 int
 main(int argc, char **argv)
 {
@@ -701,6 +871,10 @@ main(int argc, char **argv)
 
   init_h2lib(&argc, &argv);
 
+#ifdef USE_SIMD
+  test_sincos_simd();
+#endif
+
   n = 512;
   k = 2.0;
   q = 2;
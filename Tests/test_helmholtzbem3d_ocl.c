@@ -76,7 +76,7 @@ eval_brakhage_werner_c(pcbem3d bem, pcavector w, field eta, real * x)
   const uint rows = gr->triangles;
 
   uint      nq = bem->sq->n_single;
-  uint      vnq = ROUNDUP(nq, VREAL);
+  uint      vnq = ROUNDUP(nq, VREAL_PAD);
   real     *xx = bem->sq->x_single;
   real     *yy = bem->sq->y_single;
   real     *ww = bem->sq->w_single + 3 * vnq;
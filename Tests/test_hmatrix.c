@@ -3,6 +3,7 @@
 #include "hmatrix.h"
 #include "harith.h"
 #include "hcoarsen.h"
+#include "krylovsolvers.h"
 
 #include "laplacebem2d.h"
 
@@ -377,10 +378,12 @@ set_unit_amatrix(pamatrix R)
 int
 main(int argc, char **argv)
 {
-  phmatrix  a, acopy, L, R, work;
+  phmatrix  a, acopy, L, R, work, amap;
+  pmmapfile mf;
   pamatrix  La, Ra;
   pavector  x, b, b2;
-  uint      n;
+  pcoarselu lu;
+  uint      n, iter;
   real      error;
   pcurve2d  gr2;
   pbem2d    bem2;
@@ -650,6 +653,22 @@ main(int argc, char **argv)
   if (!IS_IN_RANGE(0.0, error, 10.0 * tol))
     problems++;
 
+  (void) printf("Solving by FGMRES with coarse LR factorization\n");
+  lu = build_hmatrix_coarselu(acopy, 0, 1e-2, 0);
+  clear_avector(b);
+  mvm_hmatrix_avector(1.0, false, acopy, x, b);
+  clear_avector(b2);
+  iter = solve_fgmres_hmatrix_avector(acopy, prcd_coarselu, lu, b, b2,
+				      100.0 * tol, 0, 20);
+  mvm_hmatrix_avector(-1.0, false, acopy, b2, b);
+  error = norm2_avector(b) / norm2_avector(x);
+  (void) printf("  %u steps, %.1f KB factors\n"
+		"  Residual %g, %sokay\n", iter, lu->size / 1024.0, error,
+		IS_IN_RANGE(0.0, error, 100.0 * tol) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 100.0 * tol) || iter > 15)
+    problems++;
+  del_coarselu(lu);
+
   (void) printf("Checking factorization\n");
   error = norm2_hmatrix(acopy);
   addmul_hmatrix(alpha, false, L, false, R, 0, tol, acopy);
@@ -761,6 +780,124 @@ main(int argc, char **argv)
   if (!IS_IN_RANGE(0.0, error, 10.0 * tol))
     problems++;
 
+  (void) printf("----------------------------------------\n"
+		"Checking binary container file\n");
+  if (!write_mmapcomplete_hmatrix(acopy, "test_hmatrix.h2b"))
+    problems++;
+  mf = open_mmapfile("test_hmatrix.h2b");
+  assert(mf != NULL);
+  amap = read_mmapcomplete_hmatrix(mf);
+  error = norm2diff_hmatrix(acopy, amap) / norm2_hmatrix(acopy);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, tol) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, tol))
+    problems++;
+  del_cluster((pcluster) amap->rc);
+  del_hmatrix(amap);
+  close_mmapfile(mf);
+  (void) remove("test_hmatrix.h2b");
+
+  (void) printf("Checking out-of-core matrix\n");
+  amap = clone_hmatrix(acopy);
+  mf = spill_hmatrix(amap, "test_hmatrix_ooc.h2b", 1 << 16);
+  assert(mf != NULL);
+  random_avector(x);
+  clear_avector(b);
+  addeval_hmatrix_avector(alpha, acopy, x, b);
+  addeval_stream_hmatrix_avector(-alpha, amap, mf, x, b);
+  addeval_stream_hmatrix_avector(alpha, amap, mf, x, b);
+  addeval_stream_hmatrix_avector(-alpha, amap, mf, x, b);
+  error = norm2_avector(b) / norm2_avector(x);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, tol) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, tol))
+    problems++;
+  del_hmatrix(amap);
+  close_mmapfile(mf);
+  (void) remove("test_hmatrix_ooc.h2b");
+
+  (void) printf("Checking reduced-precision matrix\n");
+  amap = clone_hmatrix(acopy);
+  lowprec_hmatrix(amap, 1.0e-4);
+  (void) printf("  Farfield storage %.1f KB, full precision %.1f KB\n",
+		getfarsize_hmatrix(amap) / 1024.0,
+		getfarsize_hmatrix(acopy) / 1024.0);
+  if (getfarsize_hmatrix(amap) >= getfarsize_hmatrix(acopy))
+    problems++;
+  error = norm2diff_hmatrix(acopy, amap) / norm2_hmatrix(acopy);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+  mf = spill_hmatrix(amap, "test_hmatrix_ooc.h2b", 0);
+  (void) printf("  Spilling rejected, %sokay\n", mf == NULL ? "" : "    NOT ");
+  if (mf != NULL) {
+    problems++;
+    close_mmapfile(mf);
+  }
+  (void) remove("test_hmatrix_ooc.h2b");
+  fullprec_hmatrix(amap);
+  error = norm2diff_hmatrix(acopy, amap) / norm2_hmatrix(acopy);
+  (void) printf("  Restored accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+  del_hmatrix(amap);
+
+  (void) printf("Checking compressed nearfield\n");
+  amap = clone_hmatrix(acopy);
+  compress_nearfield_hmatrix(amap, 1.0e-4);
+  (void) printf("  Nearfield storage %.1f KB, full precision %.1f KB\n",
+		getnearsize_hmatrix(amap) / 1024.0,
+		getnearsize_hmatrix(acopy) / 1024.0);
+  if (getnearsize_hmatrix(amap) >= getnearsize_hmatrix(acopy))
+    problems++;
+  error = norm2diff_hmatrix(acopy, amap) / norm2_hmatrix(acopy);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+  random_avector(x);
+  clear_avector(b);
+  addevalsymm_hmatrix_avector(alpha, acopy, x, b);
+  addevalsymm_hmatrix_avector(-alpha, amap, x, b);
+  error = norm2_avector(b) / norm2_avector(x) / norm2_hmatrix(acopy);
+  (void) printf("  Symmetric multiplication %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+  decompress_nearfield_hmatrix(amap);
+  error = norm2diff_hmatrix(acopy, amap) / norm2_hmatrix(acopy);
+  (void) printf("  Restored accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, 1.0e-4) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, 1.0e-4))
+    problems++;
+  del_hmatrix(amap);
+
+  (void) printf("Checking matrix-free nearfield\n");
+  amap = build_from_block_hmatrix(block2, 0);
+  assemble_bem2d_hmatrix(bem2, block2, amap);
+  work = clone_hmatrix(amap);
+  matrixfree_nearfield_hmatrix(amap, (matrixentry_t) bem2->nearfield, bem2);
+  (void) printf("  Nearfield storage %.1f KB, full precision %.1f KB\n",
+		getnearsize_hmatrix(amap) / 1024.0,
+		getnearsize_hmatrix(work) / 1024.0);
+  if (getnearsize_hmatrix(amap) >= getnearsize_hmatrix(work))
+    problems++;
+  error = norm2diff_hmatrix(work, amap) / norm2_hmatrix(work);
+  (void) printf("  Accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, tol) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, tol))
+    problems++;
+  store_nearfield_hmatrix(amap);
+  error = norm2diff_hmatrix(work, amap) / norm2_hmatrix(work);
+  (void) printf("  Restored accuracy %g, %sokay\n", error,
+		IS_IN_RANGE(0.0, error, tol) ? "" : "    NOT ");
+  if (!IS_IN_RANGE(0.0, error, tol))
+    problems++;
+  del_hmatrix(work);
+  del_hmatrix(amap);
+
   /* Final clean-up */
   (void) printf("Cleaning up\n");
   del_hmatrix(acopy);
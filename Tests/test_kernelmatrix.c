@@ -3,6 +3,23 @@
 
 #include <stdio.h>
 
+static uint problems = 0;
+
+#ifdef USE_FLOAT
+static real tolerance = 1.0e-5;
+#else
+static real tolerance = 1.0e-12;
+#endif
+
+static void
+check_error(real error, real norm, real tol)
+{
+  (void) printf("  Spectral error %.3e (%.3e), %sokay\n",
+		error, error/norm, (error <= tol * norm ? "" : "    NOT "));
+  if (error > tol * norm)
+    problems++;
+}
+
 static field
 kernel_newton_coord(const real *xx, const real *yy, void *data)
 {
@@ -39,26 +56,91 @@ kernel_log_coord(const real *xx, const real *yy, void *data)
   return (norm2 == 0.0 ? 0.0 : -0.5*REAL_LOG(norm2));
 }
 
+/* Block versions, the inner loops run over contiguous coordinates */
+
+static void
+kernel_newton_block(const real *xx, const real *yy, void *data, pamatrix N)
+{
+  uint rows = N->rows;
+  uint cols = N->cols;
+  longindex ldN = N->ld;
+  real norm2;
+  uint i, j;
+
+  (void) data;
+
+  for(j=0; j<cols; j++)
+    for(i=0; i<rows; i++) {
+      norm2 = (REAL_SQR(xx[i] - yy[j])
+	       + REAL_SQR(xx[i+rows] - yy[j+cols]));
+
+      N->a[i+j*ldN] = (norm2 == 0.0 ? 0.0 : 1.0 / REAL_SQRT(norm2));
+    }
+}
+
+static void
+kernel_exp_block(const real *xx, const real *yy, void *data, pamatrix N)
+{
+  uint rows = N->rows;
+  uint cols = N->cols;
+  longindex ldN = N->ld;
+  real norm2;
+  uint i, j;
+
+  (void) data;
+
+  for(j=0; j<cols; j++)
+    for(i=0; i<rows; i++) {
+      norm2 = (REAL_SQR(xx[i] - yy[j])
+	       + REAL_SQR(xx[i+rows] - yy[j+cols]));
+
+      N->a[i+j*ldN] = REAL_EXP(-norm2);
+    }
+}
+
+static void
+kernel_log_block(const real *xx, const real *yy, void *data, pamatrix N)
+{
+  uint rows = N->rows;
+  uint cols = N->cols;
+  longindex ldN = N->ld;
+  real norm2;
+  uint i, j;
+
+  (void) data;
+
+  for(j=0; j<cols; j++)
+    for(i=0; i<rows; i++) {
+      norm2 = (REAL_SQR(xx[i] - yy[j])
+	       + REAL_SQR(xx[i+rows] - yy[j+cols]));
+
+      N->a[i+j*ldN] = (norm2 == 0.0 ? 0.0 : -0.5*REAL_LOG(norm2));
+    }
+}
+
 int
 main(int argc, char **argv)
 {
-  pkernelmatrix km;
-  pclustergeometry cg;
-  pcluster root;
-  pblock broot;
-  pclusterbasis cb;
-  ph2matrix Gh1, Gh2;
-  pamatrix G;
+  pkernelmatrix km, km2;
+  pclustergeometry cg, cg2;
+  pcluster root, root2;
+  pblock broot, broot2;
+  pclusterbasis cb, cb2, cb3;
+  ph2matrix Gh1, Gh2, Gh3, Gh4, Gh5;
+  pamatrix G, G2;
+  pavector x, xt, xt2;
   pstopwatch sw;
   char kernel;
   uint points;
   uint m, leafsize;
-  uint *idx;
+  uint *idx, *idx2;
+  uint n;
   size_t sz;
   real eps, eta;
   real t_setup, norm, error;
-  uint i;
+  uint i, j;
   field (*kernel_func)(const real *, const real *, void *);
+  void (*kernel_block_func)(const real *, const real *, void *, pamatrix);
 
   h2lib_init(&argc, &argv);
 
@@ -84,14 +166,17 @@ main(int argc, char **argv)
   case 'e':
     (void) printf("  Exponential kernel function\n");
     kernel_func = kernel_exp_coord;
+    kernel_block_func = kernel_exp_block;
     break;
   case 'n':
     (void) printf("  Newton kernel function\n");
     kernel_func = kernel_newton_coord;
+    kernel_block_func = kernel_newton_block;
     break;
   default:
     (void) printf("  Logarithmic kernel function\n");
     kernel_func = kernel_log_coord;
+    kernel_block_func = kernel_log_block;
   }
   
   /* Setup kernel using simplified API */
@@ -132,6 +217,39 @@ main(int argc, char **argv)
 		"  %.1f KB/DoF\n",
 		t_setup, sz / 1048576.0, sz / 1024.0 / points);
 
+  (void) printf("Comparing Kronecker and full transfer matrices\n");
+  cb2 = clone_clusterbasis(cb);
+  x = new_avector(points);
+  xt = new_coeffs_clusterbasis_avector(cb);
+  xt2 = new_coeffs_clusterbasis_avector(cb2);
+  random_avector(x);
+  forward_clusterbasis_avector(cb, x, xt);
+  forward_clusterbasis_avector(cb2, x, xt2);
+  norm = norm2_avector(xt2);
+  add_avector(-1.0, xt, xt2);
+  error = norm2_avector(xt2);
+  (void) printf("  Forward error %.3e (%.3e), %sokay\n",
+		error, error/norm,
+		(error <= tolerance * norm ? "" : "    NOT "));
+  if (error > tolerance * norm)
+    problems++;
+  clear_avector(x);
+  copy_avector(xt, xt2);
+  backward_clusterbasis_avector(cb, xt, x);
+  norm = norm2_avector(x);
+  scale_avector(-1.0, x);
+  backward_clusterbasis_avector(cb2, xt2, x);
+  error = norm2_avector(x);
+  (void) printf("  Backward error %.3e (%.3e), %sokay\n",
+		error, error/norm,
+		(error <= tolerance * norm ? "" : "    NOT "));
+  if (error > tolerance * norm)
+    problems++;
+  del_avector(xt2);
+  del_avector(xt);
+  del_avector(x);
+  del_clusterbasis(cb2);
+
   (void) printf("Creating H^2-matrix\n");
   Gh1 = build_from_block_h2matrix(broot, cb, cb);
   sz = getsize_h2matrix(Gh1);
@@ -183,10 +301,138 @@ main(int argc, char **argv)
   (void) printf("  Spectral error %.3e (%.3e)\n",
 		error, error/norm);
 
+  (void) printf("Choosing interpolation orders for eps=%g\n",
+		eps);
+  chooseorders_kernelmatrix(km, root, eta, eps);
+  (void) printf("  Orders");
+  for(i=0; i<km->levels; i++)
+    (void) printf(" %u", km->m_level[i]);
+  (void) printf("\n");
+  cb2 = build_from_cluster_clusterbasis(root);
+  fill_clusterbasis_kernelmatrix(km, cb2);
+  Gh3 = build_from_block_h2matrix(broot, cb2, cb2);
+  start_stopwatch(sw);
+  fill_h2matrix_kernelmatrix(km, Gh3);
+  t_setup = stop_stopwatch(sw);
+  sz = getsize_h2matrix(Gh3);
+  (void) printf("  %.2f seconds\n"
+		"  %.1f MB\n"
+		"  %.1f KB/DoF\n",
+		t_setup, sz / 1048576.0, sz / 1024.0 / points);
+
+  (void) printf("Computing approximation error\n");
+  error = norm2diff_amatrix_h2matrix(Gh3, G);
+  check_error(error, norm, eps);
+  del_h2matrix(Gh3);
+  setorders_kernelmatrix(km, 0, 0);
+
+  (void) printf("Switching to block kernel function\n");
+  km->kernel_block = kernel_block_func;
+
+  (void) printf("Filling reference matrix\n");
+  G2 = new_amatrix(points, points);
+  start_stopwatch(sw);
+  fillN_kernelmatrix(0, 0, km, G2);
+  t_setup = stop_stopwatch(sw);
+  (void) printf("  %.2f seconds\n",
+		t_setup);
+
+  (void) printf("Comparing to pointwise reference matrix\n");
+  error = norm2diff_amatrix(G2, G);
+  check_error(error, norm, tolerance);
+
+  (void) printf("Filling H^2-matrix\n");
+  Gh3 = build_from_block_h2matrix(broot, cb, cb);
+  start_stopwatch(sw);
+  fill_h2matrix_kernelmatrix(km, Gh3);
+  t_setup = stop_stopwatch(sw);
+  (void) printf("  %.2f seconds\n",
+		t_setup);
+
+  (void) printf("Comparing to pointwise H^2-matrix\n");
+  error = norm2diff_h2matrix(Gh3, Gh1);
+  check_error(error, norm, tolerance);
+  del_h2matrix(Gh3);
+
+  /* Power of two, so that the clusters are congruent */
+  n = 1;
+  while(4*n*n <= points)
+    n *= 2;
+  (void) printf("Creating kernelmatrix object for %u x %u grid\n",
+		n, n);
+  km2 = new_kernelmatrix(2, n*n, m);
+  h2lib_setup_kernel(km2, kernel_func, NULL);
+  for(j=0; j<n; j++)
+    for(i=0; i<n; i++) {
+      km2->x[i+j*n][0] = 2.0 * i / n;
+      km2->x[i+j*n][1] = 2.0 * j / n;
+    }
+
+  cg2 = creategeometry_kernelmatrix(km2);
+  idx2 = (uint *) allocmem(sizeof(uint) * n*n);
+  for(i=0; i<n*n; i++)
+    idx2[i] = i;
+  root2 = build_adaptive_cluster(cg2, n*n, idx2, leafsize);
+  broot2 = build_strict_block(root2, root2, &eta, admissible_2_cluster);
+
+  (void) printf("Filling H^2-matrix\n");
+  cb2 = build_from_cluster_clusterbasis(root2);
+  fill_clusterbasis_kernelmatrix(km2, cb2);
+  Gh4 = build_from_block_h2matrix(broot2, cb2, cb2);
+  fill_h2matrix_kernelmatrix(km2, Gh4);
+  sz = getfarsize_h2matrix(Gh4);
+  (void) printf("  Coupling matrices %.1f MB\n",
+		sz / 1048576.0);
+
+  (void) printf("Filling H^2-matrix with shared matrices\n");
+  setshared_kernelmatrix(km2, true);
+  cb3 = build_from_cluster_clusterbasis(root2);
+  fill_clusterbasis_kernelmatrix(km2, cb3);
+  Gh5 = build_from_block_h2matrix(broot2, cb3, cb3);
+  fill_h2matrix_kernelmatrix(km2, Gh5);
+  sz = getfarsize_h2matrix(Gh5) + getsharedsize_kernelmatrix(km2);
+  (void) printf("  %u shared matrices\n"
+		"  Coupling and shared matrices %.1f MB\n",
+		km2->cache->entries, sz / 1048576.0);
+
+  (void) printf("Comparing to unshared H^2-matrix\n");
+  norm = norm2_h2matrix(Gh4);
+  error = norm2diff_h2matrix(Gh5, Gh4);
+  check_error(error, norm, tolerance);
+
+  /* Shared matrices belong to km2, the cluster bases are released
+   * together with the last matrix referencing them */
+  del_h2matrix(Gh5);
+  del_h2matrix(Gh4);
+  del_block(broot2);
+  del_cluster(root2);
+  freemem(idx2);
+  del_clustergeometry(cg2);
+  h2lib_cleanup_kernel(km2);
+  del_kernelmatrix(km2);
+
+  del_amatrix(G2);
+  del_amatrix(G);
+  del_h2matrix(Gh2);
+  del_h2matrix(Gh1);
+  del_block(broot);
+  del_cluster(root);
+  freemem(idx);
+  del_clustergeometry(cg);
+
   /* Clean up kernel data using simplified API */
   h2lib_cleanup_kernel(km);
+  del_kernelmatrix(km);
+
+  del_stopwatch(sw);
+
+  (void) printf("----------------------------------------\n"
+		"  %u matrices and\n"
+		"  %u vectors still active\n"
+		"  %u errors found\n", getactives_amatrix(),
+		getactives_avector(), problems);
 
   h2lib_finalize();
 
-  return 0;
+  return problems;
 }
@@ -19,15 +19,34 @@ gauss_seidel(void *pdata, pavector r)
   triangularsolve_amatrix_avector(true, false, false, A, r);
 }
 
+/* Inexact preconditioner: a few steps of GMRES, changing with r */
+static void
+inner_gmres(void *pdata, pavector r)
+{
+  pamatrix  A = (pamatrix) pdata;
+  pavector  b;
+
+  b = new_avector(r->dim);
+  copy_avector(r, b);
+  clear_avector(r);
+  solve_gmres_amatrix_avector(A, b, r, 1e-1, 4, 4);
+  del_avector(b);
+}
+
 int
 main()
 {
   pamatrix  A;
   pavector  b, x;
   pavector  r;
+  pamatrix  B, X, R;
+  pavector  bj, b0;
+  avector   tmp, tmp0;
+  pgmresworkspace ws;
+  precyclespace rs;
   real      eps, norm, error;
   uint      n, kmax;
-  uint      iter;
+  uint      iter, iter2, i, j;
   uint      problems;
 
   problems = 0;
@@ -126,6 +145,195 @@ main()
     problems++;
   }
 
+  (void) printf("Testing GMRES method with reused workspace\n");
+  random_invertible_amatrix(A, 1.0);
+  ws = new_gmresworkspace(n, n + 1);
+  for (i = 0; i < 3; i++) {
+    random_avector(b);
+    norm = norm2_avector(b);
+
+    clear_avector(x);
+    iter = solve_gmres_workspace_avector(A,
+					 (addeval_t) addeval_amatrix_avector,
+					 ws, b, x, eps, 0);
+    copy_avector(b, r);
+    addeval_amatrix_avector(-1.0, A, x, r);
+    error = norm2_avector(r);
+    (void) printf("  %u steps\n"
+		  "  Residual %.2e (%.2e)", iter, error, error / norm);
+
+    if (iter <= n && error <= eps * norm)
+      printf("    Okay\n");
+    else {
+      printf("    NOT Okay\n");
+      problems++;
+    }
+  }
+  del_gmresworkspace(ws);
+
+  (void) printf("Testing flexible GMRES method\n");
+  random_invertible_amatrix(A, 1.0);
+  random_avector(b);
+  norm = norm2_avector(b);
+
+  clear_avector(x);
+  iter = solve_fgmres_amatrix_avector(A, inner_gmres, A, b, x, eps, 0, kmax);
+  copy_avector(b, r);
+  addeval_amatrix_avector(-1.0, A, x, r);
+  error = norm2_avector(r);
+  (void) printf("  %u steps\n"
+		"  Residual %.2e (%.2e)", iter, error, error / norm);
+
+  if (iter <= n && error <= eps * norm)
+    printf("    Okay\n");
+  else {
+    printf("    NOT Okay\n");
+    problems++;
+  }
+
+  (void) printf("Testing block GMRES method\n");
+  random_invertible_amatrix(A, 1.0);
+  B = new_amatrix(n, 6);
+  X = new_amatrix(n, 6);
+  R = new_amatrix(n, 6);
+  random_amatrix(B);
+  /* Linearly dependent right-hand side and a zero right-hand side */
+  bj = init_column_avector(&tmp, B, 4);
+  b0 = init_column_avector(&tmp0, B, 0);
+  copy_avector(b0, bj);
+  uninit_avector(b0);
+  b0 = init_column_avector(&tmp0, B, 1);
+  add_avector(2.0, b0, bj);
+  uninit_avector(b0);
+  uninit_avector(bj);
+  bj = init_column_avector(&tmp, B, 5);
+  clear_avector(bj);
+  uninit_avector(bj);
+
+  clear_amatrix(X);
+  iter = solve_blockgmres_amatrix_amatrix(A, B, X, eps, 0, 2 * kmax + 2);
+  copy_amatrix(false, B, R);
+  addmul_amatrix(-1.0, false, A, false, X, R);
+  (void) printf("  %u steps\n", iter);
+  for (i = 0; i < 6; i++) {
+    bj = init_column_avector(&tmp, B, i);
+    norm = norm2_avector(bj);
+    uninit_avector(bj);
+    bj = init_column_avector(&tmp, R, i);
+    error = norm2_avector(bj);
+    uninit_avector(bj);
+    (void) printf("  Residual %.2e (%.2e)", error,
+		  (norm > 0.0 ? error / norm : error));
+
+    if (error <= eps * norm)
+      printf("    Okay\n");
+    else {
+      printf("    NOT Okay\n");
+      problems++;
+    }
+  }
+  if (iter > n) {
+    printf("  Too many steps\n");
+    problems++;
+  }
+  del_amatrix(R);
+  del_amatrix(X);
+  del_amatrix(B);
+
+  (void) printf("Testing GCRO-DR method with a sequence of matrices\n");
+  random_amatrix(A);
+  B = new_amatrix(n, n);
+  rs = new_recyclespace(n, kmax, 4);
+  for (j = 0; j < 4; j++) {
+    /* Slowly changing ill-conditioned matrix, four small eigenvalues
+     * stall restarted GMRES */
+    clear_amatrix(B);
+    for (i = 0; i < n; i++)
+      B->a[i + i * B->ld] = (i < 4 ? 1e-3 * (i + 1) : 1.0 + 0.02 * i);
+    add_amatrix(0.01 * (1.0 + 0.1 * j) / REAL_SQRT(n), false, A, B);
+    random_avector(b);
+    norm = norm2_avector(b);
+
+    /* Restarted GMRES with the same number of basis vectors */
+    clear_avector(x);
+    iter2 = solve_gmres_amatrix_avector(B, b, x, eps, 0, kmax + 4);
+
+    clear_avector(x);
+    iter = solve_gcrodr_amatrix_avector(B, rs, b, x, eps, 0);
+    copy_avector(b, r);
+    addeval_amatrix_avector(-1.0, B, x, r);
+    error = norm2_avector(r);
+    (void) printf("  %u steps (GMRES %u), %u recycled vectors\n"
+		  "  Residual %.2e (%.2e)", iter, iter2, rs->kc, error,
+		  error / norm);
+
+    /* Once a subspace is recycled, far fewer steps are required */
+    if (error <= eps * norm && (j == 0 ? iter <= iter2 : 2 * iter < iter2))
+      printf("    Okay\n");
+    else {
+      printf("    NOT Okay\n");
+      problems++;
+    }
+  }
+  del_recyclespace(rs);
+  del_amatrix(B);
+
+  (void) printf("Testing pipelined conjugate gradient method\n");
+  random_spd_amatrix(A, 1.0);
+  random_avector(b);
+  norm = norm2_avector(b);
+
+  clear_avector(x);
+  iter = solve_pipecg_amatrix_avector(A, 0, 0, b, x, eps, 0);
+  copy_avector(b, r);
+  addeval_amatrix_avector(-1.0, A, x, r);
+  error = norm2_avector(r);
+  (void) printf("  %u steps\n"
+		"  Residual %.2e (%.2e)", iter, error, error / norm);
+
+  if (iter <= n && error <= eps * norm)
+    printf("    Okay\n");
+  else {
+    printf("    NOT Okay\n");
+    problems++;
+  }
+
+  (void) printf("Testing pipelined preconditioned conjugate gradient method\n");
+  clear_avector(x);
+  iter = solve_pipecg_amatrix_avector(A, jacobi, A, b, x, eps, 0);
+  copy_avector(b, r);
+  addeval_amatrix_avector(-1.0, A, x, r);
+  error = norm2_avector(r);
+  (void) printf("  %u steps\n"
+		"  Residual %.2e (%.2e)", iter, error, error / norm);
+
+  if (iter <= n && error <= eps * norm)
+    printf("    Okay\n");
+  else {
+    printf("    NOT Okay\n");
+    problems++;
+  }
+
+  (void) printf("Testing pipelined GMRES method\n");
+  random_invertible_amatrix(A, 1.0);
+  random_avector(b);
+  norm = norm2_avector(b);
+
+  clear_avector(x);
+  iter = solve_pipegmres_amatrix_avector(A, b, x, eps, 0, kmax);
+  copy_avector(b, r);
+  addeval_amatrix_avector(-1.0, A, x, r);
+  error = norm2_avector(r);
+  (void) printf("  %u steps\n"
+		"  Residual %.2e (%.2e)", iter, error, error / norm);
+
+  if (error <= eps * norm)
+    printf("    Okay\n");
+  else {
+    printf("    NOT Okay\n");
+    problems++;
+  }
+
   del_avector(r);
   del_avector(x);
   del_avector(b);
@@ -54,8 +54,10 @@ test_system(matrixtype mattype, const char *apprxtype,
 	    real high)
 {
   pavector  x, f, b;
+  pctaskpool tp;
   real      errorV, errorKM, error_solve, eps_solve;
-  uint      steps;
+  uint      steps, done, stolen, i;
+  bool      timing;
 
   eps_solve = 1.0e-12;
   steps = 1000;
@@ -70,6 +72,28 @@ test_system(matrixtype mattype, const char *apprxtype,
   if (mattype == HMATRIX) {
     assemble_bem3d_hmatrix(bem_slp, brootV, (phmatrix) V);
     assemble_bem3d_hmatrix(bem_dlp, brootKM, KM);
+
+    tp = bem_dlp->tasks;
+    done = stolen = 0;
+    timing = (tp->wall > 0.0);
+    for (i = 0; i < tp->threads; i++) {
+      done += tp->done[i];
+      stolen += tp->stolen[i];
+      timing = timing && tp->busy[i] <= tp->wall * (1.0 + 1.0e-6)
+	&& REAL_ABS(tp->busy[i] + tp->idle[i] - tp->wall)
+	<= 1.0e-6 * tp->wall;
+    }
+    print_taskpool(tp);
+    if (done != tp->tasks || stolen > done) {
+      printf("  %u of %u leaves assembled, %u stolen    NOT okay\n", done,
+	     tp->tasks, stolen);
+      problems++;
+    }
+    if (!timing) {
+      printf("  Inconsistent task pool timing    NOT okay\n");
+      problems++;
+    }
+
     errorV = norm2diff_amatrix_hmatrix((phmatrix) V, Vfull)
       / norm2_amatrix(Vfull);
     printf("rel. error V       : %.5e\n", errorV);
@@ -164,6 +188,75 @@ test_system(matrixtype mattype, const char *apprxtype,
   del_avector(b);
 }
 
+static void
+test_fused(pbem3d bem_slp, pbem3d bem_dlp, pcluster rootn, pcluster rootd,
+	   pblock broot, pcamatrix Vfull, pcamatrix KMfull)
+{
+  pbem3d    bem[3];
+  pamatrix  N[3], D;
+  phmatrix  G[3], V, KM;
+  real      error, errorh;
+  uint      l;
+
+  bem[0] = bem_slp;
+  bem[1] = bem_dlp;
+  bem[2] = NULL;
+
+  /* Nearfield matrices of both operators in one pass */
+  N[0] = new_amatrix(Vfull->rows, Vfull->cols);
+  N[1] = new_amatrix(KMfull->rows, KMfull->cols);
+  N[2] = NULL;
+  nearfield_fused_laplacebem3d(NULL, NULL, bem, false, 3, N);
+
+  add_amatrix(-1.0, false, Vfull, N[0]);
+  add_amatrix(-1.0, false, KMfull, N[1]);
+  error = REAL_MAX(normfrob_amatrix(N[0]) / normfrob_amatrix(Vfull),
+		   normfrob_amatrix(N[1]) / normfrob_amatrix(KMfull));
+
+  /* Fused hmatrix assembly compared to separate assembly */
+  setup_hmatrix_aprx_inter_row_bem3d(bem_slp, rootn, rootd, broot, 4);
+  setup_hmatrix_aprx_inter_row_bem3d(bem_dlp, rootn, rootd, broot, 4);
+
+  V = build_from_block_hmatrix(broot, 0);
+  KM = build_from_block_hmatrix(broot, 0);
+  assemble_bem3d_hmatrix(bem_slp, broot, V);
+  assemble_bem3d_hmatrix(bem_dlp, broot, KM);
+
+  G[0] = build_from_block_hmatrix(broot, 0);
+  G[1] = build_from_block_hmatrix(broot, 0);
+  G[2] = NULL;
+  assemble_bem3d_fused_hmatrix(3, bem, broot, G,
+			       nearfield_fused_laplacebem3d);
+
+  D = N[0];
+  clear_amatrix(D);
+  add_hmatrix_amatrix(1.0, false, V, D);
+  add_hmatrix_amatrix(-1.0, false, G[0], D);
+  errorh = normfrob_amatrix(D) / normfrob_amatrix(Vfull);
+  D = N[1];
+  clear_amatrix(D);
+  add_hmatrix_amatrix(1.0, false, KM, D);
+  add_hmatrix_amatrix(-1.0, false, G[1], D);
+  errorh = REAL_MAX(errorh, normfrob_amatrix(D) / normfrob_amatrix(KMfull));
+
+  printf("Fused SLP/DLP assembly:\n"
+	 "  rel. error nearfield %.3e      %s\n"
+	 "  rel. error hmatrix   %.3e      %s\n\n", error,
+	 (error < 1.0e-12 ? "    okay" : "NOT okay"), errorh,
+	 (errorh < 1.0e-12 ? "    okay" : "NOT okay"));
+  if (error >= 1.0e-12)
+    problems++;
+  if (errorh >= 1.0e-12)
+    problems++;
+
+  for (l = 0; l < 2; l++) {
+    del_hmatrix(G[l]);
+    del_amatrix(N[l]);
+  }
+  del_hmatrix(KM);
+  del_hmatrix(V);
+}
+
 void
 test_suite(pcsurface3d gr, uint q, uint clf, real eta,
 	   basisfunctionbem3d row_basis, basisfunctionbem3d col_basis,
@@ -172,7 +265,9 @@ test_suite(pcsurface3d gr, uint q, uint clf, real eta,
   pbem3d    bem_slp, bem_dlp;
   pcluster  rootn, rootd;
   pblock    brootV, brootKM;
-  pamatrix  Vfull, KMfull;
+  pamatrix  Vfull, KMfull, Gcache;
+  size_t    sz;
+  uint      slots;
   phmatrix  V, KM;
   pclusterbasis Vrb, Vcb, KMrb, KMcb;
   ph2matrix V2, KM2;
@@ -182,6 +277,7 @@ test_suite(pcsurface3d gr, uint q, uint clf, real eta,
   uint      l;
   real      delta;
   real      eps_aca;
+  real      error;
 
   nn = row_basis == BASIS_LINEAR_BEM3D ? gr->vertices : gr->triangles;
   nd = col_basis == BASIS_LINEAR_BEM3D ? gr->vertices : gr->triangles;
@@ -204,6 +300,96 @@ test_suite(pcsurface3d gr, uint q, uint clf, real eta,
   bem_slp->nearfield(NULL, NULL, bem_slp, false, Vfull);
   bem_dlp->nearfield(NULL, NULL, bem_dlp, false, KMfull);
 
+  /*
+   * Test cache for singular integrals
+   */
+
+  Gcache = new_amatrix(nn, nd);
+  setup_singcache_bem3d(bem_dlp, 1 << 24);
+  bem_dlp->nearfield(NULL, NULL, bem_dlp, false, Gcache);
+  error = normfrob_amatrix(KMfull);
+  add_amatrix(-1.0, false, KMfull, Gcache);
+  error = normfrob_amatrix(Gcache) / error;
+  printf("Singular integral cache: %u classes, %lu hits, %lu misses\n"
+	 "  rel. error %.3e      %s\n\n",
+	 bem_dlp->sq->cache->entries,
+	 (unsigned long) bem_dlp->sq->cache->hits,
+	 (unsigned long) bem_dlp->sq->cache->misses, error,
+	 (error < 1.0e-10 ? "    okay" : "NOT okay"));
+  if (error >= 1.0e-10)
+    problems++;
+  /* Every pair of neighbouring triangles is congruent to some other
+   * pair on the regular test geometries, so the cache has to be used */
+  if (bem_dlp->sq->cache->hits == 0) {
+    printf("  Singular integral cache was never used    NOT okay\n\n");
+    problems++;
+  }
+  setup_singcache_bem3d(bem_dlp, 0);
+  del_amatrix(Gcache);
+
+  /*
+   * Test fused assembly of single and double layer operator
+   */
+
+  if (nn == nd)
+    test_fused(bem_slp, bem_dlp, rootn, rootd, brootKM, Vfull, KMfull);
+
+  /*
+   * Compare SIMD kernels with the scalar fallback
+   */
+
+  if (use_simd) {
+    simdisa   isa0 = simd_isa;
+    simdisa   isa;
+    pamatrix  Gref;
+
+    use_simd = false;
+    Gref = new_amatrix(nn, nd);
+    bem_dlp->nearfield(NULL, NULL, bem_dlp, false, Gref);
+    use_simd = true;
+    Gcache = new_amatrix(nn, nd);
+    for (isa = SIMD_SSE2; isa <= SIMD_AVX512; isa++) {
+      if (!supports_simd_h2lib(isa)) {
+	continue;
+      }
+      simd_isa = isa;
+      bem_dlp->nearfield(NULL, NULL, bem_dlp, false, Gcache);
+      error = normfrob_amatrix(Gref);
+      add_amatrix(-1.0, false, Gref, Gcache);
+      error = normfrob_amatrix(Gcache) / error;
+      printf("SIMD kernels (%s) vs. scalar kernels:\n"
+	     "  rel. error %.3e      %s\n\n", simd_isa_h2lib(), error,
+	     (error < 1.0e-10 ? "    okay" : "NOT okay"));
+      if (error >= 1.0e-10)
+	problems++;
+    }
+    simd_isa = isa0;
+    del_amatrix(Gcache);
+    del_amatrix(Gref);
+  }
+
+  /*
+   * Test precomputed quadrature points, restricted to half of the
+   * triangles appearing in nearfield blocks
+   */
+
+  (void) setup_triquadpoints_bem3d(bem_slp, NULL, 0, 0);
+  sz = getsize_triquadpoints_singquad2d(bem_slp->sq);
+  slots = setup_triquadpoints_bem3d(bem_slp, brootV, 1, sz / 2);
+  Gcache = new_amatrix(nn, nn);
+  bem_slp->nearfield(NULL, NULL, bem_slp, false, Gcache);
+  error = normfrob_amatrix(Vfull);
+  add_amatrix(-1.0, false, Vfull, Gcache);
+  error = normfrob_amatrix(Gcache) / error;
+  printf("Precomputed quadrature points: %u of %u triangles, %.1f KB\n"
+	 "  rel. error %.3e      %s\n\n", slots, gr->triangles,
+	 getsize_triquadpoints_singquad2d(bem_slp->sq) / 1024.0, error,
+	 (error < 1.0e-10 ? "    okay" : "NOT okay"));
+  if (error >= 1.0e-10 || 2 * slots > gr->triangles)
+    problems++;
+  del_triquadpoints_singquad2d(bem_slp->sq);
+  del_amatrix(Gcache);
+
   /*
    * Test Interpolation
    */
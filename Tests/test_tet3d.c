@@ -132,13 +132,13 @@ main(int argc, char **argv)
     (void) printf("  %.1f seconds\n"
 		  "  %.1f MB (interaction %.1f MB)\n"
 		  "  %.1f KB/DoF (interaction %.1f KB/DoF)\n"
-		  "  %u non-zero entries (interaction %u)\n",
+		  "  %lu non-zero entries (interaction %lu)\n",
 		  runtime,
 		  getsize_sparsematrix(A) / 1048576.0,
 		  getsize_sparsematrix(Af) / 1048576.0,
 		  getsize_sparsematrix(A) / 1024.0 / dc[i]->ndof,
 		  getsize_sparsematrix(Af) / 1024.0 / dc[i]->ndof,
-		  A->nz, Af->nz);
+		  (unsigned long) A->nz, (unsigned long) Af->nz);
 
     (void) printf("  Setting up Dirichlet data\n");
     xd = new_avector(dc[i]->nfix);
@@ -291,21 +291,21 @@ main (int argc, char **argv){
     (void) printf("  %.6f seconds\n"
 		  "  sp_A:\n  %.1f MB (interaction %.1f MB)\n"
 		  "  %.1f KB/DoF (interaction %.1f KB/DoF)\n"
-		  "  %u non-zero entries (interaction %u)\n"
+		  "  %lu non-zero entries (interaction %lu)\n"
 		  "  sp_B:\n  %.1f MB (interaction %.1f MB)\n"
 		  "  %.1f KB/DoF (interaction %.1f KB/DoF)\n"
-		  "  %u non-zero entries (interaction %u)\n",
+		  "  %lu non-zero entries (interaction %lu)\n",
 		  time,
 		  getsize_sparsematrix(sp_A) / 1048576.0,
 		  getsize_sparsematrix(sp_Af) / 1048576.0,
 		  getsize_sparsematrix(sp_A) / 1024.0 / dc[i]->ndof,
 		  getsize_sparsematrix(sp_Af) / 1024.0 / dc[i]->ndof,
-		  sp_A->nz, sp_Af->nz,
+		  (unsigned long) sp_A->nz, (unsigned long) sp_Af->nz,
 		  getsize_sparsematrix(sp_B) / 1048576.0,
 		  getsize_sparsematrix(sp_Bf) / 1048576.0,
 		  getsize_sparsematrix(sp_B) / 1024.0 / dc[i]->ndof,
 		  getsize_sparsematrix(sp_Bf) / 1024.0 / dc[i]->ndof,
-		  sp_B->nz, sp_Bf->nz);
+		  (unsigned long) sp_B->nz, (unsigned long) sp_Bf->nz);
     
     dim_A = sp_A->rows;
     rows_B = sp_B->rows;